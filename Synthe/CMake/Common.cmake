@@ -4,6 +4,7 @@ set ( SYNTHE_MATH_SRC_DIR ${SYNTHE_SOURCE_DIR}/Common/Math )
 set ( SYNTHE_MEMORY_INC_DIR ${SYNTHE_COMMON_INC_DIR}/Memory )
 set ( SYNTHE_SYSTEM_INC_DIR ${SYNTHE_COMMON_INC_DIR}/System )
 set ( SYNTHE_MEMORY_SRC_DIR ${SYNTHE_SOURCE_DIR}/Memory )
+set ( SYNTHE_COMMON_SRC_DIR ${SYNTHE_SOURCE_DIR}/Common )
 
 
 set ( SYNTHE_MATH_FILES
@@ -21,16 +22,30 @@ set ( SYNTHE_MEMORY_FILES
     ${SYNTHE_MEMORY_INC_DIR}/NewAllocator.hpp
     ${SYNTHE_MEMORY_INC_DIR}/BuddyAllocator.hpp
     ${SYNTHE_MEMORY_INC_DIR}/FreeListAllocator.hpp
+    ${SYNTHE_MEMORY_INC_DIR}/RangeAllocator.hpp
+    ${SYNTHE_MEMORY_INC_DIR}/StreamCopy.hpp
     
     ${SYNTHE_MEMORY_SRC_DIR}/LinearAllocator.cpp
     ${SYNTHE_MEMORY_SRC_DIR}/NewAllocator.cpp
     ${SYNTHE_MEMORY_SRC_DIR}/BuddyAllocator.cpp
     ${SYNTHE_MEMORY_SRC_DIR}/FreeListAllocator.cpp
+    ${SYNTHE_MEMORY_SRC_DIR}/RangeAllocator.cpp
+    ${SYNTHE_MEMORY_SRC_DIR}/StreamCopy.cpp
 )
 
 set ( SYNTHE_COMMON_FILES
     ${SYNTHE_COMMON_INC_DIR}/Types.hpp
+    ${SYNTHE_COMMON_INC_DIR}/BlobCache.hpp
+    ${SYNTHE_COMMON_INC_DIR}/Hash.hpp
+    ${SYNTHE_COMMON_INC_DIR}/Json.hpp
+    ${SYNTHE_COMMON_INC_DIR}/MappedFile.hpp
     ${SYNTHE_COMMON_INC_DIR}/String.hpp
+    ${SYNTHE_COMMON_INC_DIR}/WorkerPool.hpp
+
+    ${SYNTHE_COMMON_SRC_DIR}/BlobCache.cpp
+    ${SYNTHE_COMMON_SRC_DIR}/Json.cpp
+    ${SYNTHE_COMMON_SRC_DIR}/MappedFile.cpp
+    ${SYNTHE_COMMON_SRC_DIR}/WorkerPool.cpp
 )
 
 
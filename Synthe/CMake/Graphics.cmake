@@ -1,8 +1,11 @@
 set ( SYNTHE_GRAPHICS_INC_DIR ${SYNTHE_INCLUDE_DIR}/Graphics )
+set ( SYNTHE_GRAPHICS_SRC_DIR ${SYNTHE_SOURCE_DIR}/Graphics )
 set ( SYNTHE_D3D12_SRC_DIR ${SYNTHE_SOURCE_DIR}/D3D12 )
 
 
 set (SYNTHE_INCLUDE_FILES 
+    ${SYNTHE_GRAPHICS_INC_DIR}/CommandStream.hpp
+    ${SYNTHE_GRAPHICS_INC_DIR}/DrawPackets.hpp
     ${SYNTHE_GRAPHICS_INC_DIR}/Fence.hpp
     ${SYNTHE_GRAPHICS_INC_DIR}/GraphicsBuffer.hpp
     ${SYNTHE_GRAPHICS_INC_DIR}/GraphicsCommandList.hpp
@@ -12,36 +15,69 @@ set (SYNTHE_INCLUDE_FILES
     ${SYNTHE_GRAPHICS_INC_DIR}/GraphicsResource.hpp
     ${SYNTHE_GRAPHICS_INC_DIR}/GraphicsResourceView.hpp
     ${SYNTHE_GRAPHICS_INC_DIR}/GraphicsStructs.hpp
+    ${SYNTHE_GRAPHICS_INC_DIR}/ParallelRecording.hpp
     ${SYNTHE_GRAPHICS_INC_DIR}/PipelineState.hpp
     ${SYNTHE_GRAPHICS_INC_DIR}/RenderPass.hpp
+    ${SYNTHE_GRAPHICS_INC_DIR}/ShaderPack.hpp
+    ${SYNTHE_GRAPHICS_INC_DIR}/ShaderPermutations.hpp
     ${SYNTHE_GRAPHICS_INC_DIR}/Swapchain.hpp
+
+    ${SYNTHE_GRAPHICS_SRC_DIR}/CommandStream.cpp
+    ${SYNTHE_GRAPHICS_SRC_DIR}/DrawPackets.cpp
+    ${SYNTHE_GRAPHICS_SRC_DIR}/ParallelRecording.cpp
+    ${SYNTHE_GRAPHICS_SRC_DIR}/RenderPass.cpp
+    ${SYNTHE_GRAPHICS_SRC_DIR}/ShaderPack.cpp
+    ${SYNTHE_GRAPHICS_SRC_DIR}/ShaderPermutations.cpp
 )
 
 
 set (SYNTHE_D3D12_FILES
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12BarrierBatcher.hpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12BindlessTable.hpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12Buffers.hpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12CommandAllocatorPool.hpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12CommandList.hpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12ComputePipelineState.hpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12Fence.hpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12DescriptorCopyBatcher.hpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12DescriptorManager.hpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12DescriptorTableCache.hpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12GraphicsCommandQueue.hpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12GraphicsDevice.hpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12GraphicsPipelineState.hpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12LocalResourceStates.hpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12PipelineStateCache.hpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12PipelineUsage.hpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12Resource.hpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12RootSignatureCache.hpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12SamplerCache.hpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12ResourceView.hpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12Swapchain.hpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12ViewCache.hpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12BarrierBatcher.cpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12BindlessTable.cpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12CommandAllocatorPool.cpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12CommandList.cpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12ComputePipelineState.cpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12Fence.cpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12DescriptorCopyBatcher.cpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12DescriptorManager.cpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12DescriptorTableCache.cpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12GraphicsCommandQueue.cpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12GraphicsPipelineState.cpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12LocalResourceStates.cpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12PipelineStateCache.cpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12PipelineUsage.cpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12GraphicsDevice.cpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12MemoryManager.hpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12MemoryManager.cpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12PhysicalDeviceFeatures.cpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12Resource.cpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12RootSignatureCache.cpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12SamplerCache.cpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12ResourceView.cpp
     ${SYNTHE_D3D12_SRC_DIR}/D3D12Swapchain.cpp
+    ${SYNTHE_D3D12_SRC_DIR}/D3D12ViewCache.cpp
 )
 
 set ( SYNTHE_GLOB
@@ -0,0 +1,85 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Common/Types.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace Synthe {
+
+
+//! Read a whole file into memory.
+//!
+//! \param Path The file to read.
+//! \param OutBytes The contents of the file.
+//! \return SResult_OK on success. SResult_OBJECT_NOT_FOUND if the file could not be opened.
+ResultCode ReadFileBytes(const std::string& Path, std::vector<U8>& OutBytes);
+
+
+//! Write a whole file. The contents go to a temporary file first, which then replaces the
+//! destination, so an interrupted write never leaves a truncated file behind.
+//!
+//! \param Path The file to write.
+//! \param PData The contents.
+//! \param SizeInBytes The size of the contents.
+//! \return SResult_OK on success. SResult_FAILED if the file could not be written.
+ResultCode WriteFileBytes(const std::string& Path, const void* PData, U64 SizeInBytes);
+
+
+//! Persistent store of binary blobs keyed by 64 bit hashes, used to keep compiled and serialized
+//! objects across runs. Keys are hashes of the full description of the object, so callers must
+//! include everything the blob depends on, such as the API version, in the hash.
+//!
+//! The file is a header, then each entry as key, size, content hash and content. Entries whose
+//! content hash does not match are dropped on load.
+class BlobCache
+{
+public:
+    BlobCache(U32 Magic, U32 Version)
+        : m_Magic(Magic)
+        , m_Version(Version)
+        , m_Dirty(false) { }
+
+    //! Load the entries of a cache file, replacing current entries.
+    //!
+    //! \param Path The cache file.
+    //! \return SResult_OK if loaded. SResult_OBJECT_NOT_FOUND if there is no file.
+    //!         SResult_MEMORY_CORRUPTION if the file is from another version, or damaged.
+    ResultCode Load(const std::string& Path);
+
+    //! Write all entries to a cache file, if any changed since the last load or save.
+    //!
+    //! \param Path The cache file.
+    //! \return SResult_OK if written or nothing changed.
+    ResultCode Save(const std::string& Path);
+
+    //! Find the blob stored for a key.
+    //!
+    //! \return The blob, nullptr if none. Valid until the entry is stored again or removed.
+    const std::vector<U8>* Find(U64 Key) const;
+
+    //! Store a blob, replacing any previous one for the key.
+    void Store(U64 Key, const void* PData, U64 SizeInBytes);
+
+    //! Remove a blob, for instance if the device rejected it.
+    void Remove(U64 Key);
+
+    //! Drop all entries.
+    void Clear();
+
+    B32 IsDirty() const { return m_Dirty; }
+    U64 GetNumEntries() const { return m_Entries.size(); }
+    const std::unordered_map<U64, std::vector<U8>>& GetEntries() const { return m_Entries; }
+
+private:
+    U32                                         m_Magic;
+    U32                                         m_Version;
+    B32                                         m_Dirty;
+    std::unordered_map<U64, std::vector<U8>>    m_Entries;
+};
+} // Synthe
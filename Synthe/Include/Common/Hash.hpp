@@ -0,0 +1,45 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Common/Types.hpp"
+
+
+namespace Synthe {
+
+
+#define FNV1A_64_OFFSET_BASIS   (14695981039346656037ULL)
+#define FNV1A_64_PRIME          (1099511628211ULL)
+
+
+//! Hash a block of memory with 64 bit FNV-1a. Cheap, and good enough for keying caches
+//! on small POD descriptions. Callers that can not tolerate collisions must still compare keys.
+//!
+//! \param PData The data to hash.
+//! \param SizeInBytes The size of the data, in bytes.
+//! \param Seed A previous hash to continue from, or FNV1A_64_OFFSET_BASIS to start fresh.
+//! \return The 64 bit hash.
+inline U64 HashBytes(const void* PData, U64 SizeInBytes, U64 Seed = FNV1A_64_OFFSET_BASIS)
+{
+    const U8* PBytes = static_cast<const U8*>(PData);
+    U64 Hash = Seed;
+    for (U64 I = 0; I < SizeInBytes; ++I)
+    {
+        Hash ^= static_cast<U64>(PBytes[I]);
+        Hash *= FNV1A_64_PRIME;
+    }
+    return Hash;
+}
+
+
+//! Combine a value into an existing hash.
+//!
+//! \param Seed The running hash.
+//! \param Value The value to mix in.
+//! \return The combined hash.
+inline U64 HashCombine(U64 Seed, U64 Value)
+{
+    return Seed ^ (Value + 0x9E3779B97F4A7C15ULL + (Seed << 6) + (Seed >> 2));
+}
+} // Synthe
@@ -0,0 +1,70 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Common/Types.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace Synthe {
+
+
+enum JsonType
+{
+    JsonType_NULL,
+    JsonType_BOOL,
+    JsonType_NUMBER,
+    JsonType_STRING,
+    JsonType_ARRAY,
+    JsonType_OBJECT
+};
+
+
+//! Parsed JSON value. Objects keep their members in file order.
+class JsonValue
+{
+public:
+    JsonValue()
+        : m_Type(JsonType_NULL)
+        , m_Number(0.0) { }
+
+    JsonType GetType() const { return m_Type; }
+    B32 IsNull() const { return m_Type == JsonType_NULL; }
+    B32 IsString() const { return m_Type == JsonType_STRING; }
+    B32 IsArray() const { return m_Type == JsonType_ARRAY; }
+    B32 IsObject() const { return m_Type == JsonType_OBJECT; }
+
+    B32 GetBool() const { return m_Type == JsonType_BOOL && m_Number != 0.0; }
+    R64 GetNumber() const { return m_Number; }
+    const std::string& GetString() const { return m_String; }
+    const std::vector<JsonValue>& GetArray() const { return m_Array; }
+    const std::vector<std::pair<std::string, JsonValue>>& GetMembers() const { return m_Members; }
+
+    //! Find a member of an object.
+    //!
+    //! \return The member, nullptr if absent or if this is not an object.
+    const JsonValue* Find(const char* Key) const;
+
+private:
+    friend class JsonParser;
+
+    JsonType                                        m_Type;
+    R64                                             m_Number;
+    std::string                                     m_String;
+    std::vector<JsonValue>                          m_Array;
+    std::vector<std::pair<std::string, JsonValue>>  m_Members;
+};
+
+
+//! Parse a JSON document. Empty documents, or documents holding only white space, parse as null.
+//!
+//! \param PText The document.
+//! \param Length The length of the document in bytes.
+//! \param OutValue The root value.
+//! \return SResult_OK on success. SResult_INVALID_ARGS if the document is malformed.
+ResultCode ParseJson(const char* PText, U64 Length, JsonValue& OutValue);
+} // Synthe
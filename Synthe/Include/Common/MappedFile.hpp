@@ -0,0 +1,51 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Common/Types.hpp"
+
+#include <string>
+
+
+namespace Synthe {
+
+
+//! Read only view of a whole file mapped into memory. Pages are loaded by the OS on first touch, and
+//! shared with other processes mapping the same file.
+class MappedFile
+{
+public:
+    MappedFile()
+        : m_PData(nullptr)
+        , m_SizeInBytes(0)
+        , m_FileHandle(nullptr)
+        , m_MappingHandle(nullptr) { }
+
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    //! Map a file, closing any file mapped before.
+    //!
+    //! \param Path The file to map.
+    //! \return SResult_OK on success. SResult_OBJECT_NOT_FOUND if the file could not be opened.
+    //!         SResult_FAILED if it could not be mapped, empty files can not be mapped.
+    ResultCode Open(const std::string& Path);
+
+    //! Unmap the file. Pointers into the mapping are invalid afterwards.
+    void Close();
+
+    B32 IsOpen() const { return m_PData != nullptr; }
+    const U8* GetData() const { return m_PData; }
+    U64 GetSizeInBytes() const { return m_SizeInBytes; }
+
+private:
+    const U8*   m_PData;
+    U64         m_SizeInBytes;
+    //! Platform handles, the file descriptor is kept in m_FileHandle on POSIX.
+    void*       m_FileHandle;
+    void*       m_MappingHandle;
+};
+} // Synthe
@@ -0,0 +1,120 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Common/Types.hpp"
+#include "Allocator.hpp"
+
+#include <deque>
+#include <map>
+#include <set>
+#include <utility>
+
+
+namespace Synthe {
+
+
+//! Range Allocator hands out ranges from a span that the allocator never touches itself,
+//! such as descriptor heap slots, or offsets into a GPU heap. Freed ranges are merged with the free
+//! ranges on both sides, and the top of the span drops back through any free range touching it, so
+//! a span whose allocations are all freed is whole again. Allocations take the smallest free range
+//! they fit in, and only use the top of the span when no free range fits. Both free and allocate
+//! are O(log n) in the number of free ranges.
+//!
+//! Frees can also be deferred until a caller supplied value is retired, which is used to hold
+//! ranges back until the GPU has finished with the frame that last referenced them.
+//!
+//! Alignments are relative to the base of the span, padding taken to reach one is kept as a free
+//! range. Blocks returned store the aligned size, which must be passed back unchanged on Free().
+class RangeAllocator : public Allocator {
+public:
+    RangeAllocator()
+        : m_Top(MEM_BYTES(0))
+        , m_FreeBytes(MEM_BYTES(0))
+        , Allocator() { }
+
+    void OnInitialize() override;
+
+    //! Reset the allocator, all ranges, free and pending, are invalidated.
+    void Reset() override;
+
+    //! Allocate a range.
+    //!
+    //! \param Block The output block, StartAddress is an address within [BaseAddress, BaseAddress + TotalSize).
+    //! \param SizeInBytes The size of the range.
+    //! \param Alignment The alignment of the range, must be a power of two.
+    //! \return SResult_OK if the range was allocated. SResult_OUT_OF_MEMORY if no range could fit.
+    ResultCode Allocate(AllocationBlock* Block, U64 SizeInBytes, U64 Alignment) override;
+
+    //! Free the range immediately, making it available to the next Allocate() call.
+    //!
+    //! \param Block The block that was returned by Allocate().
+    //! \return SResult_OK if the range was freed. SResult_INVALID_ARGS if any of it is already free.
+    ResultCode Free(AllocationBlock* Block) override;
+
+    //! Free the range once Retire() is called with a value greater or equal to RetireValue.
+    //! RetireValue is expected to be non-decreasing between calls, (frame numbers, fence values.)
+    //!
+    //! \param Block The block that was returned by Allocate().
+    //! \param RetireValue The value at which the range may be reused.
+    //! \return SResult_OK if the range was queued.
+    ResultCode DeferFree(const AllocationBlock& Block, U64 RetireValue);
+
+    //! Release all deferred ranges whose retire value is less than or equal to CompletedValue.
+    //!
+    //! \param CompletedValue The last value that is known to be complete.
+    //! \return The number of ranges that were released.
+    U32 Retire(U64 CompletedValue);
+
+    //! Number of bytes sitting in free ranges below the top of the span, ready for reuse.
+    U64 GetFreeListBytes() const { return m_FreeBytes; }
+
+    //! Number of free ranges below the top of the span, after merging.
+    U64 GetNumFreeRanges() const { return static_cast<U64>(m_FreeRanges.size()); }
+
+    //! Number of frees that are still waiting to be retired.
+    U64 GetNumPendingFrees() const { return static_cast<U64>(m_PendingFrees.size()); }
+
+private:
+    struct PendingFree
+    {
+        AllocationBlock Block;
+        U64 RetireValue;
+    };
+
+    //! Round an address up to Alignment, relative to the base of the span.
+    UPtr AlignAddress(UPtr Address, U64 Alignment) const 
+    { 
+        return m_BaseAddress + (ALIGN_BYTES(Address - m_BaseAddress, Alignment)); 
+    }
+
+    //! Add a free range, merged with its neighbours, or given back to the top if it touches it.
+    //! Returns false, changing nothing, if the range overlaps one already free.
+    B32 InsertFreeRange(UPtr Address, U64 SizeInBytes);
+
+    //! Remove a free range.
+    void EraseFreeRange(std::map<UPtr, U64>::iterator Iter);
+
+    //! Give a free range a new start and size, reusing its nodes instead of allocating new ones.
+    std::map<UPtr, U64>::iterator MoveFreeRange(std::map<UPtr, U64>::iterator Iter, UPtr Address, U64 SizeInBytes);
+
+    //! Take NeededBytes at Alignment from the smallest free range that fits.
+    B32 TakeFreeRange(U64 NeededBytes, U64 Alignment, UPtr* OutAddress);
+
+    //! Top of the untouched part of the span.
+    UPtr                                            m_Top;
+
+    //! Bytes currently held in free ranges.
+    U64                                             m_FreeBytes;
+
+    //! Free ranges below the top, size keyed by start address. Neighbouring ranges are always merged.
+    std::map<UPtr, U64>                             m_FreeRanges;
+
+    //! The same ranges, ordered by size then address, for best fit.
+    std::set<std::pair<U64, UPtr>>                  m_FreeRangesBySize;
+
+    //! Deferred frees, in order of retire value.
+    std::deque<PendingFree>                         m_PendingFrees;
+};
+} // Synthe
@@ -0,0 +1,49 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Common/Types.hpp"
+
+
+namespace Synthe {
+
+
+//! Copies smaller than this go through a regular memcpy. Non-temporal stores only pay off
+//! once the destination would otherwise evict a meaningful amount of cache, or when writing
+//! into write-combined memory where partial cache line writes are expensive.
+#define STREAM_COPY_MIN_BYTES (4ULL * 1024ULL)
+
+
+//! Instruction set used by the streaming kernels. This is queried once at runtime,
+//! on the first call to any of the stream functions.
+enum StreamKernelLevel
+{
+    StreamKernelLevel_SCALAR,
+    StreamKernelLevel_SSE2,
+    StreamKernelLevel_AVX2
+};
+
+
+//! Get the kernel level that was selected for this machine.
+StreamKernelLevel GetStreamKernelLevel();
+
+
+//! Copy memory using non-temporal stores, bypassing the cache hierarchy for the destination.
+//! Intended for filling upload heaps (write-combined memory) and any other destination that
+//! will not be read back by the CPU any time soon. Source and destination may have any
+//! alignment, but must not overlap.
+//!
+//! \param PDst The destination memory.
+//! \param PSrc The source memory.
+//! \param SizeInBytes The number of bytes to copy.
+void StreamCopy(void* PDst, const void* PSrc, U64 SizeInBytes);
+
+
+//! Fill memory with a byte value using non-temporal stores. Same use case as StreamCopy().
+//!
+//! \param PDst The destination memory.
+//! \param Value The byte value to fill with.
+//! \param SizeInBytes The number of bytes to fill.
+void StreamFill(void* PDst, U8 Value, U64 SizeInBytes);
+} // Synthe
@@ -0,0 +1,84 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Common/Types.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+
+namespace Synthe {
+
+
+//! Fixed set of worker threads running submitted jobs. Jobs with a higher priority are picked first,
+//! jobs of equal priority run in submission order.
+class WorkerPool
+{
+public:
+    WorkerPool()
+        : m_NumActive(0)
+        , m_NextSequence(0)
+        , m_Stop(false) { }
+
+    ~WorkerPool() { Shutdown(); }
+
+    //! Get the default number of workers, one per hardware thread, leaving one to the caller.
+    static U32 GetDefaultNumThreads();
+
+    //! Start the workers.
+    //!
+    //! \param NumThreads Number of worker threads, at least one is started.
+    void Initialize(U32 NumThreads);
+
+    //! Queue a job.
+    //!
+    //! \param Job The function to run on a worker.
+    //! \param Priority Jobs with higher priorities run first.
+    void Submit(std::function<void()> Job, I32 Priority = 0);
+
+    //! Block until the queue is empty, and no job is running.
+    void WaitIdle();
+
+    //! Run the jobs still queued, then join all workers.
+    void Shutdown();
+
+    U32 GetNumThreads() const { return static_cast<U32>(m_Threads.size()); }
+
+private:
+    struct Job
+    {
+        std::function<void()> Function;
+        I32 Priority;
+        U64 Sequence;
+    };
+
+    struct JobOrder
+    {
+        bool operator()(const Job& A, const Job& B) const
+        {
+            if (A.Priority != B.Priority)
+            {
+                return A.Priority < B.Priority;
+            }
+            return A.Sequence > B.Sequence;
+        }
+    };
+
+    void WorkerMain();
+
+    std::vector<std::thread>                            m_Threads;
+    std::priority_queue<Job, std::vector<Job>, JobOrder> m_Jobs;
+    std::mutex                                          m_Mutex;
+    std::condition_variable                             m_JobAvailable;
+    std::condition_variable                             m_Idle;
+    U32                                                 m_NumActive;
+    U64                                                 m_NextSequence;
+    B32                                                 m_Stop;
+};
+} // Synthe
@@ -0,0 +1,369 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Common/Types.hpp"
+#include "Graphics/GraphicsCommandList.hpp"
+
+#include <vector>
+
+
+namespace Synthe {
+
+
+enum CommandType
+{
+    CommandType_DRAW_INDEXED_INSTANCED,
+    CommandType_DRAW_INSTANCED,
+    CommandType_DISPATCH,
+    CommandType_SET_PIPELINE_STATE,
+    CommandType_SET_PIPELINE_NOT_READY_POLICY,
+    CommandType_SET_VIEWPORTS,
+    CommandType_SET_SCISSORS,
+    CommandType_SET_RENDER_TARGETS,
+    CommandType_CLEAR_RENDER_TARGET,
+    CommandType_BIND_DESCRIPTOR_SETS,
+    CommandType_SET_BINDLESS_INDICES,
+    CommandType_SET_ROOT_CONSTANTS,
+    CommandType_SET_ROOT_CONSTANT_BUFFER,
+    CommandType_SET_ROOT_SHADER_RESOURCE,
+    CommandType_SET_ROOT_UNORDERED_ACCESS,
+    CommandType_BIND_VERTEX_BUFFERS,
+    CommandType_BIND_INDEX_BUFFER,
+    CommandType_COPY_RESOURCE,
+    CommandType_DISPATCH_RAYS,
+    CommandType_TRANSITION_RESOURCES,
+    CommandType_BEGIN_RENDER_PASS,
+    CommandType_END_RENDER_PASS
+};
+
+
+//! Header of a recorded command. The payload follows the header, and the next header follows the
+//! payload.
+struct CommandHeader
+{
+    //! CommandType of the command.
+    U16 Type;
+    U16 Reserved;
+    //! Size of the header, payload, and padding. Always a multiple of 8.
+    U32 SizeInBytes;
+};
+
+
+//! Command payloads. They only hold values and pointers, and arrays are stored inline right after the
+//! payload, read with GetCommandArray().
+
+struct CommandDrawIndexedInstanced
+{
+    U32 IndexCountPerInstance;
+    U32 InstanceCount;
+    U32 StartIndexLocation;
+    I32 BaseVertexLocation;
+    U32 StartInstanceLocation;
+};
+
+
+struct CommandDrawInstanced
+{
+    U32 VertexCountPerInstance;
+    U32 InstanceCount;
+    U32 StartVertexLocation;
+    U32 StartInstanceLocation;
+};
+
+
+struct CommandDispatch
+{
+    U32 GlobalX;
+    U32 GlobalY;
+    U32 GlobalZ;
+};
+
+
+struct CommandSetPipelineState
+{
+    PipelineStateType PipelineType;
+    PipelineState* PPipelineState;
+    RootSignature* PRootSignature;
+};
+
+
+struct CommandSetPipelineNotReadyPolicy
+{
+    PipelineNotReadyPolicy Policy;
+};
+
+
+//! Followed by NumViewports Viewport.
+struct CommandSetViewports
+{
+    U32 NumViewports;
+};
+
+
+//! Followed by NumScissors Scissor.
+struct CommandSetScissors
+{
+    U32 NumScissors;
+};
+
+
+//! Followed by NumRTVs GPUHandle.
+struct CommandSetRenderTargets
+{
+    U32 NumRTVs;
+    B32 HasDepthStencil;
+    GPUHandle DepthStencil;
+};
+
+
+//! Followed by NumBounds TargetBounds.
+struct CommandClearRenderTarget
+{
+    GPUHandle RTV;
+    ClearColorValue ClearColor;
+    B32 HasClearColor;
+    U32 NumBounds;
+};
+
+
+//! Followed by NumSets DescriptorSet*.
+struct CommandBindDescriptorSets
+{
+    U32 NumSets;
+};
+
+
+//! Followed by NumIndices U32.
+struct CommandSetBindlessIndices
+{
+    U32 NumIndices;
+    U32 FirstIndex;
+};
+
+
+//! Followed by Num32BitValues U32.
+struct CommandSetRootConstants
+{
+    U32 ParameterIndex;
+    U32 Num32BitValues;
+    U32 DestOffsetIn32BitValues;
+};
+
+
+//! Payload of the root constant buffer, shader resource, and unordered access commands.
+struct CommandSetRootDescriptor
+{
+    U32 ParameterIndex;
+    GPUHandle BufferHandle;
+    U64 OffsetInBytes;
+};
+
+
+//! Followed by NumBuffers Resource*, then by NumBuffers U32 offsets if HasOffsets.
+struct CommandBindVertexBuffers
+{
+    U32 NumBuffers;
+    B32 HasOffsets;
+};
+
+
+struct CommandBindIndexBuffer
+{
+    const Resource* PBuffer;
+    U32 Offset;
+};
+
+
+struct CommandCopyResource
+{
+    Resource* PDest;
+    Resource* PSrc;
+};
+
+
+//! Followed by NumTransitions ResourceTransition.
+struct CommandTransitionResources
+{
+    U32 NumTransitions;
+};
+
+
+//! Followed by NumRenderTargets RenderPassAttachment, then by the depth stencil if HasDepthStencil.
+struct CommandBeginRenderPass
+{
+    U32 NumRenderTargets;
+    B32 HasDepthStencil;
+};
+
+
+//! Round a size up to the 8 byte alignment of commands.
+inline U32 AlignCommandSize(U64 SizeInBytes)
+{
+    return static_cast<U32>((SizeInBytes + 7ULL) & ~7ULL);
+}
+
+
+//! Get the payload of a command.
+template<typename Payload>
+inline const Payload* GetCommandPayload(const CommandHeader* PHeader)
+{
+    return reinterpret_cast<const Payload*>(PHeader + 1);
+}
+
+
+//! Get the array stored after a payload.
+template<typename Element, typename Payload>
+inline const Element* GetCommandArray(const Payload* PPayload)
+{
+    return reinterpret_cast<const Element*>(reinterpret_cast<const U8*>(PPayload) + AlignCommandSize(sizeof(Payload)));
+}
+
+
+//! Linear stream of recorded commands, each a CommandHeader followed by its payload. Commands are
+//! written into chunks of an arena that is kept across Reset(), so recording a frame allocates
+//! nothing once the arena has grown to fit it. A command never spans chunks, and commands larger than
+//! a chunk get a chunk of their own. The stream has no knowledge of any graphics API.
+class CommandStream
+{
+public:
+    static const U32 k_ChunkSizeInBytes = 64 * 1024;
+
+    CommandStream()
+        : m_CurrentChunk(0)
+        , m_NumCommands(0)
+        , m_SizeInBytes(0) { }
+
+    ~CommandStream() { Release(); }
+
+    CommandStream(const CommandStream&) = delete;
+    CommandStream& operator=(const CommandStream&) = delete;
+
+    //! Append a command.
+    //!
+    //! \param Type The command type.
+    //! \param PayloadSizeInBytes Size of the payload, including inline arrays.
+    //! \return The payload to fill in, 8 byte aligned. nullptr if the arena could not grow.
+    void* Push(CommandType Type, U64 PayloadSizeInBytes);
+
+    //! Append a command with a payload of type Payload, and ExtraBytes of inline arrays after it.
+    template<typename Payload>
+    Payload* Push(CommandType Type, U64 ExtraBytes = 0)
+    {
+        return static_cast<Payload*>(Push(Type, AlignCommandSize(sizeof(Payload)) + ExtraBytes));
+    }
+
+    //! Drop every command, keeping the arena.
+    void Reset();
+
+    //! Drop every command, and free the arena.
+    void Release();
+
+    //! Call Function(const CommandHeader*) on each command, in recording order.
+    template<typename Function>
+    void ForEach(Function&& Func) const
+    {
+        for (const Chunk& C : m_Chunks)
+        {
+            const U8* PCursor = C.PData;
+            const U8* PEnd = C.PData + C.UsedBytes;
+            while (PCursor < PEnd)
+            {
+                const CommandHeader* PHeader = reinterpret_cast<const CommandHeader*>(PCursor);
+                Func(PHeader);
+                PCursor += PHeader->SizeInBytes;
+            }
+        }
+    }
+
+    U32 GetNumCommands() const { return m_NumCommands; }
+
+    //! Bytes of commands recorded, headers included.
+    U64 GetSizeInBytes() const { return m_SizeInBytes; }
+
+    //! Bytes of the arena.
+    U64 GetCapacityInBytes() const;
+
+private:
+    struct Chunk
+    {
+        U8* PData;
+        U32 SizeInBytes;
+        U32 UsedBytes;
+    };
+
+    std::vector<Chunk>  m_Chunks;
+    U32                 m_CurrentChunk;
+    U32                 m_NumCommands;
+    U64                 m_SizeInBytes;
+};
+
+
+//! Command list that records into a command stream, instead of a native list. It may be recorded on
+//! any thread, and without a device, so recordings can be inspected, filtered, or tested anywhere.
+//! Pointers and handles passed to it must stay valid until the stream is replayed. Begin() drops the
+//! previous recording.
+class CommandStreamList : public GraphicsCommandList
+{
+public:
+    void Begin() override { m_Stream.Reset(); }
+    void End() override { }
+
+    void DrawIndexedInstanced(U32 IndexCountPerInst,
+                              U32 InstanceCount,
+                              U32 StartIndexLocation,
+                              I32 BaseVertexLocation,
+                              U32 StartInstanceLocation) override;
+    void DrawInstanced(U32 VertexCountPerInstance,
+                       U32 InstanceCount,
+                       U32 StartVertexLocation,
+                       U32 StartInstanceLocation) override;
+    void Dispatch(U32 GlobalX, U32 GlobalY, U32 GlobalZ) override;
+    void SetPipelineState(PipelineStateType PipelineType,
+                          PipelineState* PPipelineState,
+                          RootSignature* PRootSignature) override;
+    void SetPipelineNotReadyPolicy(PipelineNotReadyPolicy Policy) override;
+    void SetViewports(U32 NumViewports, const Viewport* PViewports) override;
+    void SetScissors(U32 NumScissors, const Scissor* PScissors) override;
+    void SetRenderTargets(U32 NumRTVs, GPUHandle* RTVHandles, GPUHandle* DepthStencil) override;
+    void ClearRenderTarget(GPUHandle RTV,
+                           ClearColorValue* ClearColor,
+                           U32 NumBounds,
+                           TargetBounds* Bounds) override;
+    void BindDescriptorSets(U32 NumSets, DescriptorSet* const* PDescriptorSets) override;
+    void SetBindlessIndices(U32 NumIndices, const U32* PIndices, U32 FirstIndex) override;
+    void SetRootConstants(U32 ParameterIndex,
+                          U32 Num32BitValues,
+                          const void* PData,
+                          U32 DestOffsetIn32BitValues) override;
+    void SetRootConstantBuffer(U32 ParameterIndex, GPUHandle BufferHandle, U64 OffsetInBytes) override;
+    void SetRootShaderResource(U32 ParameterIndex, GPUHandle BufferHandle, U64 OffsetInBytes) override;
+    void SetRootUnorderedAccess(U32 ParameterIndex, GPUHandle BufferHandle, U64 OffsetInBytes) override;
+    void BindVertexBuffers(U32 NumBuffers, Resource* const* PBuffers, U32* Offsets) override;
+    void BindIndexBuffer(const Resource* PBuffer, U32 Offset) override;
+    void CopyResource(Resource* PDest, Resource* PSrc) override;
+    void DispatchRays() override;
+    void TransitionResources(U32 NumTransitions, const ResourceTransition* PTransitions) override;
+    void BeginRenderPass(U32 NumRenderTargets,
+                         const RenderPassAttachment* PRenderTargets,
+                         const RenderPassAttachment* PDepthStencil) override;
+    void EndRenderPass() override;
+
+    const CommandStream& GetStream() const { return m_Stream; }
+
+private:
+    void PushRootDescriptor(CommandType Type, U32 ParameterIndex, GPUHandle BufferHandle, U64 OffsetInBytes);
+
+    CommandStream m_Stream;
+};
+
+
+//! Translate a command stream into another command list, usually a native one, in one pass. The
+//! target must be recording, Begin() and End() are left to the caller so several streams may be
+//! replayed into one list.
+//!
+//! \param Stream The recorded commands.
+//! \param PTarget The list to record them into.
+void ReplayCommandStream(const CommandStream& Stream, GraphicsCommandList* PTarget);
+} // Synthe
@@ -0,0 +1,171 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Common/Types.hpp"
+#include "Graphics/GraphicsCommandList.hpp"
+
+#include <vector>
+
+
+namespace Synthe {
+
+
+class WorkerPool;
+
+
+//! Bits of each field of a draw sort key.
+enum DrawSortKeyBits
+{
+    DrawSortKeyBits_PASS            = 6,
+    DrawSortKeyBits_ROOT_SIGNATURE  = 6,
+    DrawSortKeyBits_PIPELINE        = 12,
+    DrawSortKeyBits_DESCRIPTOR_SET  = 12,
+    DrawSortKeyBits_MATERIAL        = 12,
+    DrawSortKeyBits_DEPTH           = 16
+};
+
+
+//! Fields of a draw sort key. Ids are small numbers the renderer hands out, such as the index of a
+//! pipeline in its pipeline table, and only their low DrawSortKeyBits are kept.
+struct DrawSortKeyInfo
+{
+    U32 Pass;
+    U32 RootSignature;
+    U32 Pipeline;
+    U32 DescriptorSet;
+    U32 Material;
+    //! Quantized depth, see QuantizeDrawDepth().
+    U32 Depth;
+    //! Sort by depth right after the pass, for blended passes that must draw back to front. State is
+    //! only grouped among draws at the same depth.
+    B32 DepthFirst;
+};
+
+
+//! Build the 64 bit sort key of a draw. Keys sort by pass first, then by the state most expensive to
+//! change: the root signature, since changing it drops every root binding, then the pipeline, the
+//! descriptor set, the material, and last the depth, front to back.
+inline U64 MakeDrawSortKey(const DrawSortKeyInfo& Info)
+{
+    U64 Key = Info.Pass & ((1ULL << DrawSortKeyBits_PASS) - 1);
+    U64 State = Info.RootSignature & ((1ULL << DrawSortKeyBits_ROOT_SIGNATURE) - 1);
+    State = (State << DrawSortKeyBits_PIPELINE) | (Info.Pipeline & ((1ULL << DrawSortKeyBits_PIPELINE) - 1));
+    State = (State << DrawSortKeyBits_DESCRIPTOR_SET) | (Info.DescriptorSet & ((1ULL << DrawSortKeyBits_DESCRIPTOR_SET) - 1));
+    State = (State << DrawSortKeyBits_MATERIAL) | (Info.Material & ((1ULL << DrawSortKeyBits_MATERIAL) - 1));
+    U64 Depth = Info.Depth & ((1ULL << DrawSortKeyBits_DEPTH) - 1);
+    const U32 StateBits = 64 - DrawSortKeyBits_PASS - DrawSortKeyBits_DEPTH;
+    if (Info.DepthFirst)
+    {
+        return (Key << (64 - DrawSortKeyBits_PASS)) | (Depth << StateBits) | State;
+    }
+    return (Key << (64 - DrawSortKeyBits_PASS)) | (State << DrawSortKeyBits_DEPTH) | Depth;
+}
+
+
+//! Quantize a view depth to the depth bits of a sort key.
+//!
+//! \param ViewDepth Distance from the camera.
+//! \param NearZ Closest distance sorted.
+//! \param FarZ Farthest distance sorted, distances past it share the last value.
+//! \param BackToFront Give farther draws smaller values, for blended passes.
+inline U32 QuantizeDrawDepth(R32 ViewDepth, R32 NearZ, R32 FarZ, B32 BackToFront)
+{
+    R32 T = (FarZ > NearZ) ? (ViewDepth - NearZ) / (FarZ - NearZ) : 0.0f;
+    T = T < 0.0f ? 0.0f : (T > 1.0f ? 1.0f : T);
+    U32 MaxValue = (1U << DrawSortKeyBits_DEPTH) - 1;
+    U32 Value = static_cast<U32>(T * static_cast<R32>(MaxValue) + 0.5f);
+    return BackToFront ? MaxValue - Value : Value;
+}
+
+
+//! Everything needed to record one draw. Packets are built by any thread, sorted by key, and recorded
+//! with only the state that changes between neighbours.
+struct DrawPacket
+{
+    static const U32 k_MaxBindlessIndices = 4;
+
+    U64 SortKey;
+    RootSignature* PRootSignature;
+    PipelineState* PPipelineState;
+    //! Descriptor set of the draw, nullptr for none.
+    DescriptorSet* PDescriptorSet;
+    //! Vertex buffer, nullptr for draws that fetch their vertices themselves.
+    Resource* PVertexBuffer;
+    //! Index buffer, nullptr for non indexed draws.
+    const Resource* PIndexBuffer;
+    //! Bindless indices of the draw, such as its material and instance data, written from slot 0.
+    U32 BindlessIndices[k_MaxBindlessIndices];
+    U32 NumBindlessIndices;
+    //! Index count for indexed draws, vertex count otherwise.
+    U32 ElementCount;
+    U32 InstanceCount;
+    U32 StartElement;
+    I32 BaseVertex;
+    U32 StartInstance;
+};
+
+
+//! Counters of a RecordDrawPackets() call.
+struct DrawPacketStatistics
+{
+    U64 NumDraws;
+    U64 NumRootSignatureChanges;
+    U64 NumPipelineChanges;
+    U64 NumDescriptorSetChanges;
+    U64 NumBindlessChanges;
+    U64 NumVertexBufferChanges;
+    U64 NumIndexBufferChanges;
+};
+
+
+//! Item sorted in place of a draw packet.
+struct DrawSortItem
+{
+    U64 Key;
+    U32 Index;
+    U32 Padding;
+};
+
+
+//! Sorts draw packets by key with a parallel LSD radix sort. The sort is stable, so packets with
+//! equal keys keep their order. Packets are not moved, the order is written as indices. The sorter 
+//! keeps its scratch memory, so a sorter used every frame stops allocating once it has seen the 
+//! largest frame. One thread may sort with a sorter at a time.
+class DrawPacketSorter
+{
+public:
+    //! \param PPool Workers to sort on, nullptr to sort on the calling thread. Small arrays always are.
+    //! \param NumPackets The number of packets.
+    //! \param PPackets The packets.
+    //! \param OutOrder Receives NumPackets packet indices, in key order.
+    void Sort(WorkerPool* PPool, U32 NumPackets, const DrawPacket* PPackets, U32* OutOrder);
+
+    //! Free the scratch memory.
+    void Release();
+
+private:
+    std::vector<DrawSortItem>   m_Items;
+    std::vector<DrawSortItem>   m_Scratch;
+    //! Per part digit counts, [Part][Pass][Digit].
+    std::vector<U32>            m_Counts;
+    //! Per part scatter offsets, [Part][Digit].
+    std::vector<U32>            m_Offsets;
+};
+
+
+//! Record draw packets, in the given order, into a command list. State is only set when it differs
+//! from the previous packet, so sorted packets record few state changes.
+//!
+//! \param PList The list, recording.
+//! \param NumPackets The number of packets to record.
+//! \param PPackets The packets.
+//! \param POrder Packet indices to record in order, nullptr to record them as they are.
+//! \param OutStatistics Optional, receives the number of draws and state changes recorded.
+void RecordDrawPackets(GraphicsCommandList* PList,
+                       U32 NumPackets,
+                       const DrawPacket* PPackets,
+                       const U32* POrder,
+                       DrawPacketStatistics* OutStatistics);
+} // Synthe
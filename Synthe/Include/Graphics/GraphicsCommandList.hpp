@@ -4,6 +4,7 @@
 #pragma once
 
 #include "GraphicsStructs.hpp"
+#include "PipelineState.hpp"
 #include "Common/Types.hpp"
 
 namespace Synthe {
@@ -44,6 +45,37 @@ enum CommandListFlag
 typedef U32 CommandListFlags;
 
 
+//! Counters of the current, or last, recording of a command list. State calls that match the state
+//! already bound are skipped instead of reaching the driver.
+struct CommandListStatistics
+{
+    U64 NumPipelineStatesIssued;
+    U64 NumPipelineStatesSkipped;
+    U64 NumRootSignaturesIssued;
+    U64 NumRootSignaturesSkipped;
+    U64 NumViewportsIssued;
+    U64 NumViewportsSkipped;
+    U64 NumScissorsIssued;
+    U64 NumScissorsSkipped;
+    U64 NumRenderTargetsIssued;
+    U64 NumRenderTargetsSkipped;
+    U64 NumDescriptorTablesIssued;
+    U64 NumDescriptorTablesSkipped;
+    //! Resource transitions asked for, one barrier each without batching.
+    U64 NumBarriersRequested;
+    //! Barriers recorded, after redundant transitions were merged or dropped.
+    U64 NumBarriersEmitted;
+    //! Barrier calls recorded, each carrying every barrier queued since the previous one.
+    U64 NumBarrierBatches;
+    //! Barriers run ahead of the list at submit, for resources the list first used in another state
+    //! than the lists before it left them in.
+    U64 NumFixupBarriers;
+    U64 NumRenderPasses;
+    //! Render pass attachments whose contents were not loaded, or not stored.
+    U64 NumAttachmentsDiscarded;
+};
+
+
 //! Command list structure for graphics processing unit.
 class GraphicsCommandList {
 public:
@@ -76,11 +108,16 @@ public:
     //! Compute command that records a dispatch.
     virtual void Dispatch(U32 GlobalX, U32 GlobalY, U32 GlobalZ) { }
 
-    //! Set the graphics pipeline state, along with the layout info.
+    //! Set the graphics pipeline state, along with the layout info. If the pipeline is still compiling,
+    //! the not ready policy decides what is bound.
     virtual void SetPipelineState(PipelineStateType PipelineType, 
                                   PipelineState* PPipelineState,
                                   RootSignature* PRootSignature) { }
 
+    //! Set what SetPipelineState() does with pipelines that are still compiling. Defaults to 
+    //! PipelineNotReadyPolicy_WAIT, and resets with each Begin().
+    virtual void SetPipelineNotReadyPolicy(PipelineNotReadyPolicy Policy) { }
+
     //! Set viewports for the corresponding pass.
     virtual void SetViewports(U32 NumViewports, const Viewport* PViewports) { }
 
@@ -96,6 +133,22 @@ public:
                                    U32 NumBounds, 
                                    TargetBounds* Bounds) { }
 
+    //! Begin a render pass, binding its attachments as the render targets. The load and store ops 
+    //! tell the backend which contents must be read in and written back, so attachments that are 
+    //! cleared, or not needed after the pass, such as a depth buffer only used by the pass, cost no 
+    //! bandwidth to load or store. Resources may not be transitioned inside a render pass.
+    //!
+    //! \param NumRenderTargets The number of render targets.
+    //! \param PRenderTargets The render targets.
+    //! \param PDepthStencil The depth stencil, nullptr for none. The load and store ops apply to 
+    //!                      both depth and stencil.
+    virtual void BeginRenderPass(U32 NumRenderTargets, 
+                                 const RenderPassAttachment* PRenderTargets, 
+                                 const RenderPassAttachment* PDepthStencil) { }
+
+    //! End the render pass begun last, storing, resolving, or discarding its attachments.
+    virtual void EndRenderPass() { }
+
     //! Set the descriptor sets that correspond to the data resources that will be used by the render pass
     //! state.
     //!
@@ -103,6 +156,38 @@ public:
     //! \param PDescriptorSets An array of descriptor sets that will be used by bound shaders.
     virtual void BindDescriptorSets(U32 NumSets, DescriptorSet* const* PDescriptorSets) { }
 
+    //! Set the bindless indices read by the next draws or dispatches. The bound root signature must be
+    //! created with UseBindless. Indices are obtained from GraphicsDevice::GetBindlessIndex().
+    //!
+    //! \param NumIndices Number of indices to set.
+    //! \param PIndices The indices.
+    //! \param FirstIndex The first index slot to write, slots not written keep their values.
+    virtual void SetBindlessIndices(U32 NumIndices, const U32* PIndices, U32 FirstIndex) { }
+
+    //! Set 32 bit values of a root constants parameter, for the next draws or dispatches.
+    //!
+    //! \param ParameterIndex Index of the parameter in RootSignatureLayoutInfo::PRootParameters.
+    //! \param Num32BitValues Number of values to set.
+    //! \param PData The values.
+    //! \param DestOffsetIn32BitValues The first value to write, values not written keep their contents.
+    virtual void SetRootConstants(U32 ParameterIndex, 
+                                  U32 Num32BitValues, 
+                                  const void* PData, 
+                                  U32 DestOffsetIn32BitValues) { }
+
+    //! Set the buffer of a root CBV parameter.
+    //!
+    //! \param ParameterIndex Index of the parameter in RootSignatureLayoutInfo::PRootParameters.
+    //! \param BufferHandle The buffer resource.
+    //! \param OffsetInBytes Offset in the buffer of the constants, must be 256 byte aligned.
+    virtual void SetRootConstantBuffer(U32 ParameterIndex, GPUHandle BufferHandle, U64 OffsetInBytes) { }
+
+    //! Set the buffer of a root SRV parameter.
+    virtual void SetRootShaderResource(U32 ParameterIndex, GPUHandle BufferHandle, U64 OffsetInBytes) { }
+
+    //! Set the buffer of a root UAV parameter.
+    virtual void SetRootUnorderedAccess(U32 ParameterIndex, GPUHandle BufferHandle, U64 OffsetInBytes) { }
+
     //! Bind vertex buffers for drawing.
     virtual void BindVertexBuffers(U32 NumBuffers, Resource* const* PBuffers, U32* Offsets) { }
 
@@ -112,7 +197,18 @@ public:
     //! Copy a Resource to another Resource.
     virtual void CopyResource(Resource* PDest, Resource* PSrc) { }
 
+    //! Move resources to the accesses of the work that follows. Backends may batch the transitions
+    //! with others, and drop those that are not needed.
+    //!
+    //! \param NumTransitions The number of transitions.
+    //! \param PTransitions The transitions.
+    virtual void TransitionResources(U32 NumTransitions, const ResourceTransition* PTransitions) { }
+
     //! Dispatch ray tracing pipeline.
     virtual void DispatchRays() { }
+
+    //! Get the counters of the current recording, or of the last one once ended. Counters restart 
+    //! with each Begin().
+    virtual ResultCode GetStatistics(CommandListStatistics* OutStatistics) const { return SResult_NOT_IMPLEMENTED; }
 };
 } // Synth
\ No newline at end of file
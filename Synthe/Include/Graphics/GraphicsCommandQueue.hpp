@@ -0,0 +1,103 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Common/Types.hpp"
+#include "Graphics/GraphicsStructs.hpp"
+
+namespace Synthe {
+
+
+class GraphicsCommandList;
+
+
+enum SubmitQueue
+{
+    //! Submit to Graphics queue.
+    SubmitQueue_GRAPHICS,
+    //! Submit to Asynchronous queue.
+    SubmitQueue_ASYNC,
+    //! Submit to copy queue.
+    SubmitQueue_COPY,
+    SubmitQueue_COUNT
+};
+
+
+//! A point on the timeline of a queue. Every submit or signal moves the timeline of its queue one
+//! value up, and a sync point is reached once the GPU has finished everything submitted to the queue
+//! up to it.
+struct SyncPoint
+{
+    SubmitQueue Queue;
+    //! Timeline value, 0 is reached from the start.
+    U64 Value;
+};
+
+
+//! Counters of a queue, accumulated since it was created.
+struct CommandQueueStatistics
+{
+    U64 NumSubmits;
+    U64 NumCommandLists;
+    //! Waits on other queues recorded on the GPU timeline.
+    U64 NumWaitsIssued;
+    //! Waits dropped because the sync point was on this queue, or covered by an earlier wait.
+    U64 NumWaitsSkipped;
+    //! Waits dropped because the other queue had already reached the sync point at submit. Compared
+    //! with NumWaitsIssued, it tells how often a dependency was done before the work needing it was
+    //! even submitted.
+    U64 NumWaitsAlreadyReached;
+    //! WaitOnCPU() calls that had to block.
+    U64 NumCPUWaits;
+};
+
+
+//! A GPU queue. Work submitted to one queue runs in order, work on different queues may overlap unless
+//! a queue waits for a sync point of another. Submits happen on one thread at a time.
+class GraphicsCommandQueue
+{
+public:
+    virtual ~GraphicsCommandQueue() { }
+
+    virtual SubmitQueue GetType() const { return SubmitQueue_GRAPHICS; }
+
+    //! Submit command lists, once the sync points waited for are reached.
+    //!
+    //! \param NumCommandLists The number of lists.
+    //! \param PPCommandLists The lists, done recording, executed in array order.
+    //! \param NumWaits The number of sync points to wait for.
+    //! \param PWaits Sync points of any queue, nullptr if NumWaits is 0.
+    //! \return The sync point reached when the lists are finished, a value of 0 on failure.
+    virtual SyncPoint Submit(U32 NumCommandLists,
+                             GraphicsCommandList* const* PPCommandLists,
+                             U32 NumWaits,
+                             const SyncPoint* PWaits) { return { GetType(), 0 }; }
+
+    //! Make work submitted to this queue afterwards wait for a sync point, on the GPU.
+    //!
+    //! \param Point A sync point of any queue.
+    //! \return SResult_OK on success. SResult_INVALID_ARGS if the sync point was never submitted, as
+    //!         waiting for it would never end.
+    virtual ResultCode Wait(const SyncPoint& Point) { return SResult_NOT_IMPLEMENTED; }
+
+    //! Move the timeline past the work submitted so far, without submitting any.
+    //!
+    //! \return The sync point reached when the work submitted so far is finished.
+    virtual SyncPoint Signal() { return { GetType(), 0 }; }
+
+    //! Whether a sync point of this queue has been reached.
+    virtual B32 IsComplete(const SyncPoint& Point) { return false; }
+
+    //! Block the calling thread until a sync point of this queue is reached.
+    virtual ResultCode WaitOnCPU(const SyncPoint& Point) { return SResult_NOT_IMPLEMENTED; }
+
+    //! The last timeline value the GPU has reached.
+    virtual U64 GetCompletedValue() { return 0ULL; }
+
+    //! The last timeline value handed out by Submit() or Signal().
+    virtual U64 GetLastSubmittedValue() const { return 0ULL; }
+
+    virtual ResultCode GetStatistics(CommandQueueStatistics* OutStatistics) const { return SResult_NOT_IMPLEMENTED; }
+};
+} // Synthe
@@ -6,6 +6,7 @@
 #include "Common/Types.hpp"
 #include "Graphics/GraphicsStructs.hpp"
 #include "Graphics/GraphicsCommandList.hpp"
+#include "Graphics/GraphicsCommandQueue.hpp"
 #include "Graphics/PipelineState.hpp"
 #include "Graphics/GraphicsResource.hpp"
 #include "Graphics/GraphicsResourceView.hpp"
@@ -69,17 +70,6 @@ struct CommandListCreateInfo
 };
 
 
-enum SubmitQueue
-{
-    //! Submit to Graphics queue.
-    SubmitQueue_GRAPHICS,
-    //! Submit to Asynchronous queue.
-    SubmitQueue_ASYNC,
-    //! Submit to copy queue.
-    SubmitQueue_COPY
-};
-
-
 //! Command List Submit information, which is used for queue execution behavior.
 //! Normally this info is a set of command lists that wait or signal given fences,
 //! although no fences need be used.
@@ -100,6 +90,12 @@ struct CommandListSubmitInfo
     U32 NumSignalFences;
     //! Fences to signal.
     Fence** SignalFences; 
+    //! Number of sync points to wait for, on any queue.
+    U32 NumWaitSyncPoints;
+    //! Sync points to wait for.
+    const SyncPoint* PWaitSyncPoints;
+    //! Receives the sync point reached when the lists are finished, if not nullptr.
+    SyncPoint* OutSyncPoint;
 };
 
 
@@ -153,7 +149,9 @@ public:
                                       const ResourceCreateInfo* PCreateInfo, 
                                       const ClearValue* PClearValue) { return SResult_NOT_IMPLEMENTED; }
 
-    //! Create a shader resource view for a given resource.
+    //! Create a shader resource view for a given resource. Creating a view of a resource with the same
+    //! description as a view still alive returns that view, this holds for render target and depth 
+    //! stencil views as well. Each create must be matched with a destroy.
     virtual ResultCode CreateShaderResourceView(const ShaderResourceViewCreateInfo& SRV,
                                                 GPUHandle* OutHandle) { return SResult_NOT_IMPLEMENTED; }
 
@@ -184,11 +182,72 @@ public:
     //! Create a fence object.
     virtual ResultCode CreateFence(GPUHandle* OutHandle) { return SResult_NOT_IMPLEMENTED; }
 
-    //! 
+    //! Destroy a resource made with CreateResource(). Views of the resource are destroyed with it, 
+    //! however many creates they were handed out to. The memory is recycled once the GPU has finished
+    //! the frame it was destroyed in.
+    //!
+    //! \param Handle The resource.
+    //! \return SResult_OK if the resource was destroyed. SResult_OBJECT_NOT_FOUND if there is no such
+    //!         resource.
     virtual ResultCode DestroyResource(GPUHandle Handle) { return SResult_NOT_IMPLEMENTED; }
 
+    //! Map a resource created with ResourceUsage_CPU_UPLOAD into host address space. Mappings are 
+    //! persistent, the resource may stay mapped while the GPU reads from it, so the same pointer can
+    //! be written to every frame without remapping. Writes should go through StreamCopy() when large, 
+    //! since the memory is write-combined. Each call must be matched with an UnmapResource().
+    //!
+    //! \param Handle The resource to map.
+    //! \param OutData The host pointer to the start of the resource memory.
+    //! \return SResult_OK if the resource was mapped. SResult_INVALID_CALL if the resource is not 
+    //!         host visible.
+    virtual ResultCode MapResource(GPUHandle Handle, void** OutData) { return SResult_NOT_IMPLEMENTED; }
+
+    //! Release a mapping made by MapResource(). The native mapping is only released once every
+    //! MapResource() call has been matched.
+    //!
+    //! \param Handle The resource to unmap.
+    //! \return SResult_OK if the call succeeds.
+    virtual ResultCode UnmapResource(GPUHandle Handle) { return SResult_NOT_IMPLEMENTED; }
+
+    //! Destroy views. The descriptor slot of a destroyed view is recycled once the GPU has finished
+    //! the frame it was destroyed in, so views can be destroyed while still referenced by in flight
+    //! frames.
     //!
+    //! \param Handle The view handle returned from the matching Create call.
+    //! \return SResult_OK if the view was destroyed.
     virtual ResultCode DestroyShaderResourceView(GPUHandle Handle) { return SResult_NOT_IMPLEMENTED; }
+
+    //! \sa DestroyShaderResourceView()
+    virtual ResultCode DestroyRenderTargetView(GPUHandle Handle) { return SResult_NOT_IMPLEMENTED; }
+
+    //! \sa DestroyShaderResourceView()
+    virtual ResultCode DestroyDepthStencilView(GPUHandle Handle) { return SResult_NOT_IMPLEMENTED; }
+
+    //! \sa DestroyShaderResourceView()
+    virtual ResultCode DestroyUnorderedAccessView(GPUHandle Handle) { return SResult_NOT_IMPLEMENTED; }
+
+    //! \sa DestroyShaderResourceView()
+    virtual ResultCode DestroyConstantBufferView(GPUHandle Handle) { return SResult_NOT_IMPLEMENTED; }
+
+    //! \sa DestroyShaderResourceView()
+    virtual ResultCode DestroySampler(GPUHandle Handle) { return SResult_NOT_IMPLEMENTED; }
+
+    //! Get the counters of the view cache, shared by shader resource, render target and depth stencil
+    //! views.
+    //!
+    //! \param OutStatistics The counters.
+    //! \return SResult_OK if the call succeeds.
+    virtual ResultCode GetViewCacheStatistics(ViewCacheStatistics* OutStatistics) 
+        { return SResult_NOT_IMPLEMENTED; }
+
+    //! Get the index of a view in the bindless tables. Only available if the device was created with
+    //! bindless enabled. Shader resource views, unordered access views and samplers are given an index 
+    //! on creation, which stays the same until the view is destroyed.
+    //!
+    //! \param ViewHandle The view handle.
+    //! \param OutIndex The index, to pass with GraphicsCommandList::SetBindlessIndices().
+    //! \return SResult_OK if the view has an index. SResult_OBJECT_NOT_FOUND otherwise.
+    virtual ResultCode GetBindlessIndex(GPUHandle ViewHandle, U32* OutIndex) { return SResult_NOT_IMPLEMENTED; }
     
     //!
     virtual ResultCode DestroyFence(GPUHandle Handle) { return SResult_NOT_IMPLEMENTED; }
@@ -248,6 +307,12 @@ public:
     virtual ResultCode SubmitCommandLists(U32 NumSubmits, 
                                           const CommandListSubmitInfo* PSubmitInfos) { return SResult_NOT_IMPLEMENTED; }
 
+    //! Get a queue of the device.
+    //!
+    //! \param Queue The queue type.
+    //! \return The queue, owned by the device. nullptr if the device has none of the type.
+    virtual GraphicsCommandQueue* GetCommandQueue(SubmitQueue Queue) { return nullptr; }
+
     //! Destroy command lists.
     //!
     //! \param NumCommandLists
@@ -278,6 +343,20 @@ public:
                                             const ComputePipelineStateCreateInfo& CreateInfo) 
         { return SResult_NOT_IMPLEMENTED; }
 
+    //! Give back a pipeline state. Identical descriptions share one pipeline state, destroyed with the
+    //! last reference.
+    //!
+    //! \param PPipelineState The pipeline state, assigned to nullptr on success.
+    //! \return SResult_OK if the call succeeds.
+    virtual ResultCode DestroyPipelineState(PipelineState** PPipelineState) { return SResult_NOT_IMPLEMENTED; }
+
+    //! Get the counters of the pipeline state cache.
+    //!
+    //! \param OutStatistics The counters.
+    //! \return SResult_OK if the call succeeds.
+    virtual ResultCode GetPipelineCacheStatistics(PipelineCacheStatistics* OutStatistics) 
+        { return SResult_NOT_IMPLEMENTED; }
+
     //! Create a hardware accelerated ray tracing pipeline for use with rendering.
     //! Note that this only works on hardware with supported ray tracing features.
     //!
@@ -325,10 +404,22 @@ public:
                                               DescriptorSetLayoutInfo* PLayouts) 
         { return SResult_NOT_IMPLEMENTED; }
 
-    //! Create a Sampler for texture use.
+    //! Create a Sampler for texture use. Identical samplers are shared, and hand out the same handle and
+    //! bindless index. Each create must be matched with a DestroySampler(), the descriptor is recycled
+    //! with the last one.
     //! 
-    //! \return SResult_ON if the function succeeds. Any other code will signify a failure.
-    virtual ResultCode CreateSampler() { return SResult_NOT_IMPLEMENTED; }
+    //! \param Info The sampler description.
+    //! \param OutHandle The sampler handle.
+    //! \return SResult_OK if the function succeeds. Any other code will signify a failure.
+    virtual ResultCode CreateSampler(const SamplerCreateInfo& Info, GPUHandle* OutHandle) 
+        { return SResult_NOT_IMPLEMENTED; }
+
+    //! Get the counters of the sampler cache.
+    //!
+    //! \param OutStatistics The counters.
+    //! \return SResult_OK if the call succeeds.
+    virtual ResultCode GetSamplerCacheStatistics(SamplerCacheStatistics* OutStatistics)
+        { return SResult_NOT_IMPLEMENTED; }
 
 protected:  
     GraphicsDeviceFeatures m_Features;
@@ -11,6 +11,9 @@ namespace Synthe {
 typedef U64 GPUHandle;
 #define SYNTHE_GPU_NO_HANDLE 0ULL
 
+//! Subresource index covering every subresource of a resource.
+#define SYNTHE_ALL_SUBRESOURCES 0xFFFFFFFF
+
 
 enum GraphicsAPI
 {
@@ -142,6 +145,17 @@ struct GraphicsDeviceConfig
     B64 DesiresRequired : 1;
     //! Enable GPU validation for debugging.
     B64 EnableDeviceDebugLayer : 1;
+    //! Keep SRVs, UAVs and samplers in global tables at stable indices, for bindless access.
+    B64 EnableBindless : 1;
+    //! Record which pipelines are bound, and create them ahead of use at the next startup. Needs
+    //! PipelineCacheDirectory.
+    B64 EnablePipelinePrewarm : 1;
+    //! Number of SRV and UAV slots in the bindless table, 0 for the default.
+    U32 BindlessResourceCapacity;
+    //! Number of sampler slots in the bindless table, 0 for the default.
+    U32 BindlessSamplerCapacity;
+    //! Directory to keep root signature and pipeline caches in across runs, nullptr to not persist them.
+    const char* PipelineCacheDirectory;
     //! Maximum device memory in bytes, for texture Pool.
     U64 TexturePoolMemoryInBytes;
     //! Maximum device memory in bytes, for buffer pool.
@@ -190,11 +204,82 @@ typedef enum ResourceUsage
     ResourceUsage_UNORDERED_ACCESS      = ( 1 << 2 ),
     ResourceUsage_SHADER_RESOURCE       = ( 1 << 3 ),
     ResourceUsage_DEPTH_STENCIL         = ( 1 << 4 ),
-    ResourceUsage_RENDER_TARGET         = ( 1 << 5 )
+    ResourceUsage_RENDER_TARGET         = ( 1 << 5 ),
+    //! Resource lives in host visible, write-combined upload memory, and can be mapped
+    //! with GraphicsDevice::MapResource(). Only valid for buffers.
+    ResourceUsage_CPU_UPLOAD            = ( 1 << 6 )
 } ResourceUsage;
 
 typedef U32 ResourceUsageFlags;
 
+
+//! How a resource is accessed by the work that follows. Each backend maps accesses to its own
+//! resource states.
+enum ResourceAccess
+{
+    ResourceAccess_COMMON,
+    ResourceAccess_RENDER_TARGET,
+    ResourceAccess_DEPTH_WRITE,
+    ResourceAccess_DEPTH_READ,
+    ResourceAccess_SHADER_READ,
+    ResourceAccess_UNORDERED_ACCESS,
+    ResourceAccess_COPY_SOURCE,
+    ResourceAccess_COPY_DEST,
+    ResourceAccess_PRESENT
+};
+
+
+//! Move a resource to the access needed by the work that follows.
+struct ResourceTransition
+{
+    GPUHandle Resource;
+    //! Subresource index, or SYNTHE_ALL_SUBRESOURCES.
+    U32 Subresource;
+    ResourceAccess Access;
+};
+
+
+//! What a render pass does with the contents of an attachment when it begins.
+enum AttachmentLoadOp
+{
+    //! Keep the contents.
+    AttachmentLoadOp_LOAD,
+    //! Clear to the clear value of the attachment.
+    AttachmentLoadOp_CLEAR,
+    //! The pass writes every pixel it reads, the contents need not be loaded.
+    AttachmentLoadOp_DONT_CARE
+};
+
+
+//! What a render pass does with the contents of an attachment when it ends.
+enum AttachmentStoreOp
+{
+    //! Keep the contents.
+    AttachmentStoreOp_STORE,
+    //! Resolve the multisampled contents into the resolve resource, and keep them.
+    AttachmentStoreOp_RESOLVE,
+    //! Nothing reads the contents after the pass, they need not be written back.
+    AttachmentStoreOp_DISCARD
+};
+
+
+//! A render target, or depth stencil, of a render pass.
+struct RenderPassAttachment
+{
+    //! Render target view, or depth stencil view.
+    GPUHandle View;
+    AttachmentLoadOp LoadOp;
+    AttachmentStoreOp StoreOp;
+    //! Clear value of render targets, with AttachmentLoadOp_CLEAR.
+    ClearColorValue ClearColor;
+    //! Clear values of depth stencils, with AttachmentLoadOp_CLEAR.
+    R32 ClearDepth;
+    U8 ClearStencil;
+    //! Resource, and subresource, written by AttachmentStoreOp_RESOLVE. Render targets only.
+    GPUHandle ResolveResource;
+    U32 ResolveSubresource;
+};
+
 typedef enum ResourceDimension
 {
     ResourceDimension_BUFFER,
@@ -507,6 +592,20 @@ struct UnorderedAccessViewCreateInfo
 };
 
 
+//! Counters of the view cache, since startup. The hit rate is NumHits / NumRequests.
+struct ViewCacheStatistics
+{
+    //! View creates requested.
+    U64 NumRequests;
+    //! Creates that returned an existing view of the same resource and description.
+    U64 NumHits;
+    //! Views currently alive, each holding one descriptor.
+    U64 NumLiveViews;
+    //! Views dropped because their resource was destroyed.
+    U64 NumInvalidated;
+};
+
+
 struct Viewport
 {
     R32 X;
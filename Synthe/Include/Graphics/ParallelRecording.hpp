@@ -0,0 +1,49 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Common/Types.hpp"
+#include "Graphics/GraphicsCommandList.hpp"
+
+#include <functional>
+
+
+namespace Synthe {
+
+
+class WorkerPool;
+
+
+//! Records the commands of one list, between its Begin() and End().
+typedef std::function<void(U32 ListIndex, GraphicsCommandList* PList)> RecordCommandListFunction;
+
+
+//! Record command lists in parallel, one job per list. The first list is recorded on the calling 
+//! thread, while the workers take the others. Lists keep their own allocators and scratch space, so 
+//! each list must appear once. Submitting the lists in array order afterwards gives the same GPU order
+//! whichever worker finished first.
+//!
+//! \param PPool Workers to record on, nullptr to record everything on the calling thread.
+//! \param NumLists The number of lists.
+//! \param PLists The lists.
+//! \param Record Called once per list, from any thread.
+void RecordCommandListsParallel(WorkerPool* PPool,
+                                U32 NumLists,
+                                GraphicsCommandList* const* PLists,
+                                const RecordCommandListFunction& Record);
+
+
+//! Split NumItems into NumParts contiguous parts, the first parts taking one more item when it does
+//! not divide evenly.
+//!
+//! \param OutFirst The first item of Part.
+//! \param OutCount The number of items in Part.
+inline void GetParallelRange(U32 NumItems, U32 NumParts, U32 Part, U32* OutFirst, U32* OutCount)
+{
+    U32 Base = NumItems / NumParts;
+    U32 Remainder = NumItems % NumParts;
+    *OutFirst = Part * Base + (Part < Remainder ? Part : Remainder);
+    *OutCount = Base + (Part < Remainder ? 1 : 0);
+}
+} // Synthe
@@ -75,6 +75,65 @@ enum GraphicsComparison
 };
 
 
+enum SamplerFilter
+{
+    SamplerFilter_POINT,
+    SamplerFilter_LINEAR
+};
+
+
+enum SamplerAddressMode
+{
+    SamplerAddressMode_WRAP,
+    SamplerAddressMode_MIRROR,
+    SamplerAddressMode_CLAMP,
+    SamplerAddressMode_BORDER,
+    SamplerAddressMode_MIRROR_ONCE
+};
+
+
+enum SamplerBorderColor
+{
+    SamplerBorderColor_TRANSPARENT_BLACK,
+    SamplerBorderColor_OPAQUE_BLACK,
+    SamplerBorderColor_OPAQUE_WHITE
+};
+
+
+//! Sampler information. Samplers that describe the same sampling share one descriptor.
+struct SamplerCreateInfo
+{
+    SamplerFilter MinFilter;
+    SamplerFilter MagFilter;
+    SamplerFilter MipFilter;
+    SamplerAddressMode AddressU;
+    SamplerAddressMode AddressV;
+    SamplerAddressMode AddressW;
+    R32 MipLODBias;
+    //! Anisotropic filtering is used when greater than 1, overriding the filters above.
+    U32 MaxAnisotropy;
+    //! Compare against ComparisonFunction, for sampling depth with SampleCmp.
+    B32 EnableComparison;
+    GraphicsComparison ComparisonFunction;
+    //! Only used if one of the address modes is SamplerAddressMode_BORDER.
+    SamplerBorderColor BorderColor;
+    R32 MinLOD;
+    R32 MaxLOD;
+};
+
+
+//! Counters of the sampler cache, since startup.
+struct SamplerCacheStatistics
+{
+    //! Creates that returned an existing sampler.
+    U64 NumHits;
+    //! Creates that wrote a new sampler descriptor.
+    U64 NumMisses;
+    //! Samplers currently alive, each holding one descriptor.
+    U64 NumLiveSamplers;
+};
+
+
 struct GraphicsDepthStencilStateDesc
 {
     B32 DepthEnable;
@@ -84,9 +143,31 @@ struct GraphicsDepthStencilStateDesc
 };
 
 
+class PipelineState;
+
+
+enum PipelineStateCreateFlag
+{
+    PipelineStateCreateFlag_NONE = 0,
+    //! Return right away with the pipeline in PipelineStateStatus_COMPILING, and compile on a worker 
+    //! thread. Shader bytecode and the root signature must stay alive until the pipeline is ready.
+    PipelineStateCreateFlag_ASYNC_COMPILE = (1 << 0)
+};
+
+
+typedef U32 PipelineStateCreateFlags;
+
+
 struct PipelineStateCreateInfo
 {
     RootSignature*                  RootSig;
+    //! Creation flags.
+    PipelineStateCreateFlags        Flags;
+    //! Pipeline bound instead while this one compiles, with PipelineNotReadyPolicy_FALLBACK.
+    PipelineState*                  PFallback;
+    //! Order of asynchronous compiles, higher first. Pipelines prewarmed at startup use negative 
+    //! priorities, so 0 and above compile ahead of them.
+    I32                             CompilePriority;
 };
 
 
@@ -132,10 +213,31 @@ struct RayTracingPipelineStateCreateInfo
 };
 
 
+//! Hints on how long descriptors and the data they point to stay unchanged, so drivers may optimize
+//! their accesses. With no hints, anything may change at any time, as with root signature version 1.0.
+//! Hints are ignored on devices that only support version 1.0.
+enum DescriptorDataFlag
+{
+    DescriptorDataFlag_NONE = 0,
+    //! Descriptors are written before the table is bound while recording, and not changed until the 
+    //! command list finishes executing. Not applicable to root descriptors.
+    DescriptorDataFlag_DESCRIPTORS_STATIC = (1 << 0),
+    //! Data is not changed while the descriptor is bound during execution.
+    DescriptorDataFlag_DATA_STATIC_WHILE_SET_AT_EXECUTE = (1 << 1),
+    //! Data is not changed from when the descriptor is bound while recording, until the command list
+    //! finishes executing. Tables need DescriptorDataFlag_DESCRIPTORS_STATIC as well.
+    DescriptorDataFlag_DATA_STATIC = (1 << 2)
+};
+
+
+typedef U32 DescriptorDataFlags;
+
+
 struct DescriptorLayoutInfo
 { 
     U32 NumDescriptors;
     U32 BaseRegister;
+    DescriptorDataFlags Flags;
 };
 
 
@@ -147,11 +249,99 @@ struct DescriptorSetLayoutInfo
     DescriptorLayoutInfo Sampler;
 };
 
+//! Register spaces of the bindless tables. Shaders declare unbounded arrays in these spaces, such as
+//! Texture2D Textures[] : register(t0, space1), and index them with the bindless root constants, 
+//! declared at register(b0, space4).
+#define BINDLESS_SRV_SPACE      1
+#define BINDLESS_UAV_SPACE      2
+#define BINDLESS_SAMPLER_SPACE  3
+#define BINDLESS_INDEX_SPACE    4
+
+
+enum RootParameterType
+{
+    //! 32 bit values inlined in the root signature, read as a constant buffer.
+    RootParameterType_CONSTANTS,
+    //! Constant buffer, bound by address.
+    RootParameterType_CBV,
+    //! Structured or raw buffer, bound by address.
+    RootParameterType_SRV,
+    //! Read/write structured or raw buffer, bound by address.
+    RootParameterType_UAV
+};
+
+
+//! A parameter set directly in the root signature, without going through a descriptor table. 
+//! Root constants take one slot of the 64 available per 32 bit value, root descriptors take two.
+struct RootParameterInfo
+{
+    RootParameterType Type;
+    U32 ShaderRegister;
+    U32 RegisterSpace;
+    //! Number of 32 bit values, for RootParameterType_CONSTANTS only.
+    U32 Num32BitValues;
+    //! Data hints, for root descriptors only.
+    DescriptorDataFlags Flags;
+};
+
+
 // Root Signature is the pipeline layout.
 struct RootSignatureLayoutInfo
 {   
     U32 NumDescriptorTables;
     DescriptorSetLayoutInfo* LayoutInfos;
+    //! Root constants and root descriptors, placed after the descriptor tables. Their index in this
+    //! array is the index given to the GraphicsCommandList root parameter setters.
+    U32 NumRootParameters;
+    RootParameterInfo* PRootParameters;
+    //! Append the global bindless tables after the descriptor tables. Requires the device to be 
+    //! created with bindless enabled.
+    B32 UseBindless;
+    //! Number of 32 bit bindless indices passed per draw, see GraphicsCommandList::SetBindlessIndices().
+    U32 NumBindlessIndices;
+};
+
+
+//! Counters of the pipeline state cache, since startup. The hit rate is 
+//! (NumHits + NumLibraryHits) / NumRequests.
+struct PipelineCacheStatistics
+{
+    //! Pipeline creates requested.
+    U64 NumRequests;
+    //! Requests made with PipelineStateCreateFlag_ASYNC_COMPILE.
+    U64 NumAsyncRequests;
+    //! Requests that returned a pipeline state already alive.
+    U64 NumHits;
+    //! Requests loaded from the on-disk pipeline library, without compiling.
+    U64 NumLibraryHits;
+    //! Requests that had to compile.
+    U64 NumCompiles;
+    //! Pipeline states currently alive.
+    U64 NumLivePipelines;
+    //! Time spent compiling, in milliseconds, summed over all worker threads.
+    R64 CompileTimeMs;
+    //! Time spent loading from the pipeline library, in milliseconds.
+    R64 LibraryLoadTimeMs;
+};
+
+
+enum PipelineStateStatus
+{
+    PipelineStateStatus_COMPILING,
+    PipelineStateStatus_READY,
+    PipelineStateStatus_FAILED
+};
+
+
+//! What a command list does when told to bind a pipeline that is still compiling.
+enum PipelineNotReadyPolicy
+{
+    //! Block until the pipeline is ready.
+    PipelineNotReadyPolicy_WAIT,
+    //! Drop draws and dispatches until a ready pipeline is bound.
+    PipelineNotReadyPolicy_SKIP,
+    //! Bind the fallback pipeline given at creation if it is ready, skip otherwise.
+    PipelineNotReadyPolicy_FALLBACK
 };
 
 
@@ -164,6 +354,15 @@ public:
     //! Get the pipeline state type.    
     PipelineStateType GetType() const { return m_Metadata.Type; }
 
+    //! Get the compile status, pipelines created without PipelineStateCreateFlag_ASYNC_COMPILE are
+    //! always ready.
+    virtual PipelineStateStatus GetStatus() const { return PipelineStateStatus_READY; }
+
+    //! Block until the pipeline finishes compiling.
+    //!
+    //! \return SResult_OK if the pipeline is ready. SResult_INITIALIZATION_FAILURE if it failed to compile.
+    virtual ResultCode Wait() { return SResult_OK; }
+
 protected:
     //! Metadata stored for this pipeline state.
     struct {
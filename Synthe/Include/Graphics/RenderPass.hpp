@@ -0,0 +1,233 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Common/Types.hpp"
+#include "Graphics/GraphicsStructs.hpp"
+
+#include <functional>
+#include <vector>
+
+
+namespace Synthe {
+
+
+class GraphicsCommandList;
+class FrameGraph;
+
+
+//! Version of a resource in a frame graph. Every write makes a new version, so reading a version
+//! orders the reader after the pass that wrote it.
+typedef U32 FrameGraphResource;
+
+
+//! Counters of a frame graph. Pass and transition counts are of the last compile, compile counts
+//! are since the graph was made.
+struct FrameGraphStatistics
+{
+    U64 NumPasses;
+    //! Passes dropped because nothing kept uses what they write.
+    U64 NumCulledPasses;
+    //! Groups of passes that do not depend on each other. Each group gets one transition batch.
+    U64 NumLevels;
+    U64 NumTransitions;
+    //! TransitionResources() calls made per Execute().
+    U64 NumTransitionBatches;
+    U64 NumCompiles;
+    //! Compiles skipped because the passes and their uses matched the last compile.
+    U64 NumCompileCacheHits;
+};
+
+
+//! Declares the resources a pass uses, handed to the setup function of the pass.
+class FrameGraphPassBuilder
+{
+public:
+    //! Read a resource. Only the latest version of a resource may be read, so passes are declared in
+    //! an order they could run in.
+    //!
+    //! \param Resource The version read.
+    //! \param Access How the pass reads it.
+    //! \return The version read, FrameGraph::k_InvalidResource if Resource is not the latest version.
+    FrameGraphResource Read(FrameGraphResource Resource, ResourceAccess Access = ResourceAccess_SHADER_READ);
+
+    //! Write a resource. Only the latest version of a resource may be written.
+    //!
+    //! \param Resource The version written over.
+    //! \param Access How the pass writes it.
+    //! \return The new version, FrameGraph::k_InvalidResource if Resource is not the latest version.
+    FrameGraphResource Write(FrameGraphResource Resource, ResourceAccess Access = ResourceAccess_RENDER_TARGET);
+
+    //! Keep the pass even if nothing uses what it writes, such as a pass writing to a readback buffer.
+    void SetSideEffects();
+
+private:
+    friend class FrameGraph;
+
+    FrameGraphPassBuilder(FrameGraph* PGraph, U32 Pass)
+        : m_PGraph(PGraph)
+        , m_Pass(Pass) { }
+
+    FrameGraph* m_PGraph;
+    U32 m_Pass;
+};
+
+
+typedef std::function<void(FrameGraphPassBuilder&)> FrameGraphSetupFunction;
+typedef std::function<void(GraphicsCommandList*)> FrameGraphExecuteFunction;
+
+
+//! Graph of the passes of a frame. Passes declare the resources they read and write, and the graph
+//! works out the rest when compiled:
+//!  - Passes whose writes are never used by an exported resource, or a pass with side effects, are
+//!    culled.
+//!  - Passes are grouped in levels, each level only depending on the levels before it, and run level
+//!    by level, in declaration order within a level.
+//!  - Transitions needed by all the passes of a level are recorded in one TransitionResources() call
+//!    ahead of the level, and exported resources are moved to their final access at the end.
+//!
+//! The graph is declared again every frame, between Reset() and Compile(). Compiling is skipped when
+//! the passes and their uses match the last compile, only resource handles and pass functions may
+//! then differ. The graph knows nothing of the device, execute it into a CommandStreamList to
+//! inspect what it records.
+class FrameGraph
+{
+public:
+    static const FrameGraphResource k_InvalidResource = 0xFFFFFFFF;
+
+    FrameGraph()
+        : m_HasCompiled(false)
+        , m_CompileResult(SResult_OK)
+        , m_FirstFinalTransition(0)
+        , m_Invalid(false)
+        , m_Statistics() { }
+
+    //! Drop the passes and resources declared, keeping the last compile.
+    void Reset();
+
+    //! Bring a resource into the graph.
+    //!
+    //! \param Name Name of the resource, for debugging. Must outlive the frame.
+    //! \param Handle The resource.
+    //! \param CurrentAccess The access the resource is in when the graph executes.
+    //! \return The first version of the resource.
+    FrameGraphResource ImportResource(const char* Name, GPUHandle Handle, ResourceAccess CurrentAccess);
+
+    //! Use a version of a resource after the graph, which keeps the passes it depends on.
+    //!
+    //! \param Resource The version used, usually the latest.
+    //! \param FinalAccess The access to leave the resource in.
+    void ExportResource(FrameGraphResource Resource, ResourceAccess FinalAccess);
+
+    //! Add a pass.
+    //!
+    //! \param Name Name of the pass, for debugging. Must outlive the frame.
+    //! \param Setup Called right away, to declare the resources of the pass.
+    //! \param Execute Called by Execute() to record the pass, unless the pass is culled.
+    //! \return The index of the pass.
+    U32 AddPass(const char* Name, const FrameGraphSetupFunction& Setup, FrameGraphExecuteFunction Execute);
+
+    //! Cull, order, and work out the transitions of the passes declared.
+    //!
+    //! \return SResult_OK on success. SResult_INVALID_ARGS if a use was not of the latest version, or
+    //!         a pass uses one resource with two different accesses.
+    ResultCode Compile();
+
+    //! Record the passes, and their transitions, into a list. Compile() must have succeeded.
+    void Execute(GraphicsCommandList* PList);
+
+    U32 GetNumPasses() const { return static_cast<U32>(m_Passes.size()); }
+
+    //! Passes left after culling, in execution order.
+    const std::vector<U32>& GetExecutionOrder() const { return m_Order; }
+
+    B32 IsPassCulled(U32 Pass) const { return m_Levels[Pass] == k_Culled; }
+
+    //! Level of a pass, passes of one level do not depend on each other.
+    U32 GetPassLevel(U32 Pass) const { return m_Levels[Pass]; }
+
+    const char* GetPassName(U32 Pass) const { return m_Passes[Pass].Name; }
+
+    const FrameGraphStatistics& GetStatistics() const { return m_Statistics; }
+
+private:
+    friend class FrameGraphPassBuilder;
+
+    static const U32 k_Culled = 0xFFFFFFFF;
+    static const U32 k_NoPass = 0xFFFFFFFF;
+
+    struct ResourceNode
+    {
+        const char* Name;
+        GPUHandle Handle;
+        ResourceAccess InitialAccess;
+        FrameGraphResource LatestVersion;
+    };
+
+    struct VersionNode
+    {
+        U32 Resource;
+        //! Pass writing the version, k_NoPass for the imported version.
+        U32 Producer;
+    };
+
+    struct PassUse
+    {
+        //! Version read, or written over.
+        FrameGraphResource Version;
+        ResourceAccess Access;
+        B32 Write;
+    };
+
+    struct PassNode
+    {
+        const char* Name;
+        FrameGraphExecuteFunction Execute;
+        U32 FirstUse;
+        U32 NumUses;
+        B32 SideEffects;
+    };
+
+    struct ExportNode
+    {
+        FrameGraphResource Version;
+        ResourceAccess FinalAccess;
+    };
+
+    //! Compiled transition, to a resource index.
+    struct CompiledTransition
+    {
+        U32 Resource;
+        ResourceAccess Access;
+    };
+
+    //! Everything Compile() reads, to tell whether the last compile still holds.
+    void BuildTopologyKey(std::vector<U32>& OutKey) const;
+
+    std::vector<ResourceNode>               m_Resources;
+    std::vector<VersionNode>                m_Versions;
+    std::vector<PassNode>                   m_Passes;
+    std::vector<PassUse>                    m_Uses;
+    std::vector<ExportNode>                 m_Exports;
+
+    // The last compile.
+    B32                                     m_HasCompiled;
+    ResultCode                              m_CompileResult;
+    std::vector<U32>                        m_CompiledKey;
+    std::vector<U32>                        m_Levels;
+    std::vector<U32>                        m_Order;
+    //! First transition of each level, and one past the last level.
+    std::vector<U32>                        m_LevelTransitions;
+    //! First pass in m_Order of each level, and one past the last level.
+    std::vector<U32>                        m_LevelPasses;
+    std::vector<CompiledTransition>         m_Transitions;
+    U32                                     m_FirstFinalTransition;
+
+    //! Set by a bad declaration this frame.
+    B32                                     m_Invalid;
+    std::vector<U32>                        m_KeyScratch;
+    std::vector<ResourceTransition>         m_TransitionScratch;
+    FrameGraphStatistics                    m_Statistics;
+};
+} // Synthe
@@ -0,0 +1,172 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Common/Types.hpp"
+#include "Common/MappedFile.hpp"
+#include "Graphics/PipelineState.hpp"
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace Synthe {
+
+
+// 'SSPK'
+#define SHADER_PACK_MAGIC       (0x4B505353)
+#define SHADER_PACK_VERSION     (1)
+//! Alignment of each bytecode blob in the pack.
+#define SHADER_PACK_ALIGNMENT   (16)
+
+
+//! Shader pack file layout, little endian:
+//!
+//!     ShaderPackHeader
+//!     ShaderPackEntry[NumEntries]     sorted by name hash, then permutation key
+//!     ShaderPackBlob[NumBlobs]        sorted by content hash
+//!     Bytecode                        at DataOffset, each blob aligned to SHADER_PACK_ALIGNMENT
+//!
+//! Entries map a shader permutation to a blob, and permutations that compile to the same bytecode share
+//! one blob. Written by ShaderPackBuilder, or by ShaderCompiler/ShaderCompile.py.
+struct ShaderPackHeader
+{
+    U32 Magic;
+    U32 Version;
+    U32 NumEntries;
+    U32 NumBlobs;
+    U64 DataOffset;
+    U64 DataSizeInBytes;
+};
+
+
+struct ShaderPackEntry
+{
+    //! HashShaderName() of the shader path, relative to the shader source directory.
+    U64 NameHash;
+    //! Permutation of the shader, 0 for the default one.
+    U64 PermutationKey;
+    U32 BlobIndex;
+    U32 Reserved;
+};
+
+
+struct ShaderPackBlob
+{
+    //! HashBytes() of the bytecode.
+    U64 ContentHash;
+    //! Offset from ShaderPackHeader::DataOffset.
+    U64 Offset;
+    U64 SizeInBytes;
+};
+
+
+//! Hash of a shader name, such as "PostProcessing/Blur.cs". Back slashes are hashed as forward slashes,
+//! so names are the same on every platform.
+U64 HashShaderName(const char* Name);
+
+
+//! Read only shader pack, memory mapped. Shader modules point straight into the mapping, so looking
+//! a shader up does no copy and no file access, and pages of bytecode are only read once used.
+class ShaderPack
+{
+public:
+    ShaderPack()
+        : m_PEntries(nullptr)
+        , m_PBlobs(nullptr)
+        , m_PData(nullptr)
+        , m_NumEntries(0)
+        , m_NumBlobs(0) { }
+
+    //! Map a pack, closing any pack opened before.
+    //!
+    //! \param Path The pack file.
+    //! \return SResult_OK on success. SResult_OBJECT_NOT_FOUND if there is no file.
+    //!         SResult_MEMORY_CORRUPTION if the file is from another version, or its tables are damaged.
+    ResultCode Open(const std::string& Path);
+
+    //! Unmap the pack. Modules found in it are invalid afterwards.
+    void Close();
+
+    //! Find the bytecode of a shader permutation.
+    //!
+    //! \param NameHash HashShaderName() of the shader.
+    //! \param PermutationKey The permutation.
+    //! \param OutModule Points into the pack. The bytecode must not be written to.
+    //! \return SResult_OK if found. SResult_OBJECT_NOT_FOUND otherwise.
+    ResultCode Find(U64 NameHash, U64 PermutationKey, ShaderModule* OutModule) const;
+
+    ResultCode Find(const char* Name, U64 PermutationKey, ShaderModule* OutModule) const
+    {
+        return Find(HashShaderName(Name), PermutationKey, OutModule);
+    }
+
+    //! Find bytecode by its content hash, as kept in pipeline caches.
+    ResultCode FindByContentHash(U64 ContentHash, ShaderModule* OutModule) const;
+
+    B32 IsOpen() const { return m_File.IsOpen(); }
+    U32 GetNumEntries() const { return m_NumEntries; }
+    U32 GetNumBlobs() const { return m_NumBlobs; }
+
+private:
+    void GetModule(const ShaderPackBlob& Blob, ShaderModule* OutModule) const;
+
+    MappedFile              m_File;
+    const ShaderPackEntry*  m_PEntries;
+    const ShaderPackBlob*   m_PBlobs;
+    const U8*               m_PData;
+    U32                     m_NumEntries;
+    U32                     m_NumBlobs;
+};
+
+
+//! Collects compiled shader permutations, and writes them as a shader pack.
+class ShaderPackBuilder
+{
+public:
+    ShaderPackBuilder()
+        : m_NumDuplicateBytes(0) { }
+
+    //! Add the bytecode of a shader permutation. Bytecode equal to an added one is stored once.
+    //!
+    //! \param NameHash HashShaderName() of the shader.
+    //! \param PermutationKey The permutation.
+    //! \param PByteCode The bytecode, copied.
+    //! \param SizeInBytes The size of the bytecode.
+    //! \return SResult_OK on success. SResult_ALREADY_EXISTS if the permutation was added before.
+    ResultCode Add(U64 NameHash, U64 PermutationKey, const void* PByteCode, U64 SizeInBytes);
+
+    ResultCode Add(const char* Name, U64 PermutationKey, const void* PByteCode, U64 SizeInBytes)
+    {
+        return Add(HashShaderName(Name), PermutationKey, PByteCode, SizeInBytes);
+    }
+
+    //! Write the pack.
+    //!
+    //! \return SResult_OK on success. SResult_FAILED if the file could not be written.
+    ResultCode Write(const std::string& Path) const;
+
+    U32 GetNumEntries() const { return static_cast<U32>(m_Entries.size()); }
+    U32 GetNumBlobs() const { return static_cast<U32>(m_Blobs.size()); }
+
+    //! Bytes not stored thanks to identical bytecode.
+    U64 GetNumDuplicateBytes() const { return m_NumDuplicateBytes; }
+
+private:
+    struct Blob
+    {
+        U64 ContentHash;
+        std::vector<U8> ByteCode;
+    };
+
+    //! Blob index of each (name hash, permutation key), ordered as written.
+    std::map<std::pair<U64, U64>, U32>  m_Entries;
+    std::vector<Blob>                   m_Blobs;
+    std::unordered_multimap<U64, U32>   m_BlobsByHash;
+    U64                                 m_NumDuplicateBytes;
+};
+} // Synthe
@@ -0,0 +1,200 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Common/Types.hpp"
+#include "Graphics/PipelineState.hpp"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace Synthe {
+
+
+class ShaderPack;
+class ShaderPackBuilder;
+
+
+//! A preprocessor define of a shader permutation.
+struct ShaderDefine
+{
+    const char* Name;
+    const char* Value;
+};
+
+
+//! What a compiler needs to build one shader permutation.
+struct ShaderCompileInfo
+{
+    //! Source file of the shader.
+    std::string SourcePath;
+    //! Directory includes are also searched in, the shader source root.
+    std::string IncludeDirectory;
+    //! Stage extension of the shader, such as "cs" or "ps".
+    std::string Stage;
+    //! Defines of the permutation, as (name, value).
+    std::vector<std::pair<std::string, std::string>> Defines;
+};
+
+
+//! Compiler used by the permutation manager. The default preprocessing expands includes, and drops
+//! the defines the expanded source never mentions, so permutations that only differ by unused defines
+//! preprocess to the same text. Compilers with a real preprocessor may override it.
+class ShaderCompiler
+{
+public:
+    virtual ~ShaderCompiler() { }
+
+    //! Produce the source that is compiled, with the defines of the permutation.
+    //!
+    //! \return SResult_OK on success. SResult_OBJECT_NOT_FOUND if the source or an include is missing.
+    virtual ResultCode Preprocess(const ShaderCompileInfo& Info, std::string& OutSource);
+
+    //! Compile preprocessed source to bytecode. There is no compiler on platforms without one, and
+    //! compiles fail with SResult_NOT_IMPLEMENTED.
+    virtual ResultCode Compile(const ShaderCompileInfo& Info,
+                               const std::string& Source,
+                               std::vector<U8>& OutByteCode)
+    {
+        return SResult_NOT_IMPLEMENTED;
+    }
+};
+
+
+//! Counters of the permutation manager, since creation.
+struct ShaderPermutationStatistics
+{
+    //! Shader requests.
+    U64 NumRequests;
+    //! Requests served from the shader pack.
+    U64 NumPackHits;
+    //! Permutations that preprocessed to the source of another permutation, and share its bytecode.
+    U64 NumDeduplicated;
+    //! Permutations compiled.
+    U64 NumCompiles;
+    //! Compiles that failed.
+    U64 NumFailures;
+};
+
+
+//! Manages the permutations of the shaders declared in the shader configs. A config lists shaders
+//! relative to its own directory, with the defines each one is permuted over:
+//!
+//!     {
+//!         "shaders": {
+//!             "Blur.cs": {
+//!                 "defines": [
+//!                     { "name": "USE_HALF" },
+//!                     { "name": "RADIUS", "values": [ "3", "5", "9" ] }
+//!                 ]
+//!             }
+//!         }
+//!     }
+//!
+//! A define without values is a switch over "0" and "1". The first value is the default. Each define
+//! takes just enough bits of the 64 bit permutation key to index its values, so the key of the
+//! default permutation is 0.
+//!
+//! Nothing is compiled up front. A permutation is compiled the first time it is asked for, unless it
+//! is in the shader pack, or preprocesses to the same source as one already compiled. The manager may
+//! be used from any thread, compiles run one at a time.
+class ShaderPermutationManager
+{
+public:
+    //! \param PCompiler Compiler to build permutations with. Not owned.
+    //! \param SourceDirectory Root of the shader sources, that shader names are relative to.
+    ShaderPermutationManager(ShaderCompiler* PCompiler, const std::string& SourceDirectory)
+        : m_PCompiler(PCompiler)
+        , m_SourceDirectory(SourceDirectory)
+        , m_PPack(nullptr)
+        , m_Statistics() { }
+
+    //! Load a shader config. Empty configs declare nothing.
+    //!
+    //! \param ConfigPath The config, relative to the source directory, such as
+    //!                   "PostProcessing/PostProcessing.json".
+    //! \return SResult_OK on success. SResult_OBJECT_NOT_FOUND if there is no file. SResult_INVALID_ARGS
+    //!         if the config is malformed, or a shader needs more than 64 key bits.
+    ResultCode LoadConfig(const std::string& ConfigPath);
+
+    //! Look shaders up in a pack before compiling them. Not owned, must outlive the manager.
+    void SetShaderPack(const ShaderPack* PPack) { m_PPack = PPack; }
+
+    //! Build the permutation key of a set of defines. Defines left out keep their default value.
+    //!
+    //! \param ShaderName The shader, such as "PostProcessing/Blur.cs".
+    //! \param NumDefines The number of defines.
+    //! \param PDefines The defines.
+    //! \param OutKey The permutation key.
+    //! \return SResult_OK on success. SResult_OBJECT_NOT_FOUND if the shader is not declared.
+    //!         SResult_INVALID_ARGS if a define, or its value, is not declared for the shader.
+    ResultCode GetPermutationKey(const char* ShaderName,
+                                 U32 NumDefines,
+                                 const ShaderDefine* PDefines,
+                                 U64* OutKey) const;
+
+    //! Get the bytecode of a permutation, compiling it on first use.
+    //!
+    //! \param ShaderName The shader.
+    //! \param PermutationKey The permutation.
+    //! \param OutModule The bytecode. Owned by the manager, or by the shader pack.
+    //! \return SResult_OK on success. SResult_OBJECT_NOT_FOUND if the shader is not declared.
+    //!         SResult_INVALID_ARGS if the key is not valid for the shader. The compile error otherwise.
+    ResultCode GetShader(const char* ShaderName, U64 PermutationKey, ShaderModule* OutModule);
+
+    //! Add every permutation compiled so far to a pack, so the next run loads instead of compiling.
+    void AddCompiledShaders(ShaderPackBuilder& Builder) const;
+
+    U32 GetNumShaders() const { return static_cast<U32>(m_Shaders.size()); }
+    ShaderPermutationStatistics GetStatistics() const;
+
+private:
+    struct PermutationDefine
+    {
+        std::string Name;
+        std::vector<std::string> Values;
+        U32 BitOffset;
+        U32 NumBits;
+    };
+
+    struct ShaderDeclaration
+    {
+        std::string Name;
+        std::vector<PermutationDefine> Defines;
+    };
+
+    struct CompiledShader
+    {
+        std::vector<U8> ByteCode;
+        //! Compile result, kept so failing permutations are not compiled again.
+        ResultCode Result;
+    };
+
+    //! Key of a permutation, (shader name hash, permutation key).
+    struct PermutationKeyHasher
+    {
+        size_t operator()(const std::pair<U64, U64>& Key) const
+        {
+            return static_cast<size_t>(Key.first ^ (Key.second * 0x9E3779B97F4A7C15ULL));
+        }
+    };
+
+    ShaderCompiler*                                     m_PCompiler;
+    std::string                                         m_SourceDirectory;
+    const ShaderPack*                                   m_PPack;
+    std::unordered_map<U64, ShaderDeclaration>          m_Shaders;
+
+    //! Compiled shaders, keyed by the hash of their preprocessed source and stage.
+    std::unordered_map<U64, std::unique_ptr<CompiledShader>>  m_CompiledBySource;
+    //! Permutations asked for, pointing at their compiled shader.
+    std::unordered_map<std::pair<U64, U64>, CompiledShader*, PermutationKeyHasher> m_Permutations;
+    ShaderPermutationStatistics                         m_Statistics;
+    mutable std::mutex                                  m_Mutex;
+};
+} // Synthe
@@ -0,0 +1,159 @@
+# No License, this is entirely open source!
+# Software for learning purposes.
+# Author: Mario Garcia
+#
+# Compiles the shaders of a source tree with dxc, and packs the bytecode into a shader pack.
+# Shaders are found by their stage extension, as named in ShadersConfig.json, such as Blur.cs.hlsl.
+# See Synthe/Include/Graphics/ShaderPack.hpp for the pack layout.
+#
+#   python ShaderCompile.py <source dir> <output pack> [--dxc <path to dxc>]
+
+import argparse
+import json
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+
+SHADER_PACK_MAGIC = 0x4B505353
+SHADER_PACK_VERSION = 1
+SHADER_PACK_ALIGNMENT = 16
+
+FNV1A_64_OFFSET_BASIS = 14695981039346656037
+FNV1A_64_PRIME = 1099511628211
+MASK_64 = (1 << 64) - 1
+
+# Profile prefix of each stage extension. Amplification shaders are named .as on disk.
+STAGE_PROFILES = {
+    'vs': 'vs', 'ps': 'ps', 'hs': 'hs', 'ds': 'ds', 'gs': 'gs', 'cs': 'cs',
+    'ms': 'ms', 'amp': 'as', 'as': 'as',
+}
+
+
+def hash_bytes(data, seed=FNV1A_64_OFFSET_BASIS):
+    """64 bit FNV-1a, matching HashBytes() in Common/Hash.hpp."""
+    value = seed
+    for byte in data:
+        value ^= byte
+        value = (value * FNV1A_64_PRIME) & MASK_64
+    return value
+
+
+def hash_shader_name(name):
+    """Matching HashShaderName() in Graphics/ShaderPack.hpp."""
+    return hash_bytes(name.replace('\\', '/').encode('utf-8'))
+
+
+def align_up(value, alignment):
+    return (value + alignment - 1) & ~(alignment - 1)
+
+
+def load_stage_extensions(config_path):
+    """Collect the stage extensions declared in ShadersConfig.json, and the shader model."""
+    with open(config_path, 'r') as config_file:
+        config = json.load(config_file)
+    extensions = set()
+
+    def collect(node):
+        for key, value in node.items():
+            if key == 'ext' and isinstance(value, str):
+                extensions.add(value)
+            elif isinstance(value, dict):
+                collect(value)
+
+    collect(config.get('shaders', {}))
+    model = config.get('global', {}).get('hlsl_version', '6_0')
+    return {ext for ext in extensions if ext in STAGE_PROFILES} | {'as'}, model
+
+
+def find_shaders(source_dir, extensions, source_ext='hlsl'):
+    """Yield (name, path, stage) of each shader entry point file, name relative to source_dir."""
+    for root, _, files in os.walk(source_dir):
+        for file_name in sorted(files):
+            parts = file_name.split('.')
+            if len(parts) < 3 or parts[-1] != source_ext or parts[-2] not in extensions:
+                continue
+            path = os.path.join(root, file_name)
+            name = os.path.relpath(path, source_dir).replace('\\', '/')
+            name = name[:-(len(source_ext) + 1)]
+            yield name, path, parts[-2]
+
+
+def compile_shader(dxc, path, stage, model, include_dir):
+    profile = '{}_{}'.format(STAGE_PROFILES[stage], model)
+    with tempfile.TemporaryDirectory() as temp_dir:
+        output = os.path.join(temp_dir, 'out.dxil')
+        command = [dxc, '-T', profile, '-E', 'main', '-I', include_dir, '-Fo', output, path]
+        result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        if result.returncode != 0:
+            sys.stderr.write('{} failed:\n{}\n'.format(path, result.stderr.decode('utf-8', 'replace')))
+            return None
+        with open(output, 'rb') as bytecode_file:
+            return bytecode_file.read()
+
+
+def write_pack(path, entries):
+    """Write a shader pack. entries is a list of (name hash, permutation key, bytecode), identical
+    bytecode is stored once."""
+    blobs = {}
+    for _, _, bytecode in entries:
+        blobs.setdefault(hash_bytes(bytecode), bytecode)
+    blob_hashes = sorted(blobs)
+    blob_index = {content_hash: index for index, content_hash in enumerate(blob_hashes)}
+
+    table = []
+    offset = 0
+    for content_hash in blob_hashes:
+        size = len(blobs[content_hash])
+        table.append((content_hash, offset, size))
+        offset = align_up(offset + size, SHADER_PACK_ALIGNMENT)
+    data_size = offset
+
+    entries = sorted((name_hash, key, blob_index[hash_bytes(bytecode)]) for name_hash, key, bytecode in entries)
+    data_offset = align_up(32 + len(entries) * 24 + len(table) * 24, SHADER_PACK_ALIGNMENT)
+
+    out = bytearray(data_offset + data_size)
+    struct.pack_into('<IIIIQQ', out, 0, SHADER_PACK_MAGIC, SHADER_PACK_VERSION, len(entries), len(table),
+                     data_offset, data_size)
+    cursor = 32
+    for name_hash, key, index in entries:
+        struct.pack_into('<QQII', out, cursor, name_hash, key, index, 0)
+        cursor += 24
+    for content_hash, blob_offset, size in table:
+        struct.pack_into('<QQQ', out, cursor, content_hash, blob_offset, size)
+        cursor += 24
+        out[data_offset + blob_offset:data_offset + blob_offset + size] = blobs[content_hash]
+
+    temp_path = path + '.tmp'
+    with open(temp_path, 'wb') as pack_file:
+        pack_file.write(out)
+    os.replace(temp_path, path)
+    return len(table)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compile shaders into a shader pack.')
+    parser.add_argument('source_dir')
+    parser.add_argument('output')
+    parser.add_argument('--dxc', default='dxc')
+    parser.add_argument('--config', default=os.path.join(os.path.dirname(__file__), 'ShadersConfig.json'))
+    args = parser.parse_args()
+
+    extensions, model = load_stage_extensions(args.config)
+    entries = []
+    failed = 0
+    for name, path, stage in find_shaders(args.source_dir, extensions):
+        bytecode = compile_shader(args.dxc, path, stage, model, args.source_dir)
+        if bytecode is None:
+            failed += 1
+            continue
+        entries.append((hash_shader_name(name), 0, bytecode))
+
+    num_blobs = write_pack(args.output, entries)
+    print('{} shaders, {} unique, {} failed'.format(len(entries), num_blobs, failed))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
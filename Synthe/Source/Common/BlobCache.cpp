@@ -0,0 +1,201 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "Common/BlobCache.hpp"
+#include "Common/Hash.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <string.h>
+
+namespace Synthe {
+
+
+struct BlobCacheHeader
+{
+    U32 Magic;
+    U32 Version;
+    U64 NumEntries;
+};
+
+
+struct BlobCacheEntryHeader
+{
+    U64 Key;
+    U64 SizeInBytes;
+    U64 ContentHash;
+};
+
+
+ResultCode ReadFileBytes(const std::string& Path, std::vector<U8>& OutBytes)
+{
+    std::ifstream File(Path, std::ios::binary | std::ios::ate);
+    if (!File.is_open())
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+    std::streamsize Size = File.tellg();
+    File.seekg(0, std::ios::beg);
+    OutBytes.resize(static_cast<size_t>(Size));
+    if (Size > 0 && !File.read(reinterpret_cast<char*>(OutBytes.data()), Size))
+    {
+        OutBytes.clear();
+        return SResult_FAILED;
+    }
+    return SResult_OK;
+}
+
+
+ResultCode WriteFileBytes(const std::string& Path, const void* PData, U64 SizeInBytes)
+{
+    std::string TempPath = Path + ".tmp";
+    {
+        std::ofstream File(TempPath, std::ios::binary | std::ios::trunc);
+        if (!File.is_open())
+        {
+            return SResult_FAILED;
+        }
+        File.write(static_cast<const char*>(PData), static_cast<std::streamsize>(SizeInBytes));
+        if (!File.good())
+        {
+            return SResult_FAILED;
+        }
+    }
+    // rename() does not replace existing files on Windows.
+    std::remove(Path.c_str());
+    if (std::rename(TempPath.c_str(), Path.c_str()) != 0)
+    {
+        std::remove(TempPath.c_str());
+        return SResult_FAILED;
+    }
+    return SResult_OK;
+}
+
+
+ResultCode BlobCache::Load(const std::string& Path)
+{
+    std::vector<U8> Bytes;
+    ResultCode Result = ReadFileBytes(Path, Bytes);
+    if (Result != SResult_OK)
+    {
+        return Result;
+    }
+
+    m_Entries.clear();
+    m_Dirty = false;
+
+    BlobCacheHeader Header = { };
+    if (Bytes.size() < sizeof(Header))
+    {
+        return SResult_MEMORY_CORRUPTION;
+    }
+    memcpy(&Header, Bytes.data(), sizeof(Header));
+    if (Header.Magic != m_Magic || Header.Version != m_Version)
+    {
+        return SResult_MEMORY_CORRUPTION;
+    }
+
+    U64 Offset = sizeof(Header);
+    for (U64 I = 0; I < Header.NumEntries; ++I)
+    {
+        BlobCacheEntryHeader Entry = { };
+        if (Bytes.size() - Offset < sizeof(Entry))
+        {
+            return SResult_MEMORY_CORRUPTION;
+        }
+        memcpy(&Entry, Bytes.data() + Offset, sizeof(Entry));
+        Offset += sizeof(Entry);
+        if (Bytes.size() - Offset < Entry.SizeInBytes)
+        {
+            return SResult_MEMORY_CORRUPTION;
+        }
+        const U8* PContent = Bytes.data() + Offset;
+        Offset += Entry.SizeInBytes;
+        if (HashBytes(PContent, Entry.SizeInBytes) != Entry.ContentHash)
+        {
+            // Drop the entry, so it gets rebuilt and the file rewritten.
+            m_Dirty = true;
+            continue;
+        }
+        m_Entries[Entry.Key].assign(PContent, PContent + Entry.SizeInBytes);
+    }
+    return SResult_OK;
+}
+
+
+ResultCode BlobCache::Save(const std::string& Path)
+{
+    if (!m_Dirty)
+    {
+        return SResult_OK;
+    }
+
+    U64 TotalSizeInBytes = sizeof(BlobCacheHeader);
+    for (auto& Entry : m_Entries)
+    {
+        TotalSizeInBytes += sizeof(BlobCacheEntryHeader) + Entry.second.size();
+    }
+
+    std::vector<U8> Bytes(static_cast<size_t>(TotalSizeInBytes));
+    BlobCacheHeader Header = { m_Magic, m_Version, m_Entries.size() };
+    memcpy(Bytes.data(), &Header, sizeof(Header));
+    U64 Offset = sizeof(Header);
+    for (auto& Entry : m_Entries)
+    {
+        BlobCacheEntryHeader EntryHeader = { };
+        EntryHeader.Key = Entry.first;
+        EntryHeader.SizeInBytes = Entry.second.size();
+        EntryHeader.ContentHash = HashBytes(Entry.second.data(), Entry.second.size());
+        memcpy(Bytes.data() + Offset, &EntryHeader, sizeof(EntryHeader));
+        Offset += sizeof(EntryHeader);
+        if (!Entry.second.empty())
+        {
+            memcpy(Bytes.data() + Offset, Entry.second.data(), Entry.second.size());
+        }
+        Offset += Entry.second.size();
+    }
+
+    ResultCode Result = WriteFileBytes(Path, Bytes.data(), Bytes.size());
+    if (Result == SResult_OK)
+    {
+        m_Dirty = false;
+    }
+    return Result;
+}
+
+
+const std::vector<U8>* BlobCache::Find(U64 Key) const
+{
+    auto Iter = m_Entries.find(Key);
+    if (Iter == m_Entries.end())
+    {
+        return nullptr;
+    }
+    return &Iter->second;
+}
+
+
+void BlobCache::Store(U64 Key, const void* PData, U64 SizeInBytes)
+{
+    const U8* PBytes = static_cast<const U8*>(PData);
+    m_Entries[Key].assign(PBytes, PBytes + SizeInBytes);
+    m_Dirty = true;
+}
+
+
+void BlobCache::Remove(U64 Key)
+{
+    if (m_Entries.erase(Key))
+    {
+        m_Dirty = true;
+    }
+}
+
+
+void BlobCache::Clear()
+{
+    m_Entries.clear();
+    m_Dirty = false;
+}
+} // Synthe
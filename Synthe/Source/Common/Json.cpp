@@ -0,0 +1,269 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "Common/Json.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace Synthe {
+
+
+//! Recursive descent parser, deep enough for configuration files.
+class JsonParser
+{
+public:
+    static const U32 k_MaxDepth = 64;
+
+    JsonParser(const char* PText, U64 Length)
+        : m_PCursor(PText)
+        , m_PEnd(PText + Length) { }
+
+    B32 ParseDocument(JsonValue& Out)
+    {
+        SkipWhiteSpace();
+        if (m_PCursor == m_PEnd)
+        {
+            Out = JsonValue();
+            return true;
+        }
+        if (!ParseValue(Out, 0))
+        {
+            return false;
+        }
+        SkipWhiteSpace();
+        return m_PCursor == m_PEnd;
+    }
+
+private:
+    void SkipWhiteSpace()
+    {
+        while (m_PCursor != m_PEnd && (*m_PCursor == ' ' || *m_PCursor == '\t' || *m_PCursor == '\n' || *m_PCursor == '\r'))
+        {
+            ++m_PCursor;
+        }
+    }
+
+    B32 Consume(char Expected)
+    {
+        SkipWhiteSpace();
+        if (m_PCursor != m_PEnd && *m_PCursor == Expected)
+        {
+            ++m_PCursor;
+            return true;
+        }
+        return false;
+    }
+
+    B32 ConsumeLiteral(const char* Literal)
+    {
+        size_t Length = strlen(Literal);
+        if (static_cast<size_t>(m_PEnd - m_PCursor) < Length || strncmp(m_PCursor, Literal, Length) != 0)
+        {
+            return false;
+        }
+        m_PCursor += Length;
+        return true;
+    }
+
+    static void AppendUtf8(std::string& Out, U32 CodePoint)
+    {
+        if (CodePoint < 0x80)
+        {
+            Out.push_back(static_cast<char>(CodePoint));
+        }
+        else if (CodePoint < 0x800)
+        {
+            Out.push_back(static_cast<char>(0xC0 | (CodePoint >> 6)));
+            Out.push_back(static_cast<char>(0x80 | (CodePoint & 0x3F)));
+        }
+        else
+        {
+            Out.push_back(static_cast<char>(0xE0 | (CodePoint >> 12)));
+            Out.push_back(static_cast<char>(0x80 | ((CodePoint >> 6) & 0x3F)));
+            Out.push_back(static_cast<char>(0x80 | (CodePoint & 0x3F)));
+        }
+    }
+
+    B32 ParseString(std::string& Out)
+    {
+        if (!Consume('"'))
+        {
+            return false;
+        }
+        Out.clear();
+        while (m_PCursor != m_PEnd)
+        {
+            char Char = *m_PCursor++;
+            if (Char == '"')
+            {
+                return true;
+            }
+            if (Char != '\\')
+            {
+                Out.push_back(Char);
+                continue;
+            }
+            if (m_PCursor == m_PEnd)
+            {
+                return false;
+            }
+            char Escape = *m_PCursor++;
+            switch (Escape)
+            {
+                case '"':   Out.push_back('"');     break;
+                case '\\':  Out.push_back('\\');    break;
+                case '/':   Out.push_back('/');     break;
+                case 'b':   Out.push_back('\b');    break;
+                case 'f':   Out.push_back('\f');    break;
+                case 'n':   Out.push_back('\n');    break;
+                case 'r':   Out.push_back('\r');    break;
+                case 't':   Out.push_back('\t');    break;
+                case 'u':
+                {
+                    if (m_PEnd - m_PCursor < 4)
+                    {
+                        return false;
+                    }
+                    char Digits[5] = { m_PCursor[0], m_PCursor[1], m_PCursor[2], m_PCursor[3], '\0' };
+                    char* PDigitsEnd = nullptr;
+                    U32 CodePoint = static_cast<U32>(strtoul(Digits, &PDigitsEnd, 16));
+                    if (PDigitsEnd != Digits + 4)
+                    {
+                        return false;
+                    }
+                    m_PCursor += 4;
+                    AppendUtf8(Out, CodePoint);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    B32 ParseValue(JsonValue& Out, U32 Depth)
+    {
+        SkipWhiteSpace();
+        if (m_PCursor == m_PEnd || Depth > k_MaxDepth)
+        {
+            return false;
+        }
+
+        switch (*m_PCursor)
+        {
+            case '{':
+            {
+                ++m_PCursor;
+                Out.m_Type = JsonType_OBJECT;
+                if (Consume('}'))
+                {
+                    return true;
+                }
+                do
+                {
+                    std::pair<std::string, JsonValue> Member;
+                    if (!ParseString(Member.first) || !Consume(':') || !ParseValue(Member.second, Depth + 1))
+                    {
+                        return false;
+                    }
+                    Out.m_Members.push_back(std::move(Member));
+                } while (Consume(','));
+                return Consume('}');
+            }
+            case '[':
+            {
+                ++m_PCursor;
+                Out.m_Type = JsonType_ARRAY;
+                if (Consume(']'))
+                {
+                    return true;
+                }
+                do
+                {
+                    Out.m_Array.emplace_back();
+                    if (!ParseValue(Out.m_Array.back(), Depth + 1))
+                    {
+                        return false;
+                    }
+                } while (Consume(','));
+                return Consume(']');
+            }
+            case '"':
+            {
+                Out.m_Type = JsonType_STRING;
+                return ParseString(Out.m_String);
+            }
+            case 't':
+            {
+                Out.m_Type = JsonType_BOOL;
+                Out.m_Number = 1.0;
+                return ConsumeLiteral("true");
+            }
+            case 'f':
+            {
+                Out.m_Type = JsonType_BOOL;
+                Out.m_Number = 0.0;
+                return ConsumeLiteral("false");
+            }
+            case 'n':
+            {
+                Out.m_Type = JsonType_NULL;
+                return ConsumeLiteral("null");
+            }
+            default:
+            {
+                // strtod needs a terminated string, numbers are short.
+                char Number[64] = { };
+                size_t Length = 0;
+                while (m_PCursor + Length != m_PEnd && Length < sizeof(Number) - 1
+                       && m_PCursor[Length] != '\0' && strchr("+-0123456789.eE", m_PCursor[Length]))
+                {
+                    Number[Length] = m_PCursor[Length];
+                    ++Length;
+                }
+                char* PNumberEnd = nullptr;
+                Out.m_Type = JsonType_NUMBER;
+                Out.m_Number = strtod(Number, &PNumberEnd);
+                if (Length == 0 || PNumberEnd != Number + Length)
+                {
+                    return false;
+                }
+                m_PCursor += Length;
+                return true;
+            }
+        }
+    }
+
+    const char* m_PCursor;
+    const char* m_PEnd;
+};
+
+
+const JsonValue* JsonValue::Find(const char* Key) const
+{
+    for (const auto& Member : m_Members)
+    {
+        if (Member.first == Key)
+        {
+            return &Member.second;
+        }
+    }
+    return nullptr;
+}
+
+
+ResultCode ParseJson(const char* PText, U64 Length, JsonValue& OutValue)
+{
+    OutValue = JsonValue();
+    JsonParser Parser(PText, Length);
+    if (!Parser.ParseDocument(OutValue))
+    {
+        OutValue = JsonValue();
+        return SResult_INVALID_ARGS;
+    }
+    return SResult_OK;
+}
+} // Synthe
@@ -0,0 +1,106 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "Common/MappedFile.hpp"
+
+#ifdef _WIN32
+ #define WIN32_LEAN_AND_MEAN
+ #include <Windows.h>
+#else
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+#endif
+
+namespace Synthe {
+
+
+#ifdef _WIN32
+ResultCode MappedFile::Open(const std::string& Path)
+{
+    Close();
+    HANDLE File = CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (File == INVALID_HANDLE_VALUE)
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+
+    LARGE_INTEGER Size = { };
+    HANDLE Mapping = nullptr;
+    const void* PView = nullptr;
+    if (GetFileSizeEx(File, &Size) && Size.QuadPart > 0)
+    {
+        Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    if (Mapping)
+    {
+        PView = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+    if (!PView)
+    {
+        if (Mapping) CloseHandle(Mapping);
+        CloseHandle(File);
+        return SResult_FAILED;
+    }
+
+    m_PData = static_cast<const U8*>(PView);
+    m_SizeInBytes = static_cast<U64>(Size.QuadPart);
+    m_FileHandle = File;
+    m_MappingHandle = Mapping;
+    return SResult_OK;
+}
+
+
+void MappedFile::Close()
+{
+    if (m_PData)            UnmapViewOfFile(m_PData);
+    if (m_MappingHandle)    CloseHandle(m_MappingHandle);
+    if (m_FileHandle)       CloseHandle(m_FileHandle);
+    m_PData = nullptr;
+    m_SizeInBytes = 0;
+    m_FileHandle = nullptr;
+    m_MappingHandle = nullptr;
+}
+#else
+ResultCode MappedFile::Open(const std::string& Path)
+{
+    Close();
+    int File = open(Path.c_str(), O_RDONLY);
+    if (File < 0)
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+
+    struct stat Stat = { };
+    void* PView = MAP_FAILED;
+    if (fstat(File, &Stat) == 0 && Stat.st_size > 0)
+    {
+        PView = mmap(nullptr, static_cast<size_t>(Stat.st_size), PROT_READ, MAP_SHARED, File, 0);
+    }
+    // The mapping keeps its own reference to the file.
+    close(File);
+    if (PView == MAP_FAILED)
+    {
+        return SResult_FAILED;
+    }
+
+    m_PData = static_cast<const U8*>(PView);
+    m_SizeInBytes = static_cast<U64>(Stat.st_size);
+    return SResult_OK;
+}
+
+
+void MappedFile::Close()
+{
+    if (m_PData)
+    {
+        munmap(const_cast<U8*>(m_PData), static_cast<size_t>(m_SizeInBytes));
+    }
+    m_PData = nullptr;
+    m_SizeInBytes = 0;
+}
+#endif
+} // Synthe
@@ -0,0 +1,91 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "Common/WorkerPool.hpp"
+
+namespace Synthe {
+
+
+U32 WorkerPool::GetDefaultNumThreads()
+{
+    U32 NumHardwareThreads = std::thread::hardware_concurrency();
+    return NumHardwareThreads > 1 ? NumHardwareThreads - 1 : 1;
+}
+
+
+void WorkerPool::Initialize(U32 NumThreads)
+{
+    Shutdown();
+    m_Stop = false;
+    NumThreads = NumThreads ? NumThreads : 1;
+    for (U32 I = 0; I < NumThreads; ++I)
+    {
+        m_Threads.emplace_back(&WorkerPool::WorkerMain, this);
+    }
+}
+
+
+void WorkerPool::Submit(std::function<void()> Job, I32 Priority)
+{
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+        m_Jobs.push({ std::move(Job), Priority, m_NextSequence++ });
+    }
+    m_JobAvailable.notify_one();
+}
+
+
+void WorkerPool::WaitIdle()
+{
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+    m_Idle.wait(Lock, [this] () -> bool { return m_Jobs.empty() && m_NumActive == 0; });
+}
+
+
+void WorkerPool::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_JobAvailable.notify_all();
+    for (std::thread& Thread : m_Threads)
+    {
+        Thread.join();
+    }
+    m_Threads.clear();
+}
+
+
+void WorkerPool::WorkerMain()
+{
+    for (;;)
+    {
+        Job Next;
+        {
+            std::unique_lock<std::mutex> Lock(m_Mutex);
+            m_JobAvailable.wait(Lock, [this] () -> bool { return m_Stop || !m_Jobs.empty(); });
+            if (m_Jobs.empty())
+            {
+                // Stopping, and nothing left to run.
+                return;
+            }
+            Next = m_Jobs.top();
+            m_Jobs.pop();
+            m_NumActive += 1;
+        }
+
+        Next.Function();
+
+        {
+            std::lock_guard<std::mutex> Lock(m_Mutex);
+            m_NumActive -= 1;
+            if (m_Jobs.empty() && m_NumActive == 0)
+            {
+                m_Idle.notify_all();
+            }
+        }
+    }
+}
+} // Synthe
@@ -0,0 +1,172 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "D3D12BarrierBatcher.hpp"
+
+namespace Synthe {
+
+
+static const U32 k_NotFound = ~0U;
+
+
+U32 D3D12BarrierBatcher::FindPending(ID3D12Resource* PResource, U32 Subresource, B32* OutOverlaps) const
+{
+    U32 Found = k_NotFound;
+    *OutOverlaps = false;
+    for (U32 I = 0; I < m_Pending.size(); ++I)
+    {
+        const D3D12_RESOURCE_TRANSITION_BARRIER& Pending = m_Pending[I].Transition;
+        if (Pending.pResource != PResource)
+        {
+            continue;
+        }
+        if (Pending.Subresource == Subresource)
+        {
+            Found = I;
+        }
+        else if (Pending.Subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES
+                 || Subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES)
+        {
+            *OutOverlaps = true;
+        }
+    }
+    return Found;
+}
+
+
+U32 D3D12BarrierBatcher::FindOpenSplit(ID3D12Resource* PResource, U32 Subresource) const
+{
+    for (U32 I = 0; I < m_OpenSplits.size(); ++I)
+    {
+        if (m_OpenSplits[I].Transition.pResource == PResource && m_OpenSplits[I].Transition.Subresource == Subresource)
+        {
+            return I;
+        }
+    }
+    return k_NotFound;
+}
+
+
+void D3D12BarrierBatcher::Queue(ID3D12Resource* PResource,
+                                U32 Subresource,
+                                D3D12_RESOURCE_STATES Before,
+                                D3D12_RESOURCE_STATES After,
+                                D3D12_RESOURCE_BARRIER_FLAGS Flags)
+{
+    D3D12_RESOURCE_BARRIER Barrier = { };
+    Barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    Barrier.Flags = Flags;
+    Barrier.Transition.pResource = PResource;
+    Barrier.Transition.Subresource = Subresource;
+    Barrier.Transition.StateBefore = Before;
+    Barrier.Transition.StateAfter = After;
+    m_Pending.push_back(Barrier);
+}
+
+
+void D3D12BarrierBatcher::Transition(ID3D12GraphicsCommandList* PList,
+                                     ID3D12Resource* PResource,
+                                     U32 Subresource,
+                                     D3D12_RESOURCE_STATES Before,
+                                     D3D12_RESOURCE_STATES After,
+                                     B32 Split)
+{
+    m_Statistics.NumRequested += 1;
+    B32 Overlaps = false;
+
+    // A subresource in the middle of a split transition must finish it first. If the begin half was
+    // never flushed, the two halves simply become one whole transition.
+    U32 OpenSplit = FindOpenSplit(PResource, Subresource);
+    if (OpenSplit != k_NotFound)
+    {
+        D3D12_RESOURCE_BARRIER Open = m_OpenSplits[OpenSplit];
+        m_OpenSplits.erase(m_OpenSplits.begin() + OpenSplit);
+        U32 Pending = FindPending(PResource, Subresource, &Overlaps);
+        if (Pending != k_NotFound && m_Pending[Pending].Flags == D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY)
+        {
+            m_Pending[Pending].Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+        }
+        else
+        {
+            Queue(PResource, Subresource, Open.Transition.StateBefore, Open.Transition.StateAfter,
+                  D3D12_RESOURCE_BARRIER_FLAG_END_ONLY);
+        }
+    }
+
+    if (Before == After)
+    {
+        m_Statistics.NumDropped += (OpenSplit == k_NotFound) ? 1 : 0;
+        return;
+    }
+
+    U32 Pending = FindPending(PResource, Subresource, &Overlaps);
+    if (Overlaps)
+    {
+        // Whole resource and single subresource barriers of one resource do not merge, keep their
+        // order by issuing what came first.
+        Flush(PList);
+        Pending = k_NotFound;
+    }
+
+    if (Pending != k_NotFound && !Split && m_Pending[Pending].Flags == D3D12_RESOURCE_BARRIER_FLAG_NONE)
+    {
+        m_Statistics.NumMerged += 1;
+        m_Pending[Pending].Transition.StateAfter = After;
+        if (m_Pending[Pending].Transition.StateBefore == After)
+        {
+            m_Statistics.NumDropped += 1;
+            m_Pending.erase(m_Pending.begin() + Pending);
+        }
+        return;
+    }
+
+    Queue(PResource, Subresource, Before, After,
+          Split ? D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY : D3D12_RESOURCE_BARRIER_FLAG_NONE);
+    if (Split)
+    {
+        m_OpenSplits.push_back(m_Pending.back());
+    }
+}
+
+
+void D3D12BarrierBatcher::EndSplitTransitions()
+{
+    for (const D3D12_RESOURCE_BARRIER& Open : m_OpenSplits)
+    {
+        B32 Overlaps = false;
+        U32 Pending = FindPending(Open.Transition.pResource, Open.Transition.Subresource, &Overlaps);
+        if (Pending != k_NotFound && m_Pending[Pending].Flags == D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY)
+        {
+            m_Pending[Pending].Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+            continue;
+        }
+        Queue(Open.Transition.pResource, Open.Transition.Subresource, Open.Transition.StateBefore,
+              Open.Transition.StateAfter, D3D12_RESOURCE_BARRIER_FLAG_END_ONLY);
+    }
+    m_OpenSplits.clear();
+}
+
+
+void D3D12BarrierBatcher::Flush(ID3D12GraphicsCommandList* PList)
+{
+    if (m_Pending.empty())
+    {
+        return;
+    }
+    if (PList)
+    {
+        PList->ResourceBarrier(static_cast<UINT>(m_Pending.size()), m_Pending.data());
+        m_Statistics.NumEmitted += m_Pending.size();
+        m_Statistics.NumBatches += 1;
+    }
+    m_Pending.clear();
+}
+
+
+void D3D12BarrierBatcher::Clear()
+{
+    m_Pending.clear();
+    m_OpenSplits.clear();
+}
+} // Synthe
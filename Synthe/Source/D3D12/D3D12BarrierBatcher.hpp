@@ -0,0 +1,114 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Win32Common.hpp"
+#include "Common/Types.hpp"
+
+#include <vector>
+
+
+namespace Synthe {
+
+
+//! Counters of a barrier batcher, accumulated until ResetStatistics().
+struct BarrierBatchStatistics
+{
+    //! Transitions asked for, each would have been its own barrier before batching.
+    U64 NumRequested;
+
+    //! Transitions folded into a pending transition of the same subresource.
+    U64 NumMerged;
+
+    //! Transitions dropped, because the subresource was already in the state, or a merge brought it
+    //! back to where it started.
+    U64 NumDropped;
+
+    //! Barriers handed to the list.
+    U64 NumEmitted;
+
+    //! ResourceBarrier() calls made.
+    U64 NumBatches;
+};
+
+
+//! Gathers the transition barriers of a command list, and issues them all at once on Flush(), which
+//! the list calls right before the next draw, dispatch, clear, or copy. Transitions are tracked per
+//! subresource: a second transition of a pending subresource is merged into the first, A to B then
+//! B to C becoming A to C, and is dropped if that leaves A to A.
+//!
+//! Transitions may be split. A split transition queues its begin half, and its end half is queued by
+//! the next transition of the same subresource, or by EndSplitTransitions(). The driver may then
+//! overlap the transition with the work recorded in between.
+//!
+//! The batcher only works on the states it is given, the caller tracks resource states. It may be
+//! used by one thread at a time.
+class D3D12BarrierBatcher
+{
+public:
+    D3D12BarrierBatcher()
+        : m_Statistics() { }
+
+    //! Queue a transition.
+    //!
+    //! \param PList The list barriers go to, pending barriers are flushed to it first when the new
+    //!              transition overlaps one of them without matching it.
+    //! \param PResource The native resource.
+    //! \param Subresource The subresource index, or D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES.
+    //! \param Before The state the subresource is in.
+    //! \param After The state needed.
+    //! \param Split Queue only the begin half of the transition.
+    void Transition(ID3D12GraphicsCommandList* PList,
+                    ID3D12Resource* PResource,
+                    U32 Subresource,
+                    D3D12_RESOURCE_STATES Before,
+                    D3D12_RESOURCE_STATES After,
+                    B32 Split = false);
+
+    //! Queue the end half of every split transition still open.
+    void EndSplitTransitions();
+
+    //! Issue every pending barrier in one ResourceBarrier() call.
+    //!
+    //! \param PList The list to record the barriers into. nullptr only drops them.
+    void Flush(ID3D12GraphicsCommandList* PList);
+
+    //! Drop pending barriers and open split transitions, as when the list is reset.
+    void Clear();
+
+    //! Barriers waiting for Flush().
+    U32 GetNumPendingBarriers() const { return static_cast<U32>(m_Pending.size()); }
+
+    //! Pending barriers, valid until the next call on the batcher.
+    const D3D12_RESOURCE_BARRIER* GetPendingBarriers() const { return m_Pending.data(); }
+
+    //! Split transitions begun and not yet ended.
+    U32 GetNumOpenSplitTransitions() const { return static_cast<U32>(m_OpenSplits.size()); }
+
+    const BarrierBatchStatistics& GetStatistics() const { return m_Statistics; }
+    void ResetStatistics() { m_Statistics = BarrierBatchStatistics(); }
+
+private:
+    //! Find the pending barrier of a subresource, the index or ~0 if none. Sets OutOverlaps if a
+    //! pending barrier covers the subresource without matching it.
+    U32 FindPending(ID3D12Resource* PResource, U32 Subresource, B32* OutOverlaps) const;
+
+    //! Find the open split transition of a subresource, the index or ~0 if none.
+    U32 FindOpenSplit(ID3D12Resource* PResource, U32 Subresource) const;
+
+    void Queue(ID3D12Resource* PResource,
+               U32 Subresource,
+               D3D12_RESOURCE_STATES Before,
+               D3D12_RESOURCE_STATES After,
+               D3D12_RESOURCE_BARRIER_FLAGS Flags);
+
+    BarrierBatchStatistics              m_Statistics;
+
+    //! Barriers in request order.
+    std::vector<D3D12_RESOURCE_BARRIER> m_Pending;
+
+    //! Split transitions whose begin half was queued, and end half was not.
+    std::vector<D3D12_RESOURCE_BARRIER> m_OpenSplits;
+};
+} // Synthe
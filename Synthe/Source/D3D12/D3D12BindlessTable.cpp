@@ -0,0 +1,106 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "D3D12BindlessTable.hpp"
+
+namespace Synthe {
+
+
+ResultCode D3D12BindlessTable::Initialize(DescriptorKeyID ShaderVisibleKey, U32 NumBuffers, U32 Capacity)
+{
+    Release();
+    if (Capacity == 0)
+    {
+        return SResult_OK;
+    }
+
+    m_ShaderVisibleKey = ShaderVisibleKey;
+    m_Tables.resize(NumBuffers);
+    for (U32 I = 0; I < NumBuffers; ++I)
+    {
+        DescriptorPool* Pool = D3D12DescriptorManager::GetDescriptorPool(ShaderVisibleKey, I);
+        if (!Pool)
+        {
+            return SResult_NOT_INITIALIZED;
+        }
+        m_HeapType = Pool->GetDescriptorHeapType();
+        m_DescriptorSizeInBytes = Pool->GetAlignmentSizeInBytes();
+        ResultCode Result = Pool->AllocateDescriptorTable(&m_Tables[I], Capacity * m_DescriptorSizeInBytes);
+        if (Result != SResult_OK)
+        {
+            return Result;
+        }
+    }
+
+    m_Capacity = Capacity;
+    m_Indices.Initialize(0ULL, static_cast<U64>(Capacity));
+    return SResult_OK;
+}
+
+
+void D3D12BindlessTable::Release()
+{
+    for (U32 I = 0; I < m_Tables.size(); ++I)
+    {
+        if (m_Tables[I].TableSizeInBytes)
+        {
+            D3D12DescriptorManager::GetDescriptorPool(m_ShaderVisibleKey, I)->FreeDescriptorTable(m_Tables[I], 0ULL);
+        }
+    }
+    m_Tables.clear();
+    m_Capacity = 0;
+    m_Indices.Reset();
+}
+
+
+ResultCode D3D12BindlessTable::Register(ID3D12Device* PDevice, D3D12_CPU_DESCRIPTOR_HANDLE Src, U32* OutIndex)
+{
+    if (!IsEnabled())
+    {
+        return SResult_NOT_INITIALIZED;
+    }
+
+    AllocationBlock Block = { };
+    if (m_Indices.Allocate(&Block, 1ULL, 1ULL) != SResult_OK)
+    {
+        return SResult_OUT_OF_MEMORY;
+    }
+
+    U32 Index = static_cast<U32>(Block.StartAddress);
+    for (DescriptorTable& Table : m_Tables)
+    {
+        D3D12_CPU_DESCRIPTOR_HANDLE Dst = Table.StartingAddress;
+        Dst.ptr += static_cast<SIZE_T>(Index * m_DescriptorSizeInBytes);
+        PDevice->CopyDescriptorsSimple(1, Dst, Src, m_HeapType);
+    }
+    *OutIndex = Index;
+    return SResult_OK;
+}
+
+
+void D3D12BindlessTable::Unregister(U32 Index, U64 RetireFrame)
+{
+    if (Index >= m_Capacity)
+    {
+        return;
+    }
+    AllocationBlock Block = { };
+    Block.StartAddress = static_cast<U64>(Index);
+    Block.SizeInBytes = 1ULL;
+    m_Indices.DeferFree(Block, RetireFrame);
+}
+
+
+void D3D12BindlessTable::RetireFrame(U64 CompletedFrame)
+{
+    m_Indices.Retire(CompletedFrame);
+}
+
+
+D3D12_GPU_DESCRIPTOR_HANDLE D3D12BindlessTable::GetGPUAddress(U32 BufferIndex) const
+{
+    DescriptorPool* Pool = D3D12DescriptorManager::GetDescriptorPool(m_ShaderVisibleKey, BufferIndex);
+    return Pool->GetGPUAddressFromCPUAddress(m_Tables[BufferIndex].StartingAddress);
+}
+} // Synthe
@@ -0,0 +1,81 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Common/Memory/RangeAllocator.hpp"
+
+#include "D3D12DescriptorManager.hpp"
+
+#include <vector>
+
+
+namespace Synthe {
+
+
+//! Global table of descriptors at stable indices, for bindless access in shaders. The table is a
+//! region reserved at the start of each buffered frame's shader visible heap, so it is visible through
+//! the same heaps bound for descriptor sets. A descriptor is written to every buffered frame's region
+//! once, when registered. Indices are recycled once the frame they were unregistered in has retired,
+//! so writing a recycled index never races the GPU.
+class D3D12BindlessTable
+{
+public:
+    static const U32 k_InvalidIndex = 0xFFFFFFFF;
+
+    D3D12BindlessTable()
+        : m_ShaderVisibleKey(0)
+        , m_HeapType(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV)
+        , m_DescriptorSizeInBytes(0)
+        , m_Capacity(0) { }
+
+    //! Reserve the table region in each shader visible pool. Called once at device initialization,
+    //! the region stays reserved for the lifetime of the device.
+    //!
+    //! \param ShaderVisibleKey The key of the shader visible pools, one pool per buffered frame.
+    //! \param NumBuffers The number of buffered frames.
+    //! \param Capacity The number of descriptors in the table.
+    //! \return SResult_OK if the regions were reserved.
+    ResultCode Initialize(DescriptorKeyID ShaderVisibleKey, U32 NumBuffers, U32 Capacity);
+
+    //! Give the regions back to their pools.
+    void Release();
+
+    //! Allocate an index, and write the descriptor to it in every buffered frame.
+    //!
+    //! \param PDevice The native device.
+    //! \param Src A descriptor in a host only heap of the same type.
+    //! \param OutIndex The index the shaders use to access the descriptor.
+    //! \return SResult_OK on success. SResult_OUT_OF_MEMORY if the table is full.
+    ResultCode Register(ID3D12Device* PDevice, D3D12_CPU_DESCRIPTOR_HANDLE Src, U32* OutIndex);
+
+    //! Release an index once RetireFrame is retired.
+    //!
+    //! \param Index The index returned by Register().
+    //! \param RetireFrame The frame the index was last usable in.
+    void Unregister(U32 Index, U64 RetireFrame);
+
+    //! Recycle indices released up to the completed frame.
+    void RetireFrame(U64 CompletedFrame);
+
+    //! Get the base of the table to bind for the given buffered frame.
+    D3D12_GPU_DESCRIPTOR_HANDLE GetGPUAddress(U32 BufferIndex) const;
+
+    //! Check if the table was initialized with any capacity.
+    B32 IsEnabled() const { return m_Capacity != 0; }
+
+    U32 GetCapacity() const { return m_Capacity; }
+
+private:
+    DescriptorKeyID                 m_ShaderVisibleKey;
+    D3D12_DESCRIPTOR_HEAP_TYPE      m_HeapType;
+    U64                             m_DescriptorSizeInBytes;
+    U32                             m_Capacity;
+
+    //! Index allocator, one byte per index.
+    RangeAllocator                  m_Indices;
+
+    //! Reserved region of each buffered frame's heap.
+    std::vector<DescriptorTable>    m_Tables;
+};
+} // Synthe
@@ -0,0 +1,153 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "D3D12CommandAllocatorPool.hpp"
+
+namespace Synthe {
+
+
+ResultCode D3D12CommandAllocatorPool::Initialize(ID3D12Device* PDevice, D3D12_COMMAND_LIST_TYPE Type)
+{
+    Release();
+    m_PDevice = PDevice;
+    m_Type = Type;
+    m_FenceValue = 0;
+    HRESULT Result = PDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, __uuidof(ID3D12Fence), (void**)&m_PFence);
+    if (FAILED(Result))
+    {
+        m_PFence = nullptr;
+        return SResult_FAILED;
+    }
+    return SResult_OK;
+}
+
+
+void D3D12CommandAllocatorPool::Release()
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    for (InFlightAllocator& InFlight : m_InFlight)
+    {
+        InFlight.PAllocator->Release();
+    }
+    for (FreeAllocator& Free : m_Free)
+    {
+        Free.PAllocator->Release();
+    }
+    m_InFlight.clear();
+    m_Free.clear();
+    if (m_PFence)
+    {
+        m_PFence->Release();
+        m_PFence = nullptr;
+    }
+    m_Statistics.NumLive = 0;
+    m_Statistics.NumInFlight = 0;
+}
+
+
+void D3D12CommandAllocatorPool::RecycleCompleted(U64 Frame)
+{
+    if (m_InFlight.empty())
+    {
+        return;
+    }
+    U64 CompletedValue = m_PFence->GetCompletedValue();
+    while (!m_InFlight.empty() && m_InFlight.front().FenceValue <= CompletedValue)
+    {
+        ID3D12CommandAllocator* PAllocator = m_InFlight.front().PAllocator;
+        m_InFlight.pop_front();
+        PAllocator->Reset();
+        m_Free.push_back({ PAllocator, Frame });
+    }
+    m_Statistics.NumInFlight = m_InFlight.size();
+}
+
+
+ID3D12CommandAllocator* D3D12CommandAllocatorPool::Acquire(U64 Frame)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    RecycleCompleted(Frame);
+    if (!m_Free.empty())
+    {
+        ID3D12CommandAllocator* PAllocator = m_Free.back().PAllocator;
+        m_Free.pop_back();
+        m_Statistics.NumRecycled += 1;
+        return PAllocator;
+    }
+
+    ID3D12CommandAllocator* PAllocator = nullptr;
+    HRESULT Result = m_PDevice->CreateCommandAllocator(m_Type, __uuidof(ID3D12CommandAllocator), (void**)&PAllocator);
+    if (FAILED(Result))
+    {
+        return nullptr;
+    }
+    m_Statistics.NumCreated += 1;
+    m_Statistics.NumLive += 1;
+    return PAllocator;
+}
+
+
+void D3D12CommandAllocatorPool::Discard(ID3D12CommandAllocator* PAllocator, U64 Frame)
+{
+    PAllocator->Reset();
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    m_Free.push_back({ PAllocator, Frame });
+}
+
+
+U64 D3D12CommandAllocatorPool::Signal(ID3D12CommandQueue* PQueue)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    m_FenceValue += 1;
+    PQueue->Signal(m_PFence, m_FenceValue);
+    return m_FenceValue;
+}
+
+
+U64 D3D12CommandAllocatorPool::GetNextFenceValue() const
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    return m_FenceValue + 1;
+}
+
+
+void D3D12CommandAllocatorPool::Retire(ID3D12CommandAllocator* PAllocator, U64 FenceValue)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    // Submits from different threads may retire out of order, keep the queue sorted.
+    auto Iter = m_InFlight.end();
+    while (Iter != m_InFlight.begin() && (Iter - 1)->FenceValue > FenceValue)
+    {
+        --Iter;
+    }
+    m_InFlight.insert(Iter, { PAllocator, FenceValue });
+    m_Statistics.NumInFlight = m_InFlight.size();
+}
+
+
+void D3D12CommandAllocatorPool::Trim(U64 Frame)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    RecycleCompleted(Frame);
+    size_t NumIdle = 0;
+    while (NumIdle < m_Free.size() && m_Free[NumIdle].FreedFrame + k_TrimAfterIdleFrames < Frame)
+    {
+        m_Free[NumIdle].PAllocator->Release();
+        NumIdle += 1;
+    }
+    if (NumIdle)
+    {
+        m_Free.erase(m_Free.begin(), m_Free.begin() + NumIdle);
+        m_Statistics.NumTrimmed += NumIdle;
+        m_Statistics.NumLive -= NumIdle;
+    }
+}
+
+
+CommandAllocatorPoolStatistics D3D12CommandAllocatorPool::GetStatistics() const
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    return m_Statistics;
+}
+} // Synthe
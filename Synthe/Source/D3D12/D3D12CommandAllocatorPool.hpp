@@ -0,0 +1,121 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Common/Types.hpp"
+#include "Win32Common.hpp"
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+
+namespace Synthe {
+
+
+//! Counters of a command allocator pool, since startup.
+struct CommandAllocatorPoolStatistics
+{
+    //! Allocators created.
+    U64 NumCreated;
+    //! Acquires served by an allocator the GPU was done with.
+    U64 NumRecycled;
+    //! Allocators released after sitting idle.
+    U64 NumTrimmed;
+    //! Allocators currently alive, held by lists, in flight, or free.
+    U64 NumLive;
+    //! Allocators waiting on the GPU.
+    U64 NumInFlight;
+};
+
+
+//! Pool of command allocators for one command list type. Lists take an allocator when they begin 
+//! recording, and give it back once submitted, tagged with a value the pool signals on the queue. 
+//! The allocator is only reset and handed out again after the GPU passes that value, so the number of
+//! allocators follows the work in flight rather than the number of lists. Allocators that sit unused
+//! for k_TrimAfterIdleFrames are released, which gives their memory back when the workload shrinks.
+//! The pool may be used from any thread.
+class D3D12CommandAllocatorPool
+{
+public:
+    static const U64 k_TrimAfterIdleFrames = 120;
+
+    D3D12CommandAllocatorPool()
+        : m_PDevice(nullptr)
+        , m_Type(D3D12_COMMAND_LIST_TYPE_DIRECT)
+        , m_PFence(nullptr)
+        , m_FenceValue(0)
+        , m_Statistics() { }
+
+    //! \param PDevice The native device.
+    //! \param Type The command list type of the allocators.
+    //! \return SResult_OK on success.
+    ResultCode Initialize(ID3D12Device* PDevice, D3D12_COMMAND_LIST_TYPE Type);
+
+    //! Release every allocator the pool holds. The GPU must be idle, and lists should have given back
+    //! their allocators.
+    void Release();
+
+    //! Get a reset allocator, recycled if the GPU is done with one, created otherwise.
+    //!
+    //! \param Frame The current frame.
+    //! \return The allocator, nullptr if it could not be created.
+    ID3D12CommandAllocator* Acquire(U64 Frame);
+
+    //! Give back an allocator that was never submitted.
+    void Discard(ID3D12CommandAllocator* PAllocator, U64 Frame);
+
+    //! Signal the pool fence on a queue, after submitting lists of this pool to it.
+    //!
+    //! \return The fence value the submitted allocators are retired with.
+    U64 Signal(ID3D12CommandQueue* PQueue);
+
+    //! The value the next Signal() will use. Bundles are never submitted on their own, and retire 
+    //! with this value instead, signaled once the frame that may execute them is submitted.
+    U64 GetNextFenceValue() const;
+
+    //! Give back the allocator of a submitted list.
+    //!
+    //! \param PAllocator The allocator.
+    //! \param FenceValue The value returned by Signal() after the submit.
+    void Retire(ID3D12CommandAllocator* PAllocator, U64 FenceValue);
+
+    //! Recycle allocators the GPU is done with, and release the ones that have been idle too long.
+    void Trim(U64 Frame);
+
+    D3D12_COMMAND_LIST_TYPE GetType() const { return m_Type; }
+    CommandAllocatorPoolStatistics GetStatistics() const;
+
+private:
+    struct InFlightAllocator
+    {
+        ID3D12CommandAllocator* PAllocator;
+        U64 FenceValue;
+    };
+
+    struct FreeAllocator
+    {
+        ID3D12CommandAllocator* PAllocator;
+        U64 FreedFrame;
+    };
+
+    //! Move allocators the GPU has passed to the free list. The mutex must be held.
+    void RecycleCompleted(U64 Frame);
+
+    ID3D12Device*                   m_PDevice;
+    D3D12_COMMAND_LIST_TYPE         m_Type;
+    ID3D12Fence*                    m_PFence;
+    U64                             m_FenceValue;
+
+    //! In fence order.
+    std::deque<InFlightAllocator>   m_InFlight;
+
+    //! In the order they were freed. Acquires take from the back, so allocators still warm are reused,
+    //! and idle ones collect at the front where they are trimmed.
+    std::vector<FreeAllocator>      m_Free;
+
+    CommandAllocatorPoolStatistics  m_Statistics;
+    mutable std::mutex              m_Mutex;
+};
+} // Synthe
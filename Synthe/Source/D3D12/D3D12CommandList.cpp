@@ -3,10 +3,15 @@
 // Author: Mario Garcia
 
 #include "D3D12CommandList.hpp"
+#include "D3D12CommandAllocatorPool.hpp"
 #include "D3D12GraphicsDevice.hpp"
 #include "D3D12DescriptorManager.hpp"
 #include "D3D12MemoryManager.hpp"
 #include "D3D12Resource.hpp"
+#include "D3D12GraphicsPipelineState.hpp"
+#include "D3D12ViewCache.hpp"
+
+#include <string.h>
 
 
 namespace Synthe {
@@ -14,25 +19,43 @@ namespace Synthe {
 
 ResultCode D3D12GraphicsCommandList::Initialize(ID3D12Device* PDevice, 
                                                 U32 NumCommandListBuffers,
-                                                ID3D12CommandAllocator** CommandAllocators,
-                                                D3D12_COMMAND_LIST_TYPE Type)
+                                                D3D12CommandAllocatorPool* PAllocatorPool)
 {
-    m_DeviceRef = PDevice;
     Release();
+    m_DeviceRef = PDevice;
+    m_PAllocatorPool = PAllocatorPool;
+    m_Type = PAllocatorPool->GetType();
 
-    m_CommandLists.resize(NumCommandListBuffers);
+    U64 Frame = static_cast<D3D12GraphicsDevice*>(GetDeviceD3D12())->GetCurrentFrame();
+    m_CommandLists.resize(NumCommandListBuffers, { nullptr, nullptr, CommandState_READY });
     for (U32 Idx = 0; Idx < m_CommandLists.size(); ++Idx)
     {
-        HRESULT Result = PDevice->CreateCommandList(0, Type, CommandAllocators[Idx], nullptr, 
-                            __uuidof(ID3D12GraphicsCommandList5), (void**)&m_CommandLists[Idx].PCmdList);
+        CommandListState& State = m_CommandLists[Idx];
+        // Lists are created open, on an allocator that goes straight back to the pool since nothing
+        // is recorded.
+        ID3D12CommandAllocator* PAllocator = m_PAllocatorPool->Acquire(Frame);
+        if (!PAllocator)
+        {
+            Release();
+            return SResult_FAILED;
+        }
+        HRESULT Result = PDevice->CreateCommandList(0, m_Type, PAllocator, nullptr, 
+                            __uuidof(ID3D12GraphicsCommandList5), (void**)&State.PCmdList);
         if (FAILED(Result))
         {
+            State.PCmdList = nullptr;
+            m_PAllocatorPool->Discard(PAllocator, Frame);
+            Release();
             return SResult_FAILED;
         }
-        m_CommandLists[Idx].PCmdList->Close();
-        m_CommandLists[Idx].State = CommandState_READY;
-        m_CommandLists[Idx].PAllocatorRef = CommandAllocators[Idx];
+        State.PCmdList->Close();
+        m_PAllocatorPool->Discard(PAllocator, Frame);
     }
+
+    D3D12_FEATURE_DATA_D3D12_OPTIONS5 FeatureOptions = { };
+    m_UseNativeRenderPasses = SUCCEEDED(PDevice->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS5, &FeatureOptions, 
+                                                                     sizeof(FeatureOptions)))
+                            && FeatureOptions.RenderPassesTier >= D3D12_RENDER_PASS_TIER_1;
     return SResult_OK;
 }
 
@@ -41,14 +64,28 @@ void D3D12GraphicsCommandList::Release()
 {
     for (CommandListState& State : m_CommandLists)
     {
-        State.PCmdList->Release();       
+        if (State.PCmdList)     State.PCmdList->Release();
+        if (State.PAllocator)   m_PAllocatorPool->Discard(State.PAllocator, 0);
     }
     m_CommandLists.clear();
 }
 
 
+void D3D12GraphicsCommandList::OnSubmitted(U64 FenceValue)
+{
+    CommandListState& Current = m_CommandLists[m_CurrentRecordingIdx];
+    if (Current.PAllocator)
+    {
+        m_PAllocatorPool->Retire(Current.PAllocator, FenceValue);
+        Current.PAllocator = nullptr;
+    }
+}
+
+
 void D3D12GraphicsCommandList::End()
 {
+    m_Barriers.EndSplitTransitions();
+    FlushBarriers();
     m_CommandLists[m_CurrentRecordingIdx].PCmdList->Close();
     m_CommandLists[m_CurrentRecordingIdx].State = CommandState_READY;
 }
@@ -56,32 +93,82 @@ void D3D12GraphicsCommandList::End()
 
 void D3D12GraphicsCommandList::Begin()
 {
-    m_CommandLists[m_CurrentRecordingIdx].PCmdList->Reset(
-        m_CommandLists[m_CurrentRecordingIdx].PAllocatorRef, nullptr);
-    m_CommandLists[m_CurrentRecordingIdx].State = CommandState_STILL_RECORDING;
+    CommandListState& Current = m_CommandLists[m_CurrentRecordingIdx];
+    // A list still holding its allocator was never submitted, so the GPU never saw the recording and
+    // the allocator can be reset in place. Bundles are the exception, lists executing the last 
+    // recording may still be in flight, so its allocator waits for the end of this frame instead.
+    if (Current.PAllocator && m_Type == D3D12_COMMAND_LIST_TYPE_BUNDLE)
+    {
+        m_PAllocatorPool->Retire(Current.PAllocator, m_PAllocatorPool->GetNextFenceValue());
+        Current.PAllocator = nullptr;
+    }
+    if (Current.PAllocator)
+    {
+        Current.PAllocator->Reset();
+    }
+    else
+    {
+        U64 Frame = static_cast<D3D12GraphicsDevice*>(GetDeviceD3D12())->GetCurrentFrame();
+        Current.PAllocator = m_PAllocatorPool->Acquire(Frame);
+    }
+    Current.PCmdList->Reset(Current.PAllocator, nullptr);
+    Current.State = CommandState_STILL_RECORDING;
+    m_PBoundRootSignature = nullptr;
+    m_NotReadyPolicy = PipelineNotReadyPolicy_WAIT;
+    m_SkipWork = false;
+    m_Statistics = CommandListStatistics();
+    m_Barriers.Clear();
+    m_Barriers.ResetStatistics();
+    m_LocalStates.Clear();
+    m_RenderPass.Active = false;
+    ResetBoundState();
+
+    if (m_Type != D3D12_COMMAND_LIST_TYPE_COPY)
+    {
+        // Shader visible heaps of this buffered frame, descriptor set tables live in these.
+        ID3D12DescriptorHeap* Heaps[] = 
+        {
+            D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_CBV_SRV_UAV, m_CurrentRecordingIdx)->GetNativeHeap(),
+            D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_SAMPLER, m_CurrentRecordingIdx)->GetNativeHeap()
+        };
+        m_CommandLists[m_CurrentRecordingIdx].PCmdList->SetDescriptorHeaps(2, Heaps);
+    }
 }
 
 
 void D3D12GraphicsCommandList::SetRenderTargets(U32 NumRTVs, GPUHandle* RTVHandles, GPUHandle* DepthStencil)
 {
-    static D3D12_CPU_DESCRIPTOR_HANDLE RTVBuffers[D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT];
+    D3D12_CPU_DESCRIPTOR_HANDLE RTVBuffers[D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT];
     D3D12_CPU_DESCRIPTOR_HANDLE DSVBuffer = { 0 };
+    B32 Redundant = (NumRTVs == m_Bound.NumRTVs) && ((DepthStencil != nullptr) == m_Bound.HasDSV);
     for (U32 I = 0; I < NumRTVs; ++I)
     {
         RTVBuffers[I].ptr = RTVHandles[I];
+        Redundant = Redundant && (RTVBuffers[I].ptr == m_Bound.RTVs[I].ptr);
     }
     if (DepthStencil)
     {
         DSVBuffer.ptr = *DepthStencil;
+        Redundant = Redundant && (DSVBuffer.ptr == m_Bound.DSV.ptr);
+    }
+    if (Redundant)
+    {
+        m_Statistics.NumRenderTargetsSkipped += 1;
+        return;
     }
     m_CommandLists[m_CurrentRecordingIdx].PCmdList->OMSetRenderTargets(
         NumRTVs, RTVBuffers, FALSE, DepthStencil ? &DSVBuffer : nullptr);
+    m_Bound.NumRTVs = NumRTVs;
+    memcpy(m_Bound.RTVs, RTVBuffers, sizeof(D3D12_CPU_DESCRIPTOR_HANDLE) * NumRTVs);
+    m_Bound.HasDSV = (DepthStencil != nullptr);
+    m_Bound.DSV = DSVBuffer;
+    m_Statistics.NumRenderTargetsIssued += 1;
 }
 
 
 void D3D12GraphicsCommandList::SetViewports(U32 NumViewports, const Viewport* PViewports)
 {
-    D3D12_VIEWPORT Viewports[8];
+    D3D12_VIEWPORT Viewports[D3D12_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
     for (U32 I = 0; I < NumViewports; ++I)
     {
         Viewports[I].Height = PViewports[I].Height;
@@ -91,13 +178,22 @@ void D3D12GraphicsCommandList::SetViewports(U32 NumViewports, const Viewport* PV
         Viewports[I].MinDepth = PViewports[I].MinDepth;
         Viewports[I].MaxDepth = PViewports[I].MaxDepth;
     }
+    if (NumViewports == m_Bound.NumViewports 
+        && memcmp(Viewports, m_Bound.Viewports, sizeof(D3D12_VIEWPORT) * NumViewports) == 0)
+    {
+        m_Statistics.NumViewportsSkipped += 1;
+        return;
+    }
     m_CommandLists[m_CurrentRecordingIdx].PCmdList->RSSetViewports(NumViewports, Viewports);
+    m_Bound.NumViewports = NumViewports;
+    memcpy(m_Bound.Viewports, Viewports, sizeof(D3D12_VIEWPORT) * NumViewports);
+    m_Statistics.NumViewportsIssued += 1;
 }
 
 
 void D3D12GraphicsCommandList::SetScissors(U32 NumScissors, const Scissor* PScissors)
 {
-    D3D12_RECT Scissors[8];
+    D3D12_RECT Scissors[D3D12_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
     for (U32 I = 0; I < NumScissors; ++I)
     {
         Scissors[I].left = PScissors[I].Left;
@@ -105,7 +201,16 @@ void D3D12GraphicsCommandList::SetScissors(U32 NumScissors, const Scissor* PScis
         Scissors[I].top = PScissors[I].Top;
         Scissors[I].bottom = PScissors[I].Bottom;
     }
+    if (NumScissors == m_Bound.NumScissors
+        && memcmp(Scissors, m_Bound.Scissors, sizeof(D3D12_RECT) * NumScissors) == 0)
+    {
+        m_Statistics.NumScissorsSkipped += 1;
+        return;
+    }
     m_CommandLists[m_CurrentRecordingIdx].PCmdList->RSSetScissorRects(NumScissors, Scissors);
+    m_Bound.NumScissors = NumScissors;
+    memcpy(m_Bound.Scissors, Scissors, sizeof(D3D12_RECT) * NumScissors);
+    m_Statistics.NumScissorsIssued += 1;
 }
 
 
@@ -114,36 +219,420 @@ void D3D12GraphicsCommandList::ClearRenderTarget(GPUHandle RTV,
                                                  U32 NumBounds, 
                                                  TargetBounds* Bounds)
 {
-    static float RGBA[4];
     D3D12_CPU_DESCRIPTOR_HANDLE Handle = { RTV };
     D3D12_RESOURCE_STATES State = D3D12_RESOURCE_STATE_RENDER_TARGET;
     TransitionResourceIfNeeded(1, &RTV, &State);
+    FlushBarriers();
     m_CommandLists[m_CurrentRecordingIdx].PCmdList->ClearRenderTargetView(Handle, 
         (float*)ClearColor, NumBounds, (D3D12_RECT*)Bounds);
 }
 
 
-void D3D12GraphicsCommandList::TransitionResourceIfNeeded(U32 NumHandles, GPUHandle* Descriptors, D3D12_RESOURCE_STATES* NeededStates)
+//! Get the resource, and subresource, a render target or depth stencil view writes to. Views made by
+//! the view cache know the subresource they write, swapchain views cover all.
+static ResultCode GetViewResource(GPUHandle View, GPUHandle* OutResource, U32* OutSubresource)
+{
+    *OutResource = SYNTHE_GPU_NO_HANDLE;
+    *OutSubresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    if (D3D12ViewCache::GetViewSubresource(View, OutResource, OutSubresource) == SResult_OK)
+    {
+        return SResult_OK;
+    }
+    return D3D12DescriptorManager::GetCachedResourceWithDescriptor(View, OutResource);
+}
+
+
+void D3D12GraphicsCommandList::TransitionResourceIfNeeded(U32 NumHandles, 
+                                                          GPUHandle* Descriptors, 
+                                                          D3D12_RESOURCE_STATES* NeededStates,
+                                                          B32 Split)
 {
-    static D3D12_RESOURCE_BARRIER Barriers[64];
     for (U32 I = 0; I < NumHandles; ++I)
     {
-        ResourceState Resource;
+        GPUHandle Key = SYNTHE_GPU_NO_HANDLE;
+        U32 Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+        if (GetViewResource(Descriptors[I], &Key, &Subresource) != SResult_OK)
+        {
+            continue;
+        }
+        TransitionResource(Key, Subresource, NeededStates[I], Split);
+    }
+}
+
+
+void D3D12GraphicsCommandList::TransitionResource(GPUHandle ResourceKey, 
+                                                  U32 Subresource, 
+                                                  D3D12_RESOURCE_STATES State, 
+                                                  B32 Split)
+{
+    ResourceState Resource;
+    if (D3D12MemoryManager::GetNativeResource(ResourceKey, &Resource) != SResult_OK)
+    {
+        return;
+    }
+    // Only the native resource and its subresource count are read, they never change while the
+    // resource lives. The state is the list's own.
+    m_LocalStates.Transition(ResourceKey, Resource.PResource, Resource.NumSubresources, Subresource, State, 
+                             Split, m_Barriers, m_CommandLists[m_CurrentRecordingIdx].PCmdList);
+}
+
+
+void D3D12GraphicsCommandList::RecordBarriers(U32 NumBarriers, const D3D12_RESOURCE_BARRIER* PBarriers)
+{
+    FlushBarriers();
+    m_CommandLists[m_CurrentRecordingIdx].PCmdList->ResourceBarrier(NumBarriers, PBarriers);
+}
+
+
+void D3D12GraphicsCommandList::ResolveResourceStates(std::vector<D3D12_RESOURCE_BARRIER>& OutBarriers)
+{
+    size_t NumBefore = OutBarriers.size();
+    m_LocalStates.Resolve(OutBarriers);
+    m_Statistics.NumFixupBarriers += OutBarriers.size() - NumBefore;
+}
+
+
+static D3D12_RESOURCE_STATES GetNativeResourceState(ResourceAccess Access)
+{
+    switch (Access)
+    {
+        case ResourceAccess_RENDER_TARGET:      return D3D12_RESOURCE_STATE_RENDER_TARGET;
+        case ResourceAccess_DEPTH_WRITE:        return D3D12_RESOURCE_STATE_DEPTH_WRITE;
+        case ResourceAccess_DEPTH_READ:         return D3D12_RESOURCE_STATE_DEPTH_READ;
+        case ResourceAccess_SHADER_READ:        return D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+        case ResourceAccess_UNORDERED_ACCESS:   return D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+        case ResourceAccess_COPY_SOURCE:        return D3D12_RESOURCE_STATE_COPY_SOURCE;
+        case ResourceAccess_COPY_DEST:          return D3D12_RESOURCE_STATE_COPY_DEST;
+        case ResourceAccess_PRESENT:            return D3D12_RESOURCE_STATE_PRESENT;
+        case ResourceAccess_COMMON:
+        default:                                return D3D12_RESOURCE_STATE_COMMON;
+    }
+}
+
+
+void D3D12GraphicsCommandList::TransitionResources(U32 NumTransitions, const ResourceTransition* PTransitions)
+{
+    for (U32 I = 0; I < NumTransitions; ++I)
+    {
+        U32 Subresource = (PTransitions[I].Subresource == SYNTHE_ALL_SUBRESOURCES) 
+                        ? D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES : PTransitions[I].Subresource;
+        TransitionResource(PTransitions[I].Resource, Subresource, GetNativeResourceState(PTransitions[I].Access));
+    }
+}
+
+
+void D3D12GraphicsCommandList::FlushBarriers()
+{
+    m_Barriers.Flush(m_CommandLists[m_CurrentRecordingIdx].PCmdList);
+}
+
+
+void D3D12GraphicsCommandList::CopyNativeResource(GPUHandle DestResource, GPUHandle SrcResource)
+{
+    ResourceState Dest, Src;
+    if (D3D12MemoryManager::GetNativeResource(DestResource, &Dest) != SResult_OK
+        || D3D12MemoryManager::GetNativeResource(SrcResource, &Src) != SResult_OK)
+    {
+        return;
+    }
+    TransitionResource(DestResource, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_STATE_COPY_DEST);
+    TransitionResource(SrcResource, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    FlushBarriers();
+    m_CommandLists[m_CurrentRecordingIdx].PCmdList->CopyResource(Dest.PResource, Src.PResource);
+}
+
+
+static B32 HasStencilPlane(DXGI_FORMAT Format)
+{
+    // The only multi planar formats the device creates are depth stencil ones.
+    return D3D12MemoryManager::GetFormatPlaneCount(Format) > 1;
+}
+
+
+void D3D12GraphicsCommandList::BeginRenderPass(U32 NumRenderTargets, 
+                                               const RenderPassAttachment* PRenderTargets, 
+                                               const RenderPassAttachment* PDepthStencil)
+{
+    if (NumRenderTargets > D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT)
+    {
+        NumRenderTargets = D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT;
+    }
+    m_RenderPass.Active = true;
+    m_RenderPass.Native = m_UseNativeRenderPasses;
+    m_RenderPass.NumRenderTargets = NumRenderTargets;
+    m_RenderPass.HasDepthStencil = (PDepthStencil != nullptr);
+    memcpy(m_RenderPass.Attachments, PRenderTargets, sizeof(RenderPassAttachment) * NumRenderTargets);
+    if (PDepthStencil)
+    {
+        m_RenderPass.Attachments[NumRenderTargets] = *PDepthStencil;
+    }
+    m_Statistics.NumRenderPasses += 1;
+
+    // No barrier may be recorded inside a native pass, so the resolve destinations are moved ahead of
+    // it along with the attachments.
+    for (U32 I = 0; I < NumRenderTargets; ++I)
+    {
+        const RenderPassAttachment& Attachment = m_RenderPass.Attachments[I];
+        D3D12_RESOURCE_STATES State = D3D12_RESOURCE_STATE_RENDER_TARGET;
+        TransitionResourceIfNeeded(1, const_cast<GPUHandle*>(&Attachment.View), &State);
+        if (m_RenderPass.Native && Attachment.StoreOp == AttachmentStoreOp_RESOLVE)
+        {
+            TransitionResource(Attachment.ResolveResource, Attachment.ResolveSubresource, D3D12_RESOURCE_STATE_RESOLVE_DEST);
+        }
+    }
+    if (PDepthStencil)
+    {
+        D3D12_RESOURCE_STATES State = D3D12_RESOURCE_STATE_DEPTH_WRITE;
+        TransitionResourceIfNeeded(1, const_cast<GPUHandle*>(&PDepthStencil->View), &State);
+    }
+    FlushBarriers();
+
+    if (m_RenderPass.Native)
+    {
+        BeginNativeRenderPass();
+        return;
+    }
+
+    ID3D12GraphicsCommandList5* PList = m_CommandLists[m_CurrentRecordingIdx].PCmdList;
+    GPUHandle RTVs[D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT];
+    for (U32 I = 0; I < NumRenderTargets; ++I)
+    {
+        const RenderPassAttachment& Attachment = m_RenderPass.Attachments[I];
+        RTVs[I] = Attachment.View;
+        if (Attachment.LoadOp == AttachmentLoadOp_CLEAR)
+        {
+            D3D12_CPU_DESCRIPTOR_HANDLE Handle = { Attachment.View };
+            PList->ClearRenderTargetView(Handle, &Attachment.ClearColor.R, 0, nullptr);
+        }
+        else if (Attachment.LoadOp == AttachmentLoadOp_DONT_CARE)
+        {
+            DiscardView(Attachment.View);
+        }
+    }
+    GPUHandle DSV = SYNTHE_GPU_NO_HANDLE;
+    if (PDepthStencil)
+    {
+        DSV = PDepthStencil->View;
+        if (PDepthStencil->LoadOp == AttachmentLoadOp_CLEAR)
+        {
+            GPUHandle Key;
+            U32 Subresource;
+            ResourceState Resource;
+            D3D12_CLEAR_FLAGS Flags = D3D12_CLEAR_FLAG_DEPTH;
+            if (GetViewResource(DSV, &Key, &Subresource) == SResult_OK
+                && D3D12MemoryManager::GetNativeResource(Key, &Resource) == SResult_OK
+                && HasStencilPlane(Resource.PResource->GetDesc().Format))
+            {
+                Flags = static_cast<D3D12_CLEAR_FLAGS>(Flags | D3D12_CLEAR_FLAG_STENCIL);
+            }
+            D3D12_CPU_DESCRIPTOR_HANDLE Handle = { DSV };
+            PList->ClearDepthStencilView(Handle, Flags, PDepthStencil->ClearDepth, PDepthStencil->ClearStencil, 0, nullptr);
+        }
+        else if (PDepthStencil->LoadOp == AttachmentLoadOp_DONT_CARE)
+        {
+            DiscardView(DSV);
+        }
+    }
+    SetRenderTargets(NumRenderTargets, RTVs, PDepthStencil ? &DSV : nullptr);
+}
+
+
+void D3D12GraphicsCommandList::BeginNativeRenderPass()
+{
+    D3D12_RENDER_PASS_RENDER_TARGET_DESC RenderTargets[D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT] = { };
+    D3D12_RENDER_PASS_DEPTH_STENCIL_DESC DepthStencil = { };
+    const U32 NumRenderTargets = m_RenderPass.NumRenderTargets;
+
+    for (U32 I = 0; I < NumRenderTargets; ++I)
+    {
+        const RenderPassAttachment& Attachment = m_RenderPass.Attachments[I];
+        D3D12_RENDER_PASS_RENDER_TARGET_DESC& Desc = RenderTargets[I];
+        Desc.cpuDescriptor.ptr = Attachment.View;
+
         GPUHandle Key;
-        D3D12DescriptorManager::GetCachedResourceWithDescriptor(Descriptors[I], &Key);
-        D3D12MemoryManager::GetNativeResource(Key, &Resource);
-        if (Resource.State == NeededStates[I])
+        U32 Subresource;
+        ResourceState Resource = { };
+        if (GetViewResource(Attachment.View, &Key, &Subresource) != SResult_OK
+            || D3D12MemoryManager::GetNativeResource(Key, &Resource) != SResult_OK)
         {
-            return;
+            Resource.PResource = nullptr;
+        }
+        D3D12_RESOURCE_DESC ResourceDesc = Resource.PResource ? Resource.PResource->GetDesc() : D3D12_RESOURCE_DESC();
+
+        switch (Attachment.LoadOp)
+        {
+            case AttachmentLoadOp_CLEAR:
+                Desc.BeginningAccess.Type = D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_CLEAR;
+                Desc.BeginningAccess.Clear.ClearValue.Format = ResourceDesc.Format;
+                memcpy(Desc.BeginningAccess.Clear.ClearValue.Color, &Attachment.ClearColor, sizeof(ClearColorValue));
+                break;
+            case AttachmentLoadOp_DONT_CARE:
+                Desc.BeginningAccess.Type = D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_DISCARD;
+                m_Statistics.NumAttachmentsDiscarded += 1;
+                break;
+            case AttachmentLoadOp_LOAD:
+            default:
+                Desc.BeginningAccess.Type = D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_PRESERVE;
+                break;
+        }
+
+        ResourceState Resolve = { };
+        if (Attachment.StoreOp == AttachmentStoreOp_RESOLVE && Resource.PResource
+            && D3D12MemoryManager::GetNativeResource(Attachment.ResolveResource, &Resolve) == SResult_OK)
+        {
+            D3D12_RENDER_PASS_ENDING_ACCESS_RESOLVE_SUBRESOURCE_PARAMETERS& Parameters = m_RenderPass.ResolveParameters[I];
+            Parameters.SrcSubresource = (Subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES) ? 0 : Subresource;
+            Parameters.DstSubresource = Attachment.ResolveSubresource;
+            Parameters.DstX = 0;
+            Parameters.DstY = 0;
+            Parameters.SrcRect = { 0, 0, static_cast<LONG>(ResourceDesc.Width), static_cast<LONG>(ResourceDesc.Height) };
+            Desc.EndingAccess.Type = D3D12_RENDER_PASS_ENDING_ACCESS_TYPE_RESOLVE;
+            Desc.EndingAccess.Resolve.pSrcResource = Resource.PResource;
+            Desc.EndingAccess.Resolve.pDstResource = Resolve.PResource;
+            Desc.EndingAccess.Resolve.SubresourceCount = 1;
+            Desc.EndingAccess.Resolve.pSubresourceParameters = &Parameters;
+            Desc.EndingAccess.Resolve.Format = ResourceDesc.Format;
+            Desc.EndingAccess.Resolve.ResolveMode = D3D12_RESOLVE_MODE_AVERAGE;
+            Desc.EndingAccess.Resolve.PreserveResolveSource = TRUE;
+        }
+        else if (Attachment.StoreOp == AttachmentStoreOp_DISCARD)
+        {
+            Desc.EndingAccess.Type = D3D12_RENDER_PASS_ENDING_ACCESS_TYPE_DISCARD;
+            m_Statistics.NumAttachmentsDiscarded += 1;
+        }
+        else
+        {
+            Desc.EndingAccess.Type = D3D12_RENDER_PASS_ENDING_ACCESS_TYPE_PRESERVE;
+        }
+    }
+
+    if (m_RenderPass.HasDepthStencil)
+    {
+        const RenderPassAttachment& Attachment = m_RenderPass.Attachments[NumRenderTargets];
+        DepthStencil.cpuDescriptor.ptr = Attachment.View;
+
+        GPUHandle Key;
+        U32 Subresource;
+        ResourceState Resource = { };
+        DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+        if (GetViewResource(Attachment.View, &Key, &Subresource) == SResult_OK
+            && D3D12MemoryManager::GetNativeResource(Key, &Resource) == SResult_OK)
+        {
+            Format = Resource.PResource->GetDesc().Format;
+        }
+
+        D3D12_RENDER_PASS_BEGINNING_ACCESS Beginning = { };
+        switch (Attachment.LoadOp)
+        {
+            case AttachmentLoadOp_CLEAR:
+                Beginning.Type = D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_CLEAR;
+                Beginning.Clear.ClearValue.Format = Format;
+                Beginning.Clear.ClearValue.DepthStencil.Depth = Attachment.ClearDepth;
+                Beginning.Clear.ClearValue.DepthStencil.Stencil = Attachment.ClearStencil;
+                break;
+            case AttachmentLoadOp_DONT_CARE:
+                Beginning.Type = D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_DISCARD;
+                m_Statistics.NumAttachmentsDiscarded += 1;
+                break;
+            case AttachmentLoadOp_LOAD:
+            default:
+                Beginning.Type = D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_PRESERVE;
+                break;
+        }
+
+        // Depth is never resolved here, a resolve store simply keeps it.
+        D3D12_RENDER_PASS_ENDING_ACCESS Ending = { };
+        Ending.Type = D3D12_RENDER_PASS_ENDING_ACCESS_TYPE_PRESERVE;
+        if (Attachment.StoreOp == AttachmentStoreOp_DISCARD)
+        {
+            Ending.Type = D3D12_RENDER_PASS_ENDING_ACCESS_TYPE_DISCARD;
+            m_Statistics.NumAttachmentsDiscarded += 1;
+        }
+
+        DepthStencil.DepthBeginningAccess = Beginning;
+        DepthStencil.DepthEndingAccess = Ending;
+        if (HasStencilPlane(Format))
+        {
+            DepthStencil.StencilBeginningAccess = Beginning;
+            DepthStencil.StencilEndingAccess = Ending;
+        }
+        else
+        {
+            DepthStencil.StencilBeginningAccess.Type = D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_NO_ACCESS;
+            DepthStencil.StencilEndingAccess.Type = D3D12_RENDER_PASS_ENDING_ACCESS_TYPE_NO_ACCESS;
+        }
+    }
+
+    m_CommandLists[m_CurrentRecordingIdx].PCmdList->BeginRenderPass(NumRenderTargets, RenderTargets, 
+        m_RenderPass.HasDepthStencil ? &DepthStencil : nullptr, D3D12_RENDER_PASS_FLAG_NONE);
+    // The pass binds its own render targets.
+    m_Bound.NumRTVs = ~0U;
+}
+
+
+void D3D12GraphicsCommandList::EndRenderPass()
+{
+    if (!m_RenderPass.Active)
+    {
+        return;
+    }
+    m_RenderPass.Active = false;
+    ID3D12GraphicsCommandList5* PList = m_CommandLists[m_CurrentRecordingIdx].PCmdList;
+    if (m_RenderPass.Native)
+    {
+        PList->EndRenderPass();
+        // Render targets bound by the pass do not outlive it.
+        m_Bound.NumRTVs = ~0U;
+        return;
+    }
+
+    // Discards first, while the attachments are still in their render target and depth write states.
+    const U32 NumAttachments = m_RenderPass.NumRenderTargets + (m_RenderPass.HasDepthStencil ? 1 : 0);
+    for (U32 I = 0; I < NumAttachments; ++I)
+    {
+        if (m_RenderPass.Attachments[I].StoreOp == AttachmentStoreOp_DISCARD)
+        {
+            DiscardView(m_RenderPass.Attachments[I].View);
+        }
+    }
+
+    for (U32 I = 0; I < m_RenderPass.NumRenderTargets; ++I)
+    {
+        const RenderPassAttachment& Attachment = m_RenderPass.Attachments[I];
+        GPUHandle Key;
+        U32 Subresource;
+        ResourceState Source, Dest;
+        if (Attachment.StoreOp != AttachmentStoreOp_RESOLVE
+            || GetViewResource(Attachment.View, &Key, &Subresource) != SResult_OK
+            || D3D12MemoryManager::GetNativeResource(Key, &Source) != SResult_OK
+            || D3D12MemoryManager::GetNativeResource(Attachment.ResolveResource, &Dest) != SResult_OK)
+        {
+            continue;
         }
-        Barriers[I].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-        Barriers[I].Transition.pResource = Resource.PResource;
-        Barriers[I].Transition.StateAfter = NeededStates[I];
-        Barriers[I].Transition.StateBefore = Resource.State;
-        Barriers[I].Transition.Subresource = 0;
-        D3D12MemoryManager::UpdateResourceState(Key, NeededStates[I]);
+        TransitionResource(Key, Subresource, D3D12_RESOURCE_STATE_RESOLVE_SOURCE);
+        TransitionResource(Attachment.ResolveResource, Attachment.ResolveSubresource, D3D12_RESOURCE_STATE_RESOLVE_DEST);
+        FlushBarriers();
+        PList->ResolveSubresource(Dest.PResource, Attachment.ResolveSubresource, Source.PResource, 
+                                  (Subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES) ? 0 : Subresource,
+                                  Source.PResource->GetDesc().Format);
+    }
+}
+
+
+void D3D12GraphicsCommandList::DiscardView(GPUHandle View)
+{
+    GPUHandle Key;
+    U32 Subresource;
+    ResourceState Resource;
+    if (GetViewResource(View, &Key, &Subresource) != SResult_OK
+        || D3D12MemoryManager::GetNativeResource(Key, &Resource) != SResult_OK)
+    {
+        return;
     }
-    m_CommandLists[m_CurrentRecordingIdx].PCmdList->ResourceBarrier(NumHandles, Barriers);
+    D3D12_DISCARD_REGION Region = { 0, nullptr, Subresource, 1 };
+    m_CommandLists[m_CurrentRecordingIdx].PCmdList->DiscardResource(Resource.PResource, 
+        (Subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES) ? nullptr : &Region);
+    m_Statistics.NumAttachmentsDiscarded += 1;
 }
 
 
@@ -152,16 +641,55 @@ void D3D12GraphicsCommandList::BindDescriptorSets(U32 NumSets, DescriptorSet* co
     for (U32 I = 0; I < NumSets; ++I)
     {
         const D3D12DescriptorSet* Set = static_cast<const D3D12DescriptorSet*>(PDescriptorSets[I]);
-        D3D12_GPU_DESCRIPTOR_HANDLE DescriptorTableGPUAddress = 
-            D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_CBV_SRV_UAV_UPLOAD)->GetGPUAddressFromCPUAddress(
-                Set->GPUTable.StartingAddress);
-        
-        m_CommandLists[m_CurrentRecordingIdx].PCmdList->SetGraphicsRootDescriptorTable(
-            I, DescriptorTableGPUAddress);
+        D3D12_GPU_DESCRIPTOR_HANDLE DescriptorTableGPUAddress = Set->GetGPUTableAddress(m_CurrentRecordingIdx);
+        SetGraphicsDescriptorTable(I, DescriptorTableGPUAddress);
     }
 }
 
 
+void D3D12GraphicsCommandList::SetGraphicsDescriptorTable(U32 Parameter, D3D12_GPU_DESCRIPTOR_HANDLE Table)
+{
+    if (Parameter < k_MaxShadowedDescriptorTables)
+    {
+        if (m_Bound.DescriptorTables[Parameter].ptr == Table.ptr)
+        {
+            m_Statistics.NumDescriptorTablesSkipped += 1;
+            return;
+        }
+        m_Bound.DescriptorTables[Parameter] = Table;
+    }
+    m_CommandLists[m_CurrentRecordingIdx].PCmdList->SetGraphicsRootDescriptorTable(Parameter, Table);
+    m_Statistics.NumDescriptorTablesIssued += 1;
+}
+
+
+void D3D12GraphicsCommandList::ResetBoundState()
+{
+    // Counts no native call can match, so the first call of each kind is issued.
+    memset(&m_Bound, 0, sizeof(m_Bound));
+    m_Bound.NumViewports = ~0U;
+    m_Bound.NumScissors = ~0U;
+    m_Bound.NumRTVs = ~0U;
+}
+
+
+void D3D12GraphicsCommandList::ResetBoundDescriptorTables()
+{
+    memset(m_Bound.DescriptorTables, 0, sizeof(m_Bound.DescriptorTables));
+}
+
+
+ResultCode D3D12GraphicsCommandList::GetStatistics(CommandListStatistics* OutStatistics) const
+{
+    *OutStatistics = m_Statistics;
+    const BarrierBatchStatistics& Barriers = m_Barriers.GetStatistics();
+    OutStatistics->NumBarriersRequested = Barriers.NumRequested;
+    OutStatistics->NumBarriersEmitted = Barriers.NumEmitted;
+    OutStatistics->NumBarrierBatches = Barriers.NumBatches;
+    return SResult_OK;
+}
+
+
 void D3D12GraphicsCommandList::SetPipelineState(PipelineStateType PipelineType,
                                                 PipelineState* PPipelineState,
                                                 RootSignature* PRootSignature)
@@ -173,7 +701,48 @@ void D3D12GraphicsCommandList::SetPipelineState(PipelineStateType PipelineType,
         return;
     }
 
-    ID3D12RootSignature* Signature = static_cast<D3D12RootSignature*>(PRootSignature)->GetNative();
+    D3D12GraphicsDevice* PDevice = static_cast<D3D12GraphicsDevice*>(GetDeviceD3D12());
+    U64 Frame = PDevice->GetCurrentFrame();
+    if (PPipelineState)
+    {
+        static_cast<D3D12PipelineState*>(PPipelineState)->MarkUsed(Frame);
+        D3D12PipelineState* PReady = ResolvePipelineState(static_cast<D3D12PipelineState*>(PPipelineState));
+        m_SkipWork = (PReady == nullptr);
+        if (PReady && PReady->GetNative() == m_Bound.PPipelineState)
+        {
+            m_Statistics.NumPipelineStatesSkipped += 1;
+        }
+        else if (PReady)
+        {
+            CommandList->SetPipelineState(PReady->GetNative());
+            m_Bound.PPipelineState = PReady->GetNative();
+            m_Statistics.NumPipelineStatesIssued += 1;
+        }
+    }
+
+    D3D12RootSignature* PD3D12RootSignature = static_cast<D3D12RootSignature*>(PRootSignature);
+    ID3D12RootSignature* Signature = PD3D12RootSignature->GetNative();
+    m_PBoundRootSignature = PD3D12RootSignature;
+    m_BoundPipelineType = PipelineType;
+    PD3D12RootSignature->MarkUsed(Frame);
+
+    // The root signature, and the bindless tables set with it, are still bound.
+    if (m_Bound.PRootSignatures[PipelineType] == Signature)
+    {
+        m_Statistics.NumRootSignaturesSkipped += 1;
+        return;
+    }
+    m_Bound.PRootSignatures[PipelineType] = Signature;
+    m_Statistics.NumRootSignaturesIssued += 1;
+
+    D3D12_GPU_DESCRIPTOR_HANDLE BindlessResources = { };
+    D3D12_GPU_DESCRIPTOR_HANDLE BindlessSamplers = { };
+    if (PD3D12RootSignature->IsBindless())
+    {
+        BindlessResources = PDevice->GetBindlessResourceTable().GetGPUAddress(m_CurrentRecordingIdx);
+        BindlessSamplers = PDevice->GetBindlessSamplerTable().GetGPUAddress(m_CurrentRecordingIdx);
+    }
+
     switch (PipelineType)
     {
         case PipelineStateType_GRAPHICS:
@@ -181,13 +750,176 @@ void D3D12GraphicsCommandList::SetPipelineState(PipelineStateType PipelineType,
             // Set Graphics Root resources.
             
             CommandList->SetGraphicsRootSignature(Signature);
+            // A new root signature drops every root argument.
+            ResetBoundDescriptorTables();
+            if (PD3D12RootSignature->IsBindless())
+            {
+                SetGraphicsDescriptorTable(PD3D12RootSignature->GetBindlessResourceParameter(), BindlessResources);
+                SetGraphicsDescriptorTable(PD3D12RootSignature->GetBindlessSamplerParameter(), BindlessSamplers);
+            }
             break;
         }
         case PipelineStateType_COMPUTE:
         {
             CommandList->SetComputeRootSignature(Signature);
+            if (PD3D12RootSignature->IsBindless())
+            {
+                CommandList->SetComputeRootDescriptorTable(
+                    PD3D12RootSignature->GetBindlessResourceParameter(), BindlessResources);
+                CommandList->SetComputeRootDescriptorTable(
+                    PD3D12RootSignature->GetBindlessSamplerParameter(), BindlessSamplers);
+            }
+            break;
+        }
+    }
+}
+
+
+void D3D12GraphicsCommandList::SetPipelineNotReadyPolicy(PipelineNotReadyPolicy Policy)
+{
+    m_NotReadyPolicy = Policy;
+}
+
+
+D3D12PipelineState* D3D12GraphicsCommandList::ResolvePipelineState(D3D12PipelineState* PPipelineState)
+{
+    if (PPipelineState->GetStatus() == PipelineStateStatus_COMPILING)
+    {
+        switch (m_NotReadyPolicy)
+        {
+            case PipelineNotReadyPolicy_WAIT:
+            {
+                PPipelineState->Wait();
+                break;
+            }
+            case PipelineNotReadyPolicy_FALLBACK:
+            {
+                D3D12PipelineState* PFallback = static_cast<D3D12PipelineState*>(PPipelineState->GetFallback());
+                if (PFallback && PFallback->GetStatus() == PipelineStateStatus_READY)
+                {
+                    return PFallback;
+                }
+                return nullptr;
+            }
+            case PipelineNotReadyPolicy_SKIP:
+            default:
+                return nullptr;
+        }
+    }
+    return PPipelineState->GetStatus() == PipelineStateStatus_READY ? PPipelineState : nullptr;
+}
+
+
+void D3D12GraphicsCommandList::SetBindlessIndices(U32 NumIndices, const U32* PIndices, U32 FirstIndex)
+{
+    if (!m_PBoundRootSignature 
+        || m_PBoundRootSignature->GetBindlessIndexParameter() == D3D12RootSignature::k_NoParameter)
+    {
+        return;
+    }
+
+    ID3D12GraphicsCommandList* CommandList = m_CommandLists[m_CurrentRecordingIdx].PCmdList;
+    U32 Parameter = m_PBoundRootSignature->GetBindlessIndexParameter();
+    if (m_BoundPipelineType == PipelineStateType_COMPUTE)
+    {
+        CommandList->SetComputeRoot32BitConstants(Parameter, NumIndices, PIndices, FirstIndex);
+    }
+    else
+    {
+        CommandList->SetGraphicsRoot32BitConstants(Parameter, NumIndices, PIndices, FirstIndex);
+    }
+}
+
+
+void D3D12GraphicsCommandList::SetRootConstants(U32 ParameterIndex, 
+                                                U32 Num32BitValues, 
+                                                const void* PData, 
+                                                U32 DestOffsetIn32BitValues)
+{
+    if (!m_PBoundRootSignature)
+    {
+        return;
+    }
+
+    U32 Parameter = m_PBoundRootSignature->GetRootParameter(ParameterIndex);
+    if (Parameter == D3D12RootSignature::k_NoParameter)
+    {
+        return;
+    }
+
+    ID3D12GraphicsCommandList* CommandList = m_CommandLists[m_CurrentRecordingIdx].PCmdList;
+    if (m_BoundPipelineType == PipelineStateType_COMPUTE)
+    {
+        CommandList->SetComputeRoot32BitConstants(Parameter, Num32BitValues, PData, DestOffsetIn32BitValues);
+    }
+    else
+    {
+        CommandList->SetGraphicsRoot32BitConstants(Parameter, Num32BitValues, PData, DestOffsetIn32BitValues);
+    }
+}
+
+
+void D3D12GraphicsCommandList::SetRootConstantBuffer(U32 ParameterIndex, GPUHandle BufferHandle, U64 OffsetInBytes)
+{
+    SetRootDescriptor(RootParameterType_CBV, ParameterIndex, BufferHandle, OffsetInBytes);
+}
+
+
+void D3D12GraphicsCommandList::SetRootShaderResource(U32 ParameterIndex, GPUHandle BufferHandle, U64 OffsetInBytes)
+{
+    SetRootDescriptor(RootParameterType_SRV, ParameterIndex, BufferHandle, OffsetInBytes);
+}
+
+
+void D3D12GraphicsCommandList::SetRootUnorderedAccess(U32 ParameterIndex, GPUHandle BufferHandle, U64 OffsetInBytes)
+{
+    SetRootDescriptor(RootParameterType_UAV, ParameterIndex, BufferHandle, OffsetInBytes);
+}
+
+
+void D3D12GraphicsCommandList::SetRootDescriptor(RootParameterType Type, 
+                                                 U32 ParameterIndex, 
+                                                 GPUHandle BufferHandle, 
+                                                 U64 OffsetInBytes)
+{
+    if (!m_PBoundRootSignature)
+    {
+        return;
+    }
+
+    U32 Parameter = m_PBoundRootSignature->GetRootParameter(ParameterIndex);
+    ResourceState State = { };
+    D3D12MemoryManager::GetNativeResource(BufferHandle, &State);
+    if (Parameter == D3D12RootSignature::k_NoParameter || !State.PResource)
+    {
+        return;
+    }
+
+    ID3D12GraphicsCommandList* CommandList = m_CommandLists[m_CurrentRecordingIdx].PCmdList;
+    D3D12_GPU_VIRTUAL_ADDRESS Address = State.PResource->GetGPUVirtualAddress() + OffsetInBytes;
+    B32 IsCompute = (m_BoundPipelineType == PipelineStateType_COMPUTE);
+    switch (Type)
+    {
+        case RootParameterType_CBV:
+        {
+            if (IsCompute) CommandList->SetComputeRootConstantBufferView(Parameter, Address);
+            else CommandList->SetGraphicsRootConstantBufferView(Parameter, Address);
+            break;
+        }
+        case RootParameterType_SRV:
+        {
+            if (IsCompute) CommandList->SetComputeRootShaderResourceView(Parameter, Address);
+            else CommandList->SetGraphicsRootShaderResourceView(Parameter, Address);
             break;
         }
+        case RootParameterType_UAV:
+        {
+            if (IsCompute) CommandList->SetComputeRootUnorderedAccessView(Parameter, Address);
+            else CommandList->SetGraphicsRootUnorderedAccessView(Parameter, Address);
+            break;
+        }
+        default:
+            break;
     }
 }
 
@@ -198,6 +930,11 @@ void D3D12GraphicsCommandList::DrawIndexedInstanced(U32 IndexCountPerInst,
                                                     I32 BaseVertexLocation,
                                                     U32 StartInstanceLocation)
 {
+    if (m_SkipWork)
+    {
+        return;
+    }
+    FlushBarriers();
     ID3D12GraphicsCommandList* CommandList = m_CommandLists[m_CurrentRecordingIdx].PCmdList;
     CommandList->DrawIndexedInstanced(IndexCountPerInst, InstanceCount, StartIndexLocation, 
         BaseVertexLocation, StartInstanceLocation);
@@ -209,6 +946,11 @@ void D3D12GraphicsCommandList::DrawInstanced(U32 VertexCountPerInstance,
                                              U32 StartVertexLocation,
                                              U32 StartInstanceLocation)
 {
+    if (m_SkipWork)
+    {
+        return;
+    }
+    FlushBarriers();
     ID3D12GraphicsCommandList* CommandList = m_CommandLists[m_CurrentRecordingIdx].PCmdList;
     CommandList->DrawInstanced(VertexCountPerInstance, InstanceCount, StartVertexLocation, StartInstanceLocation);
 }
@@ -216,6 +958,11 @@ void D3D12GraphicsCommandList::DrawInstanced(U32 VertexCountPerInstance,
 
 void D3D12GraphicsCommandList::Dispatch(U32 X, U32 Y, U32 Z)
 {
+    if (m_SkipWork)
+    {
+        return;
+    }
+    FlushBarriers();
     ID3D12GraphicsCommandList* CommandList = m_CommandLists[m_CurrentRecordingIdx].PCmdList;
     CommandList->Dispatch(X, Y, Z);
 }
@@ -5,7 +5,10 @@
 
 #include "Win32Common.hpp"
 #include "Common/Types.hpp"
+#include "D3D12BarrierBatcher.hpp"
+#include "D3D12LocalResourceStates.hpp"
 #include "Graphics/GraphicsCommandList.hpp"
+#include "Graphics/PipelineState.hpp"
 
 #include <vector>
 
@@ -13,6 +16,9 @@ namespace Synthe {
 
 
 struct ResourceState;
+class D3D12RootSignature;
+class D3D12PipelineState;
+class D3D12CommandAllocatorPool;
 
 
 enum CommandState
@@ -22,12 +28,17 @@ enum CommandState
     CommandState_STILL_EXECUTING,
 };
 
+//! D3D12 command list. Each recording takes its own command allocator from the pool of its type, so 
+//! lists can be recorded on different threads at the same time, as long as each list is recorded by 
+//! one thread. The allocator goes back to the pool when the list is submitted. Resource states are 
+//! tracked by the list while it records, and reconciled with the global states when it is submitted.
 class D3D12GraphicsCommandList : public GraphicsCommandList
 {
 private:
     struct CommandListState 
     {
-        ID3D12CommandAllocator* PAllocatorRef;
+        //! Allocator of the current recording, nullptr once given back to the pool.
+        ID3D12CommandAllocator* PAllocator;
         ID3D12GraphicsCommandList5* PCmdList;
         CommandState State;
     };
@@ -35,14 +46,33 @@ public:
     D3D12GraphicsCommandList()
         : m_CommandLists(0)
         , m_CurrentRecordingIdx(0)
-        , m_DeviceRef(nullptr) { }
+        , m_DeviceRef(nullptr)
+        , m_PAllocatorPool(nullptr)
+        , m_Type(D3D12_COMMAND_LIST_TYPE_DIRECT)
+        , m_PBoundRootSignature(nullptr)
+        , m_BoundPipelineType(PipelineStateType_GRAPHICS)
+        , m_NotReadyPolicy(PipelineNotReadyPolicy_WAIT)
+        , m_SkipWork(false)
+        , m_UseNativeRenderPasses(false)
+        , m_RenderPass()
+        , m_Statistics() { ResetBoundState(); }
 
+    //! Create the native command lists.
+    //!
+    //! \param PDevice The native device.
+    //! \param NumCommandListBuffers Number of buffered frames.
+    //! \param PAllocatorPool The allocator pool of the list type. Not owned.
+    //! \return SResult_OK on success.
     ResultCode Initialize(ID3D12Device* PDevice, 
                           U32 NumCommandListBuffers,
-                          ID3D12CommandAllocator** CommandAllocators,
-                          D3D12_COMMAND_LIST_TYPE Type);
+                          D3D12CommandAllocatorPool* PAllocatorPool);
 
     void Release();
+
+    //! Give the allocator of the current recording back to the pool, once the list is submitted.
+    //!
+    //! \param FenceValue The pool fence value signaled after the submit.
+    void OnSubmitted(U64 FenceValue);
     void Begin() override;
     void End() override;
 
@@ -56,7 +86,24 @@ public:
                            U32 NumBounds, 
                            TargetBounds* Bounds) override;
 
+    //! Render passes map onto native render passes on devices of render pass tier 1 or above. Other
+    //! devices emulate them in the runtime at a cost, so there the list clears and discards the
+    //! attachments itself, and resolves them with ResolveSubresource().
+    void BeginRenderPass(U32 NumRenderTargets, 
+                         const RenderPassAttachment* PRenderTargets, 
+                         const RenderPassAttachment* PDepthStencil) override;
+    void EndRenderPass() override;
+
     void BindDescriptorSets(U32 NumSets, DescriptorSet* const* PDescriptorSets) override;
+    void SetPipelineNotReadyPolicy(PipelineNotReadyPolicy Policy) override;
+    void SetBindlessIndices(U32 NumIndices, const U32* PIndices, U32 FirstIndex) override;
+    void SetRootConstants(U32 ParameterIndex, 
+                          U32 Num32BitValues, 
+                          const void* PData, 
+                          U32 DestOffsetIn32BitValues) override;
+    void SetRootConstantBuffer(U32 ParameterIndex, GPUHandle BufferHandle, U64 OffsetInBytes) override;
+    void SetRootShaderResource(U32 ParameterIndex, GPUHandle BufferHandle, U64 OffsetInBytes) override;
+    void SetRootUnorderedAccess(U32 ParameterIndex, GPUHandle BufferHandle, U64 OffsetInBytes) override;
     void SetPipelineState(PipelineStateType PipelineType, 
                           PipelineState* PPipelineState,
                           RootSignature* PRootSignature) override;
@@ -73,14 +120,141 @@ public:
     void BindVertexBuffers(U32 NumSets, Resource* const* PBuffers, U32* Offsets) override { }
     void BindIndexBuffer(const Resource* PBuffer, U32 Offset) override { }
 
-    void TransitionResourceIfNeeded(U32 NumHandles, GPUHandle* Descriptors, D3D12_RESOURCE_STATES* NeededStates);
+    //! Queue transitions of the subresources written by render target or depth stencil views. Views 
+    //! already in their state queue nothing. Barriers are issued together before the next draw, 
+    //! dispatch, clear, or copy.
+    //!
+    //! \param NumHandles The number of views.
+    //! \param Descriptors The views.
+    //! \param NeededStates The state needed for each view.
+    //! \param Split Only begin the transitions, they end on the next transition of the same views, or
+    //!              at End().
+    void TransitionResourceIfNeeded(U32 NumHandles, 
+                                    GPUHandle* Descriptors, 
+                                    D3D12_RESOURCE_STATES* NeededStates,
+                                    B32 Split = false);
+
+    //! Queue a transition of a resource, if needed.
+    //!
+    //! \param ResourceKey The resource handle.
+    //! \param Subresource The subresource index, or D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES.
+    //! \param State The state needed.
+    //! \param Split Only begin the transition.
+    void TransitionResource(GPUHandle ResourceKey, 
+                            U32 Subresource, 
+                            D3D12_RESOURCE_STATES State, 
+                            B32 Split = false);
+
+    //! Issue the queued barriers now.
+    void FlushBarriers();
+
+    void TransitionResources(U32 NumTransitions, const ResourceTransition* PTransitions) override;
+
+    //! Record barriers as they are, bypassing state tracking. Used for barriers built at submit.
+    void RecordBarriers(U32 NumBarriers, const D3D12_RESOURCE_BARRIER* PBarriers);
+
+    //! Reconcile the states the list recorded against the global resource states. Called by the 
+    //! device at submit, on the submitting thread, in execution order.
+    //!
+    //! \param OutBarriers Receives the barriers to execute right before the list.
+    void ResolveResourceStates(std::vector<D3D12_RESOURCE_BARRIER>& OutBarriers);
+
+    //! Copy a whole resource, transitioning both resources first.
+    //!
+    //! \param DestResource The destination resource handle.
+    //! \param SrcResource The source resource handle.
+    void CopyNativeResource(GPUHandle DestResource, GPUHandle SrcResource);
+
+    ResultCode GetStatistics(CommandListStatistics* OutStatistics) const override;
 
     ID3D12GraphicsCommandList* GetNative() { return m_CommandLists[m_CurrentRecordingIdx].PCmdList; }
     void SetCurrentIdx(U32 Idx) { m_CurrentRecordingIdx = Idx; }
 
 private:
+    //! Get the pipeline to bind for the not ready policy, nullptr to skip work until the next pipeline.
+    D3D12PipelineState* ResolvePipelineState(D3D12PipelineState* PPipelineState);
+
+    //! Set a root CBV, SRV, or UAV parameter for the bound pipeline type.
+    void SetRootDescriptor(RootParameterType Type, U32 ParameterIndex, GPUHandle BufferHandle, U64 OffsetInBytes);
+
+    //! Forget the shadowed state, as when the native list is reset.
+    void ResetBoundState();
+
+    //! Forget the graphics descriptor tables, dropped by a new graphics root signature.
+    void ResetBoundDescriptorTables();
+
+    //! Set a graphics descriptor table, unless it is bound already.
+    void SetGraphicsDescriptorTable(U32 Parameter, D3D12_GPU_DESCRIPTOR_HANDLE Table);
+
+    //! Record the render pass begun last as a native render pass.
+    void BeginNativeRenderPass();
+
+    //! Tell the driver the contents of a render target or depth stencil view are not needed.
+    void DiscardView(GPUHandle View);
+
+    //! Descriptor tables shadowed, tables of higher parameters are always set.
+    static const U32 k_MaxShadowedDescriptorTables = 16;
+
+    //! Native state last set on the list, so calls setting it again can be skipped.
+    struct BoundState
+    {
+        ID3D12PipelineState* PPipelineState;
+        //! Root signatures, indexed by PipelineStateType.
+        ID3D12RootSignature* PRootSignatures[3];
+        U32 NumViewports;
+        D3D12_VIEWPORT Viewports[D3D12_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+        U32 NumScissors;
+        D3D12_RECT Scissors[D3D12_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+        //! ~0 until render targets are set.
+        U32 NumRTVs;
+        D3D12_CPU_DESCRIPTOR_HANDLE RTVs[D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT];
+        B32 HasDSV;
+        D3D12_CPU_DESCRIPTOR_HANDLE DSV;
+        //! Graphics descriptor tables by root parameter, 0 when unknown.
+        D3D12_GPU_DESCRIPTOR_HANDLE DescriptorTables[k_MaxShadowedDescriptorTables];
+    };
+
+    //! The render pass being recorded.
+    struct RenderPassState
+    {
+        B32 Active;
+        B32 Native;
+        U32 NumRenderTargets;
+        B32 HasDepthStencil;
+        //! Render targets, then the depth stencil.
+        RenderPassAttachment Attachments[D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT + 1];
+        //! Read by the native pass up to EndRenderPass().
+        D3D12_RENDER_PASS_ENDING_ACCESS_RESOLVE_SUBRESOURCE_PARAMETERS ResolveParameters[D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT];
+    };
+
     std::vector<CommandListState>   m_CommandLists;
     U32                             m_CurrentRecordingIdx;
     ID3D12Device*                   m_DeviceRef;
+    D3D12CommandAllocatorPool*      m_PAllocatorPool;
+    D3D12_COMMAND_LIST_TYPE         m_Type;
+
+    //! Root signature last set, used to find where root parameters and bindless indices go.
+    D3D12RootSignature*             m_PBoundRootSignature;
+    PipelineStateType               m_BoundPipelineType;
+
+    PipelineNotReadyPolicy          m_NotReadyPolicy;
+
+    //! Set when the bound pipeline was not ready and skipped, draws and dispatches are dropped.
+    B32                             m_SkipWork;
+
+    //! Set when the device supports render passes natively.
+    B32                             m_UseNativeRenderPasses;
+
+    //! Barriers waiting for the next draw, dispatch, clear, or copy. Owned by the list so recording 
+    //! threads never share it.
+    D3D12BarrierBatcher             m_Barriers;
+
+    //! States of the resources this recording touched.
+    D3D12LocalResourceStates        m_LocalStates;
+
+    RenderPassState                 m_RenderPass;
+
+    BoundState                      m_Bound;
+    CommandListStatistics           m_Statistics;
 };
 } // Synthe 
\ No newline at end of file
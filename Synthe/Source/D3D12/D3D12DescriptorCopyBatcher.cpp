@@ -0,0 +1,129 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "D3D12DescriptorCopyBatcher.hpp"
+
+#include <algorithm>
+
+namespace Synthe {
+
+
+void D3D12DescriptorCopyBatcher::Initialize(D3D12_DESCRIPTOR_HEAP_TYPE HeapType, U64 DescriptorSizeInBytes)
+{
+    m_HeapType = HeapType;
+    m_DescriptorSizeInBytes = DescriptorSizeInBytes;
+    Clear();
+}
+
+
+void D3D12DescriptorCopyBatcher::Record(U64 SrcAddress, U64 DstAddress, U32 NumDescriptors)
+{
+    if (NumDescriptors == 0)
+    {
+        return;
+    }
+    m_Pending.push_back({ SrcAddress, DstAddress, NumDescriptors });
+    m_Statistics.NumRecordedCopies += 1;
+    m_Statistics.NumDescriptors += NumDescriptors;
+}
+
+
+const std::vector<DescriptorCopyRun>& D3D12DescriptorCopyBatcher::Coalesce()
+{
+    m_Runs = m_Pending;
+    m_HasOverlap = false;
+    if (m_Runs.empty())
+    {
+        return m_Runs;
+    }
+
+    std::sort(m_Runs.begin(), m_Runs.end(),
+        [] (const DescriptorCopyRun& A, const DescriptorCopyRun& B) -> bool
+        {
+            return A.DstAddress < B.DstAddress;
+        });
+
+    U32 NumMerged = 0;
+    for (U32 I = 1; I < m_Runs.size(); ++I)
+    {
+        DescriptorCopyRun& Last = m_Runs[NumMerged];
+        const DescriptorCopyRun& Run = m_Runs[I];
+        U64 RunBytes = static_cast<U64>(Last.NumDescriptors) * m_DescriptorSizeInBytes;
+        if (Run.DstAddress < Last.DstAddress + RunBytes)
+        {
+            m_HasOverlap = true;
+            break;
+        }
+        if (Run.DstAddress == Last.DstAddress + RunBytes && Run.SrcAddress == Last.SrcAddress + RunBytes)
+        {
+            Last.NumDescriptors += Run.NumDescriptors;
+        }
+        else
+        {
+            m_Runs[++NumMerged] = Run;
+        }
+    }
+
+    if (m_HasOverlap)
+    {
+        // Sorting would lose which write came last, keep record order.
+        m_Runs = m_Pending;
+        return m_Runs;
+    }
+
+    m_Runs.resize(NumMerged + 1);
+    return m_Runs;
+}
+
+
+ResultCode D3D12DescriptorCopyBatcher::Flush(ID3D12Device* PDevice)
+{
+    if (m_Pending.empty())
+    {
+        return SResult_OK;
+    }
+
+    Coalesce();
+    m_Statistics.NumRuns += m_Runs.size();
+
+    if (m_HasOverlap)
+    {
+        for (const DescriptorCopyRun& Run : m_Runs)
+        {
+            D3D12_CPU_DESCRIPTOR_HANDLE Src = { static_cast<SIZE_T>(Run.SrcAddress) };
+            D3D12_CPU_DESCRIPTOR_HANDLE Dst = { static_cast<SIZE_T>(Run.DstAddress) };
+            PDevice->CopyDescriptorsSimple(Run.NumDescriptors, Dst, Src, m_HeapType);
+        }
+        m_Statistics.NumIssuedCalls += m_Runs.size();
+        m_Statistics.NumOverlappingFlushes += 1;
+    }
+    else
+    {
+        m_DstStarts.resize(m_Runs.size());
+        m_SrcStarts.resize(m_Runs.size());
+        m_RangeSizes.resize(m_Runs.size());
+        for (U32 I = 0; I < m_Runs.size(); ++I)
+        {
+            m_DstStarts[I].ptr = static_cast<SIZE_T>(m_Runs[I].DstAddress);
+            m_SrcStarts[I].ptr = static_cast<SIZE_T>(m_Runs[I].SrcAddress);
+            m_RangeSizes[I] = m_Runs[I].NumDescriptors;
+        }
+        // Source and destination ranges match one to one, so the same sizes serve both.
+        UINT NumRanges = static_cast<UINT>(m_Runs.size());
+        PDevice->CopyDescriptors(NumRanges, m_DstStarts.data(), m_RangeSizes.data(),
+                                 NumRanges, m_SrcStarts.data(), m_RangeSizes.data(), m_HeapType);
+        m_Statistics.NumIssuedCalls += 1;
+    }
+
+    Clear();
+    return SResult_OK;
+}
+
+
+void D3D12DescriptorCopyBatcher::Clear()
+{
+    m_Pending.clear();
+    m_Runs.clear();
+}
+} // Synthe
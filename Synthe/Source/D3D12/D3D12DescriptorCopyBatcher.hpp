@@ -0,0 +1,114 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Win32Common.hpp"
+#include "Common/Types.hpp"
+
+#include <vector>
+
+
+namespace Synthe {
+
+
+//! A run of consecutive descriptors to copy, addresses are CPU descriptor handle values.
+struct DescriptorCopyRun
+{
+    U64 SrcAddress;
+    U64 DstAddress;
+    U32 NumDescriptors;
+};
+
+
+//! Counters of a descriptor copy batcher, accumulated until ResetStatistics().
+struct DescriptorCopyStatistics
+{
+    //! Copies recorded, each would have been its own CopyDescriptorsSimple() call.
+    U64 NumRecordedCopies;
+
+    //! Descriptors copied.
+    U64 NumDescriptors;
+
+    //! Runs left after coalescing, these are the ranges handed to the device.
+    U64 NumRuns;
+
+    //! Device copy calls actually made.
+    U64 NumIssuedCalls;
+
+    //! Flushes that had overlapping destinations, and were copied in record order instead.
+    U64 NumOverlappingFlushes;
+};
+
+
+//! Gathers descriptor copies of one heap type, and issues them all at once on Flush(). Copies are
+//! sorted by destination, and neighbouring copies whose sources and destinations are both contiguous
+//! are merged into one run. All runs then go to the device in a single CopyDescriptors() call.
+//!
+//! The sort and merge in Coalesce() only work on addresses, so it can be exercised without a device.
+//! Sources must stay valid until the batch is flushed. If two copies write the same destination, the
+//! batch is instead copied in record order, one call per run, so the last recorded copy wins.
+class D3D12DescriptorCopyBatcher
+{
+public:
+    D3D12DescriptorCopyBatcher()
+        : m_DescriptorSizeInBytes(0)
+        , m_HeapType(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV)
+        , m_HasOverlap(false)
+        , m_Statistics() { }
+
+    //! Initialize the batcher.
+    //!
+    //! \param HeapType The descriptor heap type of all copies in this batch.
+    //! \param DescriptorSizeInBytes The handle increment size of the heap type.
+    void Initialize(D3D12_DESCRIPTOR_HEAP_TYPE HeapType, U64 DescriptorSizeInBytes);
+
+    //! Record a copy of consecutive descriptors.
+    //!
+    //! \param SrcAddress The first source handle.
+    //! \param DstAddress The first destination handle.
+    //! \param NumDescriptors The number of descriptors, records of 0 are ignored.
+    void Record(U64 SrcAddress, U64 DstAddress, U32 NumDescriptors);
+
+    //! Sort and merge the recorded copies. Called by Flush(), exposed so the batching can be checked
+    //! without a device.
+    //!
+    //! \return The merged runs, valid until the next Record(), Coalesce() or Clear().
+    const std::vector<DescriptorCopyRun>& Coalesce();
+
+    //! Issue all recorded copies, then clear the batch.
+    //!
+    //! \param PDevice The native device.
+    //! \return SResult_OK.
+    ResultCode Flush(ID3D12Device* PDevice);
+
+    //! Drop all recorded copies without issuing them.
+    void Clear();
+
+    //! Number of recorded copies not yet flushed.
+    U32 GetNumPendingCopies() const { return static_cast<U32>(m_Pending.size()); }
+
+    //! Whether the last Coalesce() found overlapping destinations.
+    B32 HasOverlap() const { return m_HasOverlap; }
+
+    const DescriptorCopyStatistics& GetStatistics() const { return m_Statistics; }
+    void ResetStatistics() { m_Statistics = DescriptorCopyStatistics(); }
+
+private:
+    U64                                         m_DescriptorSizeInBytes;
+    D3D12_DESCRIPTOR_HEAP_TYPE                  m_HeapType;
+    B32                                         m_HasOverlap;
+    DescriptorCopyStatistics                    m_Statistics;
+
+    //! Copies in record order.
+    std::vector<DescriptorCopyRun>              m_Pending;
+
+    //! Output of Coalesce().
+    std::vector<DescriptorCopyRun>              m_Runs;
+
+    //! Scratch arrays handed to CopyDescriptors(), kept around to avoid reallocating every flush.
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE>    m_DstStarts;
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE>    m_SrcStarts;
+    std::vector<UINT>                           m_RangeSizes;
+};
+} // Synthe
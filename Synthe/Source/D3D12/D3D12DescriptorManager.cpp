@@ -83,13 +83,24 @@ ResultCode D3D12DescriptorManager::DestroyDescriptorPoolsAtKey(DescriptorKeyID K
 }
 
 
+void D3D12DescriptorManager::RetireFrame(U64 CompletedFrame)
+{
+    for (auto& Pools : DescriptorPoolCache)
+    {
+        for (DescriptorPool& Pool : Pools.second)
+        {
+            Pool.RetireFrame(CompletedFrame);
+        }
+    }
+}
+
+
 DescriptorPool::DescriptorPool()
     : m_DescriptorHeap(nullptr)
-    , m_LastCpuHandle({0})
-    , m_LastGpuHandle({0})
     , m_AlignmentSizeInBytes(0)
     , m_DescriptorHeapType(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV)
     , m_TotalDescriptorHeapSizeInBytes(0)
+    , m_CurrentNumberOfDescriptors(0)
 {
 }
 
@@ -112,15 +123,80 @@ ResultCode DescriptorPool::Create(ID3D12Device* PDevice, D3D12_DESCRIPTOR_HEAP_T
     {
         return GResult_DEVICE_CREATION_FAILURE;
     }
-    m_LastCpuHandle = m_DescriptorHeap->GetCPUDescriptorHandleForHeapStart();
-    m_LastGpuHandle = m_DescriptorHeap->GetGPUDescriptorHandleForHeapStart();
     m_AlignmentSizeInBytes = PDevice->GetDescriptorHandleIncrementSize(Type);
     m_TotalDescriptorHeapSizeInBytes = m_AlignmentSizeInBytes * NumDescriptors;
     m_DescriptorHeapType = Type;
+    m_CurrentNumberOfDescriptors = 0;
+    m_Allocator.Initialize(0ULL, m_TotalDescriptorHeapSizeInBytes);
     return SResult_OK;
 }
 
 
+B32 DescriptorPool::Contains(D3D12_CPU_DESCRIPTOR_HANDLE Handle) const
+{
+    if (!m_DescriptorHeap)
+    {
+        return false;
+    }
+    SIZE_T Base = GetBaseCPUAddress().ptr;
+    return (Handle.ptr >= Base) && (Handle.ptr < Base + m_TotalDescriptorHeapSizeInBytes);
+}
+
+
+D3D12_CPU_DESCRIPTOR_HANDLE DescriptorPool::AllocateDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE LocationInDescriptorHeap)
+{
+    if (LocationInDescriptorHeap.ptr != ADDRESS_SZ_MAX)
+    {
+        // Caller manages this slot.
+        return LocationInDescriptorHeap;
+    }
+
+    D3D12_CPU_DESCRIPTOR_HANDLE Handle = { 0 };
+    AllocationBlock Block = { };
+    if (m_Allocator.Allocate(&Block, m_AlignmentSizeInBytes, m_AlignmentSizeInBytes) != SResult_OK)
+    {
+        return Handle;
+    }
+    Handle = GetCPUAddressWithByteOffset(Block.StartAddress);
+    m_CurrentNumberOfDescriptors += 1;
+    return Handle;
+}
+
+
+ResultCode DescriptorPool::FreeDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE Handle, U64 RetireFrame)
+{
+    if (!Contains(Handle))
+    {
+        return SResult_OUT_OF_BOUNDS;
+    }
+    AllocationBlock Block = { };
+    Block.StartAddress = Handle.ptr - GetBaseCPUAddress().ptr;
+    Block.SizeInBytes = m_AlignmentSizeInBytes;
+    m_CurrentNumberOfDescriptors -= 1;
+    return m_Allocator.DeferFree(Block, RetireFrame);
+}
+
+
+ResultCode DescriptorPool::FreeDescriptorTable(const DescriptorTable& Table, U64 RetireFrame)
+{
+    if (Table.TableSizeInBytes == 0ULL || !Contains(Table.StartingAddress))
+    {
+        return SResult_OUT_OF_BOUNDS;
+    }
+    AllocationBlock Block = { };
+    Block.StartAddress = Table.StartingAddress.ptr - GetBaseCPUAddress().ptr;
+    Block.SizeInBytes = Table.TableSizeInBytes;
+    m_CurrentNumberOfDescriptors -= static_cast<UINT>(Table.TableSizeInBytes / m_AlignmentSizeInBytes);
+    return m_Allocator.DeferFree(Block, RetireFrame);
+}
+
+
+void DescriptorPool::RetireFrame(U64 CompletedFrame)
+{
+    m_Allocator.Retire(CompletedFrame);
+}
+
+
 D3D12_GPU_DESCRIPTOR_HANDLE DescriptorPool::GetGPUAddressFromCPUAddress(D3D12_CPU_DESCRIPTOR_HANDLE Handle)
 {
     D3D12_CPU_DESCRIPTOR_HANDLE CPUHandle = GetBaseCPUAddress();
@@ -147,6 +223,20 @@ D3D12_CPU_DESCRIPTOR_HANDLE DescriptorPool::GetCPUAddressFromGPUAddress(D3D12_GP
 }
 
 
+D3D12_CPU_DESCRIPTOR_HANDLE DescriptorPool::GetCPUAddressWithDescriptorCount(UINT DescriptorCountOffset)
+{
+    return GetCPUAddressWithByteOffset(static_cast<UINT64>(DescriptorCountOffset) * m_AlignmentSizeInBytes);
+}
+
+
+D3D12_CPU_DESCRIPTOR_HANDLE DescriptorPool::GetCPUAddressWithByteOffset(UINT64 OffsetInBytes)
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE Handle = GetBaseCPUAddress();
+    Handle.ptr += static_cast<SIZE_T>(OffsetInBytes);
+    return Handle;
+}
+
+
 ResultCode DescriptorPool::Release()
 {
     if (m_DescriptorHeap)
@@ -161,14 +251,12 @@ D3D12_CPU_DESCRIPTOR_HANDLE DescriptorPool::CreateSrv(ID3D12Device* PDevice,
                                                       ID3D12Resource* PResource,
                                                       D3D12_CPU_DESCRIPTOR_HANDLE LocationInDescriptorHeap)
 {
-    D3D12_CPU_DESCRIPTOR_HANDLE Handle = LocationInDescriptorHeap;
-    if (Handle.ptr == ADDRESS_SZ_MAX) 
+    D3D12_CPU_DESCRIPTOR_HANDLE Handle = AllocateDescriptor(LocationInDescriptorHeap);
+    if (!Handle.ptr)
     {
-        Handle = m_LastCpuHandle;
-        m_LastCpuHandle.ptr += m_AlignmentSizeInBytes;
+        return Handle;
     }
     PDevice->CreateShaderResourceView(PResource, &Info, Handle);
-    m_CurrentNumberOfDescriptors += 1;
     return Handle;
 }
 
@@ -178,14 +266,12 @@ D3D12_CPU_DESCRIPTOR_HANDLE DescriptorPool::CreateDsv(ID3D12Device* PDevice,
                                                       ID3D12Resource* PResource,
                                                       D3D12_CPU_DESCRIPTOR_HANDLE LocationInDescriptorHeap)
 {
-    D3D12_CPU_DESCRIPTOR_HANDLE Handle = LocationInDescriptorHeap;
-    if (Handle.ptr == ADDRESS_SZ_MAX) 
+    D3D12_CPU_DESCRIPTOR_HANDLE Handle = AllocateDescriptor(LocationInDescriptorHeap);
+    if (!Handle.ptr)
     {
-        Handle = m_LastCpuHandle;
-        m_LastCpuHandle.ptr += m_AlignmentSizeInBytes;
+        return Handle;
     }
     PDevice->CreateDepthStencilView(PResource, &Info, Handle);
-    m_CurrentNumberOfDescriptors += 1;
     return Handle;
 }
 
@@ -195,14 +281,12 @@ D3D12_CPU_DESCRIPTOR_HANDLE DescriptorPool::CreateRtv(ID3D12Device* PDevice,
                                                       ID3D12Resource* PResource,
                                                       D3D12_CPU_DESCRIPTOR_HANDLE LocationInDescriptorHeap)
 {
-    D3D12_CPU_DESCRIPTOR_HANDLE Handle = LocationInDescriptorHeap;
-    if (Handle.ptr == ADDRESS_SZ_MAX) 
+    D3D12_CPU_DESCRIPTOR_HANDLE Handle = AllocateDescriptor(LocationInDescriptorHeap);
+    if (!Handle.ptr)
     {
-        Handle = m_LastCpuHandle;
-        m_LastCpuHandle.ptr += m_AlignmentSizeInBytes;
+        return Handle;
     }
     PDevice->CreateRenderTargetView(PResource, &Info, Handle);
-    m_CurrentNumberOfDescriptors += 1;
     return Handle;
 }
 
@@ -211,14 +295,12 @@ D3D12_CPU_DESCRIPTOR_HANDLE DescriptorPool::CreateCbv(ID3D12Device* PDevice,
                                                       D3D12_CONSTANT_BUFFER_VIEW_DESC& Info,
                                                       D3D12_CPU_DESCRIPTOR_HANDLE LocationInDescriptorHeap)
 {
-    D3D12_CPU_DESCRIPTOR_HANDLE Handle = LocationInDescriptorHeap;
-    if (Handle.ptr == ADDRESS_SZ_MAX) 
+    D3D12_CPU_DESCRIPTOR_HANDLE Handle = AllocateDescriptor(LocationInDescriptorHeap);
+    if (!Handle.ptr)
     {
-        Handle = m_LastCpuHandle;
-        m_LastCpuHandle.ptr += m_AlignmentSizeInBytes;
+        return Handle;
     }
     PDevice->CreateConstantBufferView(&Info, Handle);
-    m_CurrentNumberOfDescriptors += 1;
     return Handle;
 }
 
@@ -229,14 +311,12 @@ D3D12_CPU_DESCRIPTOR_HANDLE DescriptorPool::CreateUav(ID3D12Device* PDevice,
                                                       ID3D12Resource* PResource,
                                                       D3D12_CPU_DESCRIPTOR_HANDLE LocationInDescriptorHeap)
 {
-    D3D12_CPU_DESCRIPTOR_HANDLE Handle = LocationInDescriptorHeap;
-    if (Handle.ptr == ADDRESS_SZ_MAX) 
+    D3D12_CPU_DESCRIPTOR_HANDLE Handle = AllocateDescriptor(LocationInDescriptorHeap);
+    if (!Handle.ptr)
     {
-        Handle = m_LastCpuHandle;
-        m_LastCpuHandle.ptr += m_AlignmentSizeInBytes;
+        return Handle;
     }
     PDevice->CreateUnorderedAccessView(PResource, PCounterResource, &Info, Handle);
-    m_CurrentNumberOfDescriptors += 1;
     return Handle;
 }
 
@@ -245,14 +325,12 @@ D3D12_CPU_DESCRIPTOR_HANDLE DescriptorPool::CreateSampler(ID3D12Device* PDevice,
                                                           D3D12_SAMPLER_DESC& Info,
                                                           D3D12_CPU_DESCRIPTOR_HANDLE LocationInDescriptorHeap)
 {
-    D3D12_CPU_DESCRIPTOR_HANDLE Handle = LocationInDescriptorHeap;
-    if (Handle.ptr == ADDRESS_SZ_MAX) 
+    D3D12_CPU_DESCRIPTOR_HANDLE Handle = AllocateDescriptor(LocationInDescriptorHeap);
+    if (!Handle.ptr)
     {
-        Handle = m_LastCpuHandle;
-        m_LastCpuHandle.ptr += m_AlignmentSizeInBytes;
+        return Handle;
     }
     PDevice->CreateSampler(&Info, Handle);
-    m_CurrentNumberOfDescriptors += 1;
     return Handle;
 }
 
@@ -273,13 +351,16 @@ ResultCode DescriptorPool::CopyDescriptorsRange(ID3D12Device* PDevice,
                                              D3D12_CPU_DESCRIPTOR_HANDLE* PSrcDescriptorHandles,
                                              D3D12_CPU_DESCRIPTOR_HANDLE DstDescriptorLocation)
 { 
-    for (U32 I = 0; I < NumSrcDescriptors; ++I)     
+    if (NumSrcDescriptors == 0)
     {
-        // Each individual descriptor handle is copied, this is not the best efficiency, but 
-        // if each descriptor handle is not consecutive, we will need to copy individually.
-        CopyDescriptorsRangeConsecutive(PDevice, PSrcDescriptorHandles[I], 1, 
-                                      { DstDescriptorLocation.ptr + static_cast<U64>(I * m_AlignmentSizeInBytes) });
+        return SResult_REFUSE_CALL;
     }
+    // Sources are scattered, each is a range of one, all landing in a single destination range.
+    std::vector<UINT> SrcSizes(NumSrcDescriptors, 1);
+    UINT DstSize = NumSrcDescriptors;
+    PDevice->CopyDescriptors(1, &DstDescriptorLocation, &DstSize, 
+                             NumSrcDescriptors, PSrcDescriptorHandles, SrcSizes.data(), 
+                             m_DescriptorHeapType);
     return SResult_OK;
 }
 
@@ -305,25 +386,18 @@ ResultCode DescriptorPool::CopyDescriptorRanges(ID3D12Device* PDevice,
                                                 D3D12_CPU_DESCRIPTOR_HANDLE* DstDescriptorLocations,
                                                 U32* NumDstDescriptorSizes)
 {
-    static D3D12_CPU_DESCRIPTOR_HANDLE DstCPUHandles[128];
-    static U32 DstCPUSizes[128];
-    static U32 SrcCPUSizes[128];
-    U32 NumDstDescriptorRanges = 0;
-
-    for (U32 I = 0; I < NumSrcDescriptorStarts; ++I)
+    if (NumSrcDescriptorStarts == 0)
     {
-        U64 SizeInBytes = static_cast<U64>(NumDstDescriptorSizes[I]);
-        D3D12_CPU_DESCRIPTOR_HANDLE PoolCPUAddressOffset = DstDescriptorLocations[I];
-        DstCPUHandles[I] = DstDescriptorLocations[I];
-        DstCPUSizes[I] = static_cast<U32>(SizeInBytes);
+        return SResult_REFUSE_CALL;
     }
-    
-    PDevice->CopyDescriptors(NumDstDescriptorRanges, 
-                             DstCPUHandles, 
-                             DstCPUSizes, 
+
+    // Each source range has a matching destination range.
+    PDevice->CopyDescriptors(NumSrcDescriptorStarts, 
+                             DstDescriptorLocations, 
+                             NumDstDescriptorSizes, 
                              NumSrcDescriptorStarts, 
                              PSrcDescriptorHandleStarts, 
-                             SrcCPUSizes,     
+                             PSrcDescriptorHandleCounts,     
                              m_DescriptorHeapType);
     
     return SResult_OK;
@@ -336,23 +410,20 @@ ResultCode DescriptorPool::AllocateDescriptorTable(DescriptorTable* OutTable, U6
     {
         return SResult_INVALID_ARGS;
     }
-    U64 PotentialLocation = m_LastCpuHandle.ptr + SizeInBytes;
-    if (PotentialLocation >= m_TotalDescriptorHeapSizeInBytes)
-    {
-        return SResult_OUT_OF_MEMORY;
-    }
-
     if (!OutTable)
     {
         return SResult_MEMORY_NULL_EXCEPTION;
     }    
 
-    OutTable->StartingAddress = m_LastCpuHandle;
-    OutTable->TableSizeInBytes = SizeInBytes;
+    AllocationBlock Block = { };
+    if (m_Allocator.Allocate(&Block, SizeInBytes, m_AlignmentSizeInBytes) != SResult_OK)
+    {
+        return SResult_OUT_OF_MEMORY;
+    }
 
-    m_LastGpuHandle.ptr += SizeInBytes;
-    m_LastCpuHandle.ptr = PotentialLocation;
-    m_CurrentNumberOfDescriptors += SizeInBytes / m_AlignmentSizeInBytes;
+    OutTable->StartingAddress = GetCPUAddressWithByteOffset(Block.StartAddress);
+    OutTable->TableSizeInBytes = Block.SizeInBytes;
+    m_CurrentNumberOfDescriptors += static_cast<UINT>(Block.SizeInBytes / m_AlignmentSizeInBytes);
     return SResult_OK;
 }
 } // Synthe 
\ No newline at end of file
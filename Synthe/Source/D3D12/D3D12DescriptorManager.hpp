@@ -5,6 +5,7 @@
 
 #include "Win32Common.hpp"
 #include "Common/Memory/Allocator.hpp"
+#include "Common/Memory/RangeAllocator.hpp"
 
 #include <unordered_map>
 
@@ -70,6 +71,26 @@ public:
     //! \return SResult_OK if the call succeeds.
     ResultCode AllocateDescriptorTable(DescriptorTable* OutTable, U64 SizeInBytes);
 
+    //! Free a descriptor table. The range is only made available again once RetireFrame is retired.
+    //!
+    //! \param Table The table to free.
+    //! \param RetireFrame The last frame that may still reference the table on the GPU.
+    //! \return SResult_OK if the call succeeds.
+    ResultCode FreeDescriptorTable(const DescriptorTable& Table, U64 RetireFrame);
+
+    //! Free a single descriptor created by any of the Create*() calls, (Srv, Rtv, Dsv, Cbv, Uav, Sampler.)
+    //! The slot is only made available again once RetireFrame is retired.
+    //!
+    //! \param Handle The descriptor to free.
+    //! \param RetireFrame The last frame that may still reference the descriptor on the GPU.
+    //! \return SResult_OK if the call succeeds. SResult_OUT_OF_BOUNDS if the handle is not in this pool.
+    ResultCode FreeDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE Handle, U64 RetireFrame);
+
+    //! Release all deferred frees up to, and including, the completed frame.
+    //!
+    //! \param CompletedFrame The last frame the GPU is known to have finished.
+    void RetireFrame(U64 CompletedFrame);
+
     //! Create a Shader Resource View from this descriptor pool.
     //!
     //! \param PDevice
@@ -191,7 +212,7 @@ public:
     //! \param PSrcDescriptorHandleStarts
     //! \param PSrcDescriptorHandleSizes
     //! \param NumDstOffsetsInDescriptorCount
-    //! \param NumDstDescriptorSizes Total size in bytes of the dst descriptors (the count) corresponding to 
+    //! \param NumDstDescriptorSizes Number of descriptors in each destination range, corresponding to the
     //!                              array of DstDescriptorLocations.
     //! \return The resulting code.
     ResultCode CopyDescriptorRanges(ID3D12Device* PDevice,
@@ -211,8 +232,13 @@ public:
     //! \return The base GPU address of the descriptor pool.
     D3D12_GPU_DESCRIPTOR_HANDLE GetBaseGPUAddress() const { return m_DescriptorHeap->GetGPUDescriptorHandleForHeapStart(); }
 
-    //! Reset the pool entirely. This sets our last available handles back to the beginning.
-    void ResetPool() { m_LastCpuHandle = GetBaseCPUAddress(); m_LastGpuHandle = GetBaseGPUAddress(); }
+    //! Get the native descriptor heap, used when binding shader visible heaps to a command list.
+    //!
+    //! \return The native descriptor heap.
+    ID3D12DescriptorHeap* GetNativeHeap() const { return m_DescriptorHeap; }
+
+    //! Reset the pool entirely. This invalidates all descriptors, and pending frees, in this pool.
+    void ResetPool() { m_Allocator.Reset(); m_CurrentNumberOfDescriptors = 0; }
 
     //! Get the GPU Handle address from the corresponding CPU handle address. Returns the base address
     //! if no possible to find the given Input CPU handle.
@@ -250,15 +276,23 @@ public:
     //! \return The alignment size in bytes.
     U64 GetAlignmentSizeInBytes() const { return static_cast<U64>(m_AlignmentSizeInBytes); }
 
+    //! Check if the cpu handle is located within this descriptor pool.
+    B32 Contains(D3D12_CPU_DESCRIPTOR_HANDLE Handle) const;
+
 private:
+    //! Allocate a descriptor slot, or use the location if one is given.
+    //!
+    //! \param LocationInDescriptorHeap The location requested by the caller, BASE_CPU_DESCRIPTOR_ALLOC 
+    //!                                 if none.
+    //! \return The handle, or a null handle if the pool is full.
+    D3D12_CPU_DESCRIPTOR_HANDLE AllocateDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE LocationInDescriptorHeap);
+
     //! Descriptor heap handle from native context.
     ID3D12DescriptorHeap* m_DescriptorHeap;
 
-    //! The last cpu handle that is empty.
-    D3D12_CPU_DESCRIPTOR_HANDLE m_LastCpuHandle;
-
-    //! The corresponding last gpu handle in this descriptor pool.
-    D3D12_GPU_DESCRIPTOR_HANDLE m_LastGpuHandle;
+    //! Allocator of descriptor ranges, in byte offsets from the base of the heap. Freed ranges are
+    //! merged with their free neighbours once the frame that last could reference them is retired.
+    RangeAllocator m_Allocator;
 
     //! Alingment size of the 
     UINT m_AlignmentSizeInBytes;
@@ -300,6 +334,11 @@ public:
     //! \return GResult_OK if the descriptor pools at location Key were successfully destroyed.
     static ResultCode DestroyDescriptorPoolsAtKey(DescriptorKeyID Key);
 
+    //! Retire deferred descriptor frees of all registered pools.
+    //!
+    //! \param CompletedFrame The last frame the GPU is known to have finished.
+    static void RetireFrame(U64 CompletedFrame);
+
     //! 
     static ResultCode CacheDescriptorToResource(GPUHandle Descriptor, GPUHandle Resource);
 
@@ -0,0 +1,471 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "D3D12DescriptorTableCache.hpp"
+#include "D3D12GraphicsDevice.hpp"
+#include "Common/Hash.hpp"
+#include "Common/Memory/Allocator.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+namespace Synthe {
+
+static std::unordered_map<DescriptorTableKey, D3D12DescriptorTableEntry*, DescriptorTableKeyHasher> DescriptorTables;
+static std::vector<D3D12DescriptorTableEntry*> DirtyDescriptorTables;
+static std::vector<D3D12DescriptorTableEntry*> UnusedDescriptorTables;
+// Tables in the cache holding each view, to drop them when the view's descriptor is freed.
+static std::unordered_map<GPUHandle, std::vector<D3D12DescriptorTableEntry*>> DescriptorTablesOfView;
+static DescriptorTableCacheStatistics DescriptorTableStatistics = { };
+static U32 DescriptorTableNumBuffers = 1;
+
+// Writes of new tables into the staging heaps, then copies from staging into shader visible heaps.
+static D3D12DescriptorCopyBatcher StagingCopies;
+static D3D12DescriptorCopyBatcher StagingSamplerCopies;
+static D3D12DescriptorCopyBatcher ShaderVisibleCopies;
+static D3D12DescriptorCopyBatcher ShaderVisibleSamplerCopies;
+static DescriptorCopyStatistics LastFrameCopyStatistics = { };
+
+
+void DescriptorTableKey::UpdateHash()
+{
+    U32 Counts[4] = { NumSrvs, NumCbvs, NumUavs, NumSamplers };
+    Hash = HashBytes(Counts, sizeof(Counts));
+    Hash = HashBytes(Handles.data(), Handles.size() * sizeof(GPUHandle), Hash);
+}
+
+
+static void PushToList(std::vector<D3D12DescriptorTableEntry*>& List,
+                       D3D12DescriptorTableEntry* PEntry,
+                       U32 D3D12DescriptorTableEntry::*Index)
+{
+    if (PEntry->*Index != D3D12DescriptorTableEntry::k_NotListed)
+    {
+        return;
+    }
+    PEntry->*Index = static_cast<U32>(List.size());
+    List.push_back(PEntry);
+}
+
+
+static void RemoveFromList(std::vector<D3D12DescriptorTableEntry*>& List,
+                           D3D12DescriptorTableEntry* PEntry,
+                           U32 D3D12DescriptorTableEntry::*Index)
+{
+    U32 Position = PEntry->*Index;
+    if (Position == D3D12DescriptorTableEntry::k_NotListed)
+    {
+        return;
+    }
+    D3D12DescriptorTableEntry* PLast = List.back();
+    List[Position] = PLast;
+    PLast->*Index = Position;
+    List.pop_back();
+    PEntry->*Index = D3D12DescriptorTableEntry::k_NotListed;
+}
+
+
+static void FreeEntryTables(D3D12DescriptorTableEntry* PEntry, U64 RetireFrame)
+{
+    if (PEntry->TableUpload.TableSizeInBytes)
+    {
+        D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_CBV_SRV_UAV_UPLOAD)
+            ->FreeDescriptorTable(PEntry->TableUpload, RetireFrame);
+    }
+    if (PEntry->SamplerTableUpload.TableSizeInBytes)
+    {
+        D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_SAMPLER_UPLOAD)
+            ->FreeDescriptorTable(PEntry->SamplerTableUpload, RetireFrame);
+    }
+    for (U32 I = 0; I < PEntry->GPUTables.size(); ++I)
+    {
+        if (PEntry->GPUTables[I].TableSizeInBytes)
+        {
+            D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_CBV_SRV_UAV, I)
+                ->FreeDescriptorTable(PEntry->GPUTables[I], RetireFrame);
+        }
+        if (PEntry->GPUSamplerTables[I].TableSizeInBytes)
+        {
+            D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_SAMPLER, I)
+                ->FreeDescriptorTable(PEntry->GPUSamplerTables[I], RetireFrame);
+        }
+    }
+}
+
+
+//! Index the table under each view it holds.
+static void LinkViews(D3D12DescriptorTableEntry* PEntry)
+{
+    for (GPUHandle Handle : PEntry->Key.Handles)
+    {
+        if (!Handle)
+        {
+            continue;
+        }
+        std::vector<D3D12DescriptorTableEntry*>& Tables = DescriptorTablesOfView[Handle];
+        // A view bound to several slots of the table is indexed once.
+        if (Tables.empty() || Tables.back() != PEntry)
+        {
+            Tables.push_back(PEntry);
+        }
+    }
+}
+
+
+static void UnlinkViews(D3D12DescriptorTableEntry* PEntry)
+{
+    for (GPUHandle Handle : PEntry->Key.Handles)
+    {
+        auto Iter = DescriptorTablesOfView.find(Handle);
+        if (Iter == DescriptorTablesOfView.end())
+        {
+            continue;
+        }
+        std::vector<D3D12DescriptorTableEntry*>& Tables = Iter->second;
+        for (U32 I = 0; I < Tables.size(); ++I)
+        {
+            if (Tables[I] == PEntry)
+            {
+                Tables[I] = Tables.back();
+                Tables.pop_back();
+                break;
+            }
+        }
+        if (Tables.empty())
+        {
+            DescriptorTablesOfView.erase(Iter);
+        }
+    }
+}
+
+
+//! Free a table no longer in the cache map, nor referenced.
+static void DestroyEntry(D3D12DescriptorTableEntry* PEntry, U64 RetireFrame)
+{
+    RemoveFromList(UnusedDescriptorTables, PEntry, &D3D12DescriptorTableEntry::UnusedListIndex);
+    RemoveFromList(DirtyDescriptorTables, PEntry, &D3D12DescriptorTableEntry::DirtyListIndex);
+    FreeEntryTables(PEntry, RetireFrame);
+    Free<D3D12DescriptorTableEntry>(PEntry);
+    DescriptorTableStatistics.NumLiveTables -= 1;
+}
+
+
+static ResultCode AllocateTables(DescriptorHeapType UploadType,
+                                 DescriptorHeapType ShaderVisibleType,
+                                 U32 NumDescriptors,
+                                 DescriptorTable* PUploadTable,
+                                 std::vector<DescriptorTable>& GPUTables)
+{
+    if (NumDescriptors == 0)
+    {
+        return SResult_OK;
+    }
+    DescriptorPool* UploadPool = D3D12DescriptorManager::GetDescriptorPool(UploadType);
+    U64 TableSizeInBytes = static_cast<U64>(NumDescriptors) * UploadPool->GetAlignmentSizeInBytes();
+    ResultCode Result = UploadPool->AllocateDescriptorTable(PUploadTable, TableSizeInBytes);
+    for (U32 I = 0; I < GPUTables.size() && Result == SResult_OK; ++I)
+    {
+        Result = D3D12DescriptorManager::GetDescriptorPool(ShaderVisibleType, I)
+            ->AllocateDescriptorTable(&GPUTables[I], TableSizeInBytes);
+    }
+    return Result;
+}
+
+
+static void WriteStagingTable(D3D12DescriptorCopyBatcher& Batcher,
+                              DescriptorHeapType UploadType,
+                              const GPUHandle* PHandles,
+                              U32 NumHandles,
+                              const DescriptorTable& Table)
+{
+    U64 Alignment = D3D12DescriptorManager::GetDescriptorPool(UploadType)->GetAlignmentSizeInBytes();
+    for (U32 I = 0; I < NumHandles; ++I)
+    {
+        if (!PHandles[I])
+        {
+            continue;
+        }
+        Batcher.Record(PHandles[I], Table.StartingAddress.ptr + I * Alignment, 1);
+    }
+}
+
+
+static void AccumulateCopyStatistics(DescriptorCopyStatistics& Total, D3D12DescriptorCopyBatcher& Batcher)
+{
+    const DescriptorCopyStatistics& Statistics = Batcher.GetStatistics();
+    Total.NumRecordedCopies += Statistics.NumRecordedCopies;
+    Total.NumDescriptors += Statistics.NumDescriptors;
+    Total.NumRuns += Statistics.NumRuns;
+    Total.NumIssuedCalls += Statistics.NumIssuedCalls;
+    Total.NumOverlappingFlushes += Statistics.NumOverlappingFlushes;
+    Batcher.ResetStatistics();
+}
+
+
+void D3D12DescriptorTableEntry::UploadToShaderVisibleHeap(D3D12DescriptorCopyBatcher& Batcher,
+                                                          D3D12DescriptorCopyBatcher& SamplerBatcher,
+                                                          U32 BufferIndex)
+{
+    U32 BufferBit = 1U << BufferIndex;
+    if (!(DirtyBufferMask & BufferBit))
+    {
+        return;
+    }
+
+    if (TableUpload.TableSizeInBytes)
+    {
+        U64 Alignment = D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_CBV_SRV_UAV, BufferIndex)
+            ->GetAlignmentSizeInBytes();
+        Batcher.Record(TableUpload.StartingAddress.ptr, GPUTables[BufferIndex].StartingAddress.ptr,
+            static_cast<U32>(TableUpload.TableSizeInBytes / Alignment));
+    }
+
+    if (SamplerTableUpload.TableSizeInBytes)
+    {
+        U64 Alignment = D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_SAMPLER, BufferIndex)
+            ->GetAlignmentSizeInBytes();
+        SamplerBatcher.Record(SamplerTableUpload.StartingAddress.ptr, GPUSamplerTables[BufferIndex].StartingAddress.ptr,
+            static_cast<U32>(SamplerTableUpload.TableSizeInBytes / Alignment));
+    }
+
+    DirtyBufferMask &= ~BufferBit;
+}
+
+
+D3D12_GPU_DESCRIPTOR_HANDLE D3D12DescriptorTableEntry::GetGPUTableAddress(U32 BufferIndex) const
+{
+    DescriptorPool* Pool = D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_CBV_SRV_UAV, BufferIndex);
+    return Pool->GetGPUAddressFromCPUAddress(GPUTables[BufferIndex].StartingAddress);
+}
+
+
+D3D12_GPU_DESCRIPTOR_HANDLE D3D12DescriptorTableEntry::GetGPUSamplerTableAddress(U32 BufferIndex) const
+{
+    DescriptorPool* Pool = D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_SAMPLER, BufferIndex);
+    return Pool->GetGPUAddressFromCPUAddress(GPUSamplerTables[BufferIndex].StartingAddress);
+}
+
+
+void D3D12DescriptorTableCache::Initialize(U32 NumBuffers)
+{
+    CleanUp();
+    DescriptorTableNumBuffers = NumBuffers;
+    StagingCopies.Initialize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 
+        D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_CBV_SRV_UAV_UPLOAD)->GetAlignmentSizeInBytes());
+    StagingSamplerCopies.Initialize(D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER,
+        D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_SAMPLER_UPLOAD)->GetAlignmentSizeInBytes());
+    ShaderVisibleCopies.Initialize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+        D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_CBV_SRV_UAV)->GetAlignmentSizeInBytes());
+    ShaderVisibleSamplerCopies.Initialize(D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER,
+        D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_SAMPLER)->GetAlignmentSizeInBytes());
+}
+
+
+void D3D12DescriptorTableCache::CleanUp()
+{
+    for (auto& Table : DescriptorTables)
+    {
+        Free<D3D12DescriptorTableEntry>(Table.second);
+    }
+    DescriptorTables.clear();
+    DirtyDescriptorTables.clear();
+    UnusedDescriptorTables.clear();
+    DescriptorTablesOfView.clear();
+    StagingCopies.Clear();
+    StagingSamplerCopies.Clear();
+    ShaderVisibleCopies.Clear();
+    ShaderVisibleSamplerCopies.Clear();
+    DescriptorTableStatistics.NumLiveTables = 0;
+}
+
+
+ResultCode D3D12DescriptorTableCache::Acquire(const DescriptorTableKey& Key,
+                                              U32 CurrentBufferIndex,
+                                              U64 CurrentFrame,
+                                              D3D12DescriptorTableEntry** OutEntry)
+{
+    auto Iter = DescriptorTables.find(Key);
+    if (Iter != DescriptorTables.end())
+    {
+        D3D12DescriptorTableEntry* PEntry = Iter->second;
+        RemoveFromList(UnusedDescriptorTables, PEntry, &D3D12DescriptorTableEntry::UnusedListIndex);
+        PEntry->RefCount += 1;
+        PEntry->LastUsedFrame = CurrentFrame;
+        DescriptorTableStatistics.NumHits += 1;
+        *OutEntry = PEntry;
+        return SResult_OK;
+    }
+
+    D3D12DescriptorTableEntry* PEntry = Malloc<D3D12DescriptorTableEntry>();
+    PEntry->Key = Key;
+    PEntry->GPUTables.resize(DescriptorTableNumBuffers);
+    PEntry->GPUSamplerTables.resize(DescriptorTableNumBuffers);
+
+    U32 NumDescriptors = Key.NumSrvs + Key.NumCbvs + Key.NumUavs;
+    ResultCode Result = AllocateTables(DescriptorHeapType_CBV_SRV_UAV_UPLOAD, DescriptorHeapType_CBV_SRV_UAV,
+        NumDescriptors, &PEntry->TableUpload, PEntry->GPUTables);
+    if (Result == SResult_OK)
+    {
+        Result = AllocateTables(DescriptorHeapType_SAMPLER_UPLOAD, DescriptorHeapType_SAMPLER,
+            Key.NumSamplers, &PEntry->SamplerTableUpload, PEntry->GPUSamplerTables);
+    }
+    if (Result != SResult_OK)
+    {
+        // Nothing has referenced these tables yet, they can go back right away.
+        FreeEntryTables(PEntry, 0ULL);
+        Free<D3D12DescriptorTableEntry>(PEntry);
+        return Result;
+    }
+
+    WriteStagingTable(StagingCopies, DescriptorHeapType_CBV_SRV_UAV_UPLOAD, Key.Handles.data(),
+        NumDescriptors, PEntry->TableUpload);
+    WriteStagingTable(StagingSamplerCopies, DescriptorHeapType_SAMPLER_UPLOAD, Key.Handles.data() + NumDescriptors,
+        Key.NumSamplers, PEntry->SamplerTableUpload);
+
+    // Current frame is written now, the others catch up when they begin.
+    PEntry->DirtyBufferMask = (DescriptorTableNumBuffers >= 32) ? 0xFFFFFFFF
+                                                                 : ((1U << DescriptorTableNumBuffers) - 1U);
+    PEntry->UploadToShaderVisibleHeap(ShaderVisibleCopies, ShaderVisibleSamplerCopies, CurrentBufferIndex);
+    if (PEntry->NeedsToBeFlushed())
+    {
+        PushToList(DirtyDescriptorTables, PEntry, &D3D12DescriptorTableEntry::DirtyListIndex);
+    }
+
+    PEntry->RefCount = 1;
+    PEntry->LastUsedFrame = CurrentFrame;
+    DescriptorTables[Key] = PEntry;
+    LinkViews(PEntry);
+    DescriptorTableStatistics.NumMisses += 1;
+    DescriptorTableStatistics.NumLiveTables += 1;
+    *OutEntry = PEntry;
+    return SResult_OK;
+}
+
+
+void D3D12DescriptorTableCache::Release(D3D12DescriptorTableEntry* PEntry, U64 CurrentFrame)
+{
+    if (!PEntry || PEntry->RefCount == 0)
+    {
+        return;
+    }
+    PEntry->RefCount -= 1;
+    PEntry->LastUsedFrame = CurrentFrame;
+    if (PEntry->RefCount != 0)
+    {
+        return;
+    }
+    if (PEntry->Detached)
+    {
+        DestroyEntry(PEntry, CurrentFrame);
+        return;
+    }
+    PushToList(UnusedDescriptorTables, PEntry, &D3D12DescriptorTableEntry::UnusedListIndex);
+}
+
+
+void D3D12DescriptorTableCache::InvalidateView(GPUHandle Handle, U64 CurrentFrame)
+{
+    auto Iter = DescriptorTablesOfView.find(Handle);
+    if (Iter == DescriptorTablesOfView.end())
+    {
+        return;
+    }
+    std::vector<D3D12DescriptorTableEntry*> Tables = std::move(Iter->second);
+    DescriptorTablesOfView.erase(Iter);
+    for (D3D12DescriptorTableEntry* PEntry : Tables)
+    {
+        // Out of the index of its other views too, so it is only dropped once.
+        UnlinkViews(PEntry);
+        DescriptorTables.erase(PEntry->Key);
+        DescriptorTableStatistics.NumInvalidations += 1;
+        if (PEntry->RefCount == 0)
+        {
+            DestroyEntry(PEntry, CurrentFrame);
+        }
+        else
+        {
+            PEntry->Detached = true;
+        }
+    }
+}
+
+
+void D3D12DescriptorTableCache::BeginFrame(ID3D12Device* PDevice, U32 BufferIndex, U64 CurrentFrame)
+{
+    // Copies left over from the previous frame count towards it.
+    FlushCopies(PDevice);
+    LastFrameCopyStatistics = DescriptorCopyStatistics();
+    AccumulateCopyStatistics(LastFrameCopyStatistics, StagingCopies);
+    AccumulateCopyStatistics(LastFrameCopyStatistics, StagingSamplerCopies);
+    AccumulateCopyStatistics(LastFrameCopyStatistics, ShaderVisibleCopies);
+    AccumulateCopyStatistics(LastFrameCopyStatistics, ShaderVisibleSamplerCopies);
+
+    EvictUnused(CurrentFrame);
+    FlushDirtyTables(BufferIndex);
+    FlushCopies(PDevice);
+}
+
+
+void D3D12DescriptorTableCache::FlushDirtyTables(U32 BufferIndex)
+{
+    U32 Index = 0;
+    while (Index < static_cast<U32>(DirtyDescriptorTables.size()))
+    {
+        D3D12DescriptorTableEntry* PEntry = DirtyDescriptorTables[Index];
+        PEntry->UploadToShaderVisibleHeap(ShaderVisibleCopies, ShaderVisibleSamplerCopies, BufferIndex);
+        if (PEntry->NeedsToBeFlushed())
+        {
+            Index += 1;
+        }
+        else
+        {
+            RemoveFromList(DirtyDescriptorTables, PEntry, &D3D12DescriptorTableEntry::DirtyListIndex);
+        }
+    }
+}
+
+
+void D3D12DescriptorTableCache::FlushCopies(ID3D12Device* PDevice)
+{
+    // Staging tables must hold their descriptors before being copied to shader visible heaps.
+    StagingCopies.Flush(PDevice);
+    StagingSamplerCopies.Flush(PDevice);
+    ShaderVisibleCopies.Flush(PDevice);
+    ShaderVisibleSamplerCopies.Flush(PDevice);
+}
+
+
+U32 D3D12DescriptorTableCache::EvictUnused(U64 CurrentFrame)
+{
+    U32 NumEvicted = 0;
+    U32 Index = 0;
+    while (Index < static_cast<U32>(UnusedDescriptorTables.size()))
+    {
+        D3D12DescriptorTableEntry* PEntry = UnusedDescriptorTables[Index];
+        if (PEntry->LastUsedFrame + k_MaxUnusedFrames > CurrentFrame)
+        {
+            Index += 1;
+            continue;
+        }
+        UnlinkViews(PEntry);
+        DescriptorTables.erase(PEntry->Key);
+        DestroyEntry(PEntry, CurrentFrame);
+        NumEvicted += 1;
+    }
+    DescriptorTableStatistics.NumEvictions += NumEvicted;
+    return NumEvicted;
+}
+
+
+const DescriptorTableCacheStatistics& D3D12DescriptorTableCache::GetStatistics()
+{
+    return DescriptorTableStatistics;
+}
+
+
+const DescriptorCopyStatistics& D3D12DescriptorTableCache::GetLastFrameCopyStatistics()
+{
+    return LastFrameCopyStatistics;
+}
+} // Synthe
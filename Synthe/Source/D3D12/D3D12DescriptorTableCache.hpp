@@ -0,0 +1,213 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Graphics/PipelineState.hpp"
+
+#include "D3D12DescriptorManager.hpp"
+#include "D3D12DescriptorCopyBatcher.hpp"
+
+#include <vector>
+
+
+namespace Synthe {
+
+
+//! Contents of a descriptor table, used as the key in the descriptor table cache.
+//! Handles are laid out as SRV, CBV, UAV, then Sampler, with 0 for unbound slots.
+struct DescriptorTableKey
+{
+    DescriptorTableKey()
+        : NumSrvs(0), NumCbvs(0), NumUavs(0), NumSamplers(0), Hash(0) { }
+
+    //! Compute the hash of the key, must be called after modifying handles.
+    void UpdateHash();
+
+    bool operator==(const DescriptorTableKey& Other) const
+    {
+        return Hash == Other.Hash
+            && NumSrvs == Other.NumSrvs && NumCbvs == Other.NumCbvs
+            && NumUavs == Other.NumUavs && NumSamplers == Other.NumSamplers
+            && Handles == Other.Handles;
+    }
+
+    U32 NumSrvs;
+    U32 NumCbvs;
+    U32 NumUavs;
+    U32 NumSamplers;
+    std::vector<GPUHandle> Handles;
+    U64 Hash;
+};
+
+
+struct DescriptorTableKeyHasher
+{
+    size_t operator()(const DescriptorTableKey& Key) const { return static_cast<size_t>(Key.Hash); }
+};
+
+
+//! Counters of the descriptor table cache, since startup.
+struct DescriptorTableCacheStatistics
+{
+    //! Acquires that found an existing table.
+    U64 NumHits;
+
+    //! Acquires that had to allocate and write a new table.
+    U64 NumMisses;
+
+    //! Tables evicted after going unused.
+    U64 NumEvictions;
+
+    //! Tables dropped because a view they hold was destroyed.
+    U64 NumInvalidations;
+
+    //! Tables currently alive in the cache, referenced or not.
+    U64 NumLiveTables;
+};
+
+
+//! A shared descriptor table. Contents never change once written, sets that are updated
+//! move to another table instead. Staging tables are written once on creation, then copied
+//! to each buffered frame's shader visible table, the current frame in the same batch, the others
+//! at the start of their frames.
+class D3D12DescriptorTableEntry
+{
+public:
+    static const U32 k_NotListed = 0xFFFFFFFF;
+
+    D3D12DescriptorTableEntry()
+        : RefCount(0)
+        , LastUsedFrame(0)
+        , DirtyBufferMask(0)
+        , DirtyListIndex(k_NotListed)
+        , UnusedListIndex(k_NotListed)
+        , Detached(false) { }
+
+    //! Record copies of the staging tables to the shader visible tables of the given buffered frame, 
+    //! if behind.
+    //!
+    //! \param Batcher Batch of CBV/SRV/UAV copies to shader visible heaps.
+    //! \param SamplerBatcher Batch of sampler copies to shader visible heaps.
+    //! \param BufferIndex The buffered frame.
+    void UploadToShaderVisibleHeap(D3D12DescriptorCopyBatcher& Batcher, 
+                                   D3D12DescriptorCopyBatcher& SamplerBatcher, 
+                                   U32 BufferIndex);
+
+    //! Check if any buffered frame is still behind the staging tables.
+    B32 NeedsToBeFlushed() const { return DirtyBufferMask != 0; }
+
+    //! Get the GPU address of the CBV/SRV/UAV table for the given buffered frame.
+    D3D12_GPU_DESCRIPTOR_HANDLE GetGPUTableAddress(U32 BufferIndex) const;
+
+    //! Get the GPU address of the sampler table for the given buffered frame.
+    D3D12_GPU_DESCRIPTOR_HANDLE GetGPUSamplerTableAddress(U32 BufferIndex) const;
+
+    DescriptorTableKey Key;
+    DescriptorTable TableUpload;
+    DescriptorTable SamplerTableUpload;
+    std::vector<DescriptorTable> GPUTables;
+    std::vector<DescriptorTable> GPUSamplerTables;
+
+    //! Number of descriptor sets currently using this table.
+    U32 RefCount;
+
+    //! Last frame the table was acquired or released in, used for eviction.
+    U64 LastUsedFrame;
+
+    //! Bit per buffered frame, set if that frame's shader visible table is not yet written.
+    U32 DirtyBufferMask;
+
+    //! Index in the dirty list, k_NotListed if not queued.
+    U32 DirtyListIndex;
+
+    //! Index in the unused list, k_NotListed if referenced.
+    U32 UnusedListIndex;
+
+    //! Dropped from the cache by InvalidateView() while still referenced, freed on its last Release().
+    B32 Detached;
+};
+
+
+//! Cache of shader visible descriptor tables, keyed by their contents. Descriptor sets binding the
+//! same views with the same layout share one table per buffered frame. Tables no longer referenced
+//! are kept around for k_MaxUnusedFrames, in case a set switches back to them, before being evicted.
+//!
+//! Descriptor writes are not done on the spot, they are batched frame wide and issued by FlushCopies(),
+//! staging writes first, then uploads to the shader visible heaps. Anything that submits work reading
+//! descriptor tables must flush beforehand.
+class D3D12DescriptorTableCache
+{
+public:
+    //! Frames an unreferenced table is kept before eviction.
+    static const U64 k_MaxUnusedFrames = 8ULL;
+
+    //! Initialize the cache. Descriptor pools must be created beforehand.
+    //!
+    //! \param NumBuffers The number of buffered frames, one shader visible table is kept per frame.
+    static void Initialize(U32 NumBuffers);
+
+    //! Release all tables in the cache. All entries are invalidated.
+    static void CleanUp();
+
+    //! Get a table for the given contents, creating it if not already cached. The returned table
+    //! holds a reference that must be given back with Release().
+    //!
+    //! \param Key The contents of the table, with an up to date hash.
+    //! \param CurrentBufferIndex The buffered frame currently recording.
+    //! \param CurrentFrame The current frame number.
+    //! \param OutEntry The table.
+    //! \return SResult_OK on success. SResult_OUT_OF_MEMORY if the descriptor pools are full.
+    static ResultCode Acquire(const DescriptorTableKey& Key,
+                              U32 CurrentBufferIndex,
+                              U64 CurrentFrame,
+                              D3D12DescriptorTableEntry** OutEntry);
+
+    //! Give back a reference taken with Acquire().
+    //!
+    //! \param PEntry The table.
+    //! \param CurrentFrame The current frame number.
+    static void Release(D3D12DescriptorTableEntry* PEntry, U64 CurrentFrame);
+
+    //! Drop every table holding a view whose descriptor is being freed. Keys are raw descriptor
+    //! handles and freed slots are reused, so a table left in the cache would be found by the next
+    //! view created in the same slot, with the old descriptor still in its shader visible copies.
+    //! Unreferenced tables are freed, referenced ones are no longer found by Acquire() and are freed
+    //! on their last Release().
+    //!
+    //! \param Handle The view handle.
+    //! \param CurrentFrame The current frame number, tables are freed once it retires.
+    static void InvalidateView(GPUHandle Handle, U64 CurrentFrame);
+
+    //! Start a new frame. Evicts unused tables, catches up the tables of the given buffered frame, 
+    //! and flushes all copies.
+    //!
+    //! \param PDevice The native device.
+    //! \param BufferIndex The buffered frame that is about to record.
+    //! \param CurrentFrame The current frame number.
+    static void BeginFrame(ID3D12Device* PDevice, U32 BufferIndex, U64 CurrentFrame);
+
+    //! Record uploads to the shader visible tables of the given buffered frame, for tables still behind.
+    //!
+    //! \param BufferIndex The buffered frame that is about to record.
+    static void FlushDirtyTables(U32 BufferIndex);
+
+    //! Issue all batched descriptor copies.
+    //!
+    //! \param PDevice The native device.
+    static void FlushCopies(ID3D12Device* PDevice);
+
+    //! Evict tables that have gone unreferenced for more than k_MaxUnusedFrames. Their descriptors
+    //! are freed once CurrentFrame retires.
+    //!
+    //! \param CurrentFrame The current frame number.
+    //! \return The number of tables evicted.
+    static U32 EvictUnused(U64 CurrentFrame);
+
+    //! Get the cache counters.
+    static const DescriptorTableCacheStatistics& GetStatistics();
+
+    //! Get the descriptor copy counters of the previous frame, summed over all batches.
+    static const DescriptorCopyStatistics& GetLastFrameCopyStatistics();
+};
+} // Synthe
@@ -0,0 +1,229 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "D3D12GraphicsCommandQueue.hpp"
+#include "D3D12CommandAllocatorPool.hpp"
+#include "D3D12DescriptorTableCache.hpp"
+#include "D3D12GraphicsDevice.hpp"
+
+namespace Synthe {
+
+
+//! Get the queue of the device a sync point belongs to.
+static D3D12GraphicsCommandQueue* GetQueue(SubmitQueue Queue)
+{
+    return static_cast<D3D12GraphicsCommandQueue*>(GetDeviceD3D12()->GetCommandQueue(Queue));
+}
+
+
+ResultCode D3D12GraphicsCommandQueue::Initialize(ID3D12Device* PDevice,
+                                                 SubmitQueue Type,
+                                                 D3D12CommandAllocatorPool* PAllocatorPool)
+{
+    Release();
+    m_Type = Type;
+    m_PDevice = PDevice;
+    m_PAllocatorPool = PAllocatorPool;
+
+    D3D12_COMMAND_QUEUE_DESC Desc = { };
+    Desc.Type = PAllocatorPool->GetType();
+    Desc.NodeMask = 0;
+    Desc.Priority = (Type == SubmitQueue_GRAPHICS) ? D3D12_COMMAND_QUEUE_PRIORITY_HIGH : D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
+    Desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    HRESULT Result = PDevice->CreateCommandQueue(&Desc, __uuidof(ID3D12CommandQueue), (void**)&m_PNative);
+    if (FAILED(Result))
+    {
+        m_PNative = nullptr;
+        return SResult_FAILED;
+    }
+
+    Result = PDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, __uuidof(ID3D12Fence), (void**)&m_PFence);
+    if (FAILED(Result))
+    {
+        m_PFence = nullptr;
+        Release();
+        return SResult_FAILED;
+    }
+    m_FenceEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+    return m_FixupCommandList.Initialize(PDevice, 1, PAllocatorPool);
+}
+
+
+void D3D12GraphicsCommandQueue::Release()
+{
+    m_FixupCommandList.Release();
+    if (m_FenceEvent)   CloseHandle(m_FenceEvent);
+    if (m_PFence)       m_PFence->Release();
+    if (m_PNative)      m_PNative->Release();
+    m_FenceEvent = nullptr;
+    m_PFence = nullptr;
+    m_PNative = nullptr;
+    m_LastSubmittedValue = 0;
+    m_LastCompletedValue = 0;
+    for (U64& Waited : m_WaitedValues)
+    {
+        Waited = 0;
+    }
+}
+
+
+SyncPoint D3D12GraphicsCommandQueue::Submit(U32 NumCommandLists,
+                                            GraphicsCommandList* const* PPCommandLists,
+                                            U32 NumWaits,
+                                            const SyncPoint* PWaits)
+{
+    for (U32 I = 0; I < NumWaits; ++I)
+    {
+        if (Wait(PWaits[I]) != SResult_OK)
+        {
+            return { m_Type, 0 };
+        }
+    }
+    // Descriptor tables referenced by these lists must be written before the GPU can see them.
+    D3D12DescriptorTableCache::FlushCopies(m_PDevice);
+    ExecuteCommandLists(NumCommandLists, PPCommandLists);
+    m_Statistics.NumSubmits += 1;
+    m_Statistics.NumCommandLists += NumCommandLists;
+    return Signal();
+}
+
+
+ResultCode D3D12GraphicsCommandQueue::Wait(const SyncPoint& Point)
+{
+    // Work on one queue runs in order, so it never waits for itself.
+    if (Point.Value == 0 || Point.Queue == m_Type || Point.Value <= m_WaitedValues[Point.Queue])
+    {
+        m_Statistics.NumWaitsSkipped += 1;
+        return SResult_OK;
+    }
+    D3D12GraphicsCommandQueue* POther = GetQueue(Point.Queue);
+    if (!POther || Point.Value > POther->GetLastSubmittedValue())
+    {
+        return SResult_INVALID_ARGS;
+    }
+    if (POther->IsComplete(Point))
+    {
+        m_Statistics.NumWaitsAlreadyReached += 1;
+        return SResult_OK;
+    }
+    m_PNative->Wait(POther->GetNativeFence(), Point.Value);
+    m_WaitedValues[Point.Queue] = Point.Value;
+    m_Statistics.NumWaitsIssued += 1;
+    return SResult_OK;
+}
+
+
+SyncPoint D3D12GraphicsCommandQueue::Signal()
+{
+    m_LastSubmittedValue += 1;
+    m_PNative->Signal(m_PFence, m_LastSubmittedValue);
+    return { m_Type, m_LastSubmittedValue };
+}
+
+
+U64 D3D12GraphicsCommandQueue::GetCompletedValue()
+{
+    U64 Completed = m_PFence->GetCompletedValue();
+    if (Completed > m_LastCompletedValue)
+    {
+        m_LastCompletedValue = Completed;
+    }
+    return m_LastCompletedValue;
+}
+
+
+B32 D3D12GraphicsCommandQueue::IsComplete(const SyncPoint& Point)
+{
+    if (Point.Queue != m_Type)
+    {
+        D3D12GraphicsCommandQueue* POther = GetQueue(Point.Queue);
+        return POther ? POther->IsComplete(Point) : false;
+    }
+    // The cached value saves reading the fence for sync points known to be reached.
+    return Point.Value <= m_LastCompletedValue || Point.Value <= GetCompletedValue();
+}
+
+
+ResultCode D3D12GraphicsCommandQueue::WaitOnCPU(const SyncPoint& Point)
+{
+    if (Point.Queue != m_Type)
+    {
+        D3D12GraphicsCommandQueue* POther = GetQueue(Point.Queue);
+        return POther ? POther->WaitOnCPU(Point) : SResult_INVALID_ARGS;
+    }
+    if (Point.Value > m_LastSubmittedValue)
+    {
+        return SResult_INVALID_ARGS;
+    }
+    if (IsComplete(Point))
+    {
+        return SResult_OK;
+    }
+    m_PFence->SetEventOnCompletion(Point.Value, m_FenceEvent);
+    WaitForSingleObject(m_FenceEvent, INFINITE);
+    m_Statistics.NumCPUWaits += 1;
+    GetCompletedValue();
+    return SResult_OK;
+}
+
+
+ResultCode D3D12GraphicsCommandQueue::GetStatistics(CommandQueueStatistics* OutStatistics) const
+{
+    if (!OutStatistics)
+    {
+        return SResult_INVALID_ARGS;
+    }
+    *OutStatistics = m_Statistics;
+    return SResult_OK;
+}
+
+
+void D3D12GraphicsCommandQueue::ExecuteNative(U32 NumLists, ID3D12CommandList* const* PPLists)
+{
+    D3D12DescriptorTableCache::FlushCopies(m_PDevice);
+    m_PNative->ExecuteCommandLists(NumLists, PPLists);
+}
+
+
+void D3D12GraphicsCommandQueue::ExecuteCommandLists(U32 NumLists, GraphicsCommandList* const* PPLists)
+{
+    // Lists execute in array order, whichever thread recorded them, so states are resolved in that
+    // order too. A list needing barriers first ends the run of lists before it, since the barriers
+    // must see the states those lists leave.
+    m_ExecuteScratch.clear();
+    for (U32 I = 0; I < NumLists; ++I)
+    {
+        D3D12GraphicsCommandList* PList = static_cast<D3D12GraphicsCommandList*>(PPLists[I]);
+        m_FixupBarrierScratch.clear();
+        PList->ResolveResourceStates(m_FixupBarrierScratch);
+        if (!m_FixupBarrierScratch.empty())
+        {
+            if (!m_ExecuteScratch.empty())
+            {
+                m_PNative->ExecuteCommandLists(static_cast<UINT>(m_ExecuteScratch.size()), m_ExecuteScratch.data());
+                m_ExecuteScratch.clear();
+            }
+            m_FixupCommandList.Begin();
+                m_FixupCommandList.RecordBarriers(static_cast<U32>(m_FixupBarrierScratch.size()), m_FixupBarrierScratch.data());
+            m_FixupCommandList.End();
+            ID3D12CommandList* PFixupList = m_FixupCommandList.GetNative();
+            m_PNative->ExecuteCommandLists(1, &PFixupList);
+            // The native list may be reset right away, its allocator waits for the signal below.
+            m_FixupCommandList.OnSubmitted(m_PAllocatorPool->GetNextFenceValue());
+        }
+        m_ExecuteScratch.push_back(PList->GetNative());
+    }
+    if (!m_ExecuteScratch.empty())
+    {
+        m_PNative->ExecuteCommandLists(static_cast<UINT>(m_ExecuteScratch.size()), m_ExecuteScratch.data());
+    }
+
+    // Queues only take lists of their own type, so the allocators all come from this pool.
+    U64 AllocatorFenceValue = m_PAllocatorPool->Signal(m_PNative);
+    for (U32 I = 0; I < NumLists; ++I)
+    {
+        static_cast<D3D12GraphicsCommandList*>(PPLists[I])->OnSubmitted(AllocatorFenceValue);
+    }
+}
+} // Synthe
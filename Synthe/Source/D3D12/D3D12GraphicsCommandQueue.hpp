@@ -0,0 +1,101 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Win32Common.hpp"
+#include "Common/Types.hpp"
+#include "D3D12CommandList.hpp"
+#include "Graphics/GraphicsCommandQueue.hpp"
+
+#include <vector>
+
+namespace Synthe {
+
+
+class D3D12CommandAllocatorPool;
+
+
+//! D3D12 queue. The timeline is a fence of the queue, signaled with the next value after each submit,
+//! so a sync point is a plain fence value, and waiting for one of another queue is a Wait() on that
+//! queue's fence. Lists are executed with the barriers that reconcile their resource states, see
+//! D3D12LocalResourceStates.
+class D3D12GraphicsCommandQueue : public GraphicsCommandQueue
+{
+public:
+    D3D12GraphicsCommandQueue()
+        : m_Type(SubmitQueue_GRAPHICS)
+        , m_PDevice(nullptr)
+        , m_PNative(nullptr)
+        , m_PFence(nullptr)
+        , m_FenceEvent(nullptr)
+        , m_PAllocatorPool(nullptr)
+        , m_LastSubmittedValue(0)
+        , m_LastCompletedValue(0)
+        , m_WaitedValues()
+        , m_Statistics() { }
+
+    //! Create the native queue and its timeline fence.
+    //!
+    //! \param PDevice The native device.
+    //! \param Type The queue type.
+    //! \param PAllocatorPool The allocator pool of the list type the queue executes, already initialized.
+    //!                       Not owned.
+    //! \return SResult_OK on success.
+    ResultCode Initialize(ID3D12Device* PDevice, SubmitQueue Type, D3D12CommandAllocatorPool* PAllocatorPool);
+
+    void Release();
+
+    SubmitQueue GetType() const override { return m_Type; }
+
+    SyncPoint Submit(U32 NumCommandLists,
+                     GraphicsCommandList* const* PPCommandLists,
+                     U32 NumWaits,
+                     const SyncPoint* PWaits) override;
+
+    ResultCode Wait(const SyncPoint& Point) override;
+    SyncPoint Signal() override;
+    B32 IsComplete(const SyncPoint& Point) override;
+    ResultCode WaitOnCPU(const SyncPoint& Point) override;
+    U64 GetCompletedValue() override;
+    U64 GetLastSubmittedValue() const override { return m_LastSubmittedValue; }
+    ResultCode GetStatistics(CommandQueueStatistics* OutStatistics) const override;
+
+    //! Execute native lists as they are, with no state reconciliation and no timeline signal. Used for
+    //! lists the device records at submit against the global states. Descriptor copies are flushed
+    //! first, as with Submit().
+    void ExecuteNative(U32 NumLists, ID3D12CommandList* const* PPLists);
+
+    ID3D12CommandQueue* GetNative() { return m_PNative; }
+    ID3D12Fence* GetNativeFence() { return m_PFence; }
+
+private:
+    //! Execute lists in order. Each list is preceded by the barriers that bring resources into the
+    //! states it first uses them in, and the allocators of all of them go back to the pool.
+    void ExecuteCommandLists(U32 NumLists, GraphicsCommandList* const* PPLists);
+
+    SubmitQueue                         m_Type;
+    ID3D12Device*                       m_PDevice;
+    ID3D12CommandQueue*                 m_PNative;
+    ID3D12Fence*                        m_PFence;
+    HANDLE                              m_FenceEvent;
+    D3D12CommandAllocatorPool*          m_PAllocatorPool;
+
+    U64                                 m_LastSubmittedValue;
+    //! Last value read from the fence, it only goes up.
+    U64                                 m_LastCompletedValue;
+
+    //! Highest value of each queue already waited for, later waits at or below it are dropped.
+    U64                                 m_WaitedValues[SubmitQueue_COUNT];
+
+    //! Records the barriers resolved at submit. Submitted as soon as it is recorded, so one native
+    //! list is enough.
+    D3D12GraphicsCommandList            m_FixupCommandList;
+
+    //! Scratch of ExecuteCommandLists().
+    std::vector<ID3D12CommandList*>     m_ExecuteScratch;
+    std::vector<D3D12_RESOURCE_BARRIER> m_FixupBarrierScratch;
+
+    CommandQueueStatistics              m_Statistics;
+};
+} // Synthe
@@ -10,8 +10,15 @@
 #include "D3D12GraphicsPipelineState.hpp"
 
 #include "D3D12Fence.hpp"
+#include "D3D12RootSignatureCache.hpp"
+#include "D3D12PipelineStateCache.hpp"
+#include "D3D12PipelineUsage.hpp"
+#include "D3D12SamplerCache.hpp"
+#include "D3D12ViewCache.hpp"
 
 #include <array>
+#include <climits>
+#include <string.h>
 
 namespace Synthe {
 
@@ -30,13 +37,16 @@ GraphicsDevice* GetDeviceD3D12()
 
 void InitializeMemoryHeaps(ID3D12Device* PDevice, const GraphicsDeviceConfig& Config)
 {
-    D3D12MemoryManager::CreateAndRegisterAllocator(MemoryType_SCENE, D3D12MemoryManager::AllocType_LINEAR);
-    D3D12MemoryManager::CreateAndRegisterAllocator(MemoryType_BUFFER, D3D12MemoryManager::AllocType_LINEAR);
-    D3D12MemoryManager::CreateAndRegisterAllocator(MemoryType_TEXTURE, D3D12MemoryManager::AllocType_LINEAR);
-    D3D12MemoryManager::CreateAndRegisterAllocator(MemoryType_SCRATCH, D3D12MemoryManager::AllocType_LINEAR);
-    D3D12MemoryManager::CreateAndRegisterAllocator(MemoryType_UPLOAD, D3D12MemoryManager::AllocType_LINEAR);
-    D3D12MemoryManager::CreateAndRegisterAllocator(MemoryType_READBACK, D3D12MemoryManager::AllocType_LINEAR);
-    D3D12MemoryManager::CreateAndRegisterAllocator(MemoryType_RENDER_TARGETS_AND_DEPTH, D3D12MemoryManager::AllocType_LINEAR);
+    // Resources are destroyed while the device runs, the pools must be able to take their memory back.
+    // Range allocators merge freed ranges, so a pool streamed through stays as whole as its live
+    // resources allow.
+    D3D12MemoryManager::CreateAndRegisterAllocator(MemoryType_SCENE, D3D12MemoryManager::AllocType_RANGE);
+    D3D12MemoryManager::CreateAndRegisterAllocator(MemoryType_BUFFER, D3D12MemoryManager::AllocType_RANGE);
+    D3D12MemoryManager::CreateAndRegisterAllocator(MemoryType_TEXTURE, D3D12MemoryManager::AllocType_RANGE);
+    D3D12MemoryManager::CreateAndRegisterAllocator(MemoryType_SCRATCH, D3D12MemoryManager::AllocType_RANGE);
+    D3D12MemoryManager::CreateAndRegisterAllocator(MemoryType_UPLOAD, D3D12MemoryManager::AllocType_RANGE);
+    D3D12MemoryManager::CreateAndRegisterAllocator(MemoryType_READBACK, D3D12MemoryManager::AllocType_RANGE);
+    D3D12MemoryManager::CreateAndRegisterAllocator(MemoryType_RENDER_TARGETS_AND_DEPTH, D3D12MemoryManager::AllocType_RANGE);
     
     D3D12MemoryManager::CreateAndRegisterMemoryPool(MemoryType_BUFFER);
     D3D12MemoryManager::CreateAndRegisterMemoryPool(MemoryType_UPLOAD);
@@ -122,6 +132,7 @@ void InitializeDescriptorHeaps(ID3D12Device* PDevice, U32 BufferingCount)
         D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_SAMPLER, I)->Create(PDevice,
             D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE, 1024);
     }
+    D3D12DescriptorTableCache::Initialize(BufferingCount);
 }
 
 
@@ -311,13 +322,55 @@ ResultCode D3D12GraphicsDevice::Initialize(const GraphicsDeviceConfig& DeviceCon
     m_Features.DedicatedVideoMemoryInBytes = BestInfo.DedicatedVideoMemoryBytes;
     m_ResourceHeapTier = BestInfo.FeatureSupport.ResourceHeapTier;
 
+    {
+        D3D12_FEATURE_DATA_ROOT_SIGNATURE RootSignatureFeature = { };
+        RootSignatureFeature.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_1;
+        if (FAILED(m_Device->CheckFeatureSupport(D3D12_FEATURE_ROOT_SIGNATURE, &RootSignatureFeature, 
+                                                 sizeof(RootSignatureFeature))))
+        {
+            RootSignatureFeature.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_0;
+        }
+        m_RootSignatureVersion = RootSignatureFeature.HighestVersion;
+    }
+
+    if (DeviceConfig.PipelineCacheDirectory)
+    {
+        m_PipelineCacheDirectory = DeviceConfig.PipelineCacheDirectory;
+        D3D12RootSignatureCache::LoadBlobs(GetPipelineCachePath("RootSignatures.cache"));
+    }
+
+    D3D12PipelineStateCache::Initialize(m_Device, GetPipelineCachePath("Pipelines.cache"));
+
     InitializeMemoryHeaps(m_Device, DeviceConfig);
     InitializeDescriptorHeaps(m_Device, SwapchainConfig.Buffering);    
-    CreateGraphicsQueue();
-    CreateAsyncQueue();
-    CreateCopyQueue();
+    if (InitializeBindless(DeviceConfig, SwapchainConfig.Buffering) != SResult_OK)
+    {
+        return GResult_INITIALIZATION_FAILURE;
+    }
+
+    if (DeviceConfig.EnablePipelinePrewarm && !m_PipelineCacheDirectory.empty())
+    {
+        D3D12PipelineUsage::Initialize(GetPipelineCachePath("PipelineUsage.cache"), 
+                                       GetPipelineCachePath("PipelineShaders.cache"));
+        D3D12PipelineUsage::Prewarm(this, m_PrewarmedRootSignatures, m_PrewarmedPipelineStates);
+    }
+    const D3D12_COMMAND_LIST_TYPE PoolTypes[] = { D3D12_COMMAND_LIST_TYPE_DIRECT, 
+                                                  D3D12_COMMAND_LIST_TYPE_BUNDLE,
+                                                  D3D12_COMMAND_LIST_TYPE_COMPUTE, 
+                                                  D3D12_COMMAND_LIST_TYPE_COPY };
+    for (D3D12_COMMAND_LIST_TYPE Type : PoolTypes)
+    {
+        if (m_AllocatorPools[Type].Initialize(m_Device, Type) != SResult_OK)
+        {
+            return GResult_INITIALIZATION_FAILURE;
+        }
+    }
+    if (CreateCommandQueues() != SResult_OK)
+    {
+        return GResult_DEVICE_CREATION_FAILURE;
+    }
     // Initialize our swapchain.
-    m_Swapchain.Initialize(SwapchainConfig, m_GraphicsQueue, PFactory);
+    m_Swapchain.Initialize(SwapchainConfig, GetGraphicsQueue(), PFactory);
     // Initialize RTVs for swapchain.
     m_Swapchain.BuildRTVs(m_Device, D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_RTV));
 
@@ -335,7 +388,7 @@ ResultCode D3D12GraphicsDevice::Initialize(const GraphicsDeviceConfig& DeviceCon
 void D3D12GraphicsDevice::SubmitCommandListsToBackBuffer(ID3D12CommandList* const* PPCommandLists, U32 Count, U32 FrameIndex)
 {
     BufferingResource& Buffer = m_BufferingResources[FrameIndex % m_BufferingResources.size()];
-    m_GraphicsQueue->ExecuteCommandLists(Count, PPCommandLists);
+    m_Queues[SubmitQueue_GRAPHICS].ExecuteNative(Count, PPCommandLists);
 }
 
 
@@ -343,9 +396,41 @@ ResultCode D3D12GraphicsDevice::CleanUp()
 {
     m_Swapchain.CleanUp();
     CleanUpFences();
-    if (m_GraphicsQueue)    m_GraphicsQueue->Release();
-    if (m_AsyncQueue)       m_AsyncQueue->Release();
-    if (m_CopyQueue)        m_CopyQueue->Release();
+    m_BackbufferCommandList.Release();
+    for (D3D12GraphicsCommandQueue& Queue : m_Queues)
+    {
+        Queue.Release();
+    }
+    m_PendingFrames.clear();
+    for (D3D12CommandAllocatorPool& Pool : m_AllocatorPools)
+    {
+        Pool.Release();
+    }
+    D3D12ViewCache::CleanUp();
+    D3D12MemoryManager::ReleasePendingResources();
+    D3D12DescriptorTableCache::CleanUp();
+    if (!m_PipelineCacheDirectory.empty())
+    {
+        D3D12RootSignatureCache::SaveBlobs(GetPipelineCachePath("RootSignatures.cache"));
+    }
+    for (PipelineState* PPipelineState : m_PrewarmedPipelineStates)
+    {
+        DestroyPipelineState(&PPipelineState);
+    }
+    for (RootSignature* PRootSignature : m_PrewarmedRootSignatures)
+    {
+        DestroyRootSignature(&PRootSignature);
+    }
+    m_PrewarmedPipelineStates.clear();
+    m_PrewarmedRootSignatures.clear();
+    // Folds the counters of everything still alive into the usage records, which are saved last.
+    D3D12PipelineStateCache::CleanUp();
+    D3D12RootSignatureCache::CleanUp();
+    D3D12PipelineUsage::CleanUp();
+    D3D12SamplerCache::CleanUp();
+    m_BindlessResources.Release();
+    m_BindlessSamplers.Release();
+    m_BindlessIndices.clear();
     if (m_PFactory)         m_PFactory->Release();
     if (m_Device)           m_Device->Release();
     if (m_MLDevice)         m_MLDevice->Release();
@@ -353,17 +438,35 @@ ResultCode D3D12GraphicsDevice::CleanUp()
 }
 
 
-ResultCode D3D12GraphicsDevice::CreateGraphicsQueue()
+ResultCode D3D12GraphicsDevice::CreateCommandQueues()
 {
-    D3D12_COMMAND_QUEUE_DESC Desc = { };
-    Desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
-    Desc.NodeMask = 0;
-    Desc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_HIGH;
-    Desc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
-    HRESULT HR = m_Device->CreateCommandQueue(&Desc, __uuidof(ID3D12CommandQueue), (void**)&m_GraphicsQueue);
-    if (FAILED(HR)) 
-        return GResult_DEVICE_CREATION_FAILURE;
-    return SResult_OK;
+    ResultCode Result = m_Queues[SubmitQueue_GRAPHICS].Initialize(m_Device, 
+                                                                  SubmitQueue_GRAPHICS, 
+                                                                  &m_AllocatorPools[D3D12_COMMAND_LIST_TYPE_DIRECT]);
+    if (Result != SResult_OK)
+    {
+        return Result;
+    }
+    Result = m_Queues[SubmitQueue_ASYNC].Initialize(m_Device, 
+                                                    SubmitQueue_ASYNC, 
+                                                    &m_AllocatorPools[D3D12_COMMAND_LIST_TYPE_COMPUTE]);
+    if (Result != SResult_OK)
+    {
+        return Result;
+    }
+    return m_Queues[SubmitQueue_COPY].Initialize(m_Device, 
+                                                 SubmitQueue_COPY, 
+                                                 &m_AllocatorPools[D3D12_COMMAND_LIST_TYPE_COPY]);
+}
+
+
+GraphicsCommandQueue* D3D12GraphicsDevice::GetCommandQueue(SubmitQueue Queue)
+{
+    if (Queue >= SubmitQueue_COUNT)
+    {
+        return nullptr;
+    }
+    return &m_Queues[Queue];
 }
 
 
@@ -374,7 +477,6 @@ void D3D12GraphicsDevice::CleanUpBufferingResources()
         BufferingResource& Buffer = m_BufferingResources[I];
         Buffer.PWaitFence->Release();
         CloseHandle(Buffer.FenceEventWait);
-        Buffer.PCommandAllocator->Release();
     }  
     m_BackbufferCommandList.Release();
 }
@@ -384,7 +486,6 @@ void D3D12GraphicsDevice::QueryBufferingResources(U32 BufferingCount)
 {
     CleanUpBufferingResources();
     m_BufferingResources.resize(BufferingCount);
-    std::vector<ID3D12CommandAllocator*> Allocators(BufferingCount);
     for (U32 I = 0; I < m_BufferingResources.size(); ++I)
     {
         BufferingResource& Buffer = m_BufferingResources[I];
@@ -393,11 +494,9 @@ void D3D12GraphicsDevice::QueryBufferingResources(U32 BufferingCount)
         
         HRESULT Result = 0; 
         m_Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, __uuidof(ID3D12Fence), (void**)&Buffer.PWaitFence);
-        m_Device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, __uuidof(ID3D12CommandAllocator), (void**)&Buffer.PCommandAllocator);
         Buffer.FenceWaitValue = 1ULL;
-        Allocators[I] = Buffer.PCommandAllocator;
     }
-    m_BackbufferCommandList.Initialize(m_Device, BufferingCount, Allocators.data(), D3D12_COMMAND_LIST_TYPE_DIRECT);
+    m_BackbufferCommandList.Initialize(m_Device, BufferingCount, &m_AllocatorPools[D3D12_COMMAND_LIST_TYPE_DIRECT]);
 }
 
 
@@ -430,13 +529,20 @@ ResultCode D3D12GraphicsDevice::Present()
     D3D12MemoryManager::GetNativeResource(Frame.ResourceHandle, &ResourceS);
     if (ResourceS.State != D3D12_RESOURCE_STATE_PRESENT)
     {
+        // Recorded and submitted here, after every list of the frame, so the global state is current.
+        D3D12_RESOURCE_BARRIER Barrier = { };
+        Barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        Barrier.Transition.pResource = ResourceS.PResource;
+        Barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+        Barrier.Transition.StateBefore = ResourceS.State;
+        Barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
         m_BackbufferCommandList.Begin();
-            D3D12_RESOURCE_STATES State = D3D12_RESOURCE_STATE_PRESENT;
-            m_BackbufferCommandList.TransitionResourceIfNeeded(1, (GPUHandle*)&Frame.ImageRTV.ptr, &State);
+            m_BackbufferCommandList.RecordBarriers(1, &Barrier);
         m_BackbufferCommandList.End();
         D3D12MemoryManager::UpdateResourceState(Frame.ResourceHandle, D3D12_RESOURCE_STATE_PRESENT);
         ID3D12CommandList* CmdList[] = { m_BackbufferCommandList.GetNative() };
-        m_GraphicsQueue->ExecuteCommandLists(1, CmdList);
+        m_Queues[SubmitQueue_GRAPHICS].ExecuteNative(1, CmdList);
+        m_BackbufferCommandList.OnSubmitted(m_AllocatorPools[D3D12_COMMAND_LIST_TYPE_DIRECT].Signal(GetGraphicsQueue()));
     }
     return m_Swapchain.Present();
 }
@@ -444,10 +550,7 @@ ResultCode D3D12GraphicsDevice::Present()
 
 void D3D12GraphicsDevice::Begin()
 {
-    BufferingResource& Buffer = m_BufferingResources[m_BufferIndex];
-    Buffer.PCommandAllocator->Reset();
-
-    // Update our per frame command lists.
+    // Update our per frame command lists. They take allocators from the pools as they are begun.
     for (auto* PCommandList : m_PerFrameCommandLists)
     {
         PCommandList->SetCurrentIdx(m_BufferIndex);
@@ -455,19 +558,38 @@ void D3D12GraphicsDevice::Begin()
     // Update our backbuffer commandlist too.
     m_BackbufferCommandList.SetCurrentIdx(m_BufferIndex);
 
-    // Upload all descriptors to their GPU descriptor tables.
-    D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_CBV_SRV_UAV, m_BufferIndex)->ResetPool();
-    for (std::pair<const GPUHandle, D3D12DescriptorSet*>& Set : m_DescriptorSets)
+    // Recycle descriptors that were freed by frames the GPU has finished with.
+    RetireCompletedFrames();
+    D3D12DescriptorManager::RetireFrame(m_LastCompletedFrame);
+    m_BindlessResources.RetireFrame(m_LastCompletedFrame);
+    m_BindlessSamplers.RetireFrame(m_LastCompletedFrame);
+    D3D12MemoryManager::RetireFrame(m_LastCompletedFrame);
+    for (D3D12CommandAllocatorPool& Pool : m_AllocatorPools)
     {
-        Set.second->UploadToShaderVisibleHeap(m_Device, m_BufferIndex);
+        Pool.Trim(m_FrameCount);
     }
+
+    // Drop descriptor tables no set has used for a while, then catch up the tables of this frame 
+    // that were created during a previous frame.
+    D3D12DescriptorTableCache::BeginFrame(m_Device, m_BufferIndex, m_FrameCount);
 }
 
 
 void D3D12GraphicsDevice::End()
 {
     BufferingResource& Buffer = m_BufferingResources[m_BufferIndex];
-    m_GraphicsQueue->Signal(Buffer.PWaitFence, Buffer.FenceWaitValue);
+    // Bundles re-recorded this frame may have been executed by anything submitted so far.
+    m_AllocatorPools[D3D12_COMMAND_LIST_TYPE_BUNDLE].Signal(GetGraphicsQueue());
+    GetGraphicsQueue()->Signal(Buffer.PWaitFence, Buffer.FenceWaitValue);
+
+    // Work of this frame on the async and copy queues may outlive its graphics work.
+    FrameSyncPoints Points = { };
+    Points.Frame = m_FrameCount;
+    for (U32 Queue = 0; Queue < SubmitQueue_COUNT; ++Queue)
+    {
+        Points.QueueValues[Queue] = m_Queues[Queue].GetLastSubmittedValue();
+    }
+    m_PendingFrames.push_back(Points);
 
     // Next frame to work on.
     m_BufferIndex = m_Swapchain.GetCurrentFrameIndex() % static_cast<U32>(m_BufferingResources.size());
@@ -479,13 +601,33 @@ void D3D12GraphicsDevice::End()
     }
 
     Buffer.FenceWaitValue += 1;
+    m_FrameCount += 1;
+}
+
+
+void D3D12GraphicsDevice::RetireCompletedFrames()
+{
+    // Frames end in order on each queue, so the first unfinished frame holds back the ones after it.
+    while (!m_PendingFrames.empty())
+    {
+        const FrameSyncPoints& Points = m_PendingFrames.front();
+        for (U32 Queue = 0; Queue < SubmitQueue_COUNT; ++Queue)
+        {
+            if (!m_Queues[Queue].IsComplete({ static_cast<SubmitQueue>(Queue), Points.QueueValues[Queue] }))
+            {
+                return;
+            }
+        }
+        m_LastCompletedFrame = Points.Frame;
+        m_PendingFrames.pop_front();
+    }
 }
 
 
 void D3D12GraphicsDevice::WaitOnGPU()
 {
     BufferingResource& Buffer = m_BufferingResources[m_BufferIndex];
-    m_GraphicsQueue->Signal(Buffer.PWaitFence, Buffer.FenceWaitValue);
+    GetGraphicsQueue()->Signal(Buffer.PWaitFence, Buffer.FenceWaitValue);
     Buffer.PWaitFence->SetEventOnCompletion(Buffer.FenceWaitValue, Buffer.FenceEventWait);
     WaitForSingleObject(Buffer.FenceEventWait, INFINITE);
     Buffer.FenceWaitValue += 1;
@@ -509,6 +651,22 @@ ResultCode D3D12GraphicsDevice::CreateResource(GPUHandle* Out,
             MemType = MemoryType_TEXTURE;
             break;
     }
+
+    D3D12_RESOURCE_STATES InitialState = D3D12_RESOURCE_STATE_COMMON;
+    D3D12_HEAP_TYPE HeapType = D3D12_HEAP_TYPE_DEFAULT;
+
+    if (PCreateInfo->Usage & ResourceUsage_CPU_UPLOAD)
+    {
+        // Upload heap only allows buffers, and requires them to be in the generic read state for 
+        // their entire lifetime.
+        if (PCreateInfo->Dimension != ResourceDimension_BUFFER)
+        {
+            return SResult_INVALID_ARGS;
+        }
+        MemType = MemoryType_UPLOAD;
+        HeapType = D3D12_HEAP_TYPE_UPLOAD;
+        InitialState = D3D12_RESOURCE_STATE_GENERIC_READ;
+    }
     
     D3D12_RESOURCE_DESC ResourceDesc = { };
     ResourceDesc.Width = PCreateInfo->Width;
@@ -543,16 +701,16 @@ ResultCode D3D12GraphicsDevice::CreateResource(GPUHandle* Out,
         ClearValue.Format = ResourceDesc.Format;
     }
 
-    D3D12_RESOURCE_STATES InitialState = D3D12_RESOURCE_STATE_COMMON;
-
-    ResultCode Result = D3D12MemoryManager::GetMemoryPool(MemType)->AllocateResource(m_Device, 
+    MemoryPool* PMemoryPool = D3D12MemoryManager::GetMemoryPool(MemType);
+    ResultCode Result = PMemoryPool->AllocateResource(m_Device, 
         ResourceDesc, InitialState, 
         PClearValue ? &ClearValue : nullptr, 
         &PResource);
 
     if (Result == SResult_OK) 
     {
-        ResultCode CacheResult = D3D12MemoryManager::CacheNativeResource(*Out, PResource, InitialState);
+        ResultCode CacheResult = D3D12MemoryManager::CacheNativeResource(*Out, PResource, InitialState, 
+                                                                         HeapType, PMemoryPool);
     } 
     else 
     {
@@ -563,6 +721,39 @@ ResultCode D3D12GraphicsDevice::CreateResource(GPUHandle* Out,
 }
 
 
+ResultCode D3D12GraphicsDevice::DestroyResource(GPUHandle Handle)
+{
+    ResultCode Result = D3D12MemoryManager::DestroyResource(Handle, m_FrameCount);
+    if (Result != SResult_OK)
+    {
+        return Result;
+    }
+    std::vector<std::pair<DescriptorHeapType, GPUHandle>> Views;
+    D3D12ViewCache::Invalidate(Handle, Views);
+    for (const auto& View : Views)
+    {
+        FreeViewDescriptor(View.first, View.second);
+    }
+    return SResult_OK;
+}
+
+
+ResultCode D3D12GraphicsDevice::MapResource(GPUHandle Handle, void** OutData)
+{
+    if (!OutData)
+    {
+        return SResult_INVALID_ARGS;
+    }
+    return D3D12MemoryManager::MapResource(Handle, OutData);
+}
+
+
+ResultCode D3D12GraphicsDevice::UnmapResource(GPUHandle Handle)
+{
+    return D3D12MemoryManager::UnmapResource(Handle);
+}
+
+
 ResultCode D3D12GraphicsDevice::CreateCommandList(CommandListCreateInfo& Info, GraphicsCommandList** PList)
 {
     ResultCode Code = SResult_OK;
@@ -592,14 +783,10 @@ ResultCode D3D12GraphicsDevice::CreateCommandList(CommandListCreateInfo& Info, G
     else
     {
         D3D12GraphicsCommandList* D3DCommandList = Malloc<D3D12GraphicsCommandList>(D3D12GraphicsCommandList());
-        // We need to update for each command list.
-        std::vector<ID3D12CommandAllocator*> Allocators(m_BufferingResources.size());
-        for (U32 I = 0; I < m_BufferingResources.size(); ++I)
-        {
-            Allocators[I] = m_BufferingResources[I].PCommandAllocator;
-        }
+        // Lists take allocators from the pool of their type as they record, so lists can be recorded
+        // on separate threads.
         U32 NumBuffers = static_cast<U32>(m_BufferingResources.size());
-        Code = D3DCommandList->Initialize(m_Device, NumBuffers, Allocators.data(), CommandListType);
+        Code = D3DCommandList->Initialize(m_Device, NumBuffers, &m_AllocatorPools[CommandListType]);
         if (Code == SResult_OK)
         {
             m_PerFrameCommandLists.push_back(D3DCommandList);
@@ -618,46 +805,41 @@ ResultCode D3D12GraphicsDevice::CreateCommandList(CommandListCreateInfo& Info, G
 ResultCode D3D12GraphicsDevice::SubmitCommandLists(U32 NumSubmits,
                                                    const CommandListSubmitInfo* PSubmitInfos)
 {
-    static ID3D12CommandList* CmdListBuffer[32];
     ResultCode Code = SResult_OK;
 
     for (U32 I = 0; I < NumSubmits; ++I)
     {
-        ID3D12CommandQueue* Queue = nullptr;
         const CommandListSubmitInfo& Info = PSubmitInfos[I];
-        switch (Info.QueueToSubmit)
-        {
-            case SubmitQueue_ASYNC:
-                Queue = m_AsyncQueue;
-                break;
-            case SubmitQueue_COPY:
-                Queue = m_CopyQueue;
-                break;
-            case SubmitQueue_GRAPHICS:
-            default:
-                Queue = m_GraphicsQueue;
-                break;
-        } 
+        D3D12GraphicsCommandQueue& Queue = (Info.QueueToSubmit < SubmitQueue_COUNT) 
+                                         ? m_Queues[Info.QueueToSubmit] 
+                                         : m_Queues[SubmitQueue_GRAPHICS];
 
-        for (U32 CmdIdx = 0; CmdIdx < Info.NumCommandLists; ++CmdIdx)
+        for (U32 J = 0; J < Info.NumWaitFences; ++J)
         {
-            CmdListBuffer[CmdIdx] = static_cast<D3D12GraphicsCommandList*>(
-                Info.PCmdLists[CmdIdx])->GetNative();
+            D3D12Fence* PFence = static_cast<D3D12Fence*>(Info.WaitFences[J]);
+            Queue.GetNative()->Wait(PFence->GetNativeFence(), PFence->GetCurrentValue());   
         }
 
-        for (U32 I = 0; I < Info.NumWaitFences; ++I)
+        SyncPoint Point = Queue.Submit(Info.NumCommandLists, 
+                                       Info.PCmdLists, 
+                                       Info.NumWaitSyncPoints, 
+                                       Info.PWaitSyncPoints);
+        if (Info.OutSyncPoint)
         {
-            D3D12Fence* PFence = static_cast<D3D12Fence*>(Info.WaitFences[I]);
-            Queue->Wait(PFence->GetNativeFence(), PFence->GetCurrentValue());   
+            *Info.OutSyncPoint = Point;
+        }
+        if (Point.Value == 0)
+        {
+            // A sync point waited for was never submitted, the lists were not either.
+            Code = SResult_INVALID_ARGS;
+            continue;
         }
 
-        Queue->ExecuteCommandLists(Info.NumCommandLists, CmdListBuffer);
-
-        for (U32 I = 0; I < Info.NumSignalFences; ++I)
+        for (U32 J = 0; J < Info.NumSignalFences; ++J)
         {
-            D3D12Fence* PFence = static_cast<D3D12Fence*>(Info.SignalFences[I]);
+            D3D12Fence* PFence = static_cast<D3D12Fence*>(Info.SignalFences[J]);
             PFence->SetValue(PFence->GetCurrentValue() + 1ULL);
-            Queue->Signal(PFence->GetNativeFence(), PFence->GetCurrentValue());
+            Queue.GetNative()->Signal(PFence->GetNativeFence(), PFence->GetCurrentValue());
         }
     }
 
@@ -665,38 +847,6 @@ ResultCode D3D12GraphicsDevice::SubmitCommandLists(U32 NumSubmits,
 }
 
 
-ResultCode D3D12GraphicsDevice::CreateAsyncQueue()
-{
-    D3D12_COMMAND_QUEUE_DESC Desc = { };
-    Desc.Type = D3D12_COMMAND_LIST_TYPE_COMPUTE;
-    Desc.NodeMask = 0;
-    Desc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
-    Desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
-    HRESULT Result = m_Device->CreateCommandQueue(&Desc, __uuidof(ID3D12CommandQueue), (void**)&m_AsyncQueue);
-    if (FAILED(Result))
-    {
-        return SResult_FAILED;
-    }
-    return SResult_OK;
-}
-
-
-ResultCode D3D12GraphicsDevice::CreateCopyQueue()
-{
-    D3D12_COMMAND_QUEUE_DESC Desc = { };
-    Desc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
-    Desc.NodeMask = 0;
-    Desc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_NORMAL;
-    Desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
-    HRESULT Result = m_Device->CreateCommandQueue(&Desc, __uuidof(ID3D12CommandQueue), (void**)&m_CopyQueue);
-    if (FAILED(Result))
-    {
-        return SResult_FAILED;
-    }
-    return SResult_OK;
-}
-
-
 ResultCode D3D12GraphicsDevice::DestroyCommandLists(U32 NumCommandLists, GraphicsCommandList** CommandLists)
 {
     for (U32 I = 0; I < NumCommandLists; ++I)
@@ -712,10 +862,18 @@ ResultCode D3D12GraphicsDevice::DestroyCommandLists(U32 NumCommandLists, Graphic
 ResultCode D3D12GraphicsDevice::CreateRenderTargetView(const RenderTargetViewCreateInfo& RTV,
                                                        GPUHandle* OutHandle)
 {
-    D3D12_RENDER_TARGET_VIEW_DESC Desc = { };
+    D3D12_RENDER_TARGET_VIEW_DESC Desc;
     
+    memset(&Desc, 0, sizeof(Desc));
     GetRtvDescription(RTV, Desc);
 
+    ViewKey Key;
+    Key.Build(RTV.ResourceHandle, DescriptorHeapType_RTV, &Desc, sizeof(Desc));
+    if (D3D12ViewCache::Acquire(Key, OutHandle))
+    {
+        return SResult_OK;
+    }
+
     ResourceState ResourceStateO = { };
     D3D12MemoryManager::GetNativeResource(RTV.ResourceHandle, &ResourceStateO);
     if (!ResourceStateO.PResource)
@@ -726,6 +884,11 @@ ResultCode D3D12GraphicsDevice::CreateRenderTargetView(const RenderTargetViewCre
     D3D12_CPU_DESCRIPTOR_HANDLE RtvHandle = 
         D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_RTV)->CreateRtv(
             m_Device, Desc, ResourceStateO.PResource);
+    if (!RtvHandle.ptr)
+    {
+        return SResult_OUT_OF_MEMORY;
+    }
+    D3D12ViewCache::Insert(Key, RtvHandle.ptr);
     *OutHandle = RtvHandle.ptr;
     return SResult_OK;
 }
@@ -761,23 +924,106 @@ void D3D12GraphicsDevice::CleanUpFences()
 }
 
 
-void D3D12GraphicsDevice::ReleaseAsyncQueue()
+D3D12_DESCRIPTOR_RANGE_FLAGS GetNativeRangeFlags(DescriptorDataFlags Flags)
+{
+    // No hints means anything may change, which is how version 1.0 treats every range.
+    U32 NativeFlags = D3D12_DESCRIPTOR_RANGE_FLAG_NONE;
+    if (!(Flags & DescriptorDataFlag_DESCRIPTORS_STATIC))
+    {
+        NativeFlags |= D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE;
+    }
+    if (Flags & DescriptorDataFlag_DATA_STATIC)
+    {
+        NativeFlags |= D3D12_DESCRIPTOR_RANGE_FLAG_DATA_STATIC;
+    }
+    else if (Flags & DescriptorDataFlag_DATA_STATIC_WHILE_SET_AT_EXECUTE)
+    {
+        NativeFlags |= D3D12_DESCRIPTOR_RANGE_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE;
+    }
+    else
+    {
+        NativeFlags |= D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE;
+    }
+    return static_cast<D3D12_DESCRIPTOR_RANGE_FLAGS>(NativeFlags);
+}
+
+
+D3D12_ROOT_DESCRIPTOR_FLAGS GetNativeRootDescriptorFlags(DescriptorDataFlags Flags)
 {
-    if (m_AsyncQueue)
+    if (Flags & DescriptorDataFlag_DATA_STATIC)
+    {
+        return D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC;
+    }
+    if (Flags & DescriptorDataFlag_DATA_STATIC_WHILE_SET_AT_EXECUTE)
     {
-        m_AsyncQueue->Release();
+        return D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE;
     }
-    m_AsyncQueue = nullptr;
+    return D3D12_ROOT_DESCRIPTOR_FLAG_DATA_VOLATILE;
 }
 
 
-void D3D12GraphicsDevice::ReleaseCopyQueue()
+//! Serialize a version 1.1 root signature, or strip the flags and serialize as version 1.0 if that is all
+//! the device supports.
+HRESULT SerializeRootSignature(const D3D12_ROOT_SIGNATURE_DESC1& Desc, 
+                               D3D_ROOT_SIGNATURE_VERSION Version, 
+                               ID3DBlob** OutBlob, 
+                               ID3DBlob** OutErrorBlob)
 {
-    if (m_CopyQueue)
+    if (Version >= D3D_ROOT_SIGNATURE_VERSION_1_1)
     {
-        m_CopyQueue->Release();
+        D3D12_VERSIONED_ROOT_SIGNATURE_DESC VersionedDesc = { };
+        VersionedDesc.Version = D3D_ROOT_SIGNATURE_VERSION_1_1;
+        VersionedDesc.Desc_1_1 = Desc;
+        return D3D12SerializeVersionedRootSignature(&VersionedDesc, OutBlob, OutErrorBlob);
+    }
+
+    std::vector<D3D12_ROOT_PARAMETER> Parameters(Desc.NumParameters);
+    std::vector<std::vector<D3D12_DESCRIPTOR_RANGE>> Ranges(Desc.NumParameters);
+    for (U32 I = 0; I < Desc.NumParameters; ++I)
+    {
+        const D3D12_ROOT_PARAMETER1& Parameter = Desc.pParameters[I];
+        Parameters[I].ParameterType = Parameter.ParameterType;
+        Parameters[I].ShaderVisibility = Parameter.ShaderVisibility;
+        switch (Parameter.ParameterType)
+        {
+            case D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE:
+            {
+                for (U32 R = 0; R < Parameter.DescriptorTable.NumDescriptorRanges; ++R)
+                {
+                    const D3D12_DESCRIPTOR_RANGE1& Range = Parameter.DescriptorTable.pDescriptorRanges[R];
+                    D3D12_DESCRIPTOR_RANGE Range10 = { };
+                    Range10.RangeType = Range.RangeType;
+                    Range10.NumDescriptors = Range.NumDescriptors;
+                    Range10.BaseShaderRegister = Range.BaseShaderRegister;
+                    Range10.RegisterSpace = Range.RegisterSpace;
+                    Range10.OffsetInDescriptorsFromTableStart = Range.OffsetInDescriptorsFromTableStart;
+                    Ranges[I].push_back(Range10);
+                }
+                Parameters[I].DescriptorTable.NumDescriptorRanges = Parameter.DescriptorTable.NumDescriptorRanges;
+                Parameters[I].DescriptorTable.pDescriptorRanges = Ranges[I].data();
+                break;
+            }
+            case D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS:
+            {
+                Parameters[I].Constants = Parameter.Constants;
+                break;
+            }
+            default:
+            {
+                Parameters[I].Descriptor.ShaderRegister = Parameter.Descriptor.ShaderRegister;
+                Parameters[I].Descriptor.RegisterSpace = Parameter.Descriptor.RegisterSpace;
+                break;
+            }
+        }
     }
-    m_CopyQueue = nullptr;
+
+    D3D12_ROOT_SIGNATURE_DESC Desc10 = { };
+    Desc10.NumParameters = Desc.NumParameters;
+    Desc10.pParameters = Parameters.data();
+    Desc10.NumStaticSamplers = Desc.NumStaticSamplers;
+    Desc10.pStaticSamplers = Desc.pStaticSamplers;
+    Desc10.Flags = Desc.Flags;
+    return D3D12SerializeRootSignature(&Desc10, D3D_ROOT_SIGNATURE_VERSION_1_0, OutBlob, OutErrorBlob);
 }
 
 
@@ -785,18 +1031,27 @@ ResultCode D3D12GraphicsDevice::CreateRootSignature(RootSignature** PRootSignatu
                                                     const RootSignatureLayoutInfo& CreateInfo)
 {
     ResultCode OutResult = SResult_OK;
-    D3D12_ROOT_SIGNATURE_DESC RootSigDesc = { };
+    D3D12_ROOT_SIGNATURE_DESC1 RootSigDesc = { };
+
+    RootSignatureKey Key;
+    Key.Build(CreateInfo, m_RootSignatureVersion);
+    D3D12RootSignature* PCached = D3D12RootSignatureCache::Acquire(Key);
+    if (PCached)
+    {
+        *PRootSignature = PCached;
+        return SResult_OK;
+    }
     
-    std::vector<D3D12_ROOT_PARAMETER> DescriptorTableLayouts(CreateInfo.NumDescriptorTables);
-    std::vector<std::array<D3D12_DESCRIPTOR_RANGE, 4>> Ranges(CreateInfo.NumDescriptorTables);
+    std::vector<D3D12_ROOT_PARAMETER1> DescriptorTableLayouts(CreateInfo.NumDescriptorTables);
+    std::vector<std::array<D3D12_DESCRIPTOR_RANGE1, 4>> Ranges(CreateInfo.NumDescriptorTables);
     
     for (U32 I = 0; I < DescriptorTableLayouts.size(); ++I)
     {
         DescriptorTableLayouts[I].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
-        D3D12_DESCRIPTOR_RANGE SrvRange;
-        D3D12_DESCRIPTOR_RANGE CbvRange;
-        D3D12_DESCRIPTOR_RANGE UavRange;
-        D3D12_DESCRIPTOR_RANGE SamplerRange;    
+        D3D12_DESCRIPTOR_RANGE1 SrvRange;
+        D3D12_DESCRIPTOR_RANGE1 CbvRange;
+        D3D12_DESCRIPTOR_RANGE1 UavRange;
+        D3D12_DESCRIPTOR_RANGE1 SamplerRange;    
 
         SrvRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
         CbvRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_CBV;
@@ -810,6 +1065,7 @@ ResultCode D3D12GraphicsDevice::CreateRootSignature(RootSignature** PRootSignatu
             SrvRange.BaseShaderRegister = CreateInfo.LayoutInfos[I].Srv.BaseRegister;
             SrvRange.OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;
             SrvRange.RegisterSpace = 0;
+            SrvRange.Flags = GetNativeRangeFlags(CreateInfo.LayoutInfos[I].Srv.Flags);
             Ranges[I][NumRanges++] = SrvRange;
         }
         if (CreateInfo.LayoutInfos[I].Cbv.NumDescriptors)
@@ -818,6 +1074,7 @@ ResultCode D3D12GraphicsDevice::CreateRootSignature(RootSignature** PRootSignatu
             CbvRange.BaseShaderRegister = CreateInfo.LayoutInfos[I].Cbv.BaseRegister;
             CbvRange.OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;
             CbvRange.RegisterSpace = 0;
+            CbvRange.Flags = GetNativeRangeFlags(CreateInfo.LayoutInfos[I].Cbv.Flags);
             Ranges[I][NumRanges++] = CbvRange;
         }
         if (CreateInfo.LayoutInfos[I].Uav.NumDescriptors)
@@ -826,41 +1083,148 @@ ResultCode D3D12GraphicsDevice::CreateRootSignature(RootSignature** PRootSignatu
             UavRange.BaseShaderRegister = CreateInfo.LayoutInfos[I].Uav.BaseRegister;
             UavRange.OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;
             UavRange.RegisterSpace = 0;
+            UavRange.Flags = GetNativeRangeFlags(CreateInfo.LayoutInfos[I].Uav.Flags);
             Ranges[I][NumRanges++] = UavRange;
         }
         DescriptorTableLayouts[I].DescriptorTable.pDescriptorRanges = Ranges[I].data();
         DescriptorTableLayouts[I].DescriptorTable.NumDescriptorRanges = NumRanges;
     }
-    
+
+    // Root constants and descriptors follow the tables, each table costs one of the 64 root DWORDs.
+    U32 RootSizeInDWords = CreateInfo.NumDescriptorTables;
+    U32 FirstRootParameter = static_cast<U32>(DescriptorTableLayouts.size());
+    for (U32 I = 0; I < CreateInfo.NumRootParameters; ++I)
+    {
+        const RootParameterInfo& Info = CreateInfo.PRootParameters[I];
+        D3D12_ROOT_PARAMETER1 Parameter = { };
+        Parameter.ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+        if (Info.Type == RootParameterType_CONSTANTS)
+        {
+            Parameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+            Parameter.Constants.Num32BitValues = Info.Num32BitValues;
+            Parameter.Constants.ShaderRegister = Info.ShaderRegister;
+            Parameter.Constants.RegisterSpace = Info.RegisterSpace;
+            RootSizeInDWords += Info.Num32BitValues;
+        }
+        else
+        {
+            switch (Info.Type)
+            {
+                case RootParameterType_CBV: Parameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV; break;
+                case RootParameterType_SRV: Parameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV; break;
+                case RootParameterType_UAV: Parameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE_UAV; break;
+                default: return SResult_INVALID_ARGS;
+            }
+            Parameter.Descriptor.ShaderRegister = Info.ShaderRegister;
+            Parameter.Descriptor.RegisterSpace = Info.RegisterSpace;
+            Parameter.Descriptor.Flags = GetNativeRootDescriptorFlags(Info.Flags);
+            RootSizeInDWords += 2;
+        }
+        DescriptorTableLayouts.push_back(Parameter);
+    }
+
+    // Bindless tables go after the descriptor set tables, so set indices still match root parameters.
+    U32 BindlessResourceParameter = D3D12RootSignature::k_NoParameter;
+    U32 BindlessSamplerParameter = D3D12RootSignature::k_NoParameter;
+    U32 BindlessIndexParameter = D3D12RootSignature::k_NoParameter;
+    std::array<D3D12_DESCRIPTOR_RANGE1, 3> BindlessRanges = { };
+    if (CreateInfo.UseBindless)
+    {
+        if (!m_BindlessResources.IsEnabled())
+        {
+            return SResult_INVALID_ARGS;
+        }
+
+        // SRVs and UAVs alias the same unbounded range, told apart by register space. Indices are
+        // registered while earlier frames are in flight, so the descriptors are volatile.
+        BindlessRanges[0].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+        BindlessRanges[0].NumDescriptors = UINT_MAX;
+        BindlessRanges[0].BaseShaderRegister = 0;
+        BindlessRanges[0].RegisterSpace = BINDLESS_SRV_SPACE;
+        BindlessRanges[0].OffsetInDescriptorsFromTableStart = 0;
+        BindlessRanges[0].Flags = GetNativeRangeFlags(DescriptorDataFlag_NONE);
+        BindlessRanges[1] = BindlessRanges[0];
+        BindlessRanges[1].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+        BindlessRanges[1].RegisterSpace = BINDLESS_UAV_SPACE;
+        BindlessRanges[2] = BindlessRanges[0];
+        BindlessRanges[2].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER;
+        BindlessRanges[2].RegisterSpace = BINDLESS_SAMPLER_SPACE;
+        // Samplers have no data to hint about.
+        BindlessRanges[2].Flags = D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE;
+
+        D3D12_ROOT_PARAMETER1 Parameter = { };
+        Parameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+        Parameter.ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+        Parameter.DescriptorTable.NumDescriptorRanges = 2;
+        Parameter.DescriptorTable.pDescriptorRanges = &BindlessRanges[0];
+        BindlessResourceParameter = static_cast<U32>(DescriptorTableLayouts.size());
+        DescriptorTableLayouts.push_back(Parameter);
+
+        Parameter.DescriptorTable.NumDescriptorRanges = 1;
+        Parameter.DescriptorTable.pDescriptorRanges = &BindlessRanges[2];
+        BindlessSamplerParameter = static_cast<U32>(DescriptorTableLayouts.size());
+        DescriptorTableLayouts.push_back(Parameter);
+        RootSizeInDWords += 2;
+
+        if (CreateInfo.NumBindlessIndices)
+        {
+            Parameter = { };
+            Parameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+            Parameter.ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+            Parameter.Constants.Num32BitValues = CreateInfo.NumBindlessIndices;
+            Parameter.Constants.ShaderRegister = 0;
+            Parameter.Constants.RegisterSpace = BINDLESS_INDEX_SPACE;
+            BindlessIndexParameter = static_cast<U32>(DescriptorTableLayouts.size());
+            DescriptorTableLayouts.push_back(Parameter);
+            RootSizeInDWords += CreateInfo.NumBindlessIndices;
+        }
+    }
+
+    if (RootSizeInDWords > D3D12_MAX_ROOT_COST)
+    {
+        return SResult_INVALID_ARGS;
+    }
 
     if (DescriptorTableLayouts.size()) 
     {
-        RootSigDesc.NumParameters = CreateInfo.NumDescriptorTables;
+        RootSigDesc.NumParameters = static_cast<UINT>(DescriptorTableLayouts.size());
         RootSigDesc.pParameters = DescriptorTableLayouts.data();
         ID3DBlob* PBlob = nullptr;
         ID3DBlob* PErrorBlob = nullptr;
         ID3D12RootSignature* PNativeRootSignature = nullptr;
         
-        HRESULT Result = D3D12SerializeRootSignature(&RootSigDesc, D3D_ROOT_SIGNATURE_VERSION_1_0, 
-            &PBlob, &PErrorBlob);
-        
-        if (FAILED(Result)) 
-        {
-            OutResult = GResult_ROOT_SIGNATURE_SERIALIZATION_ERROR;
-        } 
-        else
+        if (D3D12RootSignatureCache::CreateFromBlob(m_Device, Key, &PNativeRootSignature) != SResult_OK)
         {
-            Result = m_Device->CreateRootSignature(0, PBlob->GetBufferPointer(), PBlob->GetBufferSize(), 
-                __uuidof(ID3D12RootSignature), (void**)&PNativeRootSignature);
-            if (FAILED(Result))
+            HRESULT Result = SerializeRootSignature(RootSigDesc, m_RootSignatureVersion, &PBlob, &PErrorBlob);
+            if (FAILED(Result)) 
             {
-                OutResult = GResult_ROOT_SIGNATURE_CREATION_ERROR;
+                OutResult = GResult_ROOT_SIGNATURE_SERIALIZATION_ERROR;
             } 
-            else 
+            else
             {
-                *PRootSignature = Malloc<D3D12RootSignature>(PNativeRootSignature);
+                Result = m_Device->CreateRootSignature(0, PBlob->GetBufferPointer(), PBlob->GetBufferSize(), 
+                    __uuidof(ID3D12RootSignature), (void**)&PNativeRootSignature);
+                if (FAILED(Result))
+                {
+                    OutResult = GResult_ROOT_SIGNATURE_CREATION_ERROR;
+                } 
+                else
+                {
+                    D3D12RootSignatureCache::StoreBlob(Key, PBlob->GetBufferPointer(), PBlob->GetBufferSize());
+                }
             }
         }
+
+        if (OutResult == SResult_OK)
+        {
+            D3D12RootSignature* PD3D12RootSignature = Malloc<D3D12RootSignature>(PNativeRootSignature);
+            PD3D12RootSignature->SetLayoutHash(Key.Hash);
+            PD3D12RootSignature->SetRootParameters(FirstRootParameter, CreateInfo.NumRootParameters);
+            PD3D12RootSignature->SetBindlessParameters(BindlessResourceParameter, BindlessSamplerParameter, 
+                BindlessIndexParameter);
+            D3D12RootSignatureCache::Insert(Key, PD3D12RootSignature);
+            *PRootSignature = PD3D12RootSignature;
+        }
         if (PBlob) PBlob->Release();
         if (PErrorBlob) PErrorBlob->Release();
     }
@@ -868,15 +1232,49 @@ ResultCode D3D12GraphicsDevice::CreateRootSignature(RootSignature** PRootSignatu
 }
 
 
+ResultCode D3D12GraphicsDevice::DestroyRootSignature(RootSignature** PRootSignature)
+{
+    if (!PRootSignature || !*PRootSignature)
+    {
+        return SResult_INVALID_ARGS;
+    }
+    ResultCode Result = D3D12RootSignatureCache::Release(*PRootSignature);
+    if (Result == SResult_OK)
+    {
+        *PRootSignature = nullptr;
+    }
+    return Result;
+}
+
+
+std::string D3D12GraphicsDevice::GetPipelineCachePath(const char* FileName) const
+{
+    if (m_PipelineCacheDirectory.empty())
+    {
+        return std::string();
+    }
+    return m_PipelineCacheDirectory + "/" + FileName;
+}
+
+
 ResultCode D3D12GraphicsDevice::CreateShaderResourceView(const ShaderResourceViewCreateInfo& SRV,
                                                          GPUHandle* OutHandle)
 {
-    D3D12_SHADER_RESOURCE_VIEW_DESC Desc = { };
-    ResourceState ResourceStateO;    
+    D3D12_SHADER_RESOURCE_VIEW_DESC Desc;
+    ResourceState ResourceStateO = { };
 
+    // Zeroed, so the bytes of unused union members do not split the cache key.
+    memset(&Desc, 0, sizeof(Desc));
     GetSrvDescription(SRV, Desc);
-    D3D12MemoryManager::GetNativeResource(SRV.ResourceHandle, &ResourceStateO);
 
+    ViewKey Key;
+    Key.Build(SRV.ResourceHandle, DescriptorHeapType_CBV_SRV_UAV_UPLOAD, &Desc, sizeof(Desc));
+    if (D3D12ViewCache::Acquire(Key, OutHandle))
+    {
+        return SResult_OK;
+    }
+
+    D3D12MemoryManager::GetNativeResource(SRV.ResourceHandle, &ResourceStateO);
     if (!ResourceStateO.PResource)
     {
         return SResult_OBJECT_NOT_FOUND;
@@ -885,6 +1283,17 @@ ResultCode D3D12GraphicsDevice::CreateShaderResourceView(const ShaderResourceVie
     DescriptorPool* Pool = D3D12DescriptorManager::GetDescriptorPool(
         DescriptorHeapType_CBV_SRV_UAV_UPLOAD);
     D3D12_CPU_DESCRIPTOR_HANDLE Handle = Pool->CreateSrv(m_Device, Desc, ResourceStateO.PResource);
+    if (!Handle.ptr)
+    {
+        return SResult_OUT_OF_MEMORY;
+    }
+    ResultCode Result = RegisterBindlessView(m_BindlessResources, Handle.ptr);
+    if (Result != SResult_OK)
+    {
+        Pool->FreeDescriptor(Handle, m_FrameCount);
+        return Result;
+    }
+    D3D12ViewCache::Insert(Key, Handle.ptr);
     *OutHandle = Handle.ptr;
     return SResult_OK;
 }
@@ -893,11 +1302,19 @@ ResultCode D3D12GraphicsDevice::CreateShaderResourceView(const ShaderResourceVie
 ResultCode D3D12GraphicsDevice::CreateDepthStencilView(const DepthStencilViewCreateInfo& DSV,
                                                        GPUHandle* OutHandle)
 {
-    D3D12_DEPTH_STENCIL_VIEW_DESC Desc = { };
+    D3D12_DEPTH_STENCIL_VIEW_DESC Desc;
 
+    memset(&Desc, 0, sizeof(Desc));
     GetDsvDescription(DSV, Desc);
 
-    ResourceState RSO;
+    ViewKey Key;
+    Key.Build(DSV.ResourceHandle, DescriptorHeapType_DSV, &Desc, sizeof(Desc));
+    if (D3D12ViewCache::Acquire(Key, OutHandle))
+    {
+        return SResult_OK;
+    }
+
+    ResourceState RSO = { };
     D3D12MemoryManager::GetNativeResource(DSV.ResourceHandle, &RSO);
 
     if (!RSO.PResource)
@@ -905,33 +1322,193 @@ ResultCode D3D12GraphicsDevice::CreateDepthStencilView(const DepthStencilViewCre
         return SResult_OBJECT_NOT_FOUND;
     }
 
-    DescriptorPool* Pool = D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_CBV_SRV_UAV_UPLOAD);
+    DescriptorPool* Pool = D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_DSV);
     D3D12_CPU_DESCRIPTOR_HANDLE Handle = Pool->CreateDsv(m_Device, Desc, RSO.PResource);
+    if (!Handle.ptr)
+    {
+        return SResult_OUT_OF_MEMORY;
+    }
+    D3D12ViewCache::Insert(Key, Handle.ptr);
+    *OutHandle = Handle.ptr;
+
+    return SResult_OK;
+}
+
+
+ResultCode D3D12GraphicsDevice::CreateSampler(const SamplerCreateInfo& Info, GPUHandle* OutHandle)
+{
+    D3D12_SAMPLER_DESC Desc = { };
+    GetSamplerDescription(Info, Desc);
+
+    SamplerKey Key;
+    Key.Build(Desc);
+    if (D3D12SamplerCache::Acquire(Key, OutHandle))
+    {
+        return SResult_OK;
+    }
+
+    DescriptorPool* Pool = D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_SAMPLER_UPLOAD);
+    D3D12_CPU_DESCRIPTOR_HANDLE Handle = Pool->CreateSampler(m_Device, Key.Desc);
+    if (!Handle.ptr)
+    {
+        return SResult_OUT_OF_MEMORY;
+    }
+    ResultCode Result = RegisterBindlessView(m_BindlessSamplers, Handle.ptr);
+    if (Result != SResult_OK)
+    {
+        Pool->FreeDescriptor(Handle, m_FrameCount);
+        return Result;
+    }
+    D3D12SamplerCache::Insert(Key, Handle.ptr);
     *OutHandle = Handle.ptr;
+    return SResult_OK;
+}
+
+
+ResultCode D3D12GraphicsDevice::FreeViewDescriptor(DescriptorHeapType Type, GPUHandle Handle)
+{
+    DescriptorPool* Pool = D3D12DescriptorManager::GetDescriptorPool(Type);
+    if (!Pool)
+    {
+        return SResult_NOT_INITIALIZED;
+    }
+    D3D12DescriptorManager::RemoveCachedDescriptorToResource(Handle);
+    // The slot is reused by later views, tables holding this one must not be found by them.
+    D3D12DescriptorTableCache::InvalidateView(Handle, m_FrameCount);
+
+    auto Bindless = m_BindlessIndices.find(Handle);
+    if (Bindless != m_BindlessIndices.end())
+    {
+        D3D12BindlessTable& Table = (Type == DescriptorHeapType_SAMPLER_UPLOAD) ? m_BindlessSamplers 
+                                                                                : m_BindlessResources;
+        Table.Unregister(Bindless->second, m_FrameCount);
+        m_BindlessIndices.erase(Bindless);
+    }
+
+    // In flight frames may still reference this descriptor, keep it until this frame retires.
+    return Pool->FreeDescriptor({ static_cast<SIZE_T>(Handle) }, m_FrameCount);
+}
+
+
+ResultCode D3D12GraphicsDevice::InitializeBindless(const GraphicsDeviceConfig& DeviceConfig, U32 BufferingCount)
+{
+    if (!DeviceConfig.EnableBindless)
+    {
+        return SResult_OK;
+    }
+    U32 ResourceCapacity = DeviceConfig.BindlessResourceCapacity ? DeviceConfig.BindlessResourceCapacity : 4096;
+    U32 SamplerCapacity = DeviceConfig.BindlessSamplerCapacity ? DeviceConfig.BindlessSamplerCapacity : 256;
+    ResultCode Result = m_BindlessResources.Initialize(DescriptorHeapType_CBV_SRV_UAV, BufferingCount, ResourceCapacity);
+    if (Result != SResult_OK)
+    {
+        return Result;
+    }
+    return m_BindlessSamplers.Initialize(DescriptorHeapType_SAMPLER, BufferingCount, SamplerCapacity);
+}
+
 
+ResultCode D3D12GraphicsDevice::RegisterBindlessView(D3D12BindlessTable& Table, GPUHandle Handle)
+{
+    if (!Table.IsEnabled())
+    {
+        return SResult_OK;
+    }
+    U32 Index = D3D12BindlessTable::k_InvalidIndex;
+    ResultCode Result = Table.Register(m_Device, { static_cast<SIZE_T>(Handle) }, &Index);
+    if (Result != SResult_OK)
+    {
+        return Result;
+    }
+    m_BindlessIndices[Handle] = Index;
+    return SResult_OK;
+}
+
+
+ResultCode D3D12GraphicsDevice::GetBindlessIndex(GPUHandle ViewHandle, U32* OutIndex)
+{
+    auto Iter = m_BindlessIndices.find(ViewHandle);
+    if (Iter == m_BindlessIndices.end())
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+    *OutIndex = Iter->second;
     return SResult_OK;
 }
 
 
+ResultCode D3D12GraphicsDevice::ReleaseView(DescriptorHeapType Type, GPUHandle Handle)
+{
+    // Every view is made through the cache. One it does not know was never created, or was already
+    // freed with its resource, and freeing it again would free a slot another view may now hold.
+    B32 LastReference = false;
+    ResultCode Result = D3D12ViewCache::Release(Handle, &LastReference);
+    if (Result != SResult_OK)
+    {
+        return Result;
+    }
+    if (!LastReference)
+    {
+        return SResult_OK;
+    }
+    return FreeViewDescriptor(Type, Handle);
+}
+
+
+ResultCode D3D12GraphicsDevice::DestroyShaderResourceView(GPUHandle Handle)
+{
+    return ReleaseView(DescriptorHeapType_CBV_SRV_UAV_UPLOAD, Handle);
+}
+
+
+ResultCode D3D12GraphicsDevice::DestroyRenderTargetView(GPUHandle Handle)
+{
+    return ReleaseView(DescriptorHeapType_RTV, Handle);
+}
+
+
+ResultCode D3D12GraphicsDevice::DestroyDepthStencilView(GPUHandle Handle)
+{
+    return ReleaseView(DescriptorHeapType_DSV, Handle);
+}
+
+
+ResultCode D3D12GraphicsDevice::DestroyUnorderedAccessView(GPUHandle Handle)
+{
+    return ReleaseView(DescriptorHeapType_CBV_SRV_UAV_UPLOAD, Handle);
+}
+
+
+ResultCode D3D12GraphicsDevice::DestroyConstantBufferView(GPUHandle Handle)
+{
+    return FreeViewDescriptor(DescriptorHeapType_CBV_SRV_UAV_UPLOAD, Handle);
+}
+
+
+ResultCode D3D12GraphicsDevice::DestroySampler(GPUHandle Handle)
+{
+    // Every sampler is created through the cache, a handle it does not know was already destroyed.
+    B32 LastReference = false;
+    ResultCode Result = D3D12SamplerCache::Release(Handle, &LastReference);
+    if (Result != SResult_OK)
+    {
+        return Result;
+    }
+    // Other creates still share the descriptor, and its bindless index.
+    if (!LastReference)
+    {
+        return SResult_OK;
+    }
+    return FreeViewDescriptor(DescriptorHeapType_SAMPLER_UPLOAD, Handle);
+}
+
+
 ResultCode D3D12GraphicsDevice::AllocateDescriptorSets(U32 NumDescriptorSets, DescriptorSet** POutSets,
     DescriptorSetLayoutInfo* PLayouts)
 {
-    DescriptorPool* CBVSRVUAVPool = D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_CBV_SRV_UAV);
-    DescriptorPool* SamplerPool = D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_SAMPLER);
-    U64 CBVSRVUAVAlignment = CBVSRVUAVPool->GetAlignmentSizeInBytes();
-    U64 SamplerAlignment = SamplerPool->GetAlignmentSizeInBytes();
-
     for (U32 I = 0; I < NumDescriptorSets; ++I)
     {
         D3D12DescriptorSet* Set = Malloc<D3D12DescriptorSet>();
-        DescriptorSetLayoutInfo& Layout = PLayouts[I];
-        U64 SrvSize =       static_cast<U64>(Layout.Srv.NumDescriptors);
-        U32 CbvSize =       static_cast<U64>(Layout.Cbv.NumDescriptors);
-        U64 UavSize =       static_cast<U64>(Layout.Uav.NumDescriptors);
-        U64 SamplerSize =   static_cast<U64>(Layout.Sampler.NumDescriptors);
-        CBVSRVUAVPool->AllocateDescriptorTable(&Set->TableUpload, 
-            (SrvSize + CbvSize + UavSize) * CBVSRVUAVAlignment);
-        SamplerPool->AllocateDescriptorTable(&Set->SamplerTableUpload, SamplerSize * SamplerAlignment);
+        Set->Initialize(PLayouts[I]);
         POutSets[I] = Set; 
     }
     return SResult_OK;
@@ -940,7 +1517,7 @@ ResultCode D3D12GraphicsDevice::AllocateDescriptorSets(U32 NumDescriptorSets, De
 
 ResultCode D3D12GraphicsDevice::CreateGraphicsPipeline(PipelineState** OutPipelineState, const GraphicsPipelineStateCreateInfo& CreateInfo)
 {
-    D3D12PipelineState* PipelineState = Malloc<D3D12PipelineState>();
+    D3D12PipelineState* PipelineState = nullptr;
     D3D12_GRAPHICS_PIPELINE_STATE_DESC Desc = { };
 
     TRANSLATE_SHADER_MODULE(CreateInfo, Desc, PVertexShader,    VS);
@@ -961,14 +1538,16 @@ ResultCode D3D12GraphicsDevice::CreateGraphicsPipeline(PipelineState** OutPipeli
                                                    : nullptr;
     Desc.DSVFormat =            GetCommonFormatToDXGIFormat(CreateInfo.DepthStencilFormat);
     
-    ResultCode Result = PipelineState->Initialize(m_Device, Desc);
+    PipelineStateKey Key;
+    Key.Build(CreateInfo);
+    ResultCode Result = D3D12PipelineStateCache::Acquire(m_Device, Key, Desc, CreateInfo, &PipelineState);
 
     if (Result != SResult_OK)
     {
-        delete PipelineState;
         return Result;
     }
     
+    D3D12PipelineUsage::StoreShaders(CreateInfo);
     *OutPipelineState = PipelineState;
 
     return Result;
@@ -978,22 +1557,73 @@ ResultCode D3D12GraphicsDevice::CreateGraphicsPipeline(PipelineState** OutPipeli
 ResultCode D3D12GraphicsDevice::CreateComputePipeline(PipelineState** OutPipelineState,
                                                       const ComputePipelineStateCreateInfo& CreateInfo)
 {
-    D3D12PipelineState* PipelineState = Malloc<D3D12PipelineState>();
+    D3D12PipelineState* PipelineState = nullptr;
     D3D12_COMPUTE_PIPELINE_STATE_DESC Desc = { };
     Desc.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
     Desc.NodeMask = 0;
     Desc.pRootSignature = CreateInfo.RootSig ? static_cast<D3D12RootSignature*>(CreateInfo.RootSig)->GetNative() 
                                              : nullptr;
     TRANSLATE_SHADER_MODULE(CreateInfo, Desc, PComputeShader, CS);
-    ResultCode Result = PipelineState->Initialize(m_Device, Desc);
+
+    PipelineStateKey Key;
+    Key.Build(CreateInfo);
+    ResultCode Result = D3D12PipelineStateCache::Acquire(m_Device, Key, Desc, CreateInfo, &PipelineState);
 
     if (Result != SResult_OK)
     {
-        delete PipelineState;
         return Result;
     }
 
+    D3D12PipelineUsage::StoreShaders(CreateInfo);
     *OutPipelineState = PipelineState;
     return Result;
 }
+
+
+ResultCode D3D12GraphicsDevice::DestroyPipelineState(PipelineState** PPipelineState)
+{
+    if (!PPipelineState || !*PPipelineState)
+    {
+        return SResult_INVALID_ARGS;
+    }
+    ResultCode Result = D3D12PipelineStateCache::Release(*PPipelineState);
+    if (Result == SResult_OK)
+    {
+        *PPipelineState = nullptr;
+    }
+    return Result;
+}
+
+
+ResultCode D3D12GraphicsDevice::GetPipelineCacheStatistics(PipelineCacheStatistics* OutStatistics)
+{
+    if (!OutStatistics)
+    {
+        return SResult_INVALID_ARGS;
+    }
+    *OutStatistics = D3D12PipelineStateCache::GetStatistics();
+    return SResult_OK;
+}
+
+
+ResultCode D3D12GraphicsDevice::GetViewCacheStatistics(ViewCacheStatistics* OutStatistics)
+{
+    if (!OutStatistics)
+    {
+        return SResult_INVALID_ARGS;
+    }
+    *OutStatistics = D3D12ViewCache::GetStatistics();
+    return SResult_OK;
+}
+
+
+ResultCode D3D12GraphicsDevice::GetSamplerCacheStatistics(SamplerCacheStatistics* OutStatistics)
+{
+    if (!OutStatistics)
+    {
+        return SResult_INVALID_ARGS;
+    }
+    *OutStatistics = D3D12SamplerCache::GetStatistics();
+    return SResult_OK;
+}
 } // Synthe
\ No newline at end of file
@@ -10,11 +10,16 @@
 #include "Win32Common.hpp"
 #include "D3D12Swapchain.hpp"
 #include "D3D12CommandList.hpp"
+#include "D3D12CommandAllocatorPool.hpp"
+#include "D3D12GraphicsCommandQueue.hpp"
 #include "D3D12Resource.hpp"
+#include "D3D12BindlessTable.hpp"
 
+#include <deque>
 #include <list>
 #include <unordered_map>
 #include <map>
+#include <string>
 
 
 namespace Synthe {
@@ -43,13 +48,21 @@ enum DescriptorHeapType
 //! The Buffering resources that are used as part of the number of allowed frames in flight.
 struct BufferingResource
 {
-    ID3D12CommandAllocator* PCommandAllocator;
     ID3D12Fence* PWaitFence;
     HANDLE FenceEventWait;
     U64 FenceWaitValue;
 };
 
 
+//! Where each queue's timeline stood when a frame ended. The frame is finished once every queue has
+//! completed its value, a queue the frame did not touch holds an older, already reached value.
+struct FrameSyncPoints
+{
+    U64 Frame;
+    U64 QueueValues[SubmitQueue_COUNT];
+};
+
+
 //! D3D12 Graphics Device. This handles the API layer of the graphics accelerator.
 //!
 class D3D12GraphicsDevice : public GraphicsDevice {
@@ -59,7 +72,9 @@ public:
         , m_Device(nullptr)
         , m_Adapter(nullptr)
         , m_BufferIndex(0ULL)
-        , m_GraphicsQueue(nullptr)
+        , m_FrameCount(1ULL)
+        , m_LastCompletedFrame(0ULL)
+        , m_RootSignatureVersion(D3D_ROOT_SIGNATURE_VERSION_1_0)
 #if DIRECTML_COMPATIBLE
         , m_MLDevice(nullptr)
 #endif 
@@ -78,8 +93,14 @@ public:
     //! \return The current buffer index that corresponds to in flight frames.
     U32 GetCurrentBufferIndex() const { return m_BufferIndex; }
 
+    //! The current frame number. Starts at 1, and is incremented on every End().
+    U64 GetCurrentFrame() const { return m_FrameCount; }
+
+    //! The last frame that the GPU is known to have finished.
+    U64 GetLastCompletedFrame() const { return m_LastCompletedFrame; }
+
     //! Get the graphics queue.
-    ID3D12CommandQueue* GetGraphicsQueue() { return m_GraphicsQueue; }
+    ID3D12CommandQueue* GetGraphicsQueue() { return m_Queues[SubmitQueue_GRAPHICS].GetNative(); }
 
     //! Submit call to present the final back buffer to window.
     ResultCode Present() override;
@@ -95,6 +116,12 @@ public:
                               const ResourceCreateInfo* PCreateInfo, 
                               const ClearValue* PClearValue) override;
 
+    //! Persistently map an upload resource.
+    ResultCode MapResource(GPUHandle Handle, void** OutData) override;
+
+    //! Release a mapping made with MapResource().
+    ResultCode UnmapResource(GPUHandle Handle) override;
+
     //! Get the buffering resource corresponding to the buffer index.
     const BufferingResource& GetBufferingResource(U32 BufferIndex) const { return m_BufferingResources[BufferIndex]; }
     void SubmitCommandListsToBackBuffer(ID3D12CommandList* const* PPCommandLists, U32 Count, U32 FrameIndex);
@@ -106,6 +133,9 @@ public:
     ResultCode SubmitCommandLists(U32 NumSubmits, 
                                   const CommandListSubmitInfo* PSubmitInfos) override;
 
+    //! Get a queue of the device.
+    GraphicsCommandQueue* GetCommandQueue(SubmitQueue Queue) override;
+
     //! Create a D3D12 native command list.
     ResultCode CreateCommandList(CommandListCreateInfo& Info, 
                                  GraphicsCommandList** PList) override;
@@ -122,9 +152,42 @@ public:
     ResultCode CreateDepthStencilView(const DepthStencilViewCreateInfo& DSV,
                                       GPUHandle* OutHandle) override;
 
+    //! Create a D3D12 sampler, shared with every identical sampler alive.
+    ResultCode CreateSampler(const SamplerCreateInfo& Info, GPUHandle* OutHandle) override;
+
+    //! Get the counters of the sampler cache.
+    ResultCode GetSamplerCacheStatistics(SamplerCacheStatistics* OutStatistics) override;
+
+    //! Destroy a resource, along with its views.
+    ResultCode DestroyResource(GPUHandle Handle) override;
+
+    //! Destroy view functions. Descriptors are recycled once the current frame is retired.
+    ResultCode DestroyShaderResourceView(GPUHandle Handle) override;
+    ResultCode DestroyRenderTargetView(GPUHandle Handle) override;
+    ResultCode DestroyDepthStencilView(GPUHandle Handle) override;
+    ResultCode DestroyUnorderedAccessView(GPUHandle Handle) override;
+    ResultCode DestroyConstantBufferView(GPUHandle Handle) override;
+    ResultCode DestroySampler(GPUHandle Handle) override;
+
+    //! Get the counters of the view cache.
+    ResultCode GetViewCacheStatistics(ViewCacheStatistics* OutStatistics) override;
+
+    //! Get the bindless index of a view.
+    ResultCode GetBindlessIndex(GPUHandle ViewHandle, U32* OutIndex) override;
+
+    //! Global table of SRVs and UAVs, disabled unless the device was created with bindless enabled.
+    const D3D12BindlessTable& GetBindlessResourceTable() const { return m_BindlessResources; }
+
+    //! Global table of samplers, disabled unless the device was created with bindless enabled.
+    const D3D12BindlessTable& GetBindlessSamplerTable() const { return m_BindlessSamplers; }
+
     //!
     ResultCode CreateRootSignature(RootSignature** PRootSignature, const RootSignatureLayoutInfo& CreateInfo) override;
 
+    //! Give back a root signature. Identical layouts share one root signature, destroyed with the last
+    //! reference.
+    ResultCode DestroyRootSignature(RootSignature** PRootSignature) override;
+
     //! 
     ResultCode AllocateDescriptorSets(U32 NumDescriptorSets, 
                                       DescriptorSet** PDescriptorSets,
@@ -138,6 +201,12 @@ public:
     ResultCode CreateComputePipeline(PipelineState** OutPipelineState,
                                      const ComputePipelineStateCreateInfo& CreateInfo) override;
 
+    //! Give back a pipeline state created by this device.
+    ResultCode DestroyPipelineState(PipelineState** PPipelineState) override;
+
+    //! Get the counters of the pipeline state cache.
+    ResultCode GetPipelineCacheStatistics(PipelineCacheStatistics* OutStatistics) override;
+
 
     //! Begin the frame. This will prepare resources, along with prepare command lists and 
     //! other buffering resources.
@@ -172,48 +241,65 @@ public:
     ID3D12Device* GetNative() { return m_Device; }
 
 private:
-    //! Creates the back buffer queue.
-    ResultCode CreateGraphicsQueue();
+    //! Creates the graphics, asynchronous, and copy queues. The allocator pools must be initialized.
+    ResultCode CreateCommandQueues();
 
-    //! Creates the asynchronous queue.
-    ResultCode CreateAsyncQueue();
+    void CleanUpFences();
 
-    //! Creates the copy queue.
-    ResultCode CreateCopyQueue();
+    //! Move the last completed frame past every ended frame that has finished on all queues.
+    void RetireCompletedFrames();
 
-    void CleanUpFences();
+    //! Free a view descriptor from the given host pool, deferred until the current frame retires.
+    ResultCode FreeViewDescriptor(DescriptorHeapType Type, GPUHandle Handle);
+
+    //! Give back a reference to a cached view, freeing its descriptor with the last one. Returns
+    //! SResult_OBJECT_NOT_FOUND, freeing nothing, for views the cache no longer tracks.
+    ResultCode ReleaseView(DescriptorHeapType Type, GPUHandle Handle);
+
+    //! Give a newly created view an index in the bindless table, if bindless is enabled.
+    ResultCode RegisterBindlessView(D3D12BindlessTable& Table, GPUHandle Handle);
+
+    //! Reserve the bindless tables in the shader visible heaps, if enabled in the config.
+    ResultCode InitializeBindless(const GraphicsDeviceConfig& DeviceConfig, U32 BufferingCount);
+
+    //! Get the path of a file in the pipeline cache directory, empty if caches are not persisted.
+    std::string GetPipelineCachePath(const char* FileName) const;
 
     //! Cleans up buffering resources.
     void CleanUpBufferingResources();
 
     //! Queries for frame in flight buffers.
     void QueryBufferingResources(U32 BufferingCount);
-    
-    //! Release the asynchronous queue.
-    void ReleaseAsyncQueue();
-    
-    //! Release the copy queue.
-    void ReleaseCopyQueue();
 
     //! Our buffering resources.
     std::vector<BufferingResource>              m_BufferingResources;
 
-    //! 
-    ID3D12CommandQueue*                         m_GraphicsQueue;
-    
-    //! Asynchronous queue should any be available.
-    ID3D12CommandQueue*                         m_AsyncQueue;
-
-    //! Copy queue should any be available.
-    ID3D12CommandQueue*                         m_CopyQueue;
+    //! Queues, indexed by SubmitQueue.
+    D3D12GraphicsCommandQueue                   m_Queues[SubmitQueue_COUNT];
 
     U32                                         m_BufferIndex;
 
-    std::map<GPUHandle, D3D12DescriptorSet*>    m_DescriptorSets;
+    //! Frame counter, used to defer recycling of objects the GPU may still be reading.
+    U64                                         m_FrameCount;
+
+    //! Last frame the GPU has been observed to finish, on every queue.
+    U64                                         m_LastCompletedFrame;
+
+    //! Ended frames not yet finished on every queue, oldest first.
+    std::deque<FrameSyncPoints>                 m_PendingFrames;
+
+    //! Bindless tables, and the index of each view registered in them.
+    D3D12BindlessTable                          m_BindlessResources;
+    D3D12BindlessTable                          m_BindlessSamplers;
+    std::unordered_map<GPUHandle, U32>          m_BindlessIndices;
+
     std::list<D3D12GraphicsCommandList*>        m_PerFrameCommandLists;
     std::unordered_map<GPUHandle, D3D12Fence*>  m_Fences;
     D3D12GraphicsCommandList                    m_BackbufferCommandList;
 
+    //! Command allocator pools, indexed by D3D12_COMMAND_LIST_TYPE.
+    D3D12CommandAllocatorPool                   m_AllocatorPools[4];
+
     ID3D12Device*                               m_Device;
     ID3D12Device5*                              m_AdvDevice;
     IDXGIFactory2*                              m_PFactory;
@@ -223,5 +309,15 @@ private:
 #endif
     D3D12Swapchain                              m_Swapchain;
     D3D12_RESOURCE_HEAP_TIER                    m_ResourceHeapTier;
+
+    //! Highest root signature version supported, descriptor data hints need 1.1.
+    D3D_ROOT_SIGNATURE_VERSION                  m_RootSignatureVersion;
+
+    //! Directory of persistent caches, empty if not persisted.
+    std::string                                 m_PipelineCacheDirectory;
+
+    //! Created at startup from the usage recorded in earlier runs, holding a reference until clean up.
+    std::vector<RootSignature*>                 m_PrewarmedRootSignatures;
+    std::vector<PipelineState*>                 m_PrewarmedPipelineStates;
 };
 } // Synthe
\ No newline at end of file
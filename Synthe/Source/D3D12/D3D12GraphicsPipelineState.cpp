@@ -113,7 +113,7 @@ ResultCode D3D12PipelineState::Initialize(ID3D12Device* PDevice, const D3D12_GRA
 
 ResultCode D3D12PipelineState::Initialize(ID3D12Device* PDevice, const D3D12_COMPUTE_PIPELINE_STATE_DESC& Desc)
 {
-    HRESULT Result = PDevice->CreateComputePipelineState(&Desc, __uuidof(ID3D12PipelineState), (void**)m_Pipeline);
+    HRESULT Result = PDevice->CreateComputePipelineState(&Desc, __uuidof(ID3D12PipelineState), (void**)&m_Pipeline);
     if (FAILED(Result))
     {
         return SResult_INITIALIZATION_FAILURE;
@@ -122,4 +122,53 @@ ResultCode D3D12PipelineState::Initialize(ID3D12Device* PDevice, const D3D12_COM
     m_Metadata.Type = PipelineStateType_COMPUTE;
     return SResult_OK;
 }
+
+
+ResultCode D3D12PipelineState::Initialize(ID3D12PipelineState* PPipeline, PipelineStateType Type)
+{
+    if (!PPipeline)
+    {
+        return SResult_INVALID_ARGS;
+    }
+    m_Pipeline = PPipeline;
+    m_Metadata.Type = Type;
+    return SResult_OK;
+}
+
+
+ResultCode D3D12PipelineState::Wait()
+{
+    if (GetStatus() == PipelineStateStatus_COMPILING)
+    {
+        m_Compiled.wait();
+    }
+    return GetStatus() == PipelineStateStatus_READY ? SResult_OK : SResult_INITIALIZATION_FAILURE;
+}
+
+
+void D3D12PipelineState::MarkCompiling(PipelineStateType Type, 
+                                       std::shared_future<void> Compiled, 
+                                       PipelineState* PFallback)
+{
+    m_Metadata.Type = Type;
+    m_Compiled = Compiled;
+    m_PFallback = PFallback;
+    m_Status.store(PipelineStateStatus_COMPILING, std::memory_order_release);
+}
+
+
+void D3D12PipelineState::MarkCompiled(B32 Succeeded)
+{
+    m_Status.store(Succeeded ? PipelineStateStatus_READY : PipelineStateStatus_FAILED, std::memory_order_release);
+}
+
+
+void D3D12PipelineState::Release()
+{
+    if (m_Pipeline)
+    {
+        m_Pipeline->Release();
+        m_Pipeline = nullptr;
+    }
+}
 } // Synthe
\ No newline at end of file
@@ -6,6 +6,10 @@
 
 #include "Win32Common.hpp"
 #include "Graphics/PipelineState.hpp"
+#include "D3D12PipelineUsage.hpp"
+
+#include <atomic>
+#include <future>
 
 namespace Synthe {
 
@@ -13,7 +17,30 @@ class D3D12PipelineState : public PipelineState
 {
 public:
     D3D12PipelineState()
-        : m_Pipeline(nullptr) { }
+        : m_Pipeline(nullptr)
+        , m_Status(PipelineStateStatus_READY)
+        , m_PFallback(nullptr) { }
+
+    PipelineStateStatus GetStatus() const override 
+    { 
+        return static_cast<PipelineStateStatus>(m_Status.load(std::memory_order_acquire)); 
+    }
+
+    ResultCode Wait() override;
+
+    //! Mark the pipeline as compiling. Wait() blocks on the given future, which must be fulfilled after
+    //! MarkCompiled().
+    void MarkCompiling(PipelineStateType Type, std::shared_future<void> Compiled, PipelineState* PFallback);
+
+    //! Publish the result of an asynchronous compile.
+    void MarkCompiled(B32 Succeeded);
+
+    //! Get the pipeline to bind while this one compiles, may be nullptr.
+    PipelineState* GetFallback() const { return m_PFallback; }
+
+    //! Count a bind, for pipeline usage recording.
+    void MarkUsed(U64 Frame) { m_Usage.MarkUsed(Frame); }
+    const PipelineUsageCounter& GetUsage() const { return m_Usage; }
 
     //! Generate the native depth stencil description.
     static D3D12_DEPTH_STENCIL_DESC GenerateDepthStencilDescription(const GraphicsDepthStencilStateDesc& Info);
@@ -31,12 +58,27 @@ public:
     ResultCode Initialize(ID3D12Device* PDevice, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& Desc);
     //! Initialize the native compute pipeline state.
     ResultCode Initialize(ID3D12Device* PDevice, const D3D12_COMPUTE_PIPELINE_STATE_DESC& Desc);
+    //! Initialize from an already created native pipeline state, taking ownership of it.
+    ResultCode Initialize(ID3D12PipelineState* PPipeline, PipelineStateType Type);
+
+    //! Release the native pipeline state.
+    void Release();
 
     //! Return the native pipeline state handled by the driver.
     ID3D12PipelineState* GetNative() { return m_Pipeline; }
 
 private:
-    //! Native pipeline.
+    //! Native pipeline, only valid once ready.
     ID3D12PipelineState* m_Pipeline;
+
+    //! PipelineStateStatus, published after m_Pipeline is written.
+    std::atomic<U32> m_Status;
+
+    //! Fulfilled when an asynchronous compile completes.
+    std::shared_future<void> m_Compiled;
+
+    PipelineState* m_PFallback;
+
+    PipelineUsageCounter m_Usage;
 };
 } // Synthe
\ No newline at end of file
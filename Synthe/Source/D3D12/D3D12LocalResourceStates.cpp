@@ -0,0 +1,165 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "D3D12LocalResourceStates.hpp"
+#include "D3D12BarrierBatcher.hpp"
+#include "D3D12MemoryManager.hpp"
+
+namespace Synthe {
+
+
+//! State of a subresource the list has not used yet.
+static const D3D12_RESOURCE_STATES k_UnknownState = static_cast<D3D12_RESOURCE_STATES>(-1);
+
+
+static D3D12_RESOURCE_BARRIER MakeTransition(ID3D12Resource* PResource,
+                                             U32 Subresource,
+                                             D3D12_RESOURCE_STATES Before,
+                                             D3D12_RESOURCE_STATES After)
+{
+    D3D12_RESOURCE_BARRIER Barrier = { };
+    Barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    Barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+    Barrier.Transition.pResource = PResource;
+    Barrier.Transition.Subresource = Subresource;
+    Barrier.Transition.StateBefore = Before;
+    Barrier.Transition.StateAfter = After;
+    return Barrier;
+}
+
+
+void D3D12LocalResourceStates::Transition(GPUHandle ResourceKey,
+                                          ID3D12Resource* PResource,
+                                          U32 NumSubresources,
+                                          U32 Subresource,
+                                          D3D12_RESOURCE_STATES State,
+                                          B32 Split,
+                                          D3D12BarrierBatcher& Barriers,
+                                          ID3D12GraphicsCommandList* PList)
+{
+    auto Iter = m_Resources.find(ResourceKey);
+    if (Iter == m_Resources.end())
+    {
+        Iter = m_Resources.insert({ ResourceKey, { PResource, NumSubresources, k_UnknownState, { } } }).first;
+    }
+    LocalResource& Local = Iter->second;
+
+    // Known states get a barrier, unknown ones are left for Resolve().
+    auto Move = [&] (U32 Index, D3D12_RESOURCE_STATES& Current) -> void
+        {
+            if (Current == k_UnknownState)
+            {
+                m_FirstUses.push_back({ ResourceKey, Index, State });
+            }
+            else
+            {
+                Barriers.Transition(PList, PResource, Index, Current, State, Split);
+            }
+            Current = State;
+        };
+
+    if (Subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES || Local.NumSubresources == 1)
+    {
+        if (Local.Subresources.empty())
+        {
+            Move(D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, Local.State);
+            return;
+        }
+        for (U32 I = 0; I < Local.NumSubresources; ++I)
+        {
+            Move(I, Local.Subresources[I]);
+        }
+        Local.Subresources.clear();
+        Local.State = State;
+        return;
+    }
+
+    if (Subresource >= Local.NumSubresources)
+    {
+        return;
+    }
+    if (Local.Subresources.empty())
+    {
+        if (Local.State == State)
+        {
+            // Lets the batcher end an open split transition, and count the request.
+            Barriers.Transition(PList, PResource, Subresource, State, State, Split);
+            return;
+        }
+        Local.Subresources.assign(Local.NumSubresources, Local.State);
+    }
+    Move(Subresource, Local.Subresources[Subresource]);
+
+    for (D3D12_RESOURCE_STATES Other : Local.Subresources)
+    {
+        if (Other != State)
+        {
+            return;
+        }
+    }
+    Local.Subresources.clear();
+    Local.State = State;
+}
+
+
+void D3D12LocalResourceStates::Resolve(std::vector<D3D12_RESOURCE_BARRIER>& OutBarriers)
+{
+    for (const FirstUse& Use : m_FirstUses)
+    {
+        ResourceState Global;
+        if (D3D12MemoryManager::GetNativeResource(Use.ResourceKey, &Global) != SResult_OK)
+        {
+            continue;
+        }
+        D3D12_RESOURCE_STATES Current;
+        if (Use.Subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES && Global.SubresourcesDiverged)
+        {
+            for (U32 I = 0; I < Global.NumSubresources; ++I)
+            {
+                D3D12MemoryManager::GetSubresourceState(Use.ResourceKey, I, &Current);
+                if (Current != Use.State)
+                {
+                    OutBarriers.push_back(MakeTransition(Global.PResource, I, Current, Use.State));
+                }
+            }
+        }
+        else
+        {
+            D3D12MemoryManager::GetSubresourceState(Use.ResourceKey, Use.Subresource, &Current);
+            if (Current != Use.State)
+            {
+                OutBarriers.push_back(MakeTransition(Global.PResource, Use.Subresource, Current, Use.State));
+            }
+        }
+    }
+
+    // States the list leaves behind, for the lists executing after it.
+    for (const auto& Iter : m_Resources)
+    {
+        const LocalResource& Local = Iter.second;
+        if (Local.Subresources.empty())
+        {
+            if (Local.State != k_UnknownState)
+            {
+                D3D12MemoryManager::UpdateResourceState(Iter.first, Local.State);
+            }
+            continue;
+        }
+        for (U32 I = 0; I < Local.NumSubresources; ++I)
+        {
+            if (Local.Subresources[I] != k_UnknownState)
+            {
+                D3D12MemoryManager::UpdateSubresourceState(Iter.first, I, Local.Subresources[I]);
+            }
+        }
+    }
+}
+
+
+void D3D12LocalResourceStates::Clear()
+{
+    m_Resources.clear();
+    m_FirstUses.clear();
+}
+} // Synthe
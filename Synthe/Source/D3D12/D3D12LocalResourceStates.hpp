@@ -0,0 +1,86 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Win32Common.hpp"
+#include "Common/Types.hpp"
+#include "Graphics/GraphicsStructs.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+
+namespace Synthe {
+
+
+class D3D12BarrierBatcher;
+
+
+//! Resource states as seen by one command list while it records. Lists recorded in parallel, or
+//! submitted in another order than recorded, cannot know the states other lists leave resources in,
+//! so a list never reads or writes the global states while recording. The first state each
+//! subresource is used in is kept instead, and transitions after that are between states the list
+//! knows. At submit, Resolve() compares the first uses with the global states, returns the barriers
+//! to run ahead of the list, and writes back the states the list leaves the resources in.
+//!
+//! Recording touches only the list's own tracker, so it needs no lock. Resolve() runs on the
+//! submitting thread, in execution order.
+class D3D12LocalResourceStates
+{
+public:
+    //! Move a subresource to a state. Barriers between known states are queued on the batcher.
+    //!
+    //! \param ResourceKey The resource handle.
+    //! \param PResource The native resource.
+    //! \param NumSubresources The number of subresources of the resource.
+    //! \param Subresource The subresource index, or D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES.
+    //! \param State The state needed.
+    //! \param Split Only begin the transition, see D3D12BarrierBatcher.
+    //! \param Barriers The batcher of the list.
+    //! \param PList The native list, for barriers the batcher must flush early.
+    void Transition(GPUHandle ResourceKey,
+                    ID3D12Resource* PResource,
+                    U32 NumSubresources,
+                    U32 Subresource,
+                    D3D12_RESOURCE_STATES State,
+                    B32 Split,
+                    D3D12BarrierBatcher& Barriers,
+                    ID3D12GraphicsCommandList* PList);
+
+    //! Reconcile with the global resource states, at submit.
+    //!
+    //! \param OutBarriers Receives the barriers that bring resources into the states the list first
+    //!                    uses them in. They must execute right before the list.
+    void Resolve(std::vector<D3D12_RESOURCE_BARRIER>& OutBarriers);
+
+    //! Forget every resource, as when the list begins recording.
+    void Clear();
+
+    //! Number of resources the list touched.
+    U32 GetNumResources() const { return static_cast<U32>(m_Resources.size()); }
+
+private:
+    struct LocalResource
+    {
+        ID3D12Resource* PResource;
+        U32 NumSubresources;
+        //! State of every subresource, unless Subresources holds them one by one.
+        D3D12_RESOURCE_STATES State;
+        //! Per subresource states, only while they differ.
+        std::vector<D3D12_RESOURCE_STATES> Subresources;
+    };
+
+    struct FirstUse
+    {
+        GPUHandle ResourceKey;
+        U32 Subresource;
+        D3D12_RESOURCE_STATES State;
+    };
+
+    std::unordered_map<GPUHandle, LocalResource>    m_Resources;
+
+    //! First uses, in recording order.
+    std::vector<FirstUse>                           m_FirstUses;
+};
+} // Synthe
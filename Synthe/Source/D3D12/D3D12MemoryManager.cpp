@@ -7,6 +7,10 @@
 
 #include "Common/Memory/LinearAllocator.hpp"
 #include "Common/Memory/NewAllocator.hpp"
+#include "Common/Memory/RangeAllocator.hpp"
+
+#include <deque>
+#include <vector>
 
 
 namespace Synthe {
@@ -15,6 +19,31 @@ namespace Synthe {
 std::unordered_map<D3D12MemoryManager::MemoryKeyID, MemoryPool> MemoryPoolCache;
 std::unordered_map<D3D12MemoryManager::MemoryKeyID, Allocator*> AllocatorPoolCache;
 std::unordered_map<GPUHandle, ResourceState> ResourceCache;
+//! States of each subresource, only for resources whose subresources are in different states.
+std::unordered_map<GPUHandle, std::vector<D3D12_RESOURCE_STATES>> SubresourceStateCache;
+
+
+static U32 GetNumSubresources(ID3D12Resource* PResource)
+{
+    D3D12_RESOURCE_DESC Desc = PResource->GetDesc();
+    if (Desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+    {
+        return 1;
+    }
+    U32 NumArraySlices = (Desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D) ? 1 : Desc.DepthOrArraySize;
+    return Desc.MipLevels * NumArraySlices * D3D12MemoryManager::GetFormatPlaneCount(Desc.Format);
+}
+
+
+struct PendingResourceRelease
+{
+    ID3D12Resource* PResource;
+    MemoryPool* PMemoryPool;
+    U64 RetireFrame;
+};
+
+
+std::deque<PendingResourceRelease> PendingResourceReleases;
 
 U64 D3D12MemoryManager::k_TotalGPUMemoryBytes = 0ULL;
 U64 D3D12MemoryManager::k_TotalCPUMemoryBytes = 0ULL;
@@ -98,12 +127,17 @@ ResultCode MemoryPool::AllocateResource(ID3D12Device* PDevice,
     if (m_Allocator)
     {
         AllocationBlock Block = { };
-        if (!m_Allocator->Allocate(&Block, AllocationInfo.SizeInBytes, AllocationInfo.Alignment))
+        if (m_Allocator->Allocate(&Block, AllocationInfo.SizeInBytes, AllocationInfo.Alignment) != SResult_OK)
         {
             return SResult_MEMORY_ALLOCATION_FAILURE;
         }
         HRESULT Result = PDevice->CreatePlacedResource(m_Heap, Block.StartAddress, 
             &Desc, InitialState, ClearValue, __uuidof(ID3D12Resource), (void**)PPResource);
+        if (FAILED(Result))
+        {
+            m_Allocator->Free(&Block);
+            return GResult_DEVICE_CREATION_FAILURE;
+        }
         m_AllocatedBlocks[*PPResource] = Block;
     }
     else
@@ -120,15 +154,18 @@ ResultCode MemoryPool::FreeResource(ID3D12Resource* PResource)
     {
         return SResult_INITIALIZATION_FAILURE;
     }
-    AllocationBlock Block = m_AllocatedBlocks[PResource];
-    if (m_Allocator->Free(&Block))
+    auto Iter = m_AllocatedBlocks.find(PResource);
+    if (Iter == m_AllocatedBlocks.end())
     {
-        m_AllocatedBlocks.erase(PResource);
-    } 
-    else 
+        return SResult_OBJECT_NOT_FOUND;
+    }
+    // Keep the block tracked if the allocator could not take it back, so the failure is visible.
+    ResultCode Result = m_Allocator->Free(&Iter->second);
+    if (Result != SResult_OK)
     {
-        return SResult_FAILED;
+        return Result;
     }
+    m_AllocatedBlocks.erase(Iter);
     return SResult_OK;
 }
 
@@ -147,6 +184,9 @@ void D3D12MemoryManager::CreateAndRegisterAllocator(MemoryKeyID Key,
             case AllocType_LINEAR:
                 AllocatorPoolCache[Key] = Malloc<LinearAllocator>();
                 break;
+            case AllocType_RANGE:
+                AllocatorPoolCache[Key] = Malloc<RangeAllocator>();
+                break;
             case AllocType_NEW:
             default:
                 AllocatorPoolCache[Key] = Malloc<NewAllocator>();
@@ -178,13 +218,17 @@ ResultCode D3D12MemoryManager::DestroyAllocatorAtKey(MemoryKeyID Key)
 }
 
 
-ResultCode D3D12MemoryManager::CacheNativeResource(GPUHandle Key, ID3D12Resource* PResource, D3D12_RESOURCE_STATES InitialState)
+ResultCode D3D12MemoryManager::CacheNativeResource(GPUHandle Key, 
+                                                   ID3D12Resource* PResource, 
+                                                   D3D12_RESOURCE_STATES InitialState,
+                                                   D3D12_HEAP_TYPE HeapType,
+                                                   MemoryPool* PMemoryPool)
 {
     if (ResourceCache.find(Key) != ResourceCache.end())
     {
         return SResult_ALREADY_EXISTS;
     }
-    ResourceCache[Key] = { PResource, InitialState };
+    ResourceCache[Key] = { PResource, InitialState, HeapType, nullptr, 0, PMemoryPool, GetNumSubresources(PResource), false };
     return SResult_OK;
 }
 
@@ -206,7 +250,90 @@ ResultCode D3D12MemoryManager::UpdateResourceState(GPUHandle Key, D3D12_RESOURCE
     {
         return SResult_OBJECT_NOT_FOUND;
     }
-    ResourceCache[Key].State = State;
+    return UpdateSubresourceState(Key, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, State);
+}
+
+
+U32 D3D12MemoryManager::GetFormatPlaneCount(DXGI_FORMAT Format)
+{
+    switch (Format)
+    {
+        case DXGI_FORMAT_D24_UNORM_S8_UINT:
+        case DXGI_FORMAT_R24G8_TYPELESS:
+        case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+        case DXGI_FORMAT_R32G8X24_TYPELESS:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+
+ResultCode D3D12MemoryManager::GetSubresourceState(GPUHandle Key, U32 Subresource, D3D12_RESOURCE_STATES* OutState)
+{
+    auto Iter = ResourceCache.find(Key);
+    if (Iter == ResourceCache.end())
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+    if (!Iter->second.SubresourcesDiverged)
+    {
+        *OutState = Iter->second.State;
+        return SResult_OK;
+    }
+    if (Subresource >= Iter->second.NumSubresources)
+    {
+        return SResult_INVALID_ARGS;
+    }
+    *OutState = SubresourceStateCache[Key][Subresource];
+    return SResult_OK;
+}
+
+
+ResultCode D3D12MemoryManager::UpdateSubresourceState(GPUHandle Key, U32 Subresource, D3D12_RESOURCE_STATES State)
+{
+    auto Iter = ResourceCache.find(Key);
+    if (Iter == ResourceCache.end())
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+    ResourceState& Resource = Iter->second;
+    if (Subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES || Resource.NumSubresources == 1)
+    {
+        Resource.State = State;
+        if (Resource.SubresourcesDiverged)
+        {
+            SubresourceStateCache.erase(Key);
+            Resource.SubresourcesDiverged = false;
+        }
+        return SResult_OK;
+    }
+    if (Subresource >= Resource.NumSubresources)
+    {
+        return SResult_INVALID_ARGS;
+    }
+    if (!Resource.SubresourcesDiverged)
+    {
+        if (Resource.State == State)
+        {
+            return SResult_OK;
+        }
+        SubresourceStateCache[Key].assign(Resource.NumSubresources, Resource.State);
+        Resource.SubresourcesDiverged = true;
+    }
+
+    std::vector<D3D12_RESOURCE_STATES>& States = SubresourceStateCache[Key];
+    States[Subresource] = State;
+    for (D3D12_RESOURCE_STATES Other : States)
+    {
+        if (Other != State)
+        {
+            return SResult_OK;
+        }
+    }
+    Resource.State = State;
+    Resource.SubresourcesDiverged = false;
+    SubresourceStateCache.erase(Key);
     return SResult_OK;
 }
 
@@ -264,6 +391,63 @@ ResultCode D3D12MemoryManager::GetCachedResourceSize(ID3D12Device* PDevice,
 }
 
 
+ResultCode D3D12MemoryManager::MapResource(GPUHandle Key, void** OutData)
+{
+    auto Iter = ResourceCache.find(Key);
+    if (Iter == ResourceCache.end())
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+    
+    ResourceState& State = Iter->second;
+    if (State.HeapType != D3D12_HEAP_TYPE_UPLOAD)
+    {
+        return SResult_INVALID_CALL;
+    }
+
+    if (!State.PMappedData)
+    {
+        // We never read from upload memory on the host, so pass an empty read range.
+        D3D12_RANGE ReadRange = { 0, 0 };
+        HRESULT Result = State.PResource->Map(0, &ReadRange, &State.PMappedData);
+        if (FAILED(Result))
+        {
+            State.PMappedData = nullptr;
+            return SResult_FAILED;
+        }
+    }
+
+    State.MapCount += 1;
+    *OutData = State.PMappedData;
+    return SResult_OK;
+}
+
+
+ResultCode D3D12MemoryManager::UnmapResource(GPUHandle Key)
+{
+    auto Iter = ResourceCache.find(Key);
+    if (Iter == ResourceCache.end())
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+
+    ResourceState& State = Iter->second;
+    if (State.MapCount == 0)
+    {
+        return SResult_INVALID_CALL;
+    }
+
+    State.MapCount -= 1;
+    if (State.MapCount == 0)
+    {
+        // Null written range, the whole resource may have been written.
+        State.PResource->Unmap(0, nullptr);
+        State.PMappedData = nullptr;
+    }
+    return SResult_OK;
+}
+
+
 ResultCode D3D12MemoryManager::RemoveCachedNatvieResource(GPUHandle Key)
 {
     if (ResourceCache.find(Key) == ResourceCache.end())
@@ -271,6 +455,45 @@ ResultCode D3D12MemoryManager::RemoveCachedNatvieResource(GPUHandle Key)
         return SResult_OBJECT_NOT_FOUND;
     }
     ResourceCache.erase(Key);
+    SubresourceStateCache.erase(Key);
+    return SResult_OK;
+}
+
+
+ResultCode D3D12MemoryManager::DestroyResource(GPUHandle Key, U64 RetireFrame)
+{
+    auto Iter = ResourceCache.find(Key);
+    if (Iter == ResourceCache.end())
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+    if (!Iter->second.PMemoryPool)
+    {
+        return SResult_INVALID_CALL;
+    }
+    // Releasing the resource also drops any mapping left on it.
+    PendingResourceReleases.push_back({ Iter->second.PResource, Iter->second.PMemoryPool, RetireFrame });
+    SubresourceStateCache.erase(Key);
+    ResourceCache.erase(Iter);
     return SResult_OK;
 }
+
+
+void D3D12MemoryManager::RetireFrame(U64 CompletedFrame)
+{
+    // Resources are destroyed in frame order, so the retired ones are at the front.
+    while (!PendingResourceReleases.empty() && PendingResourceReleases.front().RetireFrame <= CompletedFrame)
+    {
+        PendingResourceRelease& Pending = PendingResourceReleases.front();
+        Pending.PMemoryPool->FreeResource(Pending.PResource);
+        Pending.PResource->Release();
+        PendingResourceReleases.pop_front();
+    }
+}
+
+
+void D3D12MemoryManager::ReleasePendingResources()
+{
+    RetireFrame(~0ULL);
+}
 } // Synthe
\ No newline at end of file
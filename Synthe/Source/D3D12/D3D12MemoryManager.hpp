@@ -98,8 +98,27 @@ struct ResourceState
     //! The native resource.
     ID3D12Resource* PResource;
     
-    //! The current state of the resource.
+    //! The current state of the resource, of every subresource unless SubresourcesDiverged.
     D3D12_RESOURCE_STATES State;
+
+    //! The heap type the resource was placed in. Only upload heaps can be mapped.
+    D3D12_HEAP_TYPE HeapType;
+
+    //! Persistent host pointer, if the resource is currently mapped.
+    void* PMappedData;
+
+    //! Number of outstanding MapResource() calls.
+    U32 MapCount;
+
+    //! The pool the resource was placed in, nullptr if not owned by the memory manager, such as 
+    //! swapchain images.
+    MemoryPool* PMemoryPool;
+
+    //! Number of subresources, mips times array slices times planes.
+    U32 NumSubresources;
+
+    //! Set while subresources are in different states, read them with GetSubresourceState().
+    B32 SubresourcesDiverged;
 };
 
 //! Memory manager handles all memory pool and allocator descriptions, that are 
@@ -118,6 +137,7 @@ public:
         AllocType_LINEAR,
         AllocType_BUDDY,
         AllocType_FREELIST,
+        AllocType_RANGE,    //< Frees by size bucket, for pools whose resources are destroyed and recreated.
         AllocType_CUSTOM    //< Custom allocation type allows for user to specify their own inherited Allocator.
     };
     typedef U32 AllocT;
@@ -160,7 +180,11 @@ public:
     static U64 GetTotalCPUReservedInBytes() { return k_TotalCPUMemoryBytes; }
 
     //! Cache the native gpu resource, once it has been allocated.
-    static ResultCode CacheNativeResource(GPUHandle Key, ID3D12Resource* PResource, D3D12_RESOURCE_STATES InitialState);
+    static ResultCode CacheNativeResource(GPUHandle Key, 
+                                          ID3D12Resource* PResource, 
+                                          D3D12_RESOURCE_STATES InitialState,
+                                          D3D12_HEAP_TYPE HeapType = D3D12_HEAP_TYPE_DEFAULT,
+                                          MemoryPool* PMemoryPool = nullptr);
 
     //! Get the cached native resource, if one exists. Otherwise, an error should result.
     //!
@@ -172,11 +196,69 @@ public:
     //! \param State
     //! \return 
     static ResultCode UpdateResourceState(GPUHandle Key, D3D12_RESOURCE_STATES State);
+
+    //! Get the state of one subresource.
+    //!
+    //! \param Key
+    //! \param Subresource The subresource index, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES for the state 
+    //!                    shared by all of them.
+    //! \param OutState The state.
+    //! \return SResult_OK on success. SResult_INVALID_ARGS if asking for all subresources while they
+    //!         are in different states.
+    static ResultCode GetSubresourceState(GPUHandle Key, U32 Subresource, D3D12_RESOURCE_STATES* OutState);
+
+    //! Update the state of one subresource. Per subresource states are only kept while they differ,
+    //! once every subresource is back in one state the resource is tracked as a whole again.
+    //!
+    //! \param Key
+    //! \param Subresource The subresource index, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES for all.
+    //! \param State The new state.
+    //! \return SResult_OK on success.
+    static ResultCode UpdateSubresourceState(GPUHandle Key, U32 Subresource, D3D12_RESOURCE_STATES State);
+
+    //! Get the number of planes of a resource format, subresources are counted per plane. Depth 
+    //! stencil formats keep stencil in a second plane, whether typed or typeless.
+    //!
+    //! \param Format The format the resource was created with.
+    //! \return 2 for depth stencil formats, 1 otherwise.
+    static U32 GetFormatPlaneCount(DXGI_FORMAT Format);
     
     //! Remove a resource.
     //!
     static ResultCode RemoveCachedNatvieResource(GPUHandle Key);
 
+    //! Destroy a resource placed in one of the memory pools. The handle is invalid on return, while
+    //! the native resource and its memory are kept until RetireFrame is retired, since in flight 
+    //! frames may still reference it.
+    //!
+    //! \param Key
+    //! \param RetireFrame The last frame that may still reference the resource on the GPU.
+    //! \return SResult_OK if the call succeeds. SResult_INVALID_CALL if the resource is not owned 
+    //!         by a memory pool.
+    static ResultCode DestroyResource(GPUHandle Key, U64 RetireFrame);
+
+    //! Release the resources destroyed by frames up to CompletedFrame.
+    static void RetireFrame(U64 CompletedFrame);
+
+    //! Release every destroyed resource still pending, the GPU must be idle.
+    static void ReleasePendingResources();
+
+    //! Map the resource into host memory. The native mapping is created on the first call and 
+    //! kept alive until the last matching UnmapResource(), so that upload buffers can stay 
+    //! persistently mapped across frames.
+    //!
+    //! \param Key
+    //! \param OutData
+    //! \return SResult_OK if the resource is mapped. SResult_INVALID_CALL if the resource does not
+    //!         live in an upload heap.
+    static ResultCode MapResource(GPUHandle Key, void** OutData);
+
+    //! Unmap the resource. 
+    //!
+    //! \param Key
+    //! \return SResult_OK if the call succeeds. SResult_INVALID_CALL if the resource is not mapped.
+    static ResultCode UnmapResource(GPUHandle Key);
+
 protected:
     //! Our friends!
     friend class MemoryPool;
@@ -0,0 +1,374 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "D3D12PipelineStateCache.hpp"
+#include "D3D12Resource.hpp"
+#include "D3D12PipelineUsage.hpp"
+#include "Common/BlobCache.hpp"
+#include "Common/Hash.hpp"
+#include "Common/Memory/Allocator.hpp"
+#include "Common/WorkerPool.hpp"
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace Synthe {
+
+
+struct PipelineStateCacheEntry
+{
+    D3D12PipelineState* PPipelineState;
+    U32 RefCount;
+};
+
+
+static std::unordered_map<PipelineStateKey, PipelineStateCacheEntry, PipelineStateKeyHasher> PipelineStates;
+static std::unordered_map<PipelineState*, const PipelineStateKey*> PipelineStateKeys;
+static PipelineCacheStatistics PipelineStatistics = { };
+
+static ID3D12PipelineLibrary* PipelineLibrary = nullptr;
+// The library reads from this memory for as long as it lives.
+static std::vector<U8> PipelineLibraryBlob;
+static std::string PipelineLibraryPath;
+static B32 PipelineLibraryDirty = false;
+
+// Guards the cache maps, statistics, and the dirty flag.
+static std::mutex PipelineCacheMutex;
+// Guards loads and stores in the pipeline library.
+static std::mutex PipelineLibraryMutex;
+static WorkerPool PipelineCompiler;
+
+
+static void PushHash(std::vector<U32>& Words, U64 Hash)
+{
+    Words.push_back(static_cast<U32>(Hash));
+    Words.push_back(static_cast<U32>(Hash >> 32));
+}
+
+
+static void PushShader(std::vector<U32>& Words, const ShaderModule* PModule)
+{
+    if (!PModule || !PModule->ByteCode || !PModule->SizeInBytes)
+    {
+        PushHash(Words, 0);
+        return;
+    }
+    PushHash(Words, HashBytes(PModule->ByteCode, PModule->SizeInBytes));
+    PushHash(Words, PModule->SizeInBytes);
+}
+
+
+static void PushRootSignature(std::vector<U32>& Words, RootSignature* PRootSignature)
+{
+    PushHash(Words, PRootSignature ? static_cast<D3D12RootSignature*>(PRootSignature)->GetLayoutHash() : 0);
+}
+
+
+void PipelineStateKey::Build(const GraphicsPipelineStateCreateInfo& CreateInfo)
+{
+    Words.clear();
+    Words.push_back(static_cast<U32>(PipelineStateType_GRAPHICS));
+    PushRootSignature(Words, CreateInfo.RootSig);
+    PushShader(Words, CreateInfo.PVertexShader);
+    PushShader(Words, CreateInfo.PHullShader);
+    PushShader(Words, CreateInfo.PDomainShader);
+    PushShader(Words, CreateInfo.PGeometryShader);
+    PushShader(Words, CreateInfo.PPixelShader);
+    Words.push_back(static_cast<U32>(CreateInfo.Raster.FillMode));
+    Words.push_back(static_cast<U32>(CreateInfo.Raster.CullMode));
+    Words.push_back(static_cast<U32>(CreateInfo.Raster.FrontFace));
+    Words.push_back(CreateInfo.DepthStencil.DepthEnable ? 1 : 0);
+    Words.push_back(static_cast<U32>(CreateInfo.DepthStencil.DepthWriteMask));
+    Words.push_back(static_cast<U32>(CreateInfo.DepthStencil.DepthFunction));
+    Words.push_back(CreateInfo.DepthStencil.StencilEnable ? 1 : 0);
+    Words.push_back(static_cast<U32>(CreateInfo.DepthStencilFormat));
+    Words.push_back(static_cast<U32>(CreateInfo.BlendState));
+    Words.push_back(CreateInfo.NumRenderTargets);
+    Words.push_back(CreateInfo.SampleMask);
+    // Read back in this order by the pipeline prewarm, see D3D12PipelineUsage.cpp.
+    Hash = HashBytes(Words.data(), Words.size() * sizeof(U32));
+}
+
+
+void PipelineStateKey::Build(const ComputePipelineStateCreateInfo& CreateInfo)
+{
+    Words.clear();
+    Words.push_back(static_cast<U32>(PipelineStateType_COMPUTE));
+    PushRootSignature(Words, CreateInfo.RootSig);
+    PushShader(Words, CreateInfo.PComputeShader);
+    Hash = HashBytes(Words.data(), Words.size() * sizeof(U32));
+}
+
+
+//! Name of a pipeline in the library, the hex digits of its key hash.
+static void GetLibraryName(U64 Hash, WCHAR (&OutName)[17])
+{
+    static const WCHAR Digits[] = L"0123456789ABCDEF";
+    for (U32 I = 0; I < 16; ++I)
+    {
+        OutName[I] = Digits[(Hash >> ((15 - I) * 4)) & 0xF];
+    }
+    OutName[16] = L'\0';
+}
+
+
+static HRESULT LoadFromLibrary(LPCWSTR Name, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& Desc, ID3D12PipelineState** Out)
+{
+    return PipelineLibrary->LoadGraphicsPipeline(Name, &Desc, __uuidof(ID3D12PipelineState), (void**)Out);
+}
+
+
+static HRESULT LoadFromLibrary(LPCWSTR Name, const D3D12_COMPUTE_PIPELINE_STATE_DESC& Desc, ID3D12PipelineState** Out)
+{
+    return PipelineLibrary->LoadComputePipeline(Name, &Desc, __uuidof(ID3D12PipelineState), (void**)Out);
+}
+
+
+static PipelineStateType GetPipelineType(const D3D12_GRAPHICS_PIPELINE_STATE_DESC&) { return PipelineStateType_GRAPHICS; }
+static PipelineStateType GetPipelineType(const D3D12_COMPUTE_PIPELINE_STATE_DESC&) { return PipelineStateType_COMPUTE; }
+
+
+//! Load a pipeline from the library, or compile it and store it in the library. Runs without the cache
+//! lock held, possibly on a worker thread.
+template<typename PipelineDesc>
+static ResultCode BuildPipeline(ID3D12Device* PDevice, 
+                                U64 Hash, 
+                                const PipelineDesc& Desc, 
+                                D3D12PipelineState* PPipelineState)
+{
+    WCHAR Name[17];
+    GetLibraryName(Hash, Name);
+
+    auto Start = std::chrono::steady_clock::now();
+    ID3D12PipelineState* PNative = nullptr;
+    B32 Loaded = false;
+    {
+        std::lock_guard<std::mutex> LibraryLock(PipelineLibraryMutex);
+        Loaded = PipelineLibrary && SUCCEEDED(LoadFromLibrary(Name, Desc, &PNative));
+    }
+
+    if (Loaded)
+    {
+        ResultCode Result = PPipelineState->Initialize(PNative, GetPipelineType(Desc));
+        R64 ElapsedMs = std::chrono::duration<R64, std::milli>(std::chrono::steady_clock::now() - Start).count();
+        std::lock_guard<std::mutex> Lock(PipelineCacheMutex);
+        PipelineStatistics.NumLibraryHits += 1;
+        PipelineStatistics.LibraryLoadTimeMs += ElapsedMs;
+        return Result;
+    }
+
+    ResultCode Result = PPipelineState->Initialize(PDevice, Desc);
+    R64 ElapsedMs = std::chrono::duration<R64, std::milli>(std::chrono::steady_clock::now() - Start).count();
+    B32 Stored = false;
+    if (Result == SResult_OK)
+    {
+        std::lock_guard<std::mutex> LibraryLock(PipelineLibraryMutex);
+        Stored = PipelineLibrary && SUCCEEDED(PipelineLibrary->StorePipeline(Name, PPipelineState->GetNative()));
+    }
+
+    std::lock_guard<std::mutex> Lock(PipelineCacheMutex);
+    PipelineStatistics.NumCompiles += 1;
+    PipelineStatistics.CompileTimeMs += ElapsedMs;
+    PipelineLibraryDirty = PipelineLibraryDirty || Stored;
+    return Result;
+}
+
+
+template<typename PipelineDesc>
+static ResultCode AcquirePipeline(ID3D12Device* PDevice,
+                                  const PipelineStateKey& Key,
+                                  const PipelineDesc& Desc,
+                                  const PipelineStateCreateInfo& CreateInfo,
+                                  D3D12PipelineState** OutPipelineState)
+{
+    B32 IsAsync = (CreateInfo.Flags & PipelineStateCreateFlag_ASYNC_COMPILE) != 0;
+    std::unique_lock<std::mutex> Lock(PipelineCacheMutex);
+    PipelineStatistics.NumRequests += 1;
+    PipelineStatistics.NumAsyncRequests += IsAsync ? 1 : 0;
+
+    auto Iter = PipelineStates.find(Key);
+    if (Iter != PipelineStates.end())
+    {
+        D3D12PipelineState* PCached = Iter->second.PPipelineState;
+        if (PCached->GetStatus() == PipelineStateStatus_FAILED)
+        {
+            return SResult_INITIALIZATION_FAILURE;
+        }
+        PipelineStatistics.NumHits += 1;
+        Iter->second.RefCount += 1;
+        Lock.unlock();
+
+        // Synchronous creates never hand out a pipeline that is still compiling.
+        if (!IsAsync && PCached->Wait() != SResult_OK)
+        {
+            D3D12PipelineStateCache::Release(PCached);
+            return SResult_INITIALIZATION_FAILURE;
+        }
+        *OutPipelineState = PCached;
+        return SResult_OK;
+    }
+
+    // Insert before building, so concurrent creates of the same pipeline wait on this one.
+    D3D12PipelineState* PPipelineState = Malloc<D3D12PipelineState>();
+    std::shared_ptr<std::promise<void>> Compiled = std::make_shared<std::promise<void>>();
+    PPipelineState->MarkCompiling(GetPipelineType(Desc), Compiled->get_future().share(), CreateInfo.PFallback);
+    auto Inserted = PipelineStates.insert({ Key, { PPipelineState, 1 } });
+    PipelineStateKeys[PPipelineState] = &Inserted.first->first;
+    PipelineStatistics.NumLivePipelines = PipelineStates.size();
+    Lock.unlock();
+
+    U64 Hash = Key.Hash;
+    if (IsAsync)
+    {
+        PipelineCompiler.Submit([PDevice, Hash, Desc, PPipelineState, Compiled] () -> void
+            {
+                ResultCode Result = BuildPipeline(PDevice, Hash, Desc, PPipelineState);
+                PPipelineState->MarkCompiled(Result == SResult_OK);
+                Compiled->set_value();
+            }, CreateInfo.CompilePriority);
+        *OutPipelineState = PPipelineState;
+        return SResult_OK;
+    }
+
+    ResultCode Result = BuildPipeline(PDevice, Hash, Desc, PPipelineState);
+    PPipelineState->MarkCompiled(Result == SResult_OK);
+    Compiled->set_value();
+    if (Result != SResult_OK)
+    {
+        // Stays cached as failed while others hold it, so they see the failure too.
+        D3D12PipelineStateCache::Release(PPipelineState);
+        return Result;
+    }
+    *OutPipelineState = PPipelineState;
+    return SResult_OK;
+}
+
+
+ResultCode D3D12PipelineStateCache::Initialize(ID3D12Device* PDevice, const std::string& LibraryPath)
+{
+    PipelineLibraryPath = LibraryPath;
+    PipelineLibraryDirty = false;
+    PipelineCompiler.Initialize(WorkerPool::GetDefaultNumThreads());
+    if (LibraryPath.empty())
+    {
+        return SResult_OK;
+    }
+
+    ID3D12Device1* PDevice1 = nullptr;
+    if (FAILED(PDevice->QueryInterface<ID3D12Device1>(&PDevice1)))
+    {
+        return SResult_OK;
+    }
+
+    ReadFileBytes(LibraryPath, PipelineLibraryBlob);
+    HRESULT Result = E_FAIL;
+    if (!PipelineLibraryBlob.empty())
+    {
+        Result = PDevice1->CreatePipelineLibrary(PipelineLibraryBlob.data(), PipelineLibraryBlob.size(),
+            __uuidof(ID3D12PipelineLibrary), (void**)&PipelineLibrary);
+    }
+    if (FAILED(Result))
+    {
+        // No library yet, or written by another driver or adapter. Start over with an empty one.
+        PipelineLibraryBlob.clear();
+        PDevice1->CreatePipelineLibrary(nullptr, 0, __uuidof(ID3D12PipelineLibrary), (void**)&PipelineLibrary);
+    }
+    PDevice1->Release();
+    return SResult_OK;
+}
+
+
+void D3D12PipelineStateCache::CleanUp()
+{
+    // Let in flight compiles finish, they may still store into the library.
+    PipelineCompiler.Shutdown();
+
+    if (PipelineLibrary)
+    {
+        if (PipelineLibraryDirty)
+        {
+            std::vector<U8> Serialized(PipelineLibrary->GetSerializedSize());
+            if (SUCCEEDED(PipelineLibrary->Serialize(Serialized.data(), Serialized.size())))
+            {
+                WriteFileBytes(PipelineLibraryPath, Serialized.data(), Serialized.size());
+            }
+        }
+        PipelineLibrary->Release();
+        PipelineLibrary = nullptr;
+    }
+    PipelineLibraryBlob.clear();
+    PipelineLibraryDirty = false;
+
+    for (auto& Iter : PipelineStates)
+    {
+        D3D12PipelineUsage::Record(Iter.first, Iter.second.PPipelineState->GetUsage());
+        Iter.second.PPipelineState->Release();
+        Free<D3D12PipelineState>(Iter.second.PPipelineState);
+    }
+    PipelineStates.clear();
+    PipelineStateKeys.clear();
+    PipelineStatistics.NumLivePipelines = 0;
+}
+
+
+ResultCode D3D12PipelineStateCache::Acquire(ID3D12Device* PDevice,
+                                            const PipelineStateKey& Key,
+                                            const D3D12_GRAPHICS_PIPELINE_STATE_DESC& Desc,
+                                            const PipelineStateCreateInfo& CreateInfo,
+                                            D3D12PipelineState** OutPipelineState)
+{
+    return AcquirePipeline(PDevice, Key, Desc, CreateInfo, OutPipelineState);
+}
+
+
+ResultCode D3D12PipelineStateCache::Acquire(ID3D12Device* PDevice,
+                                            const PipelineStateKey& Key,
+                                            const D3D12_COMPUTE_PIPELINE_STATE_DESC& Desc,
+                                            const PipelineStateCreateInfo& CreateInfo,
+                                            D3D12PipelineState** OutPipelineState)
+{
+    return AcquirePipeline(PDevice, Key, Desc, CreateInfo, OutPipelineState);
+}
+
+
+ResultCode D3D12PipelineStateCache::Release(PipelineState* PPipelineState)
+{
+    std::unique_lock<std::mutex> Lock(PipelineCacheMutex);
+    auto KeyIter = PipelineStateKeys.find(PPipelineState);
+    if (KeyIter == PipelineStateKeys.end())
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+
+    auto Iter = PipelineStates.find(*KeyIter->second);
+    PipelineStateCacheEntry& Entry = Iter->second;
+    if (--Entry.RefCount != 0)
+    {
+        return SResult_OK;
+    }
+
+    D3D12PipelineState* PDestroyed = Entry.PPipelineState;
+    D3D12PipelineUsage::Record(Iter->first, PDestroyed->GetUsage());
+    PipelineStateKeys.erase(KeyIter);
+    PipelineStates.erase(Iter);
+    PipelineStatistics.NumLivePipelines = PipelineStates.size();
+    Lock.unlock();
+
+    // An asynchronous compile may still be writing to it, and takes the cache lock when done.
+    PDestroyed->Wait();
+    PDestroyed->Release();
+    Free<D3D12PipelineState>(PDestroyed);
+    return SResult_OK;
+}
+
+
+PipelineCacheStatistics D3D12PipelineStateCache::GetStatistics()
+{
+    std::lock_guard<std::mutex> Lock(PipelineCacheMutex);
+    return PipelineStatistics;
+}
+} // Synthe
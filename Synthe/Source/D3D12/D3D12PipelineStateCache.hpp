@@ -0,0 +1,97 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Graphics/PipelineState.hpp"
+
+#include "Win32Common.hpp"
+#include "D3D12GraphicsPipelineState.hpp"
+
+#include <string>
+#include <vector>
+
+
+namespace Synthe {
+
+
+//! Canonical form of a pipeline state description. Shaders are keyed by a hash of their bytecode, and
+//! the root signature by the hash of its layout, so keys are stable across runs.
+struct PipelineStateKey
+{
+    PipelineStateKey()
+        : Hash(0) { }
+
+    //! Build the key of a graphics pipeline.
+    void Build(const GraphicsPipelineStateCreateInfo& CreateInfo);
+
+    //! Build the key of a compute pipeline.
+    void Build(const ComputePipelineStateCreateInfo& CreateInfo);
+
+    bool operator==(const PipelineStateKey& Other) const
+    {
+        return Hash == Other.Hash && Words == Other.Words;
+    }
+
+    std::vector<U32> Words;
+    U64 Hash;
+};
+
+
+struct PipelineStateKeyHasher
+{
+    size_t operator()(const PipelineStateKey& Key) const { return static_cast<size_t>(Key.Hash); }
+};
+
+
+//! Cache of pipeline states keyed by their description. Identical descriptions share one ref counted
+//! pipeline state. Pipelines missing from the cache are looked up in a native pipeline library before
+//! being compiled, and newly compiled pipelines are stored in the library. The library is loaded from
+//! disk at initialization, and written back on clean up if anything was added.
+//!
+//! Asynchronous creates are compiled on a worker pool, and are in the cache while compiling, so creating
+//! the same pipeline again returns the one in flight. The cache may be used from any thread.
+class D3D12PipelineStateCache
+{
+public:
+    //! Initialize the cache, and load the pipeline library.
+    //!
+    //! \param PDevice The native device, pipeline libraries need ID3D12Device1.
+    //! \param LibraryPath The library file, empty to keep pipelines in memory only.
+    //! \return SResult_OK, even if no library could be loaded. Pipelines are then compiled.
+    static ResultCode Initialize(ID3D12Device* PDevice, const std::string& LibraryPath);
+
+    //! Write the pipeline library to disk if it changed, and destroy all pipeline states.
+    static void CleanUp();
+
+    //! Get the pipeline state of a graphics description, adding a reference. Created if not cached.
+    //!
+    //! \param PDevice The native device.
+    //! \param Key The description key.
+    //! \param Desc The native description.
+    //! \param CreateInfo The create info, for its flags and fallback.
+    //! \param OutPipelineState The pipeline state.
+    //! \return SResult_OK on success. SResult_INITIALIZATION_FAILURE if the pipeline failed to compile,
+    //!         asynchronous compiles report failures through the pipeline status instead.
+    static ResultCode Acquire(ID3D12Device* PDevice,
+                              const PipelineStateKey& Key,
+                              const D3D12_GRAPHICS_PIPELINE_STATE_DESC& Desc,
+                              const PipelineStateCreateInfo& CreateInfo,
+                              D3D12PipelineState** OutPipelineState);
+
+    //! Get the pipeline state of a compute description, adding a reference. Created if not cached.
+    static ResultCode Acquire(ID3D12Device* PDevice,
+                              const PipelineStateKey& Key,
+                              const D3D12_COMPUTE_PIPELINE_STATE_DESC& Desc,
+                              const PipelineStateCreateInfo& CreateInfo,
+                              D3D12PipelineState** OutPipelineState);
+
+    //! Give back a reference, destroying the pipeline state with the last one. It stays in the pipeline
+    //! library.
+    //!
+    //! \return SResult_OK on success. SResult_OBJECT_NOT_FOUND if not made by this cache.
+    static ResultCode Release(PipelineState* PPipelineState);
+
+    static PipelineCacheStatistics GetStatistics();
+};
+} // Synthe
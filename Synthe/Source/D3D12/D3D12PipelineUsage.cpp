@@ -0,0 +1,501 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "D3D12PipelineUsage.hpp"
+#include "D3D12PipelineStateCache.hpp"
+#include "D3D12RootSignatureCache.hpp"
+#include "Graphics/GraphicsDevice.hpp"
+#include "Common/BlobCache.hpp"
+#include "Common/Hash.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <string.h>
+#include <unordered_map>
+
+namespace Synthe {
+
+
+enum PipelineUsageKind
+{
+    PipelineUsageKind_ROOT_SIGNATURE,
+    PipelineUsageKind_PIPELINE_STATE
+};
+
+
+//! Stored ahead of the key words of each record.
+struct PipelineUsageRecordHeader
+{
+    U32 Kind;
+    U32 NumWords;
+    U64 FirstUseFrame;
+    U64 UseCount;
+};
+
+
+struct PipelineUsageRecord
+{
+    PipelineUsageRecord()
+        : Kind(PipelineUsageKind_ROOT_SIGNATURE)
+        , FirstUseFrame(0)
+        , UseCount(0)
+        , PreviousUseCount(0) { }
+
+    U32 Kind;
+    //! Key words of the root signature or pipeline state.
+    std::vector<U32> Words;
+    U64 FirstUseFrame;
+    //! Binds in this session.
+    U64 UseCount;
+    //! Count carried over from previous sessions.
+    U64 PreviousUseCount;
+};
+
+
+// 'SPUS'
+static const U32 k_PipelineUsageMagic = 0x53555053;
+// 'SPSH'
+static const U32 k_PipelineShaderMagic = 0x48535053;
+
+static std::unordered_map<U64, PipelineUsageRecord> PipelineUsageRecords;
+static BlobCache PipelineUsageShaders(k_PipelineShaderMagic, 1);
+static std::string PipelineUsagePath;
+static std::string PipelineUsageShaderPath;
+static B32 PipelineUsageRecording = false;
+
+// Guards the records and shaders. Taken after the cache locks, never before.
+static std::mutex PipelineUsageMutex;
+
+
+//! Reads the words of a key back, in the order Build() pushed them.
+struct KeyReader
+{
+    KeyReader(const std::vector<U32>& Words)
+        : PWords(&Words)
+        , Position(0)
+        , Valid(true) { }
+
+    U32 Read()
+    {
+        if (Position >= PWords->size())
+        {
+            Valid = false;
+            return 0;
+        }
+        return (*PWords)[Position++];
+    }
+
+    U64 ReadHash()
+    {
+        U64 Low = Read();
+        U64 High = Read();
+        return Low | (High << 32);
+    }
+
+    const std::vector<U32>* PWords;
+    size_t Position;
+    B32 Valid;
+};
+
+
+static void ReadLayout(KeyReader& Reader, DescriptorLayoutInfo& Layout)
+{
+    Layout.NumDescriptors = Reader.Read();
+    Layout.BaseRegister = Reader.Read();
+    Layout.Flags = Reader.Read();
+}
+
+
+//! Rebuild the layout of a root signature key, see RootSignatureKey::Build().
+static B32 ReadRootSignatureLayout(const std::vector<U32>& Words,
+                                   std::vector<DescriptorSetLayoutInfo>& Tables,
+                                   std::vector<RootParameterInfo>& Parameters,
+                                   RootSignatureLayoutInfo& OutLayout)
+{
+    KeyReader Reader(Words);
+    // The device builds its key with its own version.
+    Reader.Read();
+
+    OutLayout = { };
+    OutLayout.NumDescriptorTables = Reader.Read();
+    if (OutLayout.NumDescriptorTables > Words.size())
+    {
+        return false;
+    }
+    Tables.resize(OutLayout.NumDescriptorTables);
+    for (DescriptorSetLayoutInfo& Table : Tables)
+    {
+        ReadLayout(Reader, Table.Srv);
+        ReadLayout(Reader, Table.Cbv);
+        ReadLayout(Reader, Table.Uav);
+        ReadLayout(Reader, Table.Sampler);
+    }
+
+    OutLayout.NumRootParameters = Reader.Read();
+    if (OutLayout.NumRootParameters > Words.size())
+    {
+        return false;
+    }
+    Parameters.resize(OutLayout.NumRootParameters);
+    for (RootParameterInfo& Parameter : Parameters)
+    {
+        Parameter.Type = static_cast<RootParameterType>(Reader.Read());
+        Parameter.ShaderRegister = Reader.Read();
+        Parameter.RegisterSpace = Reader.Read();
+        Parameter.Num32BitValues = Reader.Read();
+        Parameter.Flags = Reader.Read();
+    }
+
+    OutLayout.UseBindless = Reader.Read();
+    OutLayout.NumBindlessIndices = Reader.Read();
+    OutLayout.LayoutInfos = Tables.data();
+    OutLayout.PRootParameters = Parameters.data();
+    return Reader.Valid;
+}
+
+
+//! Point a module at the stored bytecode of a shader key, see PipelineStateKey::Build().
+//!
+//! \return The module, nullptr if the stage is unused. Marks the reader invalid if the bytecode is missing.
+static ShaderModule* ReadShader(KeyReader& Reader, ShaderModule& Module)
+{
+    U64 Hash = Reader.ReadHash();
+    if (!Hash)
+    {
+        return nullptr;
+    }
+    U64 SizeInBytes = Reader.ReadHash();
+
+    std::lock_guard<std::mutex> Lock(PipelineUsageMutex);
+    const std::vector<U8>* PByteCode = PipelineUsageShaders.Find(Hash);
+    if (!PByteCode || PByteCode->size() != SizeInBytes)
+    {
+        Reader.Valid = false;
+        return nullptr;
+    }
+    // Shaders are only ever added while recording, so the bytecode stays in place until clean up.
+    Module.ByteCode = const_cast<U8*>(PByteCode->data());
+    Module.SizeInBytes = SizeInBytes;
+    return &Module;
+}
+
+
+//! Copy the stored bytecode of a shader key into another cache.
+static void CopyShader(KeyReader& Reader, BlobCache& Shaders)
+{
+    U64 Hash = Reader.ReadHash();
+    if (!Hash)
+    {
+        return;
+    }
+    Reader.ReadHash();
+    const std::vector<U8>* PByteCode = PipelineUsageShaders.Find(Hash);
+    if (PByteCode)
+    {
+        Shaders.Store(Hash, PByteCode->data(), PByteCode->size());
+    }
+}
+
+
+static void StoreShader(const ShaderModule* PModule)
+{
+    if (!PModule || !PModule->ByteCode || !PModule->SizeInBytes)
+    {
+        return;
+    }
+    U64 Hash = HashBytes(PModule->ByteCode, PModule->SizeInBytes);
+    if (!PipelineUsageShaders.Find(Hash))
+    {
+        PipelineUsageShaders.Store(Hash, PModule->ByteCode, PModule->SizeInBytes);
+    }
+}
+
+
+static void RecordUse(U32 Kind, U64 Hash, const std::vector<U32>& Words, const PipelineUsageCounter& Counter)
+{
+    U64 UseCount = Counter.UseCount.load(std::memory_order_relaxed);
+    if (!UseCount)
+    {
+        return;
+    }
+    U64 FirstUseFrame = Counter.FirstUseFrame.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> Lock(PipelineUsageMutex);
+    if (!PipelineUsageRecording)
+    {
+        return;
+    }
+    PipelineUsageRecord& Record = PipelineUsageRecords[Hash];
+    if (Record.Words.empty())
+    {
+        Record.Kind = Kind;
+        Record.Words = Words;
+    }
+    // Frames of earlier sessions are replaced by the first one of this session.
+    if (Record.UseCount == 0 || FirstUseFrame < Record.FirstUseFrame)
+    {
+        Record.FirstUseFrame = FirstUseFrame;
+    }
+    Record.UseCount += UseCount;
+}
+
+
+ResultCode D3D12PipelineUsage::Initialize(const std::string& UsagePath, const std::string& ShaderPath)
+{
+    std::lock_guard<std::mutex> Lock(PipelineUsageMutex);
+    PipelineUsagePath = UsagePath;
+    PipelineUsageShaderPath = ShaderPath;
+    PipelineUsageRecording = true;
+
+    BlobCache Records(k_PipelineUsageMagic, 1);
+    if (Records.Load(UsagePath) != SResult_OK)
+    {
+        return SResult_OK;
+    }
+    PipelineUsageShaders.Load(ShaderPath);
+
+    for (const auto& Iter : Records.GetEntries())
+    {
+        const std::vector<U8>& Bytes = Iter.second;
+        PipelineUsageRecordHeader Header;
+        if (Bytes.size() < sizeof(Header))
+        {
+            continue;
+        }
+        memcpy(&Header, Bytes.data(), sizeof(Header));
+        if (Header.Kind > PipelineUsageKind_PIPELINE_STATE
+            || Bytes.size() != sizeof(Header) + Header.NumWords * sizeof(U32))
+        {
+            continue;
+        }
+
+        PipelineUsageRecord& Record = PipelineUsageRecords[Iter.first];
+        Record.Kind = Header.Kind;
+        Record.Words.resize(Header.NumWords);
+        memcpy(Record.Words.data(), Bytes.data() + sizeof(Header), Header.NumWords * sizeof(U32));
+        Record.FirstUseFrame = Header.FirstUseFrame;
+        Record.PreviousUseCount = Header.UseCount;
+    }
+    return SResult_OK;
+}
+
+
+void D3D12PipelineUsage::CleanUp()
+{
+    std::lock_guard<std::mutex> Lock(PipelineUsageMutex);
+    if (!PipelineUsageRecording)
+    {
+        return;
+    }
+
+    BlobCache Records(k_PipelineUsageMagic, 1);
+    BlobCache Shaders(k_PipelineShaderMagic, 1);
+    std::vector<U8> Bytes;
+    for (const auto& Iter : PipelineUsageRecords)
+    {
+        const PipelineUsageRecord& Record = Iter.second;
+        PipelineUsageRecordHeader Header;
+        Header.Kind = Record.Kind;
+        Header.NumWords = static_cast<U32>(Record.Words.size());
+        Header.FirstUseFrame = Record.FirstUseFrame;
+        Header.UseCount = Record.UseCount + Record.PreviousUseCount / 2;
+        if (!Header.UseCount)
+        {
+            continue;
+        }
+
+        Bytes.resize(sizeof(Header) + Header.NumWords * sizeof(U32));
+        memcpy(Bytes.data(), &Header, sizeof(Header));
+        memcpy(Bytes.data() + sizeof(Header), Record.Words.data(), Header.NumWords * sizeof(U32));
+        Records.Store(Iter.first, Bytes.data(), Bytes.size());
+
+        if (Record.Kind == PipelineUsageKind_PIPELINE_STATE)
+        {
+            KeyReader Reader(Record.Words);
+            U32 Type = Reader.Read();
+            Reader.ReadHash();
+            U32 NumShaders = (Type == PipelineStateType_GRAPHICS) ? 5 : 1;
+            for (U32 I = 0; I < NumShaders; ++I)
+            {
+                CopyShader(Reader, Shaders);
+            }
+        }
+    }
+
+    if (Records.GetNumEntries())
+    {
+        Records.Save(PipelineUsagePath);
+        Shaders.Save(PipelineUsageShaderPath);
+    }
+    else
+    {
+        // Everything decayed, don't prewarm stale records next run.
+        std::remove(PipelineUsagePath.c_str());
+        std::remove(PipelineUsageShaderPath.c_str());
+    }
+
+    PipelineUsageRecords.clear();
+    PipelineUsageShaders.Clear();
+    PipelineUsageRecording = false;
+}
+
+
+B32 D3D12PipelineUsage::IsRecording()
+{
+    std::lock_guard<std::mutex> Lock(PipelineUsageMutex);
+    return PipelineUsageRecording;
+}
+
+
+void D3D12PipelineUsage::StoreShaders(const GraphicsPipelineStateCreateInfo& CreateInfo)
+{
+    std::lock_guard<std::mutex> Lock(PipelineUsageMutex);
+    if (!PipelineUsageRecording)
+    {
+        return;
+    }
+    StoreShader(CreateInfo.PVertexShader);
+    StoreShader(CreateInfo.PHullShader);
+    StoreShader(CreateInfo.PDomainShader);
+    StoreShader(CreateInfo.PGeometryShader);
+    StoreShader(CreateInfo.PPixelShader);
+}
+
+
+void D3D12PipelineUsage::StoreShaders(const ComputePipelineStateCreateInfo& CreateInfo)
+{
+    std::lock_guard<std::mutex> Lock(PipelineUsageMutex);
+    if (!PipelineUsageRecording)
+    {
+        return;
+    }
+    StoreShader(CreateInfo.PComputeShader);
+}
+
+
+void D3D12PipelineUsage::Record(const RootSignatureKey& Key, const PipelineUsageCounter& Counter)
+{
+    RecordUse(PipelineUsageKind_ROOT_SIGNATURE, Key.Hash, Key.Words, Counter);
+}
+
+
+void D3D12PipelineUsage::Record(const PipelineStateKey& Key, const PipelineUsageCounter& Counter)
+{
+    RecordUse(PipelineUsageKind_PIPELINE_STATE, Key.Hash, Key.Words, Counter);
+}
+
+
+void D3D12PipelineUsage::Prewarm(GraphicsDevice* PDevice,
+                                 std::vector<RootSignature*>& OutRootSignatures,
+                                 std::vector<PipelineState*>& OutPipelineStates)
+{
+    std::vector<std::pair<U64, PipelineUsageRecord>> Ordered;
+    {
+        std::lock_guard<std::mutex> Lock(PipelineUsageMutex);
+        Ordered.assign(PipelineUsageRecords.begin(), PipelineUsageRecords.end());
+    }
+
+    // What the first frames need goes first, then the most used.
+    std::sort(Ordered.begin(), Ordered.end(),
+        [] (const std::pair<U64, PipelineUsageRecord>& A, const std::pair<U64, PipelineUsageRecord>& B) -> bool
+        {
+            if (A.second.FirstUseFrame != B.second.FirstUseFrame)
+            {
+                return A.second.FirstUseFrame < B.second.FirstUseFrame;
+            }
+            return A.second.PreviousUseCount > B.second.PreviousUseCount;
+        });
+
+    // Root signatures are created from their stored blobs, which is quick, and pipelines need them.
+    std::unordered_map<U64, RootSignature*> RootSignaturesByHash;
+    std::vector<DescriptorSetLayoutInfo> Tables;
+    std::vector<RootParameterInfo> Parameters;
+    for (const auto& Iter : Ordered)
+    {
+        RootSignatureLayoutInfo Layout;
+        RootSignature* PRootSignature = nullptr;
+        if (Iter.second.Kind != PipelineUsageKind_ROOT_SIGNATURE
+            || !ReadRootSignatureLayout(Iter.second.Words, Tables, Parameters, Layout)
+            || PDevice->CreateRootSignature(&PRootSignature, Layout) != SResult_OK)
+        {
+            continue;
+        }
+        RootSignaturesByHash[Iter.first] = PRootSignature;
+        OutRootSignatures.push_back(PRootSignature);
+    }
+
+    // Below the default priority, so pipelines the application asks for compile first.
+    I32 Priority = -1;
+    for (const auto& Iter : Ordered)
+    {
+        if (Iter.second.Kind != PipelineUsageKind_PIPELINE_STATE)
+        {
+            continue;
+        }
+        KeyReader Reader(Iter.second.Words);
+        PipelineStateType Type = static_cast<PipelineStateType>(Reader.Read());
+        U64 RootSignatureHash = Reader.ReadHash();
+        RootSignature* PRootSignature = nullptr;
+        if (RootSignatureHash)
+        {
+            auto Found = RootSignaturesByHash.find(RootSignatureHash);
+            if (Found == RootSignaturesByHash.end())
+            {
+                continue;
+            }
+            PRootSignature = Found->second;
+        }
+
+        ShaderModule Modules[5];
+        PipelineState* PPipelineState = nullptr;
+        ResultCode Result = SResult_FAILED;
+        if (Type == PipelineStateType_GRAPHICS)
+        {
+            GraphicsPipelineStateCreateInfo CreateInfo = { };
+            CreateInfo.RootSig = PRootSignature;
+            CreateInfo.Flags = PipelineStateCreateFlag_ASYNC_COMPILE;
+            CreateInfo.CompilePriority = Priority;
+            CreateInfo.PVertexShader = ReadShader(Reader, Modules[0]);
+            CreateInfo.PHullShader = ReadShader(Reader, Modules[1]);
+            CreateInfo.PDomainShader = ReadShader(Reader, Modules[2]);
+            CreateInfo.PGeometryShader = ReadShader(Reader, Modules[3]);
+            CreateInfo.PPixelShader = ReadShader(Reader, Modules[4]);
+            CreateInfo.Raster.FillMode = static_cast<GraphicsFillMode>(Reader.Read());
+            CreateInfo.Raster.CullMode = static_cast<GraphicsCullMode>(Reader.Read());
+            CreateInfo.Raster.FrontFace = static_cast<GraphicsFrontFaceWinding>(Reader.Read());
+            CreateInfo.DepthStencil.DepthEnable = Reader.Read();
+            CreateInfo.DepthStencil.DepthWriteMask = static_cast<GraphicsDepthWriteMask>(Reader.Read());
+            CreateInfo.DepthStencil.DepthFunction = static_cast<GraphicsComparison>(Reader.Read());
+            CreateInfo.DepthStencil.StencilEnable = Reader.Read();
+            CreateInfo.DepthStencilFormat = static_cast<PixelFormat>(Reader.Read());
+            CreateInfo.BlendState = static_cast<GraphicsBlendStateDesc>(Reader.Read());
+            CreateInfo.NumRenderTargets = Reader.Read();
+            CreateInfo.SampleMask = Reader.Read();
+            if (Reader.Valid)
+            {
+                Result = PDevice->CreateGraphicsPipeline(&PPipelineState, CreateInfo);
+            }
+        }
+        else if (Type == PipelineStateType_COMPUTE)
+        {
+            ComputePipelineStateCreateInfo CreateInfo = { };
+            CreateInfo.RootSig = PRootSignature;
+            CreateInfo.Flags = PipelineStateCreateFlag_ASYNC_COMPILE;
+            CreateInfo.CompilePriority = Priority;
+            CreateInfo.PComputeShader = ReadShader(Reader, Modules[0]);
+            if (Reader.Valid)
+            {
+                Result = PDevice->CreateComputePipeline(&PPipelineState, CreateInfo);
+            }
+        }
+
+        if (Result == SResult_OK)
+        {
+            OutPipelineStates.push_back(PPipelineState);
+            Priority -= 1;
+        }
+    }
+}
+} // Synthe
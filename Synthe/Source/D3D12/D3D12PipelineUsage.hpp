@@ -0,0 +1,90 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Graphics/PipelineState.hpp"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+
+namespace Synthe {
+
+
+class GraphicsDevice;
+class D3D12RootSignature;
+struct RootSignatureKey;
+struct PipelineStateKey;
+
+
+//! Bind counters kept on root signatures and pipeline states. Command lists count every bind, and the
+//! counts are folded into the usage records once the object is destroyed.
+struct PipelineUsageCounter
+{
+    PipelineUsageCounter()
+        : UseCount(0)
+        , FirstUseFrame(0) { }
+
+    //! Count a bind.
+    //!
+    //! \param Frame The frame being recorded.
+    void MarkUsed(U64 Frame)
+    {
+        if (UseCount.fetch_add(1, std::memory_order_relaxed) == 0)
+        {
+            FirstUseFrame.store(Frame, std::memory_order_relaxed);
+        }
+    }
+
+    std::atomic<U64> UseCount;
+    std::atomic<U64> FirstUseFrame;
+};
+
+
+//! Records which root signatures and pipeline states are bound during a session, the frame each was
+//! first bound at, and how often. At the next startup, recorded root signatures are created up front,
+//! and recorded pipelines are queued for asynchronous compiles, earliest used first. Later creates from
+//! the application then hit the pipeline cache, or wait on the compile already in flight.
+//!
+//! Recreating a pipeline needs its shaders, so the bytecode of every pipeline created while recording is
+//! kept, and the bytecode of recorded pipelines is saved next to the records. Records not bound in a
+//! session lose half their count, and are dropped once it reaches zero.
+class D3D12PipelineUsage
+{
+public:
+    //! Load the records of previous sessions, and start recording.
+    //!
+    //! \param UsagePath The record file.
+    //! \param ShaderPath The file holding the shaders of recorded pipelines.
+    //! \return SResult_OK, even if nothing was recorded before.
+    static ResultCode Initialize(const std::string& UsagePath, const std::string& ShaderPath);
+
+    //! Save the records, and stop recording. Root signatures and pipeline states must have been
+    //! destroyed first, so their counters are folded in.
+    static void CleanUp();
+
+    static B32 IsRecording();
+
+    //! Keep the shaders of a created pipeline.
+    static void StoreShaders(const GraphicsPipelineStateCreateInfo& CreateInfo);
+    static void StoreShaders(const ComputePipelineStateCreateInfo& CreateInfo);
+
+    //! Fold the counters of a root signature about to be destroyed into its record.
+    static void Record(const RootSignatureKey& Key, const PipelineUsageCounter& Counter);
+
+    //! Fold the counters of a pipeline state about to be destroyed into its record.
+    static void Record(const PipelineStateKey& Key, const PipelineUsageCounter& Counter);
+
+    //! Create the recorded root signatures, and queue compiles of the recorded pipelines. The created
+    //! objects hold a reference, which the caller gives back through the device.
+    //!
+    //! \param PDevice The device to create on.
+    //! \param OutRootSignatures The root signatures created.
+    //! \param OutPipelineStates The pipeline states queued.
+    static void Prewarm(GraphicsDevice* PDevice,
+                        std::vector<RootSignature*>& OutRootSignatures,
+                        std::vector<PipelineState*>& OutPipelineStates);
+};
+} // Synthe
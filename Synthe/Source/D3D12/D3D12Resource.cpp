@@ -10,98 +10,108 @@
 namespace Synthe {
 
 
+ResultCode D3D12DescriptorSet::Initialize(const DescriptorSetLayoutInfo& Layout)
+{
+    m_Key.NumSrvs = Layout.Srv.NumDescriptors;
+    m_Key.NumCbvs = Layout.Cbv.NumDescriptors;
+    m_Key.NumUavs = Layout.Uav.NumDescriptors;
+    m_Key.NumSamplers = Layout.Sampler.NumDescriptors;
+    m_Key.Handles.assign(m_Key.NumSrvs + m_Key.NumCbvs + m_Key.NumUavs + m_Key.NumSamplers, 0);
+    m_Key.UpdateHash();
+    return SResult_OK;
+}
+
+
 ResultCode D3D12DescriptorSet::Update(const DescriptorSetUpdateInfo& Info)
 {
-    ID3D12Device* PDevice = static_cast<D3D12GraphicsDevice*>(GetDeviceD3D12())->GetNative();
-    DescriptorPool* CBVSRVUAVPool = D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_CBV_SRV_UAV);
-    DescriptorPool* SamplerPool = D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_SAMPLER);
-    U64 CBVSRVUAVAlignment = CBVSRVUAVPool->GetAlignmentSizeInBytes();
-    U64 SamplerAlignment = SamplerPool->GetAlignmentSizeInBytes();
-    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> CBVInfos;
-    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> SRVInfos;
-    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> UAVInfos;
-    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> SamplerInfos;
+    D3D12GraphicsDevice* PGraphicsDevice = static_cast<D3D12GraphicsDevice*>(GetDeviceD3D12());
+
+    // Ranges are laid out in the table in the same order the root signature appends them.
+    const U32 SrvOffset = 0;
+    const U32 CbvOffset = SrvOffset + m_Key.NumSrvs;
+    const U32 UavOffset = CbvOffset + m_Key.NumCbvs;
+    const U32 SamplerOffset = UavOffset + m_Key.NumUavs;
 
     for (U32 I = 0; I < Info.NumDescriptors; ++I)
     {
-        DescriptorInfo& Descriptor = Info.PDescriptors[I];
+        const DescriptorInfo& Descriptor = Info.PDescriptors[I];
+        U32 RangeSize = 0;
+        U32 RangeOffset = 0;
         switch (Descriptor.Type)
         {
             case DescriptorType_SHADER_RESOURCE_VIEW:
-            {
-                SRVInfos.reserve(Descriptor.Binding + 1ULL);
-                SRVInfos[Descriptor.Binding] = {Descriptor.ViewHandle};
+                RangeSize = m_Key.NumSrvs;
+                RangeOffset = SrvOffset;
                 break;
-            }
             case DescriptorType_CONSTANT_BUFFER:
-            {
-                CBVInfos.reserve(Descriptor.Binding + 1ULL);
-                CBVInfos[Descriptor.Binding] = {Descriptor.ViewHandle};
+                RangeSize = m_Key.NumCbvs;
+                RangeOffset = CbvOffset;
                 break;
-            }
             case DescriptorType_UNORDERED_ACCESS_VIEW:
-            {
-                UAVInfos.reserve(Descriptor.Binding + 1ULL);
-                UAVInfos[Descriptor.Binding] = {Descriptor.ViewHandle};
+                RangeSize = m_Key.NumUavs;
+                RangeOffset = UavOffset;
                 break;
-            }
             case DescriptorType_SAMPLER:
-            {
-                SamplerInfos.reserve(Descriptor.Binding + 1ULL);
-                SamplerInfos[Descriptor.Binding] = {Descriptor.ViewHandle};
+                RangeSize = m_Key.NumSamplers;
+                RangeOffset = SamplerOffset;
                 break;
-            }
             default:
-            {
-                break;
-            }
+                return SResult_INVALID_ARGS;
         }
+
+        if (Descriptor.Binding >= RangeSize)
+        {
+            return SResult_OUT_OF_BOUNDS;
+        }
+        m_Key.Handles[RangeOffset + Descriptor.Binding] = Descriptor.ViewHandle;
     }
+    m_Key.UpdateHash();
 
+    if (m_PEntry && m_PEntry->Key == m_Key)
     {
-        D3D12_CPU_DESCRIPTOR_HANDLE OffsetAddress = TableUpload.StartingAddress;
-        CBVSRVUAVPool->CopyDescriptorsRange(PDevice, SRVInfos.size(), SRVInfos.data(), OffsetAddress);
-        OffsetAddress.ptr += SRVInfos.size() + CBVSRVUAVAlignment;
-        CBVSRVUAVPool->CopyDescriptorsRange(PDevice, CBVInfos.size(), CBVInfos.data(), OffsetAddress);
-        OffsetAddress.ptr += CBVInfos.size() + CBVSRVUAVAlignment;
-        CBVSRVUAVPool->CopyDescriptorsRange(PDevice, UAVInfos.size(), UAVInfos.data(), OffsetAddress);
+        return SResult_OK;
     }
 
+    // Take the new table before letting go of the old one, so a set bouncing between two tables
+    // never drops the only reference.
+    D3D12DescriptorTableEntry* PEntry = nullptr;
+    ResultCode Result = D3D12DescriptorTableCache::Acquire(m_Key, PGraphicsDevice->GetCurrentBufferIndex(), 
+        PGraphicsDevice->GetCurrentFrame(), &PEntry);
+    if (Result != SResult_OK)
     {
-        SamplerPool->CopyDescriptorsRange(PDevice, SamplerInfos.size(), SamplerInfos.data(), 
-            SamplerTableUpload.StartingAddress);
-        m_NeedsFlushToGPU = true;
+        return Result;
     }
+    D3D12DescriptorTableCache::Release(m_PEntry, PGraphicsDevice->GetCurrentFrame());
+    m_PEntry = PEntry;
     return SResult_OK;
 }
 
 
-void D3D12DescriptorSet::UploadToShaderVisibleHeap(ID3D12Device* PDevice, U32 CurrentBufferIndex)
+D3D12_GPU_DESCRIPTOR_HANDLE D3D12DescriptorSet::GetGPUTableAddress(U32 BufferIndex) const
 {
-    if (NeedsToBeFlushed()) 
+    if (!m_PEntry || !m_PEntry->TableUpload.TableSizeInBytes)
     {
-        DescriptorPool* Pool = 
-            D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_CBV_SRV_UAV, CurrentBufferIndex);
-        DescriptorPool* SamplerPool =
-            D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_SAMPLER, CurrentBufferIndex);
-
-        Pool->CopyDescriptorsRangeConsecutive(PDevice, TableUpload.StartingAddress, 
-            TableUpload.TableSizeInBytes / Pool->GetAlignmentSizeInBytes(), 
-            GPUTable.StartingAddress);
-
-        SamplerPool->CopyDescriptorsRangeConsecutive(PDevice, SamplerTableUpload.StartingAddress,
-            SamplerTableUpload.TableSizeInBytes / SamplerPool->GetAlignmentSizeInBytes(), 
-            GPUSamplerTable.StartingAddress);
+        return D3D12_GPU_DESCRIPTOR_HANDLE { 0 };
     }
+    return m_PEntry->GetGPUTableAddress(BufferIndex);
+}
+
 
-    m_NeedsFlushToGPU = false;
+D3D12_GPU_DESCRIPTOR_HANDLE D3D12DescriptorSet::GetGPUSamplerTableAddress(U32 BufferIndex) const
+{
+    if (!m_PEntry || !m_PEntry->SamplerTableUpload.TableSizeInBytes)
+    {
+        return D3D12_GPU_DESCRIPTOR_HANDLE { 0 };
+    }
+    return m_PEntry->GetGPUSamplerTableAddress(BufferIndex);
 }
 
 
 ResultCode D3D12DescriptorSet::Release()
 {
-    DescriptorPool* Pool = D3D12DescriptorManager::GetDescriptorPool(DescriptorHeapType_CBV_SRV_UAV);
-    
+    D3D12GraphicsDevice* PGraphicsDevice = static_cast<D3D12GraphicsDevice*>(GetDeviceD3D12());
+    D3D12DescriptorTableCache::Release(m_PEntry, PGraphicsDevice->GetCurrentFrame());
+    m_PEntry = nullptr;
     return SResult_OK;
 }
 } // Synthe
\ No newline at end of file
@@ -5,62 +5,117 @@
 
 #include "Graphics/GraphicsResource.hpp"
 #include "Graphics/GraphicsStructs.hpp"
+#include "Graphics/PipelineState.hpp"
 
 #include "D3D12DescriptorManager.hpp"
+#include "D3D12DescriptorTableCache.hpp"
 #include "D3D12MemoryManager.hpp"
+#include "D3D12PipelineUsage.hpp"
+
+#include <vector>
 
 
 namespace Synthe {
 
 
+//! D3D12 descriptor set. The set only keeps track of the views bound to it, the shader visible
+//! tables are shared with every other set binding the same views, through D3D12DescriptorTableCache.
+//! An update moves the set to the table matching its new contents, which is only written if no other
+//! set already uses it.
 class D3D12DescriptorSet : public DescriptorSet
 {
 public:
-    //! Update descriptor set. This updates CPU bound descriptors, so be sure to 
-    //! call UploadToShaderVisibleHeap, in order to keep this object coherent.
-    ResultCode Update(const DescriptorSetUpdateInfo& Info) override;
-
-    //! Clean up this descriptor set, release on finish.
-    ResultCode Release() override;
-
-    //! Upload CPU descriptor heap to GPU visible descriptor heap.
-    //!
-    //! \param PDevice
-    //! \param CurrentBufferIndex
-    void UploadToShaderVisibleHeap(ID3D12Device* PDevice, U32 CurrentBufferIndex);
+    D3D12DescriptorSet()
+        : m_PEntry(nullptr) { }
 
+    //! Set up the set for the given layout. No table is referenced until the first Update().
     //!
-    B32 NeedsToBeFlushed() const { return m_NeedsFlushToGPU; }
+    //! \param Layout The layout of the set.
+    //! \return SResult_OK.
+    ResultCode Initialize(const DescriptorSetLayoutInfo& Layout);
 
-    //! Table that contains the offsets of our resources.
-    DescriptorTable TableUpload;
+    //! Update descriptor set. Bindings not in Info keep their previous view.
+    ResultCode Update(const DescriptorSetUpdateInfo& Info) override;
 
-    //! Sampler table that contains the offsets of our resources.
-    DescriptorTable SamplerTableUpload;
+    //! Clean up this descriptor set, release on finish.
+    ResultCode Release() override;
 
-    //! GPU table used for input in shaders.
-    DescriptorTable GPUTable;
+    //! Get the GPU address of the CBV/SRV/UAV table to bind for the given buffered frame.
+    D3D12_GPU_DESCRIPTOR_HANDLE GetGPUTableAddress(U32 BufferIndex) const;
 
-    //! Sampler table used for input in shaders.
-    DescriptorTable GPUSamplerTable;   
+    //! Get the GPU address of the sampler table to bind for the given buffered frame.
+    D3D12_GPU_DESCRIPTOR_HANDLE GetGPUSamplerTableAddress(U32 BufferIndex) const;
 
 private:
 
-    //! Bool to check if this descriptor set needs to actually be flushed to the shader visible set.
-    //! Default set to false, until Update() is called.
-    B32 m_NeedsFlushToGPU;
+    //! Views currently bound to the set, along with the layout counts.
+    DescriptorTableKey m_Key;
+
+    //! Shared table matching m_Key, null if never updated.
+    D3D12DescriptorTableEntry* m_PEntry;
 };
 
 
 class D3D12RootSignature : public RootSignature
 {
 public:
+    static const U32 k_NoParameter = 0xFFFFFFFF;
+
     D3D12RootSignature(ID3D12RootSignature* PRoot) 
-        : m_RootSignature(PRoot) { }
+        : m_RootSignature(PRoot)
+        , m_LayoutHash(0)
+        , m_FirstRootParameter(0)
+        , m_NumRootParameters(0)
+        , m_BindlessResourceParameter(k_NoParameter)
+        , m_BindlessSamplerParameter(k_NoParameter)
+        , m_BindlessIndexParameter(k_NoParameter) { }
 
     ID3D12RootSignature* GetNative() { return m_RootSignature; }
+
+    //! Root parameter indices of the bindless tables and indices, k_NoParameter if not bindless.
+    void SetBindlessParameters(U32 ResourceTable, U32 SamplerTable, U32 Indices)
+    {
+        m_BindlessResourceParameter = ResourceTable;
+        m_BindlessSamplerParameter = SamplerTable;
+        m_BindlessIndexParameter = Indices;
+    }
+
+    //! Hash of the layout this root signature was created from, stable across runs.
+    void SetLayoutHash(U64 Hash) { m_LayoutHash = Hash; }
+    U64 GetLayoutHash() const { return m_LayoutHash; }
+
+    //! Place the root constants and descriptors, which follow the descriptor tables.
+    void SetRootParameters(U32 FirstParameter, U32 NumParameters)
+    {
+        m_FirstRootParameter = FirstParameter;
+        m_NumRootParameters = NumParameters;
+    }
+
+    //! Get the native root parameter index of an entry in RootSignatureLayoutInfo::PRootParameters, 
+    //! k_NoParameter if out of range.
+    U32 GetRootParameter(U32 ParameterIndex) const 
+    { 
+        return ParameterIndex < m_NumRootParameters ? m_FirstRootParameter + ParameterIndex : k_NoParameter; 
+    }
+
+    B32 IsBindless() const { return m_BindlessResourceParameter != k_NoParameter; }
+    U32 GetBindlessResourceParameter() const { return m_BindlessResourceParameter; }
+    U32 GetBindlessSamplerParameter() const { return m_BindlessSamplerParameter; }
+    U32 GetBindlessIndexParameter() const { return m_BindlessIndexParameter; }
+
+    //! Count a bind, for pipeline usage recording.
+    void MarkUsed(U64 Frame) { m_Usage.MarkUsed(Frame); }
+    const PipelineUsageCounter& GetUsage() const { return m_Usage; }
+
 private:
     ID3D12RootSignature* m_RootSignature;
+    PipelineUsageCounter m_Usage;
+    U64 m_LayoutHash;
+    U32 m_FirstRootParameter;
+    U32 m_NumRootParameters;
+    U32 m_BindlessResourceParameter;
+    U32 m_BindlessSamplerParameter;
+    U32 m_BindlessIndexParameter;
 };
 
 
@@ -222,4 +222,78 @@ ResultCode GetDsvDescription(const DepthStencilViewCreateInfo& DSV, D3D12_DEPTH_
 
     return SResult_OK;
 }
+
+static D3D12_TEXTURE_ADDRESS_MODE GetNativeAddressMode(SamplerAddressMode Mode)
+{
+    switch (Mode)
+    {
+        case SamplerAddressMode_MIRROR:         return D3D12_TEXTURE_ADDRESS_MODE_MIRROR;
+        case SamplerAddressMode_CLAMP:          return D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+        case SamplerAddressMode_BORDER:         return D3D12_TEXTURE_ADDRESS_MODE_BORDER;
+        case SamplerAddressMode_MIRROR_ONCE:    return D3D12_TEXTURE_ADDRESS_MODE_MIRROR_ONCE;
+        case SamplerAddressMode_WRAP:
+        default:                                return D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+    }
+}
+
+
+static D3D12_COMPARISON_FUNC GetNativeComparison(GraphicsComparison Comparison)
+{
+    switch (Comparison)
+    {
+        case GraphicsComparison_ALWAYS:         return D3D12_COMPARISON_FUNC_ALWAYS;
+        case GraphicsComparison_EQUAL:          return D3D12_COMPARISON_FUNC_EQUAL;
+        case GraphicsComparison_GREATER:        return D3D12_COMPARISON_FUNC_GREATER;
+        case GraphicsComparison_LESS:           return D3D12_COMPARISON_FUNC_LESS;
+        case GraphicsComparison_LESS_EQUAL:     return D3D12_COMPARISON_FUNC_LESS_EQUAL;
+        case GraphicsComparison_NOT_EQUAL:      return D3D12_COMPARISON_FUNC_NOT_EQUAL;
+        case GraphicsComparison_GREATER_EQUAL:  return D3D12_COMPARISON_FUNC_GREATER_EQUAL;
+        case GraphicsComparison_NEVER:
+        default:                                return D3D12_COMPARISON_FUNC_NEVER;
+    }
+}
+
+
+ResultCode GetSamplerDescription(const SamplerCreateInfo& Sampler, D3D12_SAMPLER_DESC& Desc)
+{
+    Desc = { };
+    D3D12_FILTER_REDUCTION_TYPE Reduction = Sampler.EnableComparison ? D3D12_FILTER_REDUCTION_TYPE_COMPARISON 
+                                                                     : D3D12_FILTER_REDUCTION_TYPE_STANDARD;
+    if (Sampler.MaxAnisotropy > 1)
+    {
+        Desc.Filter = D3D12_ENCODE_ANISOTROPIC_FILTER(Reduction);
+        Desc.MaxAnisotropy = Sampler.MaxAnisotropy < D3D12_REQ_MAXANISOTROPY ? Sampler.MaxAnisotropy 
+                                                                             : D3D12_REQ_MAXANISOTROPY;
+    }
+    else
+    {
+        Desc.Filter = D3D12_ENCODE_BASIC_FILTER(
+            Sampler.MinFilter == SamplerFilter_LINEAR ? D3D12_FILTER_TYPE_LINEAR : D3D12_FILTER_TYPE_POINT,
+            Sampler.MagFilter == SamplerFilter_LINEAR ? D3D12_FILTER_TYPE_LINEAR : D3D12_FILTER_TYPE_POINT,
+            Sampler.MipFilter == SamplerFilter_LINEAR ? D3D12_FILTER_TYPE_LINEAR : D3D12_FILTER_TYPE_POINT,
+            Reduction);
+        Desc.MaxAnisotropy = 1;
+    }
+    Desc.AddressU = GetNativeAddressMode(Sampler.AddressU);
+    Desc.AddressV = GetNativeAddressMode(Sampler.AddressV);
+    Desc.AddressW = GetNativeAddressMode(Sampler.AddressW);
+    Desc.MipLODBias = Sampler.MipLODBias;
+    Desc.ComparisonFunc = Sampler.EnableComparison ? GetNativeComparison(Sampler.ComparisonFunction) 
+                                                   : D3D12_COMPARISON_FUNC_NEVER;
+    Desc.MinLOD = Sampler.MinLOD;
+    Desc.MaxLOD = Sampler.MaxLOD;
+
+    if (Sampler.AddressU == SamplerAddressMode_BORDER 
+        || Sampler.AddressV == SamplerAddressMode_BORDER 
+        || Sampler.AddressW == SamplerAddressMode_BORDER)
+    {
+        FLOAT Alpha = (Sampler.BorderColor == SamplerBorderColor_TRANSPARENT_BLACK) ? 0.0f : 1.0f;
+        FLOAT Color = (Sampler.BorderColor == SamplerBorderColor_OPAQUE_WHITE) ? 1.0f : 0.0f;
+        Desc.BorderColor[0] = Color;
+        Desc.BorderColor[1] = Color;
+        Desc.BorderColor[2] = Color;
+        Desc.BorderColor[3] = Alpha;
+    }
+    return SResult_OK;
+}
 } // Synthe
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include "Win32Common.hpp"
 
 #include "Graphics/GraphicsStructs.hpp"
+#include "Graphics/PipelineState.hpp"
 
 namespace Synthe {
 
@@ -29,5 +30,10 @@ ResultCode GetRtvDescription(const RenderTargetViewCreateInfo& RTV, D3D12_RENDER
 //!
 ResultCode GetDsvDescription(const DepthStencilViewCreateInfo& DSV, D3D12_DEPTH_STENCIL_VIEW_DESC& Desc);
 
+//! Obtain the Sampler description in native D3D12 context. Fields the sampler ignores are zeroed, 
+//! so samplers that sample the same give byte equal descriptions.
+//!
+ResultCode GetSamplerDescription(const SamplerCreateInfo& Sampler, D3D12_SAMPLER_DESC& Desc);
+
 } // Synthe 
 #endif // D3D12_RESOURCE_VIEW_HPP
\ No newline at end of file
@@ -0,0 +1,211 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "D3D12RootSignatureCache.hpp"
+#include "D3D12PipelineUsage.hpp"
+#include "Common/BlobCache.hpp"
+#include "Common/Hash.hpp"
+#include "Common/Memory/Allocator.hpp"
+
+#include <cstring>
+#include <unordered_map>
+
+namespace Synthe {
+
+
+struct RootSignatureCacheEntry
+{
+    D3D12RootSignature* PRootSignature;
+    U32 RefCount;
+};
+
+
+static std::unordered_map<RootSignatureKey, RootSignatureCacheEntry, RootSignatureKeyHasher> RootSignatures;
+static std::unordered_map<RootSignature*, const RootSignatureKey*> RootSignatureKeys;
+static RootSignatureCacheStatistics RootSignatureStatistics = { };
+
+// 'SRSG'. Version 2 stores the key ahead of each blob.
+static BlobCache RootSignatureBlobs(0x47535253, 2);
+
+//! Bumped whenever RootSignatureKey::Build() changes how layouts are encoded, so blobs stored with
+//! an older encoding never match.
+static const U32 k_KeyEncodingVersion = 1;
+
+//! Words stored ahead of the serialized root signature, followed by the key words.
+struct RootSignatureBlobHeader
+{
+    U32 KeyEncodingVersion;
+    U32 NumKeyWords;
+};
+
+
+static void PushLayout(std::vector<U32>& Words, const DescriptorLayoutInfo& Layout)
+{
+    Words.push_back(Layout.NumDescriptors);
+    Words.push_back(Layout.NumDescriptors ? Layout.BaseRegister : 0);
+    Words.push_back(Layout.NumDescriptors ? Layout.Flags : 0);
+}
+
+
+void RootSignatureKey::Build(const RootSignatureLayoutInfo& CreateInfo, D3D_ROOT_SIGNATURE_VERSION Version)
+{
+    Words.clear();
+    Words.push_back(static_cast<U32>(Version));
+    Words.push_back(CreateInfo.NumDescriptorTables);
+    for (U32 I = 0; I < CreateInfo.NumDescriptorTables; ++I)
+    {
+        PushLayout(Words, CreateInfo.LayoutInfos[I].Srv);
+        PushLayout(Words, CreateInfo.LayoutInfos[I].Cbv);
+        PushLayout(Words, CreateInfo.LayoutInfos[I].Uav);
+        PushLayout(Words, CreateInfo.LayoutInfos[I].Sampler);
+    }
+
+    Words.push_back(CreateInfo.NumRootParameters);
+    for (U32 I = 0; I < CreateInfo.NumRootParameters; ++I)
+    {
+        const RootParameterInfo& Parameter = CreateInfo.PRootParameters[I];
+        B32 IsConstants = (Parameter.Type == RootParameterType_CONSTANTS);
+        Words.push_back(static_cast<U32>(Parameter.Type));
+        Words.push_back(Parameter.ShaderRegister);
+        Words.push_back(Parameter.RegisterSpace);
+        Words.push_back(IsConstants ? Parameter.Num32BitValues : 0);
+        Words.push_back(IsConstants ? 0 : Parameter.Flags);
+    }
+
+    Words.push_back(CreateInfo.UseBindless ? 1 : 0);
+    Words.push_back(CreateInfo.UseBindless ? CreateInfo.NumBindlessIndices : 0);
+    // Read back in this order by the pipeline prewarm, see D3D12PipelineUsage.cpp.
+
+    Hash = HashBytes(Words.data(), Words.size() * sizeof(U32));
+}
+
+
+D3D12RootSignature* D3D12RootSignatureCache::Acquire(const RootSignatureKey& Key)
+{
+    auto Iter = RootSignatures.find(Key);
+    if (Iter == RootSignatures.end())
+    {
+        RootSignatureStatistics.NumMisses += 1;
+        return nullptr;
+    }
+    RootSignatureStatistics.NumHits += 1;
+    Iter->second.RefCount += 1;
+    return Iter->second.PRootSignature;
+}
+
+
+void D3D12RootSignatureCache::Insert(const RootSignatureKey& Key, D3D12RootSignature* PRootSignature)
+{
+    auto Result = RootSignatures.insert({ Key, { PRootSignature, 1 } });
+    RootSignatureKeys[PRootSignature] = &Result.first->first;
+    RootSignatureStatistics.NumLiveRootSignatures = RootSignatures.size();
+}
+
+
+ResultCode D3D12RootSignatureCache::Release(RootSignature* PRootSignature)
+{
+    auto KeyIter = RootSignatureKeys.find(PRootSignature);
+    if (KeyIter == RootSignatureKeys.end())
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+
+    auto Iter = RootSignatures.find(*KeyIter->second);
+    RootSignatureCacheEntry& Entry = Iter->second;
+    if (--Entry.RefCount == 0)
+    {
+        D3D12PipelineUsage::Record(Iter->first, Entry.PRootSignature->GetUsage());
+        Entry.PRootSignature->GetNative()->Release();
+        Free<D3D12RootSignature>(Entry.PRootSignature);
+        RootSignatureKeys.erase(KeyIter);
+        RootSignatures.erase(Iter);
+        RootSignatureStatistics.NumLiveRootSignatures = RootSignatures.size();
+    }
+    return SResult_OK;
+}
+
+
+ResultCode D3D12RootSignatureCache::CreateFromBlob(ID3D12Device* PDevice,
+                                                   const RootSignatureKey& Key,
+                                                   ID3D12RootSignature** OutRootSignature)
+{
+    const std::vector<U8>* PBlob = RootSignatureBlobs.Find(Key.Hash);
+    if (!PBlob || PBlob->size() < sizeof(RootSignatureBlobHeader))
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+
+    // Blobs are found by hash only, the stored key tells collisions and old encodings apart.
+    RootSignatureBlobHeader Header = { };
+    memcpy(&Header, PBlob->data(), sizeof(Header));
+    U64 KeySizeInBytes = static_cast<U64>(Header.NumKeyWords) * sizeof(U32);
+    U64 DataOffset = sizeof(Header) + KeySizeInBytes;
+    if (Header.KeyEncodingVersion != k_KeyEncodingVersion
+        || Header.NumKeyWords != Key.Words.size()
+        || PBlob->size() <= DataOffset
+        || memcmp(PBlob->data() + sizeof(Header), Key.Words.data(), KeySizeInBytes) != 0)
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+
+    HRESULT Result = PDevice->CreateRootSignature(0, PBlob->data() + DataOffset, PBlob->size() - DataOffset,
+        __uuidof(ID3D12RootSignature), (void**)OutRootSignature);
+    if (FAILED(Result))
+    {
+        // Stale or damaged, let the caller serialize it again.
+        RootSignatureBlobs.Remove(Key.Hash);
+        return SResult_OBJECT_NOT_FOUND;
+    }
+    RootSignatureStatistics.NumBlobHits += 1;
+    return SResult_OK;
+}
+
+
+void D3D12RootSignatureCache::StoreBlob(const RootSignatureKey& Key, const void* PData, U64 SizeInBytes)
+{
+    RootSignatureBlobHeader Header = { };
+    Header.KeyEncodingVersion = k_KeyEncodingVersion;
+    Header.NumKeyWords = static_cast<U32>(Key.Words.size());
+    U64 KeySizeInBytes = static_cast<U64>(Header.NumKeyWords) * sizeof(U32);
+
+    std::vector<U8> Blob(sizeof(Header) + KeySizeInBytes + SizeInBytes);
+    memcpy(Blob.data(), &Header, sizeof(Header));
+    memcpy(Blob.data() + sizeof(Header), Key.Words.data(), KeySizeInBytes);
+    memcpy(Blob.data() + sizeof(Header) + KeySizeInBytes, PData, SizeInBytes);
+    RootSignatureBlobs.Store(Key.Hash, Blob.data(), Blob.size());
+}
+
+
+ResultCode D3D12RootSignatureCache::LoadBlobs(const std::string& Path)
+{
+    return RootSignatureBlobs.Load(Path);
+}
+
+
+ResultCode D3D12RootSignatureCache::SaveBlobs(const std::string& Path)
+{
+    return RootSignatureBlobs.Save(Path);
+}
+
+
+void D3D12RootSignatureCache::CleanUp()
+{
+    for (auto& Iter : RootSignatures)
+    {
+        D3D12PipelineUsage::Record(Iter.first, Iter.second.PRootSignature->GetUsage());
+        Iter.second.PRootSignature->GetNative()->Release();
+        Free<D3D12RootSignature>(Iter.second.PRootSignature);
+    }
+    RootSignatures.clear();
+    RootSignatureKeys.clear();
+    RootSignatureBlobs.Clear();
+    RootSignatureStatistics.NumLiveRootSignatures = 0;
+}
+
+
+const RootSignatureCacheStatistics& D3D12RootSignatureCache::GetStatistics()
+{
+    return RootSignatureStatistics;
+}
+} // Synthe
@@ -0,0 +1,110 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Graphics/PipelineState.hpp"
+
+#include "Win32Common.hpp"
+#include "D3D12Resource.hpp"
+
+#include <string>
+#include <vector>
+
+
+namespace Synthe {
+
+
+//! Canonical form of a root signature layout. Fields that do not affect the created root signature,
+//! such as the register of an empty range, are zeroed, so equivalent layouts give equal keys.
+struct RootSignatureKey
+{
+    RootSignatureKey()
+        : Hash(0) { }
+
+    //! Build the key of a layout.
+    //!
+    //! \param CreateInfo The layout.
+    //! \param Version The root signature version it will be serialized with.
+    void Build(const RootSignatureLayoutInfo& CreateInfo, D3D_ROOT_SIGNATURE_VERSION Version);
+
+    bool operator==(const RootSignatureKey& Other) const
+    {
+        return Hash == Other.Hash && Words == Other.Words;
+    }
+
+    std::vector<U32> Words;
+    U64 Hash;
+};
+
+
+struct RootSignatureKeyHasher
+{
+    size_t operator()(const RootSignatureKey& Key) const { return static_cast<size_t>(Key.Hash); }
+};
+
+
+//! Counters of the root signature cache, since startup.
+struct RootSignatureCacheStatistics
+{
+    //! Creates that returned an existing root signature.
+    U64 NumHits;
+
+    //! Creates that had to build a new root signature.
+    U64 NumMisses;
+
+    //! Misses that were created from a stored blob, skipping serialization.
+    U64 NumBlobHits;
+
+    //! Root signatures currently alive.
+    U64 NumLiveRootSignatures;
+};
+
+
+//! Cache of root signatures keyed by their layout. Identical layouts share one ref counted root
+//! signature, which is destroyed once every create has been matched by a destroy. Serialized blobs are
+//! kept in a blob cache that can be saved to disk, so later runs create root signatures straight
+//! from the blob.
+class D3D12RootSignatureCache
+{
+public:
+    //! Get the root signature of a layout, adding a reference.
+    //!
+    //! \param Key The layout key.
+    //! \return The root signature, nullptr if not cached.
+    static D3D12RootSignature* Acquire(const RootSignatureKey& Key);
+
+    //! Add a newly created root signature, with one reference.
+    static void Insert(const RootSignatureKey& Key, D3D12RootSignature* PRootSignature);
+
+    //! Give back a reference, destroying the root signature with the last one.
+    //!
+    //! \return SResult_OK on success. SResult_OBJECT_NOT_FOUND if not made by this cache.
+    static ResultCode Release(RootSignature* PRootSignature);
+
+    //! Create a native root signature from the stored blob of a layout. The key stored with the blob
+    //! must match, a blob stored under the same hash for another layout is not used.
+    //!
+    //! \param PDevice The native device.
+    //! \param Key The layout key.
+    //! \param OutRootSignature The native root signature.
+    //! \return SResult_OK if created. SResult_OBJECT_NOT_FOUND if there is no usable blob.
+    static ResultCode CreateFromBlob(ID3D12Device* PDevice,
+                                     const RootSignatureKey& Key,
+                                     ID3D12RootSignature** OutRootSignature);
+
+    //! Keep the serialized blob of a layout, along with its key.
+    static void StoreBlob(const RootSignatureKey& Key, const void* PData, U64 SizeInBytes);
+
+    //! Load stored blobs from disk.
+    static ResultCode LoadBlobs(const std::string& Path);
+
+    //! Save stored blobs to disk, if any were added.
+    static ResultCode SaveBlobs(const std::string& Path);
+
+    //! Destroy all root signatures, and drop the stored blobs.
+    static void CleanUp();
+
+    static const RootSignatureCacheStatistics& GetStatistics();
+};
+} // Synthe
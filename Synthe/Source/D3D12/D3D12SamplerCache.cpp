@@ -0,0 +1,102 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "D3D12SamplerCache.hpp"
+#include "Common/Hash.hpp"
+
+#include <string.h>
+#include <unordered_map>
+
+namespace Synthe {
+
+
+struct SamplerCacheEntry
+{
+    GPUHandle Handle;
+    U32 RefCount;
+};
+
+
+static std::unordered_map<SamplerKey, SamplerCacheEntry, SamplerKeyHasher> Samplers;
+static std::unordered_map<GPUHandle, SamplerKey> SamplerKeys;
+static SamplerCacheStatistics SamplerStatistics = { };
+
+
+void SamplerKey::Build(const D3D12_SAMPLER_DESC& SamplerDesc)
+{
+    Desc = SamplerDesc;
+    // Adding zero turns -0.0 into 0.0, which sample the same but differ in bits.
+    Desc.MipLODBias += 0.0f;
+    Desc.MinLOD += 0.0f;
+    Desc.MaxLOD += 0.0f;
+    for (U32 I = 0; I < 4; ++I)
+    {
+        Desc.BorderColor[I] += 0.0f;
+    }
+    Hash = HashBytes(&Desc, sizeof(Desc));
+}
+
+
+bool SamplerKey::operator==(const SamplerKey& Other) const
+{
+    return Hash == Other.Hash && memcmp(&Desc, &Other.Desc, sizeof(Desc)) == 0;
+}
+
+
+B32 D3D12SamplerCache::Acquire(const SamplerKey& Key, GPUHandle* OutHandle)
+{
+    auto Iter = Samplers.find(Key);
+    if (Iter == Samplers.end())
+    {
+        SamplerStatistics.NumMisses += 1;
+        return false;
+    }
+    SamplerStatistics.NumHits += 1;
+    Iter->second.RefCount += 1;
+    *OutHandle = Iter->second.Handle;
+    return true;
+}
+
+
+void D3D12SamplerCache::Insert(const SamplerKey& Key, GPUHandle Handle)
+{
+    Samplers[Key] = { Handle, 1 };
+    SamplerKeys[Handle] = Key;
+    SamplerStatistics.NumLiveSamplers = Samplers.size();
+}
+
+
+ResultCode D3D12SamplerCache::Release(GPUHandle Handle, B32* OutLastReference)
+{
+    auto KeyIter = SamplerKeys.find(Handle);
+    if (KeyIter == SamplerKeys.end())
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+
+    auto Iter = Samplers.find(KeyIter->second);
+    *OutLastReference = (--Iter->second.RefCount == 0);
+    if (*OutLastReference)
+    {
+        Samplers.erase(Iter);
+        SamplerKeys.erase(KeyIter);
+        SamplerStatistics.NumLiveSamplers = Samplers.size();
+    }
+    return SResult_OK;
+}
+
+
+void D3D12SamplerCache::CleanUp()
+{
+    Samplers.clear();
+    SamplerKeys.clear();
+    SamplerStatistics.NumLiveSamplers = 0;
+}
+
+
+const SamplerCacheStatistics& D3D12SamplerCache::GetStatistics()
+{
+    return SamplerStatistics;
+}
+} // Synthe
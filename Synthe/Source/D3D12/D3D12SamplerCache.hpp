@@ -0,0 +1,65 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Graphics/PipelineState.hpp"
+
+#include "Win32Common.hpp"
+
+
+namespace Synthe {
+
+
+//! Key of a sampler, its native description as given by GetSamplerDescription().
+struct SamplerKey
+{
+    SamplerKey()
+        : Desc()
+        , Hash(0) { }
+
+    //! Build the key of a native sampler description.
+    void Build(const D3D12_SAMPLER_DESC& SamplerDesc);
+
+    bool operator==(const SamplerKey& Other) const;
+
+    D3D12_SAMPLER_DESC Desc;
+    U64 Hash;
+};
+
+
+struct SamplerKeyHasher
+{
+    size_t operator()(const SamplerKey& Key) const { return static_cast<size_t>(Key.Hash); }
+};
+
+
+//! Cache of sampler descriptors keyed by their description. Identical samplers share one ref counted 
+//! descriptor, so the sampler heaps only ever hold the distinct samplers in use. The cache only tracks 
+//! handles, descriptors are written and freed by the device.
+class D3D12SamplerCache
+{
+public:
+    //! Get the descriptor of a sampler, adding a reference.
+    //!
+    //! \param Key The sampler key.
+    //! \param OutHandle The sampler descriptor.
+    //! \return True if cached.
+    static B32 Acquire(const SamplerKey& Key, GPUHandle* OutHandle);
+
+    //! Add a newly written sampler descriptor, with one reference.
+    static void Insert(const SamplerKey& Key, GPUHandle Handle);
+
+    //! Give back a reference.
+    //!
+    //! \param Handle The sampler descriptor.
+    //! \param OutLastReference True if that was the last reference, and the descriptor should be freed.
+    //! \return SResult_OK on success. SResult_OBJECT_NOT_FOUND if not made by this cache.
+    static ResultCode Release(GPUHandle Handle, B32* OutLastReference);
+
+    //! Forget all samplers. Their descriptors go away with the descriptor pools.
+    static void CleanUp();
+
+    static const SamplerCacheStatistics& GetStatistics();
+};
+} // Synthe
@@ -0,0 +1,245 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "D3D12ViewCache.hpp"
+#include "D3D12MemoryManager.hpp"
+#include "Common/Hash.hpp"
+
+#include <string.h>
+#include <unordered_map>
+
+namespace Synthe {
+
+
+static_assert(sizeof(D3D12_SHADER_RESOURCE_VIEW_DESC) <= ViewKey::k_MaxDescSizeInBytes, "View key too small.");
+static_assert(sizeof(D3D12_UNORDERED_ACCESS_VIEW_DESC) <= ViewKey::k_MaxDescSizeInBytes, "View key too small.");
+static_assert(sizeof(D3D12_RENDER_TARGET_VIEW_DESC) <= ViewKey::k_MaxDescSizeInBytes, "View key too small.");
+static_assert(sizeof(D3D12_DEPTH_STENCIL_VIEW_DESC) <= ViewKey::k_MaxDescSizeInBytes, "View key too small.");
+
+
+struct ViewCacheEntry
+{
+    GPUHandle Handle;
+    U32 RefCount;
+};
+
+
+static std::unordered_map<ViewKey, ViewCacheEntry, ViewKeyHasher> Views;
+static std::unordered_map<GPUHandle, ViewKey> ViewKeys;
+static std::unordered_map<GPUHandle, std::vector<GPUHandle>> ViewsOfResource;
+static ViewCacheStatistics ViewStatistics = { };
+
+
+void ViewKey::Build(GPUHandle ResourceHandle, DescriptorHeapType HeapType, const void* PDesc, U32 DescSizeInBytes)
+{
+    Resource = ResourceHandle;
+    Type = HeapType;
+    SizeInBytes = DescSizeInBytes;
+    memset(Desc, 0, sizeof(Desc));
+    memcpy(Desc, PDesc, DescSizeInBytes);
+    Hash = HashBytes(&Resource, sizeof(Resource));
+    Hash = HashBytes(&Type, sizeof(Type), Hash);
+    Hash = HashBytes(Desc, SizeInBytes, Hash);
+}
+
+
+bool ViewKey::operator==(const ViewKey& Other) const
+{
+    return Hash == Other.Hash 
+        && Resource == Other.Resource 
+        && Type == Other.Type 
+        && SizeInBytes == Other.SizeInBytes 
+        && memcmp(Desc, Other.Desc, SizeInBytes) == 0;
+}
+
+
+B32 D3D12ViewCache::Acquire(const ViewKey& Key, GPUHandle* OutHandle)
+{
+    ViewStatistics.NumRequests += 1;
+    auto Iter = Views.find(Key);
+    if (Iter == Views.end())
+    {
+        return false;
+    }
+    ViewStatistics.NumHits += 1;
+    Iter->second.RefCount += 1;
+    *OutHandle = Iter->second.Handle;
+    return true;
+}
+
+
+void D3D12ViewCache::Insert(const ViewKey& Key, GPUHandle Handle)
+{
+    Views[Key] = { Handle, 1 };
+    ViewKeys[Handle] = Key;
+    ViewsOfResource[Key.Resource].push_back(Handle);
+    ViewStatistics.NumLiveViews = Views.size();
+}
+
+
+static void EraseView(std::unordered_map<GPUHandle, ViewKey>::iterator KeyIter)
+{
+    std::vector<GPUHandle>& ResourceViews = ViewsOfResource[KeyIter->second.Resource];
+    for (size_t I = 0; I < ResourceViews.size(); ++I)
+    {
+        if (ResourceViews[I] == KeyIter->first)
+        {
+            ResourceViews[I] = ResourceViews.back();
+            ResourceViews.pop_back();
+            break;
+        }
+    }
+    if (ResourceViews.empty())
+    {
+        ViewsOfResource.erase(KeyIter->second.Resource);
+    }
+    Views.erase(KeyIter->second);
+    ViewKeys.erase(KeyIter);
+}
+
+
+ResultCode D3D12ViewCache::Release(GPUHandle Handle, B32* OutLastReference)
+{
+    auto KeyIter = ViewKeys.find(Handle);
+    if (KeyIter == ViewKeys.end())
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+
+    auto Iter = Views.find(KeyIter->second);
+    *OutLastReference = (--Iter->second.RefCount == 0);
+    if (*OutLastReference)
+    {
+        EraseView(KeyIter);
+        ViewStatistics.NumLiveViews = Views.size();
+    }
+    return SResult_OK;
+}
+
+
+ResultCode D3D12ViewCache::GetViewSubresource(GPUHandle Handle, GPUHandle* OutResource, U32* OutSubresource)
+{
+    auto KeyIter = ViewKeys.find(Handle);
+    if (KeyIter == ViewKeys.end())
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+    const ViewKey& Key = KeyIter->second;
+    *OutResource = Key.Resource;
+    *OutSubresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+    // Only views of a single mip of a single slice write one subresource.
+    U32 Mip = 0, ArraySlice = 0, ArraySize = 1, Plane = 0;
+    B32 WritesAllPlanes = false;
+    if (Key.Type == DescriptorHeapType_RTV)
+    {
+        D3D12_RENDER_TARGET_VIEW_DESC Desc;
+        memcpy(&Desc, Key.Desc, sizeof(Desc));
+        switch (Desc.ViewDimension)
+        {
+            case D3D12_RTV_DIMENSION_TEXTURE1D: Mip = Desc.Texture1D.MipSlice; break;
+            case D3D12_RTV_DIMENSION_TEXTURE2D: Mip = Desc.Texture2D.MipSlice; Plane = Desc.Texture2D.PlaneSlice; break;
+            case D3D12_RTV_DIMENSION_TEXTURE2DMS: break;
+            case D3D12_RTV_DIMENSION_TEXTURE1DARRAY: 
+                Mip = Desc.Texture1DArray.MipSlice; 
+                ArraySlice = Desc.Texture1DArray.FirstArraySlice;
+                ArraySize = Desc.Texture1DArray.ArraySize;
+                break;
+            case D3D12_RTV_DIMENSION_TEXTURE2DARRAY:
+                Mip = Desc.Texture2DArray.MipSlice;
+                ArraySlice = Desc.Texture2DArray.FirstArraySlice;
+                ArraySize = Desc.Texture2DArray.ArraySize;
+                Plane = Desc.Texture2DArray.PlaneSlice;
+                break;
+            default:
+                return SResult_OK;
+        }
+    }
+    else if (Key.Type == DescriptorHeapType_DSV)
+    {
+        D3D12_DEPTH_STENCIL_VIEW_DESC Desc;
+        memcpy(&Desc, Key.Desc, sizeof(Desc));
+        switch (Desc.ViewDimension)
+        {
+            case D3D12_DSV_DIMENSION_TEXTURE1D: Mip = Desc.Texture1D.MipSlice; break;
+            case D3D12_DSV_DIMENSION_TEXTURE2D: Mip = Desc.Texture2D.MipSlice; break;
+            case D3D12_DSV_DIMENSION_TEXTURE2DMS: break;
+            case D3D12_DSV_DIMENSION_TEXTURE1DARRAY:
+                Mip = Desc.Texture1DArray.MipSlice;
+                ArraySlice = Desc.Texture1DArray.FirstArraySlice;
+                ArraySize = Desc.Texture1DArray.ArraySize;
+                break;
+            case D3D12_DSV_DIMENSION_TEXTURE2DARRAY:
+                Mip = Desc.Texture2DArray.MipSlice;
+                ArraySlice = Desc.Texture2DArray.FirstArraySlice;
+                ArraySize = Desc.Texture2DArray.ArraySize;
+                break;
+            default:
+                return SResult_OK;
+        }
+        // Depth views write both planes of depth stencil resources.
+        WritesAllPlanes = true;
+    }
+    else
+    {
+        return SResult_OK;
+    }
+
+    ResourceState Resource = { };
+    if (ArraySize != 1 || D3D12MemoryManager::GetNativeResource(Key.Resource, &Resource) != SResult_OK)
+    {
+        return SResult_OK;
+    }
+    D3D12_RESOURCE_DESC ResourceDesc = Resource.PResource->GetDesc();
+    // Checked on the resource, the view may use DXGI_FORMAT_UNKNOWN, and the resource a typeless format.
+    if (WritesAllPlanes && D3D12MemoryManager::GetFormatPlaneCount(ResourceDesc.Format) > 1)
+    {
+        return SResult_OK;
+    }
+    U32 NumArraySlices = (ResourceDesc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D) ? 1 : ResourceDesc.DepthOrArraySize;
+    if (ResourceDesc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D)
+    {
+        ArraySlice = 0;
+    }
+    *OutSubresource = Mip + (ArraySlice + Plane * NumArraySlices) * ResourceDesc.MipLevels;
+    return SResult_OK;
+}
+
+
+void D3D12ViewCache::Invalidate(GPUHandle Resource, std::vector<std::pair<DescriptorHeapType, GPUHandle>>& OutViews)
+{
+    auto Iter = ViewsOfResource.find(Resource);
+    if (Iter == ViewsOfResource.end())
+    {
+        return;
+    }
+    std::vector<GPUHandle> ResourceViews;
+    ResourceViews.swap(Iter->second);
+    ViewsOfResource.erase(Iter);
+    for (GPUHandle Handle : ResourceViews)
+    {
+        auto KeyIter = ViewKeys.find(Handle);
+        OutViews.push_back({ KeyIter->second.Type, Handle });
+        Views.erase(KeyIter->second);
+        ViewKeys.erase(KeyIter);
+    }
+    ViewStatistics.NumInvalidated += ResourceViews.size();
+    ViewStatistics.NumLiveViews = Views.size();
+}
+
+
+void D3D12ViewCache::CleanUp()
+{
+    Views.clear();
+    ViewKeys.clear();
+    ViewsOfResource.clear();
+    ViewStatistics.NumLiveViews = 0;
+}
+
+
+const ViewCacheStatistics& D3D12ViewCache::GetStatistics()
+{
+    return ViewStatistics;
+}
+} // Synthe
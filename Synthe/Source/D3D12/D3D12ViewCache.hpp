@@ -0,0 +1,99 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Graphics/GraphicsStructs.hpp"
+
+#include "Win32Common.hpp"
+#include "D3D12GraphicsDevice.hpp"
+
+#include <utility>
+#include <vector>
+
+
+namespace Synthe {
+
+
+//! Key of a view, the resource it views and the native view description.
+struct ViewKey
+{
+    static const U32 k_MaxDescSizeInBytes = 48;
+
+    ViewKey()
+        : Resource(SYNTHE_GPU_NO_HANDLE)
+        , Type(DescriptorHeapType_CBV_SRV_UAV_UPLOAD)
+        , SizeInBytes(0)
+        , Desc()
+        , Hash(0) { }
+
+    //! Build the key of a view. The description must have been zeroed before it was filled, so 
+    //! unused union members compare equal.
+    //!
+    //! \param ResourceHandle The viewed resource.
+    //! \param HeapType The heap the view is written to.
+    //! \param PDesc The native view description.
+    //! \param DescSizeInBytes The size of the description, at most k_MaxDescSizeInBytes.
+    void Build(GPUHandle ResourceHandle, DescriptorHeapType HeapType, const void* PDesc, U32 DescSizeInBytes);
+
+    bool operator==(const ViewKey& Other) const;
+
+    GPUHandle Resource;
+    DescriptorHeapType Type;
+    U32 SizeInBytes;
+    U8 Desc[k_MaxDescSizeInBytes];
+    U64 Hash;
+};
+
+
+struct ViewKeyHasher
+{
+    size_t operator()(const ViewKey& Key) const { return static_cast<size_t>(Key.Hash); }
+};
+
+
+//! Cache of view descriptors keyed by their resource and description. Asking again for a view that is
+//! alive returns its descriptor, with another reference, instead of writing a new one. Views are 
+//! dropped with their last reference, or all at once when their resource is destroyed. The cache only
+//! tracks handles, descriptors are written and freed by the device.
+class D3D12ViewCache
+{
+public:
+    //! Get the descriptor of a view, adding a reference.
+    //!
+    //! \param Key The view key.
+    //! \param OutHandle The view descriptor.
+    //! \return True if cached.
+    static B32 Acquire(const ViewKey& Key, GPUHandle* OutHandle);
+
+    //! Add a newly written view descriptor, with one reference.
+    static void Insert(const ViewKey& Key, GPUHandle Handle);
+
+    //! Give back a reference.
+    //!
+    //! \param Handle The view descriptor.
+    //! \param OutLastReference True if that was the last reference, and the descriptor should be freed.
+    //! \return SResult_OK on success. SResult_OBJECT_NOT_FOUND if not made by this cache.
+    static ResultCode Release(GPUHandle Handle, B32* OutLastReference);
+
+    //! Drop every view of a resource, whatever their references.
+    //!
+    //! \param Resource The resource being destroyed.
+    //! \param OutViews The dropped views, as (heap type, descriptor), to be freed by the caller.
+    static void Invalidate(GPUHandle Resource, std::vector<std::pair<DescriptorHeapType, GPUHandle>>& OutViews);
+
+    //! Get the resource and subresource a render target or depth stencil view writes to.
+    //!
+    //! \param Handle The view descriptor.
+    //! \param OutResource The viewed resource.
+    //! \param OutSubresource The subresource index, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES if the view
+    //!                       covers several, or is not a render target or depth stencil view.
+    //! \return SResult_OK on success. SResult_OBJECT_NOT_FOUND if not made by this cache.
+    static ResultCode GetViewSubresource(GPUHandle Handle, GPUHandle* OutResource, U32* OutSubresource);
+
+    //! Forget all views. Their descriptors go away with the descriptor pools.
+    static void CleanUp();
+
+    static const ViewCacheStatistics& GetStatistics();
+};
+} // Synthe
@@ -0,0 +1,534 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "Graphics/CommandStream.hpp"
+#include "Common/Memory/Allocator.hpp"
+
+#include <string.h>
+
+namespace Synthe {
+
+
+void* CommandStream::Push(CommandType Type, U64 PayloadSizeInBytes)
+{
+    U64 SizeInBytes = sizeof(CommandHeader) + AlignCommandSize(PayloadSizeInBytes);
+    if (SizeInBytes > 0xFFFFFFFFULL)
+    {
+        return nullptr;
+    }
+
+    // Move on to the next chunk that fits, adding one sized for the command if none does.
+    while (m_CurrentChunk < m_Chunks.size()
+           && m_Chunks[m_CurrentChunk].SizeInBytes - m_Chunks[m_CurrentChunk].UsedBytes < SizeInBytes)
+    {
+        m_CurrentChunk += 1;
+    }
+    if (m_CurrentChunk == m_Chunks.size())
+    {
+        Chunk NewChunk;
+        NewChunk.SizeInBytes = static_cast<U32>(SizeInBytes > k_ChunkSizeInBytes ? SizeInBytes : k_ChunkSizeInBytes);
+        NewChunk.UsedBytes = 0;
+        NewChunk.PData = MallocArray<U8>(NewChunk.SizeInBytes);
+        if (!NewChunk.PData)
+        {
+            return nullptr;
+        }
+        m_Chunks.push_back(NewChunk);
+    }
+
+    Chunk& Current = m_Chunks[m_CurrentChunk];
+    CommandHeader* PHeader = reinterpret_cast<CommandHeader*>(Current.PData + Current.UsedBytes);
+    PHeader->Type = static_cast<U16>(Type);
+    PHeader->Reserved = 0;
+    PHeader->SizeInBytes = static_cast<U32>(SizeInBytes);
+    Current.UsedBytes += static_cast<U32>(SizeInBytes);
+    m_NumCommands += 1;
+    m_SizeInBytes += SizeInBytes;
+    return PHeader + 1;
+}
+
+
+void CommandStream::Reset()
+{
+    for (Chunk& C : m_Chunks)
+    {
+        C.UsedBytes = 0;
+    }
+    m_CurrentChunk = 0;
+    m_NumCommands = 0;
+    m_SizeInBytes = 0;
+}
+
+
+void CommandStream::Release()
+{
+    for (Chunk& C : m_Chunks)
+    {
+        FreeArray<U8>(C.PData);
+    }
+    m_Chunks.clear();
+    m_CurrentChunk = 0;
+    m_NumCommands = 0;
+    m_SizeInBytes = 0;
+}
+
+
+U64 CommandStream::GetCapacityInBytes() const
+{
+    U64 Capacity = 0;
+    for (const Chunk& C : m_Chunks)
+    {
+        Capacity += C.SizeInBytes;
+    }
+    return Capacity;
+}
+
+
+//! Copy an array after a freshly pushed payload.
+template<typename Element, typename Payload>
+static void WriteCommandArray(Payload* PPayload, const Element* PSource, U32 Count)
+{
+    if (Count)
+    {
+        memcpy(const_cast<Element*>(GetCommandArray<Element>(PPayload)), PSource, sizeof(Element) * Count);
+    }
+}
+
+
+void CommandStreamList::DrawIndexedInstanced(U32 IndexCountPerInst,
+                                             U32 InstanceCount,
+                                             U32 StartIndexLocation,
+                                             I32 BaseVertexLocation,
+                                             U32 StartInstanceLocation)
+{
+    CommandDrawIndexedInstanced* PCommand = m_Stream.Push<CommandDrawIndexedInstanced>(CommandType_DRAW_INDEXED_INSTANCED);
+    if (PCommand)
+    {
+        PCommand->IndexCountPerInstance = IndexCountPerInst;
+        PCommand->InstanceCount = InstanceCount;
+        PCommand->StartIndexLocation = StartIndexLocation;
+        PCommand->BaseVertexLocation = BaseVertexLocation;
+        PCommand->StartInstanceLocation = StartInstanceLocation;
+    }
+}
+
+
+void CommandStreamList::DrawInstanced(U32 VertexCountPerInstance,
+                                      U32 InstanceCount,
+                                      U32 StartVertexLocation,
+                                      U32 StartInstanceLocation)
+{
+    CommandDrawInstanced* PCommand = m_Stream.Push<CommandDrawInstanced>(CommandType_DRAW_INSTANCED);
+    if (PCommand)
+    {
+        PCommand->VertexCountPerInstance = VertexCountPerInstance;
+        PCommand->InstanceCount = InstanceCount;
+        PCommand->StartVertexLocation = StartVertexLocation;
+        PCommand->StartInstanceLocation = StartInstanceLocation;
+    }
+}
+
+
+void CommandStreamList::Dispatch(U32 GlobalX, U32 GlobalY, U32 GlobalZ)
+{
+    CommandDispatch* PCommand = m_Stream.Push<CommandDispatch>(CommandType_DISPATCH);
+    if (PCommand)
+    {
+        PCommand->GlobalX = GlobalX;
+        PCommand->GlobalY = GlobalY;
+        PCommand->GlobalZ = GlobalZ;
+    }
+}
+
+
+void CommandStreamList::SetPipelineState(PipelineStateType PipelineType,
+                                         PipelineState* PPipelineState,
+                                         RootSignature* PRootSignature)
+{
+    CommandSetPipelineState* PCommand = m_Stream.Push<CommandSetPipelineState>(CommandType_SET_PIPELINE_STATE);
+    if (PCommand)
+    {
+        PCommand->PipelineType = PipelineType;
+        PCommand->PPipelineState = PPipelineState;
+        PCommand->PRootSignature = PRootSignature;
+    }
+}
+
+
+void CommandStreamList::SetPipelineNotReadyPolicy(PipelineNotReadyPolicy Policy)
+{
+    CommandSetPipelineNotReadyPolicy* PCommand = m_Stream.Push<CommandSetPipelineNotReadyPolicy>(CommandType_SET_PIPELINE_NOT_READY_POLICY);
+    if (PCommand)
+    {
+        PCommand->Policy = Policy;
+    }
+}
+
+
+void CommandStreamList::SetViewports(U32 NumViewports, const Viewport* PViewports)
+{
+    CommandSetViewports* PCommand = m_Stream.Push<CommandSetViewports>(CommandType_SET_VIEWPORTS,
+                                                                       sizeof(Viewport) * NumViewports);
+    if (PCommand)
+    {
+        PCommand->NumViewports = NumViewports;
+        WriteCommandArray(PCommand, PViewports, NumViewports);
+    }
+}
+
+
+void CommandStreamList::SetScissors(U32 NumScissors, const Scissor* PScissors)
+{
+    CommandSetScissors* PCommand = m_Stream.Push<CommandSetScissors>(CommandType_SET_SCISSORS,
+                                                                     sizeof(Scissor) * NumScissors);
+    if (PCommand)
+    {
+        PCommand->NumScissors = NumScissors;
+        WriteCommandArray(PCommand, PScissors, NumScissors);
+    }
+}
+
+
+void CommandStreamList::SetRenderTargets(U32 NumRTVs, GPUHandle* RTVHandles, GPUHandle* DepthStencil)
+{
+    CommandSetRenderTargets* PCommand = m_Stream.Push<CommandSetRenderTargets>(CommandType_SET_RENDER_TARGETS,
+                                                                               sizeof(GPUHandle) * NumRTVs);
+    if (PCommand)
+    {
+        PCommand->NumRTVs = NumRTVs;
+        PCommand->HasDepthStencil = DepthStencil != nullptr;
+        PCommand->DepthStencil = DepthStencil ? *DepthStencil : 0;
+        WriteCommandArray(PCommand, RTVHandles, NumRTVs);
+    }
+}
+
+
+void CommandStreamList::ClearRenderTarget(GPUHandle RTV,
+                                          ClearColorValue* ClearColor,
+                                          U32 NumBounds,
+                                          TargetBounds* Bounds)
+{
+    CommandClearRenderTarget* PCommand = m_Stream.Push<CommandClearRenderTarget>(CommandType_CLEAR_RENDER_TARGET,
+                                                                                 sizeof(TargetBounds) * NumBounds);
+    if (PCommand)
+    {
+        PCommand->RTV = RTV;
+        PCommand->HasClearColor = ClearColor != nullptr;
+        PCommand->ClearColor = ClearColor ? *ClearColor : ClearColorValue();
+        PCommand->NumBounds = NumBounds;
+        WriteCommandArray(PCommand, Bounds, NumBounds);
+    }
+}
+
+
+void CommandStreamList::BindDescriptorSets(U32 NumSets, DescriptorSet* const* PDescriptorSets)
+{
+    CommandBindDescriptorSets* PCommand = m_Stream.Push<CommandBindDescriptorSets>(CommandType_BIND_DESCRIPTOR_SETS,
+                                                                                   sizeof(DescriptorSet*) * NumSets);
+    if (PCommand)
+    {
+        PCommand->NumSets = NumSets;
+        WriteCommandArray(PCommand, PDescriptorSets, NumSets);
+    }
+}
+
+
+void CommandStreamList::SetBindlessIndices(U32 NumIndices, const U32* PIndices, U32 FirstIndex)
+{
+    CommandSetBindlessIndices* PCommand = m_Stream.Push<CommandSetBindlessIndices>(CommandType_SET_BINDLESS_INDICES,
+                                                                                   sizeof(U32) * NumIndices);
+    if (PCommand)
+    {
+        PCommand->NumIndices = NumIndices;
+        PCommand->FirstIndex = FirstIndex;
+        WriteCommandArray(PCommand, PIndices, NumIndices);
+    }
+}
+
+
+void CommandStreamList::SetRootConstants(U32 ParameterIndex,
+                                         U32 Num32BitValues,
+                                         const void* PData,
+                                         U32 DestOffsetIn32BitValues)
+{
+    CommandSetRootConstants* PCommand = m_Stream.Push<CommandSetRootConstants>(CommandType_SET_ROOT_CONSTANTS,
+                                                                               sizeof(U32) * Num32BitValues);
+    if (PCommand)
+    {
+        PCommand->ParameterIndex = ParameterIndex;
+        PCommand->Num32BitValues = Num32BitValues;
+        PCommand->DestOffsetIn32BitValues = DestOffsetIn32BitValues;
+        WriteCommandArray(PCommand, static_cast<const U32*>(PData), Num32BitValues);
+    }
+}
+
+
+void CommandStreamList::PushRootDescriptor(CommandType Type, U32 ParameterIndex, GPUHandle BufferHandle, U64 OffsetInBytes)
+{
+    CommandSetRootDescriptor* PCommand = m_Stream.Push<CommandSetRootDescriptor>(Type);
+    if (PCommand)
+    {
+        PCommand->ParameterIndex = ParameterIndex;
+        PCommand->BufferHandle = BufferHandle;
+        PCommand->OffsetInBytes = OffsetInBytes;
+    }
+}
+
+
+void CommandStreamList::SetRootConstantBuffer(U32 ParameterIndex, GPUHandle BufferHandle, U64 OffsetInBytes)
+{
+    PushRootDescriptor(CommandType_SET_ROOT_CONSTANT_BUFFER, ParameterIndex, BufferHandle, OffsetInBytes);
+}
+
+
+void CommandStreamList::SetRootShaderResource(U32 ParameterIndex, GPUHandle BufferHandle, U64 OffsetInBytes)
+{
+    PushRootDescriptor(CommandType_SET_ROOT_SHADER_RESOURCE, ParameterIndex, BufferHandle, OffsetInBytes);
+}
+
+
+void CommandStreamList::SetRootUnorderedAccess(U32 ParameterIndex, GPUHandle BufferHandle, U64 OffsetInBytes)
+{
+    PushRootDescriptor(CommandType_SET_ROOT_UNORDERED_ACCESS, ParameterIndex, BufferHandle, OffsetInBytes);
+}
+
+
+void CommandStreamList::BindVertexBuffers(U32 NumBuffers, Resource* const* PBuffers, U32* Offsets)
+{
+    U64 ExtraBytes = sizeof(Resource*) * NumBuffers + (Offsets ? sizeof(U32) * NumBuffers : 0);
+    CommandBindVertexBuffers* PCommand = m_Stream.Push<CommandBindVertexBuffers>(CommandType_BIND_VERTEX_BUFFERS, ExtraBytes);
+    if (PCommand)
+    {
+        PCommand->NumBuffers = NumBuffers;
+        PCommand->HasOffsets = Offsets != nullptr;
+        WriteCommandArray(PCommand, PBuffers, NumBuffers);
+        if (Offsets && NumBuffers)
+        {
+            U32* POffsets = reinterpret_cast<U32*>(const_cast<Resource**>(GetCommandArray<Resource*>(PCommand)) + NumBuffers);
+            memcpy(POffsets, Offsets, sizeof(U32) * NumBuffers);
+        }
+    }
+}
+
+
+void CommandStreamList::BindIndexBuffer(const Resource* PBuffer, U32 Offset)
+{
+    CommandBindIndexBuffer* PCommand = m_Stream.Push<CommandBindIndexBuffer>(CommandType_BIND_INDEX_BUFFER);
+    if (PCommand)
+    {
+        PCommand->PBuffer = PBuffer;
+        PCommand->Offset = Offset;
+    }
+}
+
+
+void CommandStreamList::CopyResource(Resource* PDest, Resource* PSrc)
+{
+    CommandCopyResource* PCommand = m_Stream.Push<CommandCopyResource>(CommandType_COPY_RESOURCE);
+    if (PCommand)
+    {
+        PCommand->PDest = PDest;
+        PCommand->PSrc = PSrc;
+    }
+}
+
+
+void CommandStreamList::DispatchRays()
+{
+    m_Stream.Push(CommandType_DISPATCH_RAYS, 0);
+}
+
+
+void CommandStreamList::TransitionResources(U32 NumTransitions, const ResourceTransition* PTransitions)
+{
+    CommandTransitionResources* PCommand = m_Stream.Push<CommandTransitionResources>(
+        CommandType_TRANSITION_RESOURCES, sizeof(ResourceTransition) * NumTransitions);
+    if (PCommand)
+    {
+        PCommand->NumTransitions = NumTransitions;
+        WriteCommandArray(PCommand, PTransitions, NumTransitions);
+    }
+}
+
+
+void CommandStreamList::BeginRenderPass(U32 NumRenderTargets,
+                                        const RenderPassAttachment* PRenderTargets,
+                                        const RenderPassAttachment* PDepthStencil)
+{
+    U32 NumAttachments = NumRenderTargets + (PDepthStencil ? 1 : 0);
+    CommandBeginRenderPass* PCommand = m_Stream.Push<CommandBeginRenderPass>(
+        CommandType_BEGIN_RENDER_PASS, sizeof(RenderPassAttachment) * NumAttachments);
+    if (PCommand)
+    {
+        PCommand->NumRenderTargets = NumRenderTargets;
+        PCommand->HasDepthStencil = PDepthStencil != nullptr;
+        WriteCommandArray(PCommand, PRenderTargets, NumRenderTargets);
+        if (PDepthStencil)
+        {
+            const RenderPassAttachment* PArray = GetCommandArray<RenderPassAttachment>(PCommand);
+            memcpy(const_cast<RenderPassAttachment*>(PArray + NumRenderTargets), PDepthStencil, sizeof(RenderPassAttachment));
+        }
+    }
+}
+
+
+void CommandStreamList::EndRenderPass()
+{
+    m_Stream.Push(CommandType_END_RENDER_PASS, 0);
+}
+
+
+void ReplayCommandStream(const CommandStream& Stream, GraphicsCommandList* PTarget)
+{
+    Stream.ForEach([PTarget] (const CommandHeader* PHeader) -> void
+    {
+        switch (PHeader->Type)
+        {
+            case CommandType_DRAW_INDEXED_INSTANCED:
+            {
+                const CommandDrawIndexedInstanced* P = GetCommandPayload<CommandDrawIndexedInstanced>(PHeader);
+                PTarget->DrawIndexedInstanced(P->IndexCountPerInstance, P->InstanceCount, P->StartIndexLocation,
+                                              P->BaseVertexLocation, P->StartInstanceLocation);
+                break;
+            }
+            case CommandType_DRAW_INSTANCED:
+            {
+                const CommandDrawInstanced* P = GetCommandPayload<CommandDrawInstanced>(PHeader);
+                PTarget->DrawInstanced(P->VertexCountPerInstance, P->InstanceCount, P->StartVertexLocation,
+                                       P->StartInstanceLocation);
+                break;
+            }
+            case CommandType_DISPATCH:
+            {
+                const CommandDispatch* P = GetCommandPayload<CommandDispatch>(PHeader);
+                PTarget->Dispatch(P->GlobalX, P->GlobalY, P->GlobalZ);
+                break;
+            }
+            case CommandType_SET_PIPELINE_STATE:
+            {
+                const CommandSetPipelineState* P = GetCommandPayload<CommandSetPipelineState>(PHeader);
+                PTarget->SetPipelineState(P->PipelineType, P->PPipelineState, P->PRootSignature);
+                break;
+            }
+            case CommandType_SET_PIPELINE_NOT_READY_POLICY:
+            {
+                PTarget->SetPipelineNotReadyPolicy(GetCommandPayload<CommandSetPipelineNotReadyPolicy>(PHeader)->Policy);
+                break;
+            }
+            case CommandType_SET_VIEWPORTS:
+            {
+                const CommandSetViewports* P = GetCommandPayload<CommandSetViewports>(PHeader);
+                PTarget->SetViewports(P->NumViewports, GetCommandArray<Viewport>(P));
+                break;
+            }
+            case CommandType_SET_SCISSORS:
+            {
+                const CommandSetScissors* P = GetCommandPayload<CommandSetScissors>(PHeader);
+                PTarget->SetScissors(P->NumScissors, GetCommandArray<Scissor>(P));
+                break;
+            }
+            case CommandType_SET_RENDER_TARGETS:
+            {
+                const CommandSetRenderTargets* P = GetCommandPayload<CommandSetRenderTargets>(PHeader);
+                GPUHandle DepthStencil = P->DepthStencil;
+                PTarget->SetRenderTargets(P->NumRTVs, const_cast<GPUHandle*>(GetCommandArray<GPUHandle>(P)),
+                                          P->HasDepthStencil ? &DepthStencil : nullptr);
+                break;
+            }
+            case CommandType_CLEAR_RENDER_TARGET:
+            {
+                const CommandClearRenderTarget* P = GetCommandPayload<CommandClearRenderTarget>(PHeader);
+                ClearColorValue ClearColor = P->ClearColor;
+                PTarget->ClearRenderTarget(P->RTV, P->HasClearColor ? &ClearColor : nullptr, P->NumBounds,
+                                           const_cast<TargetBounds*>(GetCommandArray<TargetBounds>(P)));
+                break;
+            }
+            case CommandType_BIND_DESCRIPTOR_SETS:
+            {
+                const CommandBindDescriptorSets* P = GetCommandPayload<CommandBindDescriptorSets>(PHeader);
+                PTarget->BindDescriptorSets(P->NumSets, GetCommandArray<DescriptorSet*>(P));
+                break;
+            }
+            case CommandType_SET_BINDLESS_INDICES:
+            {
+                const CommandSetBindlessIndices* P = GetCommandPayload<CommandSetBindlessIndices>(PHeader);
+                PTarget->SetBindlessIndices(P->NumIndices, GetCommandArray<U32>(P), P->FirstIndex);
+                break;
+            }
+            case CommandType_SET_ROOT_CONSTANTS:
+            {
+                const CommandSetRootConstants* P = GetCommandPayload<CommandSetRootConstants>(PHeader);
+                PTarget->SetRootConstants(P->ParameterIndex, P->Num32BitValues, GetCommandArray<U32>(P),
+                                          P->DestOffsetIn32BitValues);
+                break;
+            }
+            case CommandType_SET_ROOT_CONSTANT_BUFFER:
+            {
+                const CommandSetRootDescriptor* P = GetCommandPayload<CommandSetRootDescriptor>(PHeader);
+                PTarget->SetRootConstantBuffer(P->ParameterIndex, P->BufferHandle, P->OffsetInBytes);
+                break;
+            }
+            case CommandType_SET_ROOT_SHADER_RESOURCE:
+            {
+                const CommandSetRootDescriptor* P = GetCommandPayload<CommandSetRootDescriptor>(PHeader);
+                PTarget->SetRootShaderResource(P->ParameterIndex, P->BufferHandle, P->OffsetInBytes);
+                break;
+            }
+            case CommandType_SET_ROOT_UNORDERED_ACCESS:
+            {
+                const CommandSetRootDescriptor* P = GetCommandPayload<CommandSetRootDescriptor>(PHeader);
+                PTarget->SetRootUnorderedAccess(P->ParameterIndex, P->BufferHandle, P->OffsetInBytes);
+                break;
+            }
+            case CommandType_BIND_VERTEX_BUFFERS:
+            {
+                const CommandBindVertexBuffers* P = GetCommandPayload<CommandBindVertexBuffers>(PHeader);
+                Resource* const* PBuffers = GetCommandArray<Resource*>(P);
+                U32* POffsets = P->HasOffsets ? const_cast<U32*>(reinterpret_cast<const U32*>(PBuffers + P->NumBuffers))
+                                              : nullptr;
+                PTarget->BindVertexBuffers(P->NumBuffers, PBuffers, POffsets);
+                break;
+            }
+            case CommandType_BIND_INDEX_BUFFER:
+            {
+                const CommandBindIndexBuffer* P = GetCommandPayload<CommandBindIndexBuffer>(PHeader);
+                PTarget->BindIndexBuffer(P->PBuffer, P->Offset);
+                break;
+            }
+            case CommandType_COPY_RESOURCE:
+            {
+                const CommandCopyResource* P = GetCommandPayload<CommandCopyResource>(PHeader);
+                PTarget->CopyResource(P->PDest, P->PSrc);
+                break;
+            }
+            case CommandType_DISPATCH_RAYS:
+            {
+                PTarget->DispatchRays();
+                break;
+            }
+            case CommandType_TRANSITION_RESOURCES:
+            {
+                const CommandTransitionResources* P = GetCommandPayload<CommandTransitionResources>(PHeader);
+                PTarget->TransitionResources(P->NumTransitions, GetCommandArray<ResourceTransition>(P));
+                break;
+            }
+            case CommandType_BEGIN_RENDER_PASS:
+            {
+                const CommandBeginRenderPass* P = GetCommandPayload<CommandBeginRenderPass>(PHeader);
+                const RenderPassAttachment* PAttachments = GetCommandArray<RenderPassAttachment>(P);
+                PTarget->BeginRenderPass(P->NumRenderTargets, PAttachments, 
+                                         P->HasDepthStencil ? PAttachments + P->NumRenderTargets : nullptr);
+                break;
+            }
+            case CommandType_END_RENDER_PASS:
+            {
+                PTarget->EndRenderPass();
+                break;
+            }
+            default:
+                break;
+        }
+    });
+}
+} // Synthe
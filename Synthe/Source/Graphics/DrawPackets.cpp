@@ -0,0 +1,260 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "Graphics/DrawPackets.hpp"
+#include "Graphics/ParallelRecording.hpp"
+#include "Common/WorkerPool.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <string.h>
+#include <vector>
+
+namespace Synthe {
+
+
+static const U32 k_RadixBits = 8;
+static const U32 k_RadixSize = 1 << k_RadixBits;
+static const U32 k_NumRadixPasses = 64 / k_RadixBits;
+
+//! Fewer items than this per worker cost more in hand off than they save.
+static const U32 k_MinItemsPerPart = 16 * 1024;
+
+
+//! Run Func(Part) for each part, part 0 on the calling thread, and wait for all of them.
+template<typename Function>
+static void RunParts(WorkerPool* PPool, U32 NumParts, const Function& Func)
+{
+    if (NumParts < 2)
+    {
+        Func(0);
+        return;
+    }
+
+    std::mutex Mutex;
+    std::condition_variable Done;
+    U32 NumRemaining = NumParts - 1;
+    for (U32 Part = 1; Part < NumParts; ++Part)
+    {
+        PPool->Submit([&, Part] () -> void
+            {
+                Func(Part);
+                std::lock_guard<std::mutex> Lock(Mutex);
+                if (--NumRemaining == 0)
+                {
+                    Done.notify_one();
+                }
+            });
+    }
+
+    Func(0);
+
+    std::unique_lock<std::mutex> Lock(Mutex);
+    Done.wait(Lock, [&] () -> bool { return NumRemaining == 0; });
+}
+
+
+static U32 GetDigit(U64 Key, U32 Pass)
+{
+    return static_cast<U32>(Key >> (Pass * k_RadixBits)) & (k_RadixSize - 1);
+}
+
+
+void DrawPacketSorter::Sort(WorkerPool* PPool, U32 NumPackets, const DrawPacket* PPackets, U32* OutOrder)
+{
+    if (NumPackets == 0)
+    {
+        return;
+    }
+
+    U32 NumParts = 1;
+    if (PPool)
+    {
+        U32 MaxParts = PPool->GetNumThreads() + 1;
+        NumParts = NumPackets / k_MinItemsPerPart;
+        NumParts = NumParts < 1 ? 1 : (NumParts > MaxParts ? MaxParts : NumParts);
+    }
+
+    if (m_Items.size() < NumPackets)
+    {
+        m_Items.resize(NumPackets);
+        m_Scratch.resize(NumPackets);
+    }
+    // The first sweep counts every pass at once, to find the passes where all keys share a digit, 
+    // such as the pass bits of a single pass frame.
+    m_Counts.assign(NumParts * k_NumRadixPasses * k_RadixSize, 0);
+    m_Offsets.resize(NumParts * k_RadixSize);
+    DrawSortItem* PItems = m_Items.data();
+    U32* PAllCounts = m_Counts.data();
+    U32* PAllOffsets = m_Offsets.data();
+    RunParts(PPool, NumParts, [&] (U32 Part) -> void
+        {
+            U32 First, Count;
+            GetParallelRange(NumPackets, NumParts, Part, &First, &Count);
+            U32* PCounts = PAllCounts + Part * k_NumRadixPasses * k_RadixSize;
+            for (U32 I = First; I < First + Count; ++I)
+            {
+                U64 Key = PPackets[I].SortKey;
+                PItems[I].Key = Key;
+                PItems[I].Index = I;
+                PItems[I].Padding = 0;
+                for (U32 Pass = 0; Pass < k_NumRadixPasses; ++Pass)
+                {
+                    PCounts[Pass * k_RadixSize + GetDigit(Key, Pass)] += 1;
+                }
+            }
+        });
+
+    B32 CountsMatchOrder = true;
+    DrawSortItem* PSource = m_Items.data();
+    DrawSortItem* PDest = m_Scratch.data();
+    for (U32 Pass = 0; Pass < k_NumRadixPasses; ++Pass)
+    {
+        U32 Totals[k_RadixSize] = { };
+        for (U32 Part = 0; Part < NumParts; ++Part)
+        {
+            const U32* PCounts = PAllCounts + (Part * k_NumRadixPasses + Pass) * k_RadixSize;
+            for (U32 Digit = 0; Digit < k_RadixSize; ++Digit)
+            {
+                Totals[Digit] += PCounts[Digit];
+            }
+        }
+        if (Totals[GetDigit(PSource[0].Key, Pass)] == NumPackets)
+        {
+            continue;
+        }
+
+        // Parts own ranges of the array, once items moved their counts must be taken again.
+        if (!CountsMatchOrder)
+        {
+            RunParts(PPool, NumParts, [&] (U32 Part) -> void
+                {
+                    U32 First, Count;
+                    GetParallelRange(NumPackets, NumParts, Part, &First, &Count);
+                    U32* PCounts = PAllCounts + (Part * k_NumRadixPasses + Pass) * k_RadixSize;
+                    memset(PCounts, 0, sizeof(U32) * k_RadixSize);
+                    for (U32 I = First; I < First + Count; ++I)
+                    {
+                        PCounts[GetDigit(PSource[I].Key, Pass)] += 1;
+                    }
+                });
+        }
+
+        // Each part scatters its items of a digit after the same digit of the parts before it, which
+        // keeps the sort stable.
+        U32 Offset = 0;
+        for (U32 Digit = 0; Digit < k_RadixSize; ++Digit)
+        {
+            for (U32 Part = 0; Part < NumParts; ++Part)
+            {
+                PAllOffsets[Part * k_RadixSize + Digit] = Offset;
+                Offset += PAllCounts[(Part * k_NumRadixPasses + Pass) * k_RadixSize + Digit];
+            }
+        }
+        RunParts(PPool, NumParts, [&] (U32 Part) -> void
+            {
+                U32 First, Count;
+                GetParallelRange(NumPackets, NumParts, Part, &First, &Count);
+                // Local copies, so the compiler need not reload them after every store.
+                U32 PartOffsets[k_RadixSize];
+                memcpy(PartOffsets, PAllOffsets + Part * k_RadixSize, sizeof(PartOffsets));
+                const DrawSortItem* PIn = PSource;
+                DrawSortItem* POut = PDest;
+                for (U32 I = First; I < First + Count; ++I)
+                {
+                    POut[PartOffsets[GetDigit(PIn[I].Key, Pass)]++] = PIn[I];
+                }
+            });
+
+        DrawSortItem* PSwap = PSource;
+        PSource = PDest;
+        PDest = PSwap;
+        CountsMatchOrder = false;
+    }
+
+    for (U32 I = 0; I < NumPackets; ++I)
+    {
+        OutOrder[I] = PSource[I].Index;
+    }
+}
+
+
+void DrawPacketSorter::Release()
+{
+    m_Items = std::vector<DrawSortItem>();
+    m_Scratch = std::vector<DrawSortItem>();
+    m_Counts = std::vector<U32>();
+    m_Offsets = std::vector<U32>();
+}
+
+
+void RecordDrawPackets(GraphicsCommandList* PList,
+                       U32 NumPackets,
+                       const DrawPacket* PPackets,
+                       const U32* POrder,
+                       DrawPacketStatistics* OutStatistics)
+{
+    DrawPacketStatistics Statistics = { };
+    const DrawPacket* PPrevious = nullptr;
+    for (U32 I = 0; I < NumPackets; ++I)
+    {
+        const DrawPacket& Packet = PPackets[POrder ? POrder[I] : I];
+
+        // A new root signature drops the root bindings, so the bindings of the packet are set again.
+        B32 RootSignatureChanged = !PPrevious || Packet.PRootSignature != PPrevious->PRootSignature;
+        B32 PipelineChanged = !PPrevious || Packet.PPipelineState != PPrevious->PPipelineState;
+        if (RootSignatureChanged || PipelineChanged)
+        {
+            PList->SetPipelineState(PipelineStateType_GRAPHICS, Packet.PPipelineState, Packet.PRootSignature);
+            Statistics.NumRootSignatureChanges += RootSignatureChanged ? 1 : 0;
+            Statistics.NumPipelineChanges += PipelineChanged ? 1 : 0;
+        }
+
+        if (Packet.PDescriptorSet
+            && (RootSignatureChanged || Packet.PDescriptorSet != PPrevious->PDescriptorSet))
+        {
+            PList->BindDescriptorSets(1, &Packet.PDescriptorSet);
+            Statistics.NumDescriptorSetChanges += 1;
+        }
+
+        if (Packet.NumBindlessIndices
+            && (RootSignatureChanged
+                || Packet.NumBindlessIndices != PPrevious->NumBindlessIndices
+                || memcmp(Packet.BindlessIndices, PPrevious->BindlessIndices, sizeof(U32) * Packet.NumBindlessIndices) != 0))
+        {
+            PList->SetBindlessIndices(Packet.NumBindlessIndices, Packet.BindlessIndices, 0);
+            Statistics.NumBindlessChanges += 1;
+        }
+
+        if (Packet.PVertexBuffer && (!PPrevious || Packet.PVertexBuffer != PPrevious->PVertexBuffer))
+        {
+            PList->BindVertexBuffers(1, &Packet.PVertexBuffer, nullptr);
+            Statistics.NumVertexBufferChanges += 1;
+        }
+
+        if (Packet.PIndexBuffer)
+        {
+            if (!PPrevious || Packet.PIndexBuffer != PPrevious->PIndexBuffer)
+            {
+                PList->BindIndexBuffer(Packet.PIndexBuffer, 0);
+                Statistics.NumIndexBufferChanges += 1;
+            }
+            PList->DrawIndexedInstanced(Packet.ElementCount, Packet.InstanceCount, Packet.StartElement,
+                                        Packet.BaseVertex, Packet.StartInstance);
+        }
+        else
+        {
+            PList->DrawInstanced(Packet.ElementCount, Packet.InstanceCount, Packet.StartElement,
+                                 Packet.StartInstance);
+        }
+        Statistics.NumDraws += 1;
+        PPrevious = &Packet;
+    }
+
+    if (OutStatistics)
+    {
+        *OutStatistics = Statistics;
+    }
+}
+} // Synthe
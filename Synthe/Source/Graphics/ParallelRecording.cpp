@@ -0,0 +1,58 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "Graphics/ParallelRecording.hpp"
+#include "Common/WorkerPool.hpp"
+
+#include <condition_variable>
+#include <mutex>
+
+namespace Synthe {
+
+
+static void RecordCommandList(U32 ListIndex, GraphicsCommandList* PList, const RecordCommandListFunction& Record)
+{
+    PList->Begin();
+    Record(ListIndex, PList);
+    PList->End();
+}
+
+
+void RecordCommandListsParallel(WorkerPool* PPool,
+                                U32 NumLists,
+                                GraphicsCommandList* const* PLists,
+                                const RecordCommandListFunction& Record)
+{
+    if (!PPool || NumLists < 2)
+    {
+        for (U32 I = 0; I < NumLists; ++I)
+        {
+            RecordCommandList(I, PLists[I], Record);
+        }
+        return;
+    }
+
+    // Waits on these jobs alone, the pool may be busy with other work.
+    std::mutex Mutex;
+    std::condition_variable Done;
+    U32 NumRemaining = NumLists - 1;
+    for (U32 I = 1; I < NumLists; ++I)
+    {
+        PPool->Submit([&, I] () -> void
+            {
+                RecordCommandList(I, PLists[I], Record);
+                std::lock_guard<std::mutex> Lock(Mutex);
+                if (--NumRemaining == 0)
+                {
+                    Done.notify_one();
+                }
+            });
+    }
+
+    RecordCommandList(0, PLists[0], Record);
+
+    std::unique_lock<std::mutex> Lock(Mutex);
+    Done.wait(Lock, [&] () -> bool { return NumRemaining == 0; });
+}
+} // Synthe
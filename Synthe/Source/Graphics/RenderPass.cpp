@@ -0,0 +1,390 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "Graphics/RenderPass.hpp"
+#include "Graphics/GraphicsCommandList.hpp"
+
+#include <algorithm>
+
+namespace Synthe {
+
+
+const FrameGraphResource FrameGraph::k_InvalidResource;
+const U32 FrameGraph::k_Culled;
+const U32 FrameGraph::k_NoPass;
+
+
+FrameGraphResource FrameGraphPassBuilder::Read(FrameGraphResource Resource, ResourceAccess Access)
+{
+    FrameGraph& Graph = *m_PGraph;
+    if (Resource >= Graph.m_Versions.size()
+        || Graph.m_Resources[Graph.m_Versions[Resource].Resource].LatestVersion != Resource)
+    {
+        Graph.m_Invalid = true;
+        return FrameGraph::k_InvalidResource;
+    }
+    Graph.m_Uses.push_back({ Resource, Access, false });
+    Graph.m_Passes[m_Pass].NumUses += 1;
+    return Resource;
+}
+
+
+FrameGraphResource FrameGraphPassBuilder::Write(FrameGraphResource Resource, ResourceAccess Access)
+{
+    FrameGraph& Graph = *m_PGraph;
+    if (Resource >= Graph.m_Versions.size()
+        || Graph.m_Resources[Graph.m_Versions[Resource].Resource].LatestVersion != Resource)
+    {
+        Graph.m_Invalid = true;
+        return FrameGraph::k_InvalidResource;
+    }
+    Graph.m_Uses.push_back({ Resource, Access, true });
+    Graph.m_Passes[m_Pass].NumUses += 1;
+
+    U32 ResourceIndex = Graph.m_Versions[Resource].Resource;
+    FrameGraphResource NewVersion = static_cast<FrameGraphResource>(Graph.m_Versions.size());
+    Graph.m_Versions.push_back({ ResourceIndex, m_Pass });
+    Graph.m_Resources[ResourceIndex].LatestVersion = NewVersion;
+    return NewVersion;
+}
+
+
+void FrameGraphPassBuilder::SetSideEffects()
+{
+    m_PGraph->m_Passes[m_Pass].SideEffects = true;
+}
+
+
+void FrameGraph::Reset()
+{
+    m_Resources.clear();
+    m_Versions.clear();
+    m_Passes.clear();
+    m_Uses.clear();
+    m_Exports.clear();
+    m_Invalid = false;
+}
+
+
+FrameGraphResource FrameGraph::ImportResource(const char* Name, GPUHandle Handle, ResourceAccess CurrentAccess)
+{
+    FrameGraphResource Version = static_cast<FrameGraphResource>(m_Versions.size());
+    m_Versions.push_back({ static_cast<U32>(m_Resources.size()), k_NoPass });
+    m_Resources.push_back({ Name, Handle, CurrentAccess, Version });
+    return Version;
+}
+
+
+void FrameGraph::ExportResource(FrameGraphResource Resource, ResourceAccess FinalAccess)
+{
+    if (Resource >= m_Versions.size())
+    {
+        m_Invalid = true;
+        return;
+    }
+    m_Exports.push_back({ Resource, FinalAccess });
+}
+
+
+U32 FrameGraph::AddPass(const char* Name, const FrameGraphSetupFunction& Setup, FrameGraphExecuteFunction Execute)
+{
+    U32 Pass = static_cast<U32>(m_Passes.size());
+    m_Passes.push_back({ Name, std::move(Execute), static_cast<U32>(m_Uses.size()), 0, false });
+    if (Setup)
+    {
+        FrameGraphPassBuilder Builder(this, Pass);
+        Setup(Builder);
+    }
+    return Pass;
+}
+
+
+void FrameGraph::BuildTopologyKey(std::vector<U32>& OutKey) const
+{
+    OutKey.clear();
+    OutKey.push_back(m_Invalid);
+    OutKey.push_back(static_cast<U32>(m_Resources.size()));
+    for (const ResourceNode& Resource : m_Resources)
+    {
+        OutKey.push_back(Resource.InitialAccess);
+    }
+    OutKey.push_back(static_cast<U32>(m_Passes.size()));
+    for (const PassNode& Pass : m_Passes)
+    {
+        OutKey.push_back(Pass.SideEffects);
+        OutKey.push_back(Pass.NumUses);
+        for (U32 I = Pass.FirstUse; I < Pass.FirstUse + Pass.NumUses; ++I)
+        {
+            OutKey.push_back(m_Uses[I].Version);
+            OutKey.push_back(m_Uses[I].Access | (m_Uses[I].Write ? 0x80000000 : 0));
+        }
+    }
+    OutKey.push_back(static_cast<U32>(m_Exports.size()));
+    for (const ExportNode& Export : m_Exports)
+    {
+        OutKey.push_back(Export.Version);
+        OutKey.push_back(Export.FinalAccess);
+    }
+}
+
+
+ResultCode FrameGraph::Compile()
+{
+    // Versions are numbered in declaration order, so the uses and exports above pin down the versions
+    // and their producers as well.
+    BuildTopologyKey(m_KeyScratch);
+    if (m_HasCompiled && m_KeyScratch == m_CompiledKey)
+    {
+        m_Statistics.NumCompileCacheHits += 1;
+        return m_CompileResult;
+    }
+    m_CompiledKey.swap(m_KeyScratch);
+    m_HasCompiled = true;
+    m_Statistics.NumCompiles += 1;
+
+    const U32 NumPasses = static_cast<U32>(m_Passes.size());
+    m_Levels.assign(NumPasses, k_Culled);
+    m_Order.clear();
+    m_LevelTransitions.clear();
+    m_LevelPasses.clear();
+    m_Transitions.clear();
+    m_FirstFinalTransition = 0;
+    m_Statistics.NumPasses = NumPasses;
+    m_Statistics.NumCulledPasses = 0;
+    m_Statistics.NumLevels = 0;
+    m_Statistics.NumTransitions = 0;
+    m_Statistics.NumTransitionBatches = 0;
+
+    m_CompileResult = SResult_INVALID_ARGS;
+    if (m_Invalid)
+    {
+        return m_CompileResult;
+    }
+
+    // A pass runs its commands against one state per resource.
+    for (const PassNode& Pass : m_Passes)
+    {
+        for (U32 I = Pass.FirstUse; I < Pass.FirstUse + Pass.NumUses; ++I)
+        {
+            for (U32 J = I + 1; J < Pass.FirstUse + Pass.NumUses; ++J)
+            {
+                if (m_Versions[m_Uses[I].Version].Resource == m_Versions[m_Uses[J].Version].Resource
+                    && m_Uses[I].Access != m_Uses[J].Access)
+                {
+                    return m_CompileResult;
+                }
+            }
+        }
+    }
+
+    // Culling. Passes with side effects, and producers of exported versions, are kept, then so are
+    // the producers of everything a kept pass uses. A write needs the producer of the version it
+    // writes over as well, the pass may only touch part of the resource.
+    std::vector<B32> Alive(NumPasses, false);
+    std::vector<U32> Stack;
+    auto Keep = [&] (U32 Pass) -> void
+        {
+            if (Pass != k_NoPass && !Alive[Pass])
+            {
+                Alive[Pass] = true;
+                Stack.push_back(Pass);
+            }
+        };
+    for (U32 Pass = 0; Pass < NumPasses; ++Pass)
+    {
+        if (m_Passes[Pass].SideEffects)
+        {
+            Keep(Pass);
+        }
+    }
+    for (const ExportNode& Export : m_Exports)
+    {
+        Keep(m_Versions[Export.Version].Producer);
+    }
+    while (!Stack.empty())
+    {
+        const PassNode& Pass = m_Passes[Stack.back()];
+        Stack.pop_back();
+        for (U32 I = Pass.FirstUse; I < Pass.FirstUse + Pass.NumUses; ++I)
+        {
+            Keep(m_Versions[m_Uses[I].Version].Producer);
+        }
+    }
+
+    // Levels. Uses are always of the latest version, so declaration order is already a valid order,
+    // and every pass a pass depends on has its level by the time the pass is reached. A pass goes one
+    // level past the producers of what it uses, and past the readers of a version it writes over.
+    // Passes sharing a level must also agree on the access of every resource they share, since the
+    // level gets one transition batch.
+    std::vector<std::vector<U32>> VersionReaders(m_Versions.size());
+    std::vector<std::vector<CompiledTransition>> LevelAccesses;
+    U32 NumLevels = 0;
+    for (U32 Pass = 0; Pass < NumPasses; ++Pass)
+    {
+        if (!Alive[Pass])
+        {
+            m_Statistics.NumCulledPasses += 1;
+            continue;
+        }
+        const PassNode& Node = m_Passes[Pass];
+        U32 Level = 0;
+        for (U32 I = Node.FirstUse; I < Node.FirstUse + Node.NumUses; ++I)
+        {
+            const PassUse& Use = m_Uses[I];
+            U32 Producer = m_Versions[Use.Version].Producer;
+            if (Producer != k_NoPass && Producer != Pass)
+            {
+                Level = std::max(Level, m_Levels[Producer] + 1);
+            }
+            if (Use.Write)
+            {
+                for (U32 Reader : VersionReaders[Use.Version])
+                {
+                    if (Reader != Pass)
+                    {
+                        Level = std::max(Level, m_Levels[Reader] + 1);
+                    }
+                }
+            }
+        }
+
+        for (B32 Conflict = true; Conflict; )
+        {
+            Conflict = false;
+            if (Level >= LevelAccesses.size())
+            {
+                break;
+            }
+            for (U32 I = Node.FirstUse; I < Node.FirstUse + Node.NumUses && !Conflict; ++I)
+            {
+                U32 Resource = m_Versions[m_Uses[I].Version].Resource;
+                for (const CompiledTransition& Claim : LevelAccesses[Level])
+                {
+                    if (Claim.Resource == Resource && Claim.Access != m_Uses[I].Access)
+                    {
+                        Conflict = true;
+                        Level += 1;
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (Level >= LevelAccesses.size())
+        {
+            LevelAccesses.resize(Level + 1);
+        }
+        for (U32 I = Node.FirstUse; I < Node.FirstUse + Node.NumUses; ++I)
+        {
+            const PassUse& Use = m_Uses[I];
+            LevelAccesses[Level].push_back({ m_Versions[Use.Version].Resource, Use.Access });
+            if (!Use.Write)
+            {
+                VersionReaders[Use.Version].push_back(Pass);
+            }
+        }
+        m_Levels[Pass] = Level;
+        m_Order.push_back(Pass);
+        NumLevels = std::max(NumLevels, Level + 1);
+    }
+
+    // Level by level, declaration order within a level.
+    std::stable_sort(m_Order.begin(), m_Order.end(),
+                     [&] (U32 A, U32 B) -> bool { return m_Levels[A] < m_Levels[B]; });
+
+    // Transitions ahead of each level, from the access each resource was left in.
+    std::vector<ResourceAccess> Current(m_Resources.size());
+    for (U32 I = 0; I < m_Resources.size(); ++I)
+    {
+        Current[I] = m_Resources[I].InitialAccess;
+    }
+    U32 OrderIndex = 0;
+    for (U32 Level = 0; Level < NumLevels; ++Level)
+    {
+        m_LevelTransitions.push_back(static_cast<U32>(m_Transitions.size()));
+        m_LevelPasses.push_back(OrderIndex);
+        for (; OrderIndex < m_Order.size() && m_Levels[m_Order[OrderIndex]] == Level; ++OrderIndex)
+        {
+            const PassNode& Node = m_Passes[m_Order[OrderIndex]];
+            for (U32 I = Node.FirstUse; I < Node.FirstUse + Node.NumUses; ++I)
+            {
+                U32 Resource = m_Versions[m_Uses[I].Version].Resource;
+                if (Current[Resource] != m_Uses[I].Access)
+                {
+                    Current[Resource] = m_Uses[I].Access;
+                    m_Transitions.push_back({ Resource, m_Uses[I].Access });
+                }
+            }
+        }
+        if (m_Transitions.size() > m_LevelTransitions.back())
+        {
+            m_Statistics.NumTransitionBatches += 1;
+        }
+    }
+    m_LevelTransitions.push_back(static_cast<U32>(m_Transitions.size()));
+    m_LevelPasses.push_back(OrderIndex);
+
+    m_FirstFinalTransition = static_cast<U32>(m_Transitions.size());
+    for (const ExportNode& Export : m_Exports)
+    {
+        U32 Resource = m_Versions[Export.Version].Resource;
+        if (Current[Resource] != Export.FinalAccess)
+        {
+            Current[Resource] = Export.FinalAccess;
+            m_Transitions.push_back({ Resource, Export.FinalAccess });
+        }
+    }
+    if (m_Transitions.size() > m_FirstFinalTransition)
+    {
+        m_Statistics.NumTransitionBatches += 1;
+    }
+
+    m_Statistics.NumLevels = NumLevels;
+    m_Statistics.NumTransitions = m_Transitions.size();
+    m_CompileResult = SResult_OK;
+    return m_CompileResult;
+}
+
+
+void FrameGraph::Execute(GraphicsCommandList* PList)
+{
+    if (!m_HasCompiled || m_CompileResult != SResult_OK)
+    {
+        return;
+    }
+
+    // Compiled transitions point at resource indices, the handles are this frame's.
+    auto Transition = [&] (U32 First, U32 Last) -> void
+        {
+            if (First == Last)
+            {
+                return;
+            }
+            m_TransitionScratch.clear();
+            for (U32 I = First; I < Last; ++I)
+            {
+                const CompiledTransition& Compiled = m_Transitions[I];
+                m_TransitionScratch.push_back({ m_Resources[Compiled.Resource].Handle,
+                                                SYNTHE_ALL_SUBRESOURCES,
+                                                Compiled.Access });
+            }
+            PList->TransitionResources(static_cast<U32>(m_TransitionScratch.size()), m_TransitionScratch.data());
+        };
+
+    const U32 NumLevels = static_cast<U32>(m_LevelPasses.size()) - 1;
+    for (U32 Level = 0; Level < NumLevels; ++Level)
+    {
+        Transition(m_LevelTransitions[Level], m_LevelTransitions[Level + 1]);
+        for (U32 I = m_LevelPasses[Level]; I < m_LevelPasses[Level + 1]; ++I)
+        {
+            const PassNode& Pass = m_Passes[m_Order[I]];
+            if (Pass.Execute)
+            {
+                Pass.Execute(PList);
+            }
+        }
+    }
+    Transition(m_FirstFinalTransition, static_cast<U32>(m_Transitions.size()));
+}
+} // Synthe
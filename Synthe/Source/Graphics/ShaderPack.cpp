@@ -0,0 +1,236 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "Graphics/ShaderPack.hpp"
+#include "Common/BlobCache.hpp"
+#include "Common/Hash.hpp"
+
+#include <algorithm>
+#include <string.h>
+
+namespace Synthe {
+
+
+static U64 AlignUp(U64 Value, U64 Alignment)
+{
+    return (Value + Alignment - 1) & ~(Alignment - 1);
+}
+
+
+U64 HashShaderName(const char* Name)
+{
+    U64 Hash = FNV1A_64_OFFSET_BASIS;
+    for (const char* PChar = Name; *PChar; ++PChar)
+    {
+        char Char = (*PChar == '\\') ? '/' : *PChar;
+        Hash = HashBytes(&Char, 1, Hash);
+    }
+    return Hash;
+}
+
+
+ResultCode ShaderPack::Open(const std::string& Path)
+{
+    Close();
+    ResultCode Result = m_File.Open(Path);
+    if (Result != SResult_OK)
+    {
+        return Result == SResult_FAILED ? SResult_MEMORY_CORRUPTION : Result;
+    }
+
+    const U8* PBase = m_File.GetData();
+    U64 FileSize = m_File.GetSizeInBytes();
+    ShaderPackHeader Header = { };
+    if (FileSize < sizeof(Header))
+    {
+        Close();
+        return SResult_MEMORY_CORRUPTION;
+    }
+    memcpy(&Header, PBase, sizeof(Header));
+
+    U64 TablesEnd = sizeof(Header)
+                  + Header.NumEntries * sizeof(ShaderPackEntry)
+                  + Header.NumBlobs * sizeof(ShaderPackBlob);
+    if (Header.Magic != SHADER_PACK_MAGIC
+        || Header.Version != SHADER_PACK_VERSION
+        || TablesEnd > Header.DataOffset
+        || Header.DataOffset > FileSize
+        || Header.DataSizeInBytes > FileSize - Header.DataOffset)
+    {
+        Close();
+        return SResult_MEMORY_CORRUPTION;
+    }
+
+    m_PEntries = reinterpret_cast<const ShaderPackEntry*>(PBase + sizeof(Header));
+    m_PBlobs = reinterpret_cast<const ShaderPackBlob*>(m_PEntries + Header.NumEntries);
+    m_PData = PBase + Header.DataOffset;
+    m_NumEntries = Header.NumEntries;
+    m_NumBlobs = Header.NumBlobs;
+
+    // Only the tables are touched here, bytecode pages load when first used.
+    for (U32 I = 0; I < m_NumBlobs; ++I)
+    {
+        if (m_PBlobs[I].Offset > Header.DataSizeInBytes
+            || m_PBlobs[I].SizeInBytes > Header.DataSizeInBytes - m_PBlobs[I].Offset)
+        {
+            Close();
+            return SResult_MEMORY_CORRUPTION;
+        }
+    }
+    for (U32 I = 0; I < m_NumEntries; ++I)
+    {
+        if (m_PEntries[I].BlobIndex >= m_NumBlobs)
+        {
+            Close();
+            return SResult_MEMORY_CORRUPTION;
+        }
+    }
+    return SResult_OK;
+}
+
+
+void ShaderPack::Close()
+{
+    m_File.Close();
+    m_PEntries = nullptr;
+    m_PBlobs = nullptr;
+    m_PData = nullptr;
+    m_NumEntries = 0;
+    m_NumBlobs = 0;
+}
+
+
+void ShaderPack::GetModule(const ShaderPackBlob& Blob, ShaderModule* OutModule) const
+{
+    // The mapping is read only, and the device only reads bytecode.
+    OutModule->ByteCode = const_cast<U8*>(m_PData + Blob.Offset);
+    OutModule->SizeInBytes = Blob.SizeInBytes;
+}
+
+
+ResultCode ShaderPack::Find(U64 NameHash, U64 PermutationKey, ShaderModule* OutModule) const
+{
+    const ShaderPackEntry* PEnd = m_PEntries + m_NumEntries;
+    const ShaderPackEntry* PFound = std::lower_bound(m_PEntries, PEnd, std::make_pair(NameHash, PermutationKey),
+        [] (const ShaderPackEntry& Entry, const std::pair<U64, U64>& Key) -> bool
+        {
+            return std::make_pair(Entry.NameHash, Entry.PermutationKey) < Key;
+        });
+    if (PFound == PEnd || PFound->NameHash != NameHash || PFound->PermutationKey != PermutationKey)
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+    GetModule(m_PBlobs[PFound->BlobIndex], OutModule);
+    return SResult_OK;
+}
+
+
+ResultCode ShaderPack::FindByContentHash(U64 ContentHash, ShaderModule* OutModule) const
+{
+    const ShaderPackBlob* PEnd = m_PBlobs + m_NumBlobs;
+    const ShaderPackBlob* PFound = std::lower_bound(m_PBlobs, PEnd, ContentHash,
+        [] (const ShaderPackBlob& Blob, U64 Hash) -> bool
+        {
+            return Blob.ContentHash < Hash;
+        });
+    if (PFound == PEnd || PFound->ContentHash != ContentHash)
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+    GetModule(*PFound, OutModule);
+    return SResult_OK;
+}
+
+
+ResultCode ShaderPackBuilder::Add(U64 NameHash, U64 PermutationKey, const void* PByteCode, U64 SizeInBytes)
+{
+    std::pair<U64, U64> Key(NameHash, PermutationKey);
+    if (m_Entries.find(Key) != m_Entries.end())
+    {
+        return SResult_ALREADY_EXISTS;
+    }
+
+    const U8* PBytes = static_cast<const U8*>(PByteCode);
+    U64 ContentHash = HashBytes(PBytes, SizeInBytes);
+    auto Range = m_BlobsByHash.equal_range(ContentHash);
+    for (auto Iter = Range.first; Iter != Range.second; ++Iter)
+    {
+        const std::vector<U8>& Existing = m_Blobs[Iter->second].ByteCode;
+        if (Existing.size() == SizeInBytes && (!SizeInBytes || memcmp(Existing.data(), PBytes, SizeInBytes) == 0))
+        {
+            m_Entries[Key] = Iter->second;
+            m_NumDuplicateBytes += SizeInBytes;
+            return SResult_OK;
+        }
+    }
+
+    U32 BlobIndex = static_cast<U32>(m_Blobs.size());
+    m_Blobs.push_back({ ContentHash, std::vector<U8>(PBytes, PBytes + SizeInBytes) });
+    m_BlobsByHash.insert({ ContentHash, BlobIndex });
+    m_Entries[Key] = BlobIndex;
+    return SResult_OK;
+}
+
+
+ResultCode ShaderPackBuilder::Write(const std::string& Path) const
+{
+    // Blobs are written in content hash order, so they can be searched by hash.
+    std::vector<U32> Order(m_Blobs.size());
+    for (U32 I = 0; I < Order.size(); ++I)
+    {
+        Order[I] = I;
+    }
+    std::sort(Order.begin(), Order.end(), [this] (U32 A, U32 B) -> bool
+        {
+            return m_Blobs[A].ContentHash < m_Blobs[B].ContentHash;
+        });
+    std::vector<U32> Remap(m_Blobs.size());
+    std::vector<ShaderPackBlob> Blobs(m_Blobs.size());
+    U64 DataSizeInBytes = 0;
+    for (U32 I = 0; I < Order.size(); ++I)
+    {
+        const Blob& Source = m_Blobs[Order[I]];
+        Remap[Order[I]] = I;
+        Blobs[I].ContentHash = Source.ContentHash;
+        Blobs[I].Offset = DataSizeInBytes;
+        Blobs[I].SizeInBytes = Source.ByteCode.size();
+        DataSizeInBytes = AlignUp(DataSizeInBytes + Source.ByteCode.size(), SHADER_PACK_ALIGNMENT);
+    }
+
+    ShaderPackHeader Header = { };
+    Header.Magic = SHADER_PACK_MAGIC;
+    Header.Version = SHADER_PACK_VERSION;
+    Header.NumEntries = static_cast<U32>(m_Entries.size());
+    Header.NumBlobs = static_cast<U32>(m_Blobs.size());
+    Header.DataOffset = AlignUp(sizeof(Header)
+                                + Header.NumEntries * sizeof(ShaderPackEntry)
+                                + Header.NumBlobs * sizeof(ShaderPackBlob), SHADER_PACK_ALIGNMENT);
+    Header.DataSizeInBytes = DataSizeInBytes;
+
+    std::vector<U8> Bytes(static_cast<size_t>(Header.DataOffset + DataSizeInBytes), 0);
+    U8* PWrite = Bytes.data();
+    memcpy(PWrite, &Header, sizeof(Header));
+    PWrite += sizeof(Header);
+    // The map iterates in (name hash, permutation key) order, as the reader expects.
+    for (auto& Iter : m_Entries)
+    {
+        ShaderPackEntry Entry = { Iter.first.first, Iter.first.second, Remap[Iter.second], 0 };
+        memcpy(PWrite, &Entry, sizeof(Entry));
+        PWrite += sizeof(Entry);
+    }
+    if (!Blobs.empty())
+    {
+        memcpy(PWrite, Blobs.data(), Blobs.size() * sizeof(ShaderPackBlob));
+    }
+    for (U32 I = 0; I < Order.size(); ++I)
+    {
+        const std::vector<U8>& ByteCode = m_Blobs[Order[I]].ByteCode;
+        if (!ByteCode.empty())
+        {
+            memcpy(Bytes.data() + Header.DataOffset + Blobs[I].Offset, ByteCode.data(), ByteCode.size());
+        }
+    }
+    return WriteFileBytes(Path, Bytes.data(), Bytes.size());
+}
+} // Synthe
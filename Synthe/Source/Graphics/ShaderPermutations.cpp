@@ -0,0 +1,366 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "Graphics/ShaderPermutations.hpp"
+#include "Graphics/ShaderPack.hpp"
+#include "Common/BlobCache.hpp"
+#include "Common/Hash.hpp"
+#include "Common/Json.hpp"
+
+#include <unordered_set>
+
+namespace Synthe {
+
+
+static std::string GetDirectory(const std::string& Path)
+{
+    size_t Slash = Path.find_last_of("/\\");
+    return Slash == std::string::npos ? std::string() : Path.substr(0, Slash + 1);
+}
+
+
+static B32 IsIdentifierChar(char Char)
+{
+    return (Char >= 'a' && Char <= 'z') || (Char >= 'A' && Char <= 'Z') || (Char >= '0' && Char <= '9') || Char == '_';
+}
+
+
+//! Paste includes into the source, each file once.
+static ResultCode ExpandIncludes(const std::string& Path,
+                                 const std::string& IncludeDirectory,
+                                 std::unordered_set<std::string>& Included,
+                                 std::string& Out)
+{
+    std::vector<U8> Bytes;
+    if (ReadFileBytes(Path, Bytes) != SResult_OK)
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+    Included.insert(Path);
+
+    std::string Source(Bytes.begin(), Bytes.end());
+    size_t LineStart = 0;
+    while (LineStart < Source.size())
+    {
+        size_t LineEnd = Source.find('\n', LineStart);
+        LineEnd = (LineEnd == std::string::npos) ? Source.size() : LineEnd + 1;
+        size_t First = Source.find_first_not_of(" \t", LineStart);
+        if (First < LineEnd && Source.compare(First, 8, "#include") == 0)
+        {
+            size_t NameStart = Source.find_first_of("\"<", First + 8);
+            size_t NameEnd = (NameStart < LineEnd) ? Source.find_first_of("\">", NameStart + 1) : std::string::npos;
+            if (NameEnd < LineEnd)
+            {
+                std::string Name = Source.substr(NameStart + 1, NameEnd - NameStart - 1);
+                std::string Candidates[2] = { GetDirectory(Path) + Name, IncludeDirectory + "/" + Name };
+                ResultCode Result = SResult_OBJECT_NOT_FOUND;
+                for (const std::string& Candidate : Candidates)
+                {
+                    if (Included.count(Candidate))
+                    {
+                        Result = SResult_OK;
+                        break;
+                    }
+                    Result = ExpandIncludes(Candidate, IncludeDirectory, Included, Out);
+                    if (Result != SResult_OBJECT_NOT_FOUND)
+                    {
+                        break;
+                    }
+                }
+                if (Result != SResult_OK)
+                {
+                    return Result;
+                }
+                LineStart = LineEnd;
+                continue;
+            }
+        }
+        Out.append(Source, LineStart, LineEnd - LineStart);
+        LineStart = LineEnd;
+    }
+    if (!Out.empty() && Out.back() != '\n')
+    {
+        Out.push_back('\n');
+    }
+    return SResult_OK;
+}
+
+
+ResultCode ShaderCompiler::Preprocess(const ShaderCompileInfo& Info, std::string& OutSource)
+{
+    std::string Expanded;
+    std::unordered_set<std::string> Included;
+    ResultCode Result = ExpandIncludes(Info.SourcePath, Info.IncludeDirectory, Included, Expanded);
+    if (Result != SResult_OK)
+    {
+        return Result;
+    }
+
+    std::unordered_set<std::string> Identifiers;
+    for (size_t I = 0; I < Expanded.size(); )
+    {
+        if (!IsIdentifierChar(Expanded[I]))
+        {
+            ++I;
+            continue;
+        }
+        size_t Start = I;
+        while (I < Expanded.size() && IsIdentifierChar(Expanded[I]))
+        {
+            ++I;
+        }
+        Identifiers.insert(Expanded.substr(Start, I - Start));
+    }
+
+    OutSource.clear();
+    for (const auto& Define : Info.Defines)
+    {
+        if (Identifiers.count(Define.first))
+        {
+            OutSource += "#define " + Define.first + " " + Define.second + "\n";
+        }
+    }
+    OutSource += Expanded;
+    return SResult_OK;
+}
+
+
+ResultCode ShaderPermutationManager::LoadConfig(const std::string& ConfigPath)
+{
+    std::vector<U8> Bytes;
+    ResultCode Result = ReadFileBytes(m_SourceDirectory + "/" + ConfigPath, Bytes);
+    if (Result != SResult_OK)
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+
+    JsonValue Root;
+    if (ParseJson(reinterpret_cast<const char*>(Bytes.data()), Bytes.size(), Root) != SResult_OK)
+    {
+        return SResult_INVALID_ARGS;
+    }
+    const JsonValue* PShaders = Root.IsObject() ? Root.Find("shaders") : nullptr;
+    if (!PShaders)
+    {
+        return Root.IsNull() || Root.IsObject() ? SResult_OK : SResult_INVALID_ARGS;
+    }
+    if (!PShaders->IsObject())
+    {
+        return SResult_INVALID_ARGS;
+    }
+
+    // Parse everything before adding, so a bad config adds nothing.
+    std::string Prefix = GetDirectory(ConfigPath);
+    std::vector<ShaderDeclaration> Declarations;
+    for (const auto& Shader : PShaders->GetMembers())
+    {
+        ShaderDeclaration Declaration;
+        Declaration.Name = Prefix + Shader.first;
+        const JsonValue* PDefines = Shader.second.IsObject() ? Shader.second.Find("defines") : nullptr;
+        U32 BitOffset = 0;
+        for (const JsonValue& Define : PDefines ? PDefines->GetArray() : std::vector<JsonValue>())
+        {
+            const JsonValue* PName = Define.Find("name");
+            const JsonValue* PValues = Define.Find("values");
+            if (!PName || !PName->IsString() || (PValues && (!PValues->IsArray() || PValues->GetArray().empty())))
+            {
+                return SResult_INVALID_ARGS;
+            }
+
+            PermutationDefine Permutation;
+            Permutation.Name = PName->GetString();
+            if (PValues)
+            {
+                for (const JsonValue& Value : PValues->GetArray())
+                {
+                    if (!Value.IsString())
+                    {
+                        return SResult_INVALID_ARGS;
+                    }
+                    Permutation.Values.push_back(Value.GetString());
+                }
+            }
+            else
+            {
+                Permutation.Values = { "0", "1" };
+            }
+
+            Permutation.NumBits = 0;
+            while ((1ULL << Permutation.NumBits) < Permutation.Values.size())
+            {
+                Permutation.NumBits += 1;
+            }
+            Permutation.BitOffset = BitOffset;
+            BitOffset += Permutation.NumBits;
+            if (BitOffset > 64)
+            {
+                return SResult_INVALID_ARGS;
+            }
+            Declaration.Defines.push_back(std::move(Permutation));
+        }
+        Declarations.push_back(std::move(Declaration));
+    }
+
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    for (ShaderDeclaration& Declaration : Declarations)
+    {
+        U64 NameHash = HashShaderName(Declaration.Name.c_str());
+        m_Shaders[NameHash] = std::move(Declaration);
+    }
+    return SResult_OK;
+}
+
+
+ResultCode ShaderPermutationManager::GetPermutationKey(const char* ShaderName,
+                                                       U32 NumDefines,
+                                                       const ShaderDefine* PDefines,
+                                                       U64* OutKey) const
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    auto Iter = m_Shaders.find(HashShaderName(ShaderName));
+    if (Iter == m_Shaders.end())
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+
+    U64 Key = 0;
+    for (U32 I = 0; I < NumDefines; ++I)
+    {
+        const PermutationDefine* PFound = nullptr;
+        for (const PermutationDefine& Define : Iter->second.Defines)
+        {
+            if (Define.Name == PDefines[I].Name)
+            {
+                PFound = &Define;
+                break;
+            }
+        }
+        if (!PFound)
+        {
+            return SResult_INVALID_ARGS;
+        }
+        U64 ValueIndex = 0;
+        while (ValueIndex < PFound->Values.size() && PFound->Values[ValueIndex] != PDefines[I].Value)
+        {
+            ValueIndex += 1;
+        }
+        if (ValueIndex == PFound->Values.size())
+        {
+            return SResult_INVALID_ARGS;
+        }
+        if (PFound->NumBits)
+        {
+            U64 Mask = ((PFound->NumBits == 64) ? ~0ULL : ((1ULL << PFound->NumBits) - 1)) << PFound->BitOffset;
+            Key = (Key & ~Mask) | (ValueIndex << PFound->BitOffset);
+        }
+    }
+    *OutKey = Key;
+    return SResult_OK;
+}
+
+
+ResultCode ShaderPermutationManager::GetShader(const char* ShaderName, U64 PermutationKey, ShaderModule* OutModule)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    m_Statistics.NumRequests += 1;
+
+    U64 NameHash = HashShaderName(ShaderName);
+    auto ShaderIter = m_Shaders.find(NameHash);
+    if (ShaderIter == m_Shaders.end())
+    {
+        return SResult_OBJECT_NOT_FOUND;
+    }
+    const ShaderDeclaration& Declaration = ShaderIter->second;
+
+    auto Found = m_Permutations.find({ NameHash, PermutationKey });
+    if (Found != m_Permutations.end())
+    {
+        if (Found->second->Result != SResult_OK)
+        {
+            return Found->second->Result;
+        }
+        OutModule->ByteCode = Found->second->ByteCode.data();
+        OutModule->SizeInBytes = Found->second->ByteCode.size();
+        return SResult_OK;
+    }
+
+    if (m_PPack && m_PPack->Find(NameHash, PermutationKey, OutModule) == SResult_OK)
+    {
+        m_Statistics.NumPackHits += 1;
+        return SResult_OK;
+    }
+
+    ShaderCompileInfo Info;
+    Info.SourcePath = m_SourceDirectory + "/" + Declaration.Name + ".hlsl";
+    Info.IncludeDirectory = m_SourceDirectory;
+    size_t Dot = Declaration.Name.find_last_of('.');
+    Info.Stage = (Dot == std::string::npos) ? std::string() : Declaration.Name.substr(Dot + 1);
+    U64 UsedBits = 0;
+    for (const PermutationDefine& Define : Declaration.Defines)
+    {
+        U64 Mask = (Define.NumBits == 64) ? ~0ULL : ((1ULL << Define.NumBits) - 1);
+        U64 ValueIndex = (PermutationKey >> Define.BitOffset) & Mask;
+        if (ValueIndex >= Define.Values.size())
+        {
+            return SResult_INVALID_ARGS;
+        }
+        UsedBits |= Mask << Define.BitOffset;
+        Info.Defines.push_back({ Define.Name, Define.Values[ValueIndex] });
+    }
+    if (PermutationKey & ~UsedBits)
+    {
+        return SResult_INVALID_ARGS;
+    }
+
+    std::string Source;
+    ResultCode Result = m_PCompiler->Preprocess(Info, Source);
+    if (Result != SResult_OK)
+    {
+        return Result;
+    }
+
+    U64 SourceHash = HashBytes(Info.Stage.data(), Info.Stage.size(), HashBytes(Source.data(), Source.size()));
+    std::unique_ptr<CompiledShader>& Compiled = m_CompiledBySource[SourceHash];
+    if (Compiled)
+    {
+        m_Statistics.NumDeduplicated += 1;
+    }
+    else
+    {
+        Compiled.reset(new CompiledShader());
+        Compiled->Result = m_PCompiler->Compile(Info, Source, Compiled->ByteCode);
+        m_Statistics.NumCompiles += 1;
+        m_Statistics.NumFailures += (Compiled->Result != SResult_OK) ? 1 : 0;
+    }
+    m_Permutations[{ NameHash, PermutationKey }] = Compiled.get();
+
+    if (Compiled->Result != SResult_OK)
+    {
+        return Compiled->Result;
+    }
+    OutModule->ByteCode = Compiled->ByteCode.data();
+    OutModule->SizeInBytes = Compiled->ByteCode.size();
+    return SResult_OK;
+}
+
+
+void ShaderPermutationManager::AddCompiledShaders(ShaderPackBuilder& Builder) const
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    for (const auto& Iter : m_Permutations)
+    {
+        if (Iter.second->Result == SResult_OK)
+        {
+            Builder.Add(Iter.first.first, Iter.first.second, Iter.second->ByteCode.data(), Iter.second->ByteCode.size());
+        }
+    }
+}
+
+
+ShaderPermutationStatistics ShaderPermutationManager::GetStatistics() const
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    return m_Statistics;
+}
+} // Synthe
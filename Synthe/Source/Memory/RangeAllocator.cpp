@@ -0,0 +1,232 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "Common/Memory/RangeAllocator.hpp"
+
+#include <iterator>
+
+namespace Synthe {
+
+
+void RangeAllocator::OnInitialize()
+{
+    Reset();
+}
+
+
+void RangeAllocator::Reset()
+{
+    m_Top = m_BaseAddress;
+    m_FreeBytes = 0ULL;
+    m_NumAllocations = 0ULL;
+    m_CurrentUsedBytes = 0ULL;
+    m_FreeRanges.clear();
+    m_FreeRangesBySize.clear();
+    m_PendingFrees.clear();
+}
+
+
+void RangeAllocator::EraseFreeRange(std::map<UPtr, U64>::iterator Iter)
+{
+    m_FreeRangesBySize.erase({ Iter->second, Iter->first });
+    m_FreeBytes -= Iter->second;
+    m_FreeRanges.erase(Iter);
+}
+
+
+std::map<Allocator::UPtr, U64>::iterator RangeAllocator::MoveFreeRange(std::map<UPtr, U64>::iterator Iter, 
+                                                                        UPtr Address, 
+                                                                        U64 SizeInBytes)
+{
+    auto SizeNode = m_FreeRangesBySize.extract({ Iter->second, Iter->first });
+    SizeNode.value() = { SizeInBytes, Address };
+    m_FreeRangesBySize.insert(std::move(SizeNode));
+    m_FreeBytes = m_FreeBytes - Iter->second + SizeInBytes;
+    if (Iter->first == Address)
+    {
+        Iter->second = SizeInBytes;
+        return Iter;
+    }
+    auto Node = m_FreeRanges.extract(Iter);
+    Node.key() = Address;
+    Node.mapped() = SizeInBytes;
+    return m_FreeRanges.insert(std::move(Node)).position;
+}
+
+
+B32 RangeAllocator::InsertFreeRange(UPtr Address, U64 SizeInBytes)
+{
+    if (SizeInBytes == 0ULL)
+    {
+        return true;
+    }
+
+    auto Next = m_FreeRanges.lower_bound(Address);
+    auto Prev = (Next != m_FreeRanges.begin()) ? std::prev(Next) : m_FreeRanges.end();
+    if ((Next != m_FreeRanges.end() && Next->first < Address + SizeInBytes)
+        || (Prev != m_FreeRanges.end() && Prev->first + Prev->second > Address))
+    {
+        return false;
+    }
+    B32 MergesPrev = (Prev != m_FreeRanges.end()) && (Prev->first + Prev->second == Address);
+    B32 MergesNext = (Next != m_FreeRanges.end()) && (Address + SizeInBytes == Next->first);
+
+    std::map<UPtr, U64>::iterator Range;
+    if (MergesPrev && MergesNext)
+    {
+        U64 MergedSize = Prev->second + SizeInBytes + Next->second;
+        EraseFreeRange(Next);
+        Range = MoveFreeRange(Prev, Prev->first, MergedSize);
+    }
+    else if (MergesPrev)
+    {
+        Range = MoveFreeRange(Prev, Prev->first, Prev->second + SizeInBytes);
+    }
+    else if (MergesNext)
+    {
+        Range = MoveFreeRange(Next, Address, SizeInBytes + Next->second);
+    }
+    else
+    {
+        Range = m_FreeRanges.emplace_hint(Next, Address, SizeInBytes);
+        m_FreeRangesBySize.insert({ SizeInBytes, Address });
+        m_FreeBytes += SizeInBytes;
+    }
+
+    // Merged with everything free around it, so nothing free is left between it and the top.
+    if (Range->first + Range->second == m_Top)
+    {
+        m_Top = Range->first;
+        EraseFreeRange(Range);
+    }
+    return true;
+}
+
+
+B32 RangeAllocator::TakeFreeRange(U64 NeededBytes, U64 Alignment, UPtr* OutAddress)
+{
+    if (m_FreeBytes < NeededBytes)
+    {
+        return false;
+    }
+
+    // Smallest range first, larger ones are only looked at if alignment padding does not fit.
+    for (auto Iter = m_FreeRangesBySize.lower_bound({ NeededBytes, 0ULL }); Iter != m_FreeRangesBySize.end(); ++Iter)
+    {
+        U64 RangeSize = Iter->first;
+        UPtr RangeStart = Iter->second;
+        UPtr Address = AlignAddress(RangeStart, Alignment);
+        if (Address + NeededBytes > RangeStart + RangeSize)
+        {
+            continue;
+        }
+
+        // Padding and the remainder stay free, their other neighbours are not, so nothing merges.
+        U64 PaddingBytes = Address - RangeStart;
+        U64 RemainderBytes = (RangeStart + RangeSize) - (Address + NeededBytes);
+        auto Range = m_FreeRanges.find(RangeStart);
+        if (PaddingBytes == 0ULL && RemainderBytes == 0ULL)
+        {
+            EraseFreeRange(Range);
+        }
+        else if (PaddingBytes == 0ULL)
+        {
+            MoveFreeRange(Range, Address + NeededBytes, RemainderBytes);
+        }
+        else
+        {
+            MoveFreeRange(Range, RangeStart, PaddingBytes);
+            InsertFreeRange(Address + NeededBytes, RemainderBytes);
+        }
+        *OutAddress = Address;
+        return true;
+    }
+    return false;
+}
+
+
+ResultCode RangeAllocator::Allocate(AllocationBlock* Block, U64 SizeInBytes, U64 Alignment)
+{
+    if (!Block)
+    {
+        return SResult_INITIALIZATION_FAILURE;
+    }
+
+    if (SizeInBytes == 0ULL)
+    {
+        return SResult_INVALID_ARGS;
+    }
+
+    U64 NeededBytes = ALIGN_BYTES(SizeInBytes, Alignment);
+    UPtr Address = 0ULL;
+    UPtr LastPtr = m_BaseAddress + m_TotalSizeInBytes;
+
+    if (!TakeFreeRange(NeededBytes, Alignment, &Address))
+    {
+        UPtr AlignedTop = AlignAddress(m_Top, Alignment);
+        if (AlignedTop + NeededBytes > LastPtr)
+        {
+            return SResult_OUT_OF_MEMORY;
+        }
+        UPtr OldTop = m_Top;
+        m_Top = AlignedTop + NeededBytes;
+        // Padding is a free range like any other, taken back once its neighbours are freed.
+        InsertFreeRange(OldTop, AlignedTop - OldTop);
+        Address = AlignedTop;
+    }
+
+    Block->StartAddress = Address;
+    Block->SizeInBytes = NeededBytes;
+    Block->AllocationID = static_cast<U32>(m_NumAllocations++);
+    Block->AllocatorPoolID = m_ID;
+    m_CurrentUsedBytes += NeededBytes;
+    return SResult_OK;
+}
+
+
+ResultCode RangeAllocator::Free(AllocationBlock* Block)
+{
+    if (!Block)
+    {
+        return SResult_MEMORY_NULL_EXCEPTION;
+    }
+
+    if (Block->StartAddress < m_BaseAddress || Block->StartAddress + Block->SizeInBytes > m_Top)
+    {
+        return SResult_OUT_OF_BOUNDS;
+    }
+
+    // A block overlapping a free range was already freed.
+    if (!InsertFreeRange(Block->StartAddress, Block->SizeInBytes))
+    {
+        return SResult_INVALID_ARGS;
+    }
+    m_CurrentUsedBytes -= Block->SizeInBytes;
+    return SResult_OK;
+}
+
+
+ResultCode RangeAllocator::DeferFree(const AllocationBlock& Block, U64 RetireValue)
+{
+    if (Block.SizeInBytes == 0ULL)
+    {
+        return SResult_INVALID_ARGS;
+    }
+    m_PendingFrees.push_back({ Block, RetireValue });
+    return SResult_OK;
+}
+
+
+U32 RangeAllocator::Retire(U64 CompletedValue)
+{
+    U32 NumRetired = 0;
+    while (!m_PendingFrees.empty() && m_PendingFrees.front().RetireValue <= CompletedValue)
+    {
+        Free(&m_PendingFrees.front().Block);
+        m_PendingFrees.pop_front();
+        NumRetired += 1;
+    }
+    return NumRetired;
+}
+} // Synthe
@@ -0,0 +1,319 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "Common/Memory/StreamCopy.hpp"
+
+#include <string.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+ #define SYNTHE_STREAM_X86 1
+ #include <emmintrin.h>
+ #include <immintrin.h>
+ #if defined(_MSC_VER)
+  #include <intrin.h>
+  #define SYNTHE_TARGET_AVX2
+ #else
+  #include <cpuid.h>
+  #define SYNTHE_TARGET_AVX2 __attribute__((target("avx2")))
+ #endif
+#else
+ #define SYNTHE_STREAM_X86 0
+#endif
+
+
+namespace Synthe {
+
+
+typedef void (*StreamCopyFunction)(U8*, const U8*, U64);
+typedef void (*StreamFillFunction)(U8*, U8, U64);
+
+
+struct StreamKernels
+{
+    StreamKernelLevel Level;
+    StreamCopyFunction Copy;
+    StreamFillFunction Fill;
+};
+
+
+static void StreamCopyScalar(U8* PDst, const U8* PSrc, U64 SizeInBytes)
+{
+    memcpy(PDst, PSrc, SizeInBytes);
+}
+
+
+static void StreamFillScalar(U8* PDst, U8 Value, U64 SizeInBytes)
+{
+    memset(PDst, Value, SizeInBytes);
+}
+
+
+#if SYNTHE_STREAM_X86
+//! Number of bytes needed to bring Ptr up to the given power of two alignment.
+static U64 GetHeadBytes(const U8* Ptr, U64 Alignment, U64 SizeInBytes)
+{
+    U64 Head = (Alignment - (reinterpret_cast<U64>(Ptr) & (Alignment - 1))) & (Alignment - 1);
+    return Head < SizeInBytes ? Head : SizeInBytes;
+}
+
+
+static void StreamCopySSE2(U8* PDst, const U8* PSrc, U64 SizeInBytes)
+{
+    // Stores must be aligned, loads can be whatever the source gives us.
+    U64 Head = GetHeadBytes(PDst, 16, SizeInBytes);
+    memcpy(PDst, PSrc, Head);
+    PDst += Head;
+    PSrc += Head;
+    SizeInBytes -= Head;
+
+    // Full cache lines at a time, so the write combine buffers flush whole lines.
+    while (SizeInBytes >= 64)
+    {
+        __m128i A = _mm_loadu_si128(reinterpret_cast<const __m128i*>(PSrc));
+        __m128i B = _mm_loadu_si128(reinterpret_cast<const __m128i*>(PSrc + 16));
+        __m128i C = _mm_loadu_si128(reinterpret_cast<const __m128i*>(PSrc + 32));
+        __m128i D = _mm_loadu_si128(reinterpret_cast<const __m128i*>(PSrc + 48));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(PDst), A);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(PDst + 16), B);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(PDst + 32), C);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(PDst + 48), D);
+        PDst += 64;
+        PSrc += 64;
+        SizeInBytes -= 64;
+    }
+
+    while (SizeInBytes >= 16)
+    {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(PDst),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(PSrc)));
+        PDst += 16;
+        PSrc += 16;
+        SizeInBytes -= 16;
+    }
+
+    // Non-temporal stores are weakly ordered, fence them before anyone else
+    // (like the GPU, once we submit) can observe the memory.
+    _mm_sfence();
+    memcpy(PDst, PSrc, SizeInBytes);
+}
+
+
+static void StreamFillSSE2(U8* PDst, U8 Value, U64 SizeInBytes)
+{
+    U64 Head = GetHeadBytes(PDst, 16, SizeInBytes);
+    memset(PDst, Value, Head);
+    PDst += Head;
+    SizeInBytes -= Head;
+
+    __m128i V = _mm_set1_epi8(static_cast<char>(Value));
+    while (SizeInBytes >= 64)
+    {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(PDst), V);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(PDst + 16), V);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(PDst + 32), V);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(PDst + 48), V);
+        PDst += 64;
+        SizeInBytes -= 64;
+    }
+
+    while (SizeInBytes >= 16)
+    {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(PDst), V);
+        PDst += 16;
+        SizeInBytes -= 16;
+    }
+
+    _mm_sfence();
+    memset(PDst, Value, SizeInBytes);
+}
+
+
+SYNTHE_TARGET_AVX2 static void StreamCopyAVX2(U8* PDst, const U8* PSrc, U64 SizeInBytes)
+{
+    U64 Head = GetHeadBytes(PDst, 32, SizeInBytes);
+    memcpy(PDst, PSrc, Head);
+    PDst += Head;
+    PSrc += Head;
+    SizeInBytes -= Head;
+
+    // Two cache lines per iteration.
+    while (SizeInBytes >= 128)
+    {
+        __m256i A = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(PSrc));
+        __m256i B = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(PSrc + 32));
+        __m256i C = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(PSrc + 64));
+        __m256i D = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(PSrc + 96));
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(PDst), A);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(PDst + 32), B);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(PDst + 64), C);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(PDst + 96), D);
+        PDst += 128;
+        PSrc += 128;
+        SizeInBytes -= 128;
+    }
+
+    while (SizeInBytes >= 32)
+    {
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(PDst),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(PSrc)));
+        PDst += 32;
+        PSrc += 32;
+        SizeInBytes -= 32;
+    }
+
+    _mm_sfence();
+    // Avoid the AVX to SSE transition penalty in whatever runs after us.
+    _mm256_zeroupper();
+    memcpy(PDst, PSrc, SizeInBytes);
+}
+
+
+SYNTHE_TARGET_AVX2 static void StreamFillAVX2(U8* PDst, U8 Value, U64 SizeInBytes)
+{
+    U64 Head = GetHeadBytes(PDst, 32, SizeInBytes);
+    memset(PDst, Value, Head);
+    PDst += Head;
+    SizeInBytes -= Head;
+
+    __m256i V = _mm256_set1_epi8(static_cast<char>(Value));
+    while (SizeInBytes >= 128)
+    {
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(PDst), V);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(PDst + 32), V);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(PDst + 64), V);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(PDst + 96), V);
+        PDst += 128;
+        SizeInBytes -= 128;
+    }
+
+    while (SizeInBytes >= 32)
+    {
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(PDst), V);
+        PDst += 32;
+        SizeInBytes -= 32;
+    }
+
+    _mm_sfence();
+    _mm256_zeroupper();
+    memset(PDst, Value, SizeInBytes);
+}
+
+
+static void QueryCpuId(U32 Leaf, U32 SubLeaf, U32 Registers[4])
+{
+#if defined(_MSC_VER)
+    int Info[4];
+    __cpuidex(Info, static_cast<int>(Leaf), static_cast<int>(SubLeaf));
+    Registers[0] = Info[0]; Registers[1] = Info[1]; Registers[2] = Info[2]; Registers[3] = Info[3];
+#else
+    __cpuid_count(Leaf, SubLeaf, Registers[0], Registers[1], Registers[2], Registers[3]);
+#endif
+}
+
+
+//! Check that the OS saves the upper halves of the YMM registers on context switch.
+static B32 IsAvxStateEnabledByOS()
+{
+#if defined(_MSC_VER)
+    U64 XCR0 = _xgetbv(0);
+#else
+    U32 Eax = 0, Edx = 0;
+    __asm__ volatile ("xgetbv" : "=a"(Eax), "=d"(Edx) : "c"(0));
+    U64 XCR0 = (static_cast<U64>(Edx) << 32) | Eax;
+#endif
+    // XMM and YMM state.
+    return (XCR0 & 0x6) == 0x6;
+}
+
+
+static StreamKernelLevel QueryStreamKernelLevel()
+{
+    U32 Registers[4] = { };
+    QueryCpuId(0, 0, Registers);
+    U32 MaxLeaf = Registers[0];
+    if (MaxLeaf < 1)
+    {
+        return StreamKernelLevel_SCALAR;
+    }
+
+    QueryCpuId(1, 0, Registers);
+    B32 HasSSE2 = (Registers[3] & (1U << 26)) != 0;
+    B32 HasOSXSave = (Registers[2] & (1U << 27)) != 0;
+    B32 HasAVX = (Registers[2] & (1U << 28)) != 0;
+    if (!HasSSE2)
+    {
+        return StreamKernelLevel_SCALAR;
+    }
+
+    if (MaxLeaf >= 7 && HasOSXSave && HasAVX && IsAvxStateEnabledByOS())
+    {
+        QueryCpuId(7, 0, Registers);
+        if (Registers[1] & (1U << 5))
+        {
+            return StreamKernelLevel_AVX2;
+        }
+    }
+    return StreamKernelLevel_SSE2;
+}
+#endif
+
+
+static StreamKernels SelectStreamKernels()
+{
+    StreamKernels Kernels = { StreamKernelLevel_SCALAR, StreamCopyScalar, StreamFillScalar };
+#if SYNTHE_STREAM_X86
+    Kernels.Level = QueryStreamKernelLevel();
+    switch (Kernels.Level)
+    {
+        case StreamKernelLevel_AVX2:
+            Kernels.Copy = StreamCopyAVX2;
+            Kernels.Fill = StreamFillAVX2;
+            break;
+        case StreamKernelLevel_SSE2:
+            Kernels.Copy = StreamCopySSE2;
+            Kernels.Fill = StreamFillSSE2;
+            break;
+        default:
+            break;
+    }
+#endif
+    return Kernels;
+}
+
+
+static const StreamKernels& GetStreamKernels()
+{
+    // Selected once, thread safe by way of static initialization.
+    static const StreamKernels Kernels = SelectStreamKernels();
+    return Kernels;
+}
+
+
+StreamKernelLevel GetStreamKernelLevel()
+{
+    return GetStreamKernels().Level;
+}
+
+
+void StreamCopy(void* PDst, const void* PSrc, U64 SizeInBytes)
+{
+    if (SizeInBytes < STREAM_COPY_MIN_BYTES)
+    {
+        memcpy(PDst, PSrc, SizeInBytes);
+        return;
+    }
+    GetStreamKernels().Copy(static_cast<U8*>(PDst), static_cast<const U8*>(PSrc), SizeInBytes);
+}
+
+
+void StreamFill(void* PDst, U8 Value, U64 SizeInBytes)
+{
+    if (SizeInBytes < STREAM_COPY_MIN_BYTES)
+    {
+        memset(PDst, Value, SizeInBytes);
+        return;
+    }
+    GetStreamKernels().Fill(static_cast<U8*>(PDst), Value, SizeInBytes);
+}
+} // Synthe
@@ -0,0 +1,40 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+#pragma once
+
+#include "Common/Types.hpp"
+#include "Common/Memory/Allocator.hpp"
+#include "Graphics/GraphicsDevice.hpp"
+
+#include <chrono>
+
+
+namespace Synthe {
+
+
+//! Seconds on a monotonic clock, for timing benchmark loops.
+inline R64 GetBenchSeconds()
+{
+    return std::chrono::duration<R64>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+//! Benchmarks, each prints its results to stdout. PDevice is nullptr when no device could be
+//! created, or with --no-device, and benchmarks then skip their GPU parts.
+
+//! memcpy against StreamCopy(), into host memory and into a mapped upload buffer.
+void RunStreamCopyBench(GraphicsDevice* PDevice);
+
+//! Descriptor alloc and deferred free churn, on a RangeAllocator and through view create and destroy.
+void RunDescriptorChurnBench(GraphicsDevice* PDevice);
+
+//! Frame begin cost with 50k descriptor sets, 1% of them updated per frame.
+void RunDescriptorSetBench(GraphicsDevice* PDevice);
+
+//! Draw packet sort throughput on 100k packets, and the state changes sorting avoids.
+void RunDrawPacketBench(GraphicsDevice* PDevice);
+
+//! Recording 10k draws into command stream lists on 1 to 16 threads.
+void RunParallelRecordingBench(GraphicsDevice* PDevice);
+} // Synthe
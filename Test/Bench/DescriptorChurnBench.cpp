@@ -0,0 +1,182 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "Bench.hpp"
+#include "Common/Memory/RangeAllocator.hpp"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+namespace Synthe {
+
+
+//! Size of one descriptor, as on most hardware.
+static const U64 k_DescriptorSize = 32ULL;
+
+
+//! Alloc and deferred free pairs on a RangeAllocator sized like the CBV/SRV/UAV staging heap. Most
+//! allocations are single views, one in eight a table of 2 to 8 descriptors.
+static void RunRangeAllocatorChurn()
+{
+    const U64 NumSlots = 8192;
+    const U32 NumLive = 2048;
+    const U32 NumPairs = 1000000;
+    const U32 PairsPerFrame = 512;
+    const U64 RetireDelay = 3;
+
+    RangeAllocator Allocator;
+    Allocator.Initialize(0ULL, NumSlots * k_DescriptorSize);
+    std::mt19937 Random(1234);
+    std::vector<AllocationBlock> Live;
+    Live.reserve(NumLive);
+    U64 HighWater = 0;
+    U32 NumFailed = 0;
+
+    auto AllocateOne = [&] () -> B32
+    {
+        U64 Count = (Random() % 8) ? 1 : 2 + Random() % 7;
+        AllocationBlock Block = { };
+        if (Allocator.Allocate(&Block, Count * k_DescriptorSize, k_DescriptorSize) != SResult_OK)
+        {
+            NumFailed += 1;
+            return false;
+        }
+        U64 End = Block.StartAddress + Block.SizeInBytes;
+        HighWater = End > HighWater ? End : HighWater;
+        Live.push_back(Block);
+        return true;
+    };
+
+    while (Live.size() < NumLive)
+    {
+        if (!AllocateOne())
+        {
+            printf("  allocator: %u live allocations do not fit, skipped.\n", NumLive);
+            return;
+        }
+    }
+
+    U64 Frame = 1;
+    R64 Start = GetBenchSeconds();
+    for (U32 I = 0; I < NumPairs; ++I)
+    {
+        if ((I % PairsPerFrame) == 0)
+        {
+            Frame += 1;
+            Allocator.Retire(Frame > RetireDelay ? Frame - RetireDelay : 0);
+        }
+        U32 Victim = Random() % static_cast<U32>(Live.size());
+        Allocator.DeferFree(Live[Victim], Frame);
+        Live[Victim] = Live.back();
+        Live.pop_back();
+        AllocateOne();
+    }
+    R64 Seconds = GetBenchSeconds() - Start;
+
+    printf("  allocator: %u pairs, %u live, %llu frame retire delay, %llu slots\n",
+           NumPairs, NumLive, RetireDelay, NumSlots);
+    printf("  allocator: %.1f ns per pair, high water %llu slots, %u failed allocations\n",
+           Seconds * 1e9 / NumPairs, HighWater / k_DescriptorSize, NumFailed);
+}
+
+
+//! Create and destroy buffer views through the device, frame after frame. Views differ in their
+//! first element so each takes its own descriptor instead of hitting the view cache.
+static void RunViewChurn(GraphicsDevice* PDevice)
+{
+    const U32 NumElements = 16384;
+    const U32 NumLive = 1024;
+    const U32 PairsPerFrame = 64;
+    const U32 NumFrames = 500;
+
+    ResourceCreateInfo CreateInfo = { };
+    CreateInfo.Dimension = ResourceDimension_BUFFER;
+    CreateInfo.Width = NumElements * 4ULL;
+    CreateInfo.Height = 1;
+    CreateInfo.DepthOrArraySize = 1;
+    CreateInfo.Mips = 1;
+    CreateInfo.ResourceFormat = GFormat_UNKNOWN;
+    CreateInfo.Usage = ResourceUsage_SHADER_RESOURCE;
+    CreateInfo.SampleCount = 1;
+    CreateInfo.SampleQuality = 0;
+    GPUHandle Buffer = 0;
+    if (PDevice->CreateResource(&Buffer, &CreateInfo, nullptr) != SResult_OK)
+    {
+        printf("  views: buffer could not be created, skipped.\n");
+        return;
+    }
+
+    ShaderResourceViewCreateInfo SrvInfo = { };
+    SrvInfo.ResourceHandle = Buffer;
+    SrvInfo.Format = GFormat_UNKNOWN;
+    SrvInfo.Dimension = SrvViewDimension_BUFFER;
+    SrvInfo.Buffer.NumElements = 1;
+    SrvInfo.Buffer.StructureByteStride = 4;
+
+    std::mt19937 Random(1234);
+    std::vector<GPUHandle> Live;
+    U32 NextElement = 0;
+    U32 NumFailed = 0;
+    auto CreateOne = [&] ()
+    {
+        GPUHandle View = 0;
+        SrvInfo.Buffer.FirstElement = (NextElement++) % NumElements;
+        if (PDevice->CreateShaderResourceView(SrvInfo, &View) != SResult_OK)
+        {
+            NumFailed += 1;
+            return;
+        }
+        Live.push_back(View);
+    };
+
+    while (Live.size() < NumLive && NumFailed == 0)
+    {
+        CreateOne();
+    }
+
+    R64 ChurnSeconds = 0.0;
+    R64 Start = GetBenchSeconds();
+    for (U32 Frame = 0; Frame < NumFrames; ++Frame)
+    {
+        PDevice->Begin();
+        R64 ChurnStart = GetBenchSeconds();
+        for (U32 I = 0; I < PairsPerFrame && !Live.empty(); ++I)
+        {
+            U32 Victim = Random() % static_cast<U32>(Live.size());
+            PDevice->DestroyShaderResourceView(Live[Victim]);
+            Live[Victim] = Live.back();
+            Live.pop_back();
+            CreateOne();
+        }
+        ChurnSeconds += GetBenchSeconds() - ChurnStart;
+        PDevice->End();
+    }
+    R64 Seconds = GetBenchSeconds() - Start;
+
+    ViewCacheStatistics Statistics = { };
+    PDevice->GetViewCacheStatistics(&Statistics);
+    printf("  views: %u frames of %u pairs, %u live\n", NumFrames, PairsPerFrame, NumLive);
+    printf("  views: %.1f ns per pair, %.3f ms per frame with Begin/End, %llu live views, %u failed creates\n",
+           ChurnSeconds * 1e9 / (NumFrames * PairsPerFrame), Seconds * 1e3 / NumFrames,
+           Statistics.NumLiveViews, NumFailed);
+
+    for (GPUHandle View : Live)
+    {
+        PDevice->DestroyShaderResourceView(View);
+    }
+    PDevice->DestroyResource(Buffer);
+}
+
+
+void RunDescriptorChurnBench(GraphicsDevice* PDevice)
+{
+    RunRangeAllocatorChurn();
+    if (PDevice)
+    {
+        RunViewChurn(PDevice);
+    }
+}
+} // Synthe
@@ -0,0 +1,119 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "Bench.hpp"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+namespace Synthe {
+
+
+//! Many descriptor sets, few of them updated per frame. Begin() should cost in proportion to the
+//! sets updated, not to the sets alive.
+void RunDescriptorSetBench(GraphicsDevice* PDevice)
+{
+    if (!PDevice)
+    {
+        printf("  needs a device, skipped.\n");
+        return;
+    }
+    const U32 NumSets = 50000;
+    const U32 NumUpdatesPerFrame = NumSets / 100;
+    // Sets pick from this many views, identical sets share their table.
+    const U32 NumViews = 2048;
+    const U32 NumWarmupFrames = 10;
+    const U32 NumFrames = 300;
+
+    ResourceCreateInfo CreateInfo = { };
+    CreateInfo.Dimension = ResourceDimension_BUFFER;
+    CreateInfo.Width = NumViews * 4ULL;
+    CreateInfo.Height = 1;
+    CreateInfo.DepthOrArraySize = 1;
+    CreateInfo.Mips = 1;
+    CreateInfo.ResourceFormat = GFormat_UNKNOWN;
+    CreateInfo.Usage = ResourceUsage_SHADER_RESOURCE;
+    CreateInfo.SampleCount = 1;
+    CreateInfo.SampleQuality = 0;
+    GPUHandle Buffer = 0;
+    if (PDevice->CreateResource(&Buffer, &CreateInfo, nullptr) != SResult_OK)
+    {
+        printf("  buffer could not be created, skipped.\n");
+        return;
+    }
+
+    std::vector<GPUHandle> Views(NumViews);
+    ShaderResourceViewCreateInfo SrvInfo = { };
+    SrvInfo.ResourceHandle = Buffer;
+    SrvInfo.Format = GFormat_UNKNOWN;
+    SrvInfo.Dimension = SrvViewDimension_BUFFER;
+    SrvInfo.Buffer.NumElements = 1;
+    SrvInfo.Buffer.StructureByteStride = 4;
+    for (U32 I = 0; I < NumViews; ++I)
+    {
+        SrvInfo.Buffer.FirstElement = I;
+        PDevice->CreateShaderResourceView(SrvInfo, &Views[I]);
+    }
+
+    DescriptorSetLayoutInfo Layout = { };
+    Layout.Srv.BaseRegister = 0;
+    Layout.Srv.NumDescriptors = 1;
+    std::vector<DescriptorSetLayoutInfo> Layouts(NumSets, Layout);
+    std::vector<DescriptorSet*> Sets(NumSets);
+    PDevice->AllocateDescriptorSets(NumSets, Sets.data(), Layouts.data());
+
+    DescriptorInfo Descriptor = { };
+    Descriptor.Type = DescriptorType_SHADER_RESOURCE_VIEW;
+    Descriptor.Binding = 0;
+    DescriptorSetUpdateInfo UpdateInfo = { };
+    UpdateInfo.PDescriptors = &Descriptor;
+    UpdateInfo.NumDescriptors = 1;
+
+    PDevice->Begin();
+    for (U32 I = 0; I < NumSets; ++I)
+    {
+        Descriptor.ViewHandle = Views[I % NumViews];
+        Sets[I]->Update(UpdateInfo);
+    }
+    PDevice->End();
+
+    std::mt19937 Random(1234);
+    R64 UpdateSeconds = 0.0;
+    R64 BeginSeconds = 0.0;
+    for (U32 Frame = 0; Frame < NumWarmupFrames + NumFrames; ++Frame)
+    {
+        R64 Start = GetBenchSeconds();
+        PDevice->Begin();
+        R64 Began = GetBenchSeconds();
+        for (U32 I = 0; I < NumUpdatesPerFrame; ++I)
+        {
+            Descriptor.ViewHandle = Views[Random() % NumViews];
+            Sets[Random() % NumSets]->Update(UpdateInfo);
+        }
+        R64 Updated = GetBenchSeconds();
+        PDevice->End();
+        if (Frame >= NumWarmupFrames)
+        {
+            BeginSeconds += Began - Start;
+            UpdateSeconds += Updated - Began;
+        }
+    }
+
+    printf("  %u sets, %u updated per frame, %u views\n", NumSets, NumUpdatesPerFrame, NumViews);
+    printf("  Begin() %.3f ms per frame, updates %.3f ms per frame\n",
+           BeginSeconds * 1e3 / NumFrames, UpdateSeconds * 1e3 / NumFrames);
+
+    for (DescriptorSet* PSet : Sets)
+    {
+        PSet->Release();
+    }
+    for (GPUHandle View : Views)
+    {
+        PDevice->DestroyShaderResourceView(View);
+    }
+    PDevice->DestroyResource(Buffer);
+}
+} // Synthe
@@ -0,0 +1,171 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "Bench.hpp"
+#include "Common/WorkerPool.hpp"
+#include "Graphics/CommandStream.hpp"
+#include "Graphics/DrawPackets.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+
+namespace Synthe {
+
+
+static const U32 k_NumPackets = 100000;
+//! Runs of each sort and recording, the best one is kept.
+static const U32 k_NumSortRuns = 20;
+
+
+//! Stand in for an API object, never dereferenced by a stream list.
+template<typename Type>
+static Type* GetBenchObject(U32 Kind, U32 Id)
+{
+    SIZE Address = (static_cast<SIZE>(Kind) << 24) | (static_cast<SIZE>(Id + 1) << 4);
+    return reinterpret_cast<Type*>(Address);
+}
+
+
+//! Packets of a scene with 4 passes, 8 root signatures, 64 pipelines, 512 descriptor sets and 256
+//! materials, submitted in random order as a scene traversal would.
+static void BuildBenchPackets(std::vector<DrawPacket>& Packets)
+{
+    std::mt19937 Random(1234);
+    Packets.resize(k_NumPackets);
+    for (DrawPacket& Packet : Packets)
+    {
+        DrawSortKeyInfo Info = { };
+        Info.Pass = Random() % 4;
+        Info.Pipeline = Random() % 64;
+        Info.RootSignature = Info.Pipeline % 8;
+        Info.DescriptorSet = Random() % 512;
+        Info.Material = Random() % 256;
+        // The last pass is blended, back to front.
+        Info.DepthFirst = (Info.Pass == 3);
+        Info.Depth = QuantizeDrawDepth(static_cast<R32>(Random() % 1000), 0.0f, 1000.0f, Info.DepthFirst);
+
+        Packet = { };
+        Packet.SortKey = MakeDrawSortKey(Info);
+        Packet.PRootSignature = GetBenchObject<RootSignature>(1, Info.RootSignature);
+        Packet.PPipelineState = GetBenchObject<PipelineState>(2, Info.Pipeline);
+        Packet.PDescriptorSet = GetBenchObject<DescriptorSet>(3, Info.DescriptorSet);
+        // Meshes follow the material, so sorted draws also share buffers.
+        Packet.PVertexBuffer = GetBenchObject<Resource>(4, Info.Material % 32);
+        Packet.PIndexBuffer = GetBenchObject<Resource>(5, Info.Material % 32);
+        Packet.BindlessIndices[0] = Info.Material;
+        Packet.NumBindlessIndices = 1;
+        Packet.ElementCount = 36;
+        Packet.InstanceCount = 1;
+    }
+}
+
+
+//! Best throughput of Sort, in millions of packets per second.
+template<typename Function>
+static R64 MeasureSort(const Function& Sort)
+{
+    R64 Best = 0.0;
+    for (U32 Run = 0; Run < k_NumSortRuns; ++Run)
+    {
+        R64 Start = GetBenchSeconds();
+        Sort();
+        R64 Seconds = GetBenchSeconds() - Start;
+        R64 Throughput = k_NumPackets / Seconds / 1e6;
+        Best = Throughput > Best ? Throughput : Best;
+    }
+    return Best;
+}
+
+
+//! Best time of recording the packets in the given order. The first run also grows the stream arena.
+static R64 MeasureRecording(CommandStreamList* PList,
+                            const std::vector<DrawPacket>& Packets,
+                            const U32* POrder,
+                            DrawPacketStatistics* OutStatistics)
+{
+    R64 Best = 0.0;
+    for (U32 Run = 0; Run < k_NumSortRuns; ++Run)
+    {
+        *OutStatistics = { };
+        PList->Begin();
+        R64 Start = GetBenchSeconds();
+        RecordDrawPackets(PList, k_NumPackets, Packets.data(), POrder, OutStatistics);
+        R64 Seconds = GetBenchSeconds() - Start;
+        PList->End();
+        Best = (Run == 0 || Seconds < Best) ? Seconds : Best;
+    }
+    return Best;
+}
+
+
+static void PrintRecording(const char* Label, const DrawPacketStatistics& Statistics, R64 Seconds)
+{
+    printf("  %-8s %.3f ms   root signatures %6llu   pipelines %6llu   descriptor sets %6llu   bindless %6llu   vertex buffers %6llu   index buffers %6llu\n",
+           Label, Seconds * 1e3, Statistics.NumRootSignatureChanges, Statistics.NumPipelineChanges,
+           Statistics.NumDescriptorSetChanges, Statistics.NumBindlessChanges,
+           Statistics.NumVertexBufferChanges, Statistics.NumIndexBufferChanges);
+}
+
+
+//! Sort throughput of 100k draw packets against std::stable_sort, and the state changes recorded
+//! with and without sorting. CPU only, the device is not used.
+void RunDrawPacketBench(GraphicsDevice*)
+{
+    std::vector<DrawPacket> Packets;
+    BuildBenchPackets(Packets);
+
+    DrawPacketSorter Sorter;
+    std::vector<U32> Order(k_NumPackets);
+    R64 RadixSerial = MeasureSort([&] () -> void
+        {
+            Sorter.Sort(nullptr, k_NumPackets, Packets.data(), Order.data());
+        });
+
+    WorkerPool Pool;
+    Pool.Initialize(WorkerPool::GetDefaultNumThreads());
+    std::vector<U32> ParallelOrder(k_NumPackets);
+    R64 RadixParallel = MeasureSort([&] () -> void
+        {
+            Sorter.Sort(&Pool, k_NumPackets, Packets.data(), ParallelOrder.data());
+        });
+
+    std::vector<DrawSortItem> Items(k_NumPackets);
+    R64 StableSort = MeasureSort([&] () -> void
+        {
+            for (U32 I = 0; I < k_NumPackets; ++I)
+            {
+                Items[I] = { Packets[I].SortKey, I, 0 };
+            }
+            std::stable_sort(Items.begin(), Items.end(), [] (const DrawSortItem& A, const DrawSortItem& B) -> bool
+                {
+                    return A.Key < B.Key;
+                });
+        });
+
+    // Both sorts are stable, so all three orders must match exactly.
+    B32 OrdersMatch = (Order == ParallelOrder);
+    for (U32 I = 0; I < k_NumPackets && OrdersMatch; ++I)
+    {
+        OrdersMatch = (Items[I].Index == Order[I]);
+    }
+
+    printf("  %u packets, best of %u runs, %u workers\n", k_NumPackets, k_NumSortRuns, Pool.GetNumThreads());
+    printf("  radix sort           %7.2f M packets/s\n", RadixSerial);
+    printf("  radix sort, parallel %7.2f M packets/s\n", RadixParallel);
+    printf("  std::stable_sort     %7.2f M packets/s\n", StableSort);
+    printf("  orders %s\n", OrdersMatch ? "match" : "DIFFER");
+
+    CommandStreamList List;
+    DrawPacketStatistics Unsorted = { };
+    DrawPacketStatistics Sorted = { };
+    R64 UnsortedSeconds = MeasureRecording(&List, Packets, nullptr, &Unsorted);
+    R64 SortedSeconds = MeasureRecording(&List, Packets, Order.data(), &Sorted);
+
+    PrintRecording("unsorted", Unsorted, UnsortedSeconds);
+    PrintRecording("sorted", Sorted, SortedSeconds);
+}
+} // Synthe
\ No newline at end of file
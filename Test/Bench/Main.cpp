@@ -0,0 +1,155 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "Bench.hpp"
+
+#include "Display/Window.hpp"
+#include "System.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace Synthe;
+
+
+struct BenchEntry
+{
+    const char* Name;
+    void (*Run)(GraphicsDevice* PDevice);
+    //! Whether the benchmark has a GPU part, the device is only created if one of these runs.
+    B32 UsesDevice;
+};
+
+
+static const BenchEntry k_Benches[] =
+{
+    { "StreamCopy",         RunStreamCopyBench,         true },
+    { "DescriptorChurn",    RunDescriptorChurnBench,    true },
+    { "DescriptorSets",     RunDescriptorSetBench,      true },
+    { "ParallelRecording",  RunParallelRecordingBench,  false },
+    { "DrawPackets",        RunDrawPacketBench,         false },
+};
+
+
+static const U32 k_NumBenches = sizeof(k_Benches) / sizeof(k_Benches[0]);
+
+
+static Window* GBenchWindow = nullptr;
+
+
+static GraphicsDevice* CreateBenchDevice()
+{
+    InitializeSystem();
+    // The swapchain needs a window, it is never shown.
+    GBenchWindow = CreateAppWindow();
+    GBenchWindow->Initialize("Synthe Bench", 0, 0, 256, 256);
+
+    GraphicsDeviceConfig DeviceConfig = { };
+    SwapchainConfig SwapchainConfiguration = { };
+
+    DeviceConfig.DesiredVendor = static_cast<GPUVendor>(GPUVendor_NVIDIA | GPUVendor_AMD | GPUVendor_INTEL);
+    DeviceConfig.ScratchPoolMemoryInBytes =      MEM_1MB * MEM_BYTES(1);
+    DeviceConfig.BufferPoolMemoryInBytes =       MEM_1MB * MEM_BYTES(256);
+    DeviceConfig.RenderTargetPoolMemoryInBytes = MEM_1MB * MEM_BYTES(64);
+    DeviceConfig.UploadPoolMemoryInBytes =       MEM_1MB * MEM_BYTES(256);
+    DeviceConfig.ReadBackPoolMemoryInBytes =     MEM_1KB * MEM_BYTES(64);
+    DeviceConfig.TexturePoolMemoryInBytes =      MEM_1MB * MEM_BYTES(256);
+    DeviceConfig.ShaderResourceMemoryInBytes =   MEM_1MB * MEM_BYTES(64);
+
+    SwapchainConfiguration.NumFrames = 3;
+    SwapchainConfiguration.Buffering = 3;
+    SwapchainConfiguration.Format = GFormat_R8G8B8A8_UNORM;
+    SwapchainConfiguration.Width = 256;
+    SwapchainConfiguration.Height = 256;
+    SwapchainConfiguration.Windowed = true;
+    SwapchainConfiguration.NativeWinHandle = GBenchWindow->GetNativeHandle();
+
+    GraphicsDevice* PDevice = GetDeviceD3D12();
+    if (PDevice->Initialize(DeviceConfig, SwapchainConfiguration) != SResult_OK)
+    {
+        return nullptr;
+    }
+    return PDevice;
+}
+
+
+static void DestroyBenchDevice(GraphicsDevice* PDevice)
+{
+    if (PDevice)
+    {
+        PDevice->CleanUp();
+    }
+    if (GBenchWindow)
+    {
+        GBenchWindow->Close();
+        GBenchWindow->CleanUp();
+        DestroyAppWindow(GBenchWindow);
+        GBenchWindow = nullptr;
+    }
+}
+
+
+//! Usage: Bench [--no-device] [Name...]. Runs the named benchmarks, or all of them if none are named.
+int main(int c, char* argv[])
+{
+    B32 UseDevice = true;
+    B32 Selected[k_NumBenches] = { };
+    B32 AnySelected = false;
+    for (int I = 1; I < c; ++I)
+    {
+        if (strcmp(argv[I], "--no-device") == 0)
+        {
+            UseDevice = false;
+            continue;
+        }
+        B32 Found = false;
+        for (U32 B = 0; B < k_NumBenches; ++B)
+        {
+            if (strcmp(argv[I], k_Benches[B].Name) == 0)
+            {
+                Selected[B] = true;
+                AnySelected = Found = true;
+            }
+        }
+        if (!Found)
+        {
+            printf("Unknown benchmark %s. Available:", argv[I]);
+            for (U32 B = 0; B < k_NumBenches; ++B)
+            {
+                printf(" %s", k_Benches[B].Name);
+            }
+            printf("\n");
+            return 1;
+        }
+    }
+
+    B32 NeedsDevice = false;
+    for (U32 B = 0; B < k_NumBenches; ++B)
+    {
+        Selected[B] = Selected[B] || !AnySelected;
+        NeedsDevice = NeedsDevice || (Selected[B] && k_Benches[B].UsesDevice);
+    }
+
+    GraphicsDevice* PDevice = nullptr;
+    if (UseDevice && NeedsDevice)
+    {
+        PDevice = CreateBenchDevice();
+        if (!PDevice)
+        {
+            printf("No device could be created, GPU parts are skipped.\n");
+        }
+    }
+
+    for (U32 B = 0; B < k_NumBenches; ++B)
+    {
+        if (Selected[B])
+        {
+            printf("== %s\n", k_Benches[B].Name);
+            k_Benches[B].Run(PDevice);
+        }
+    }
+
+    DestroyBenchDevice(PDevice);
+    return 0;
+}
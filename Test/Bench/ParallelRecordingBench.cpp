@@ -0,0 +1,96 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "Bench.hpp"
+#include "Common/WorkerPool.hpp"
+#include "Graphics/CommandStream.hpp"
+#include "Graphics/ParallelRecording.hpp"
+
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+
+namespace Synthe {
+
+
+//! Record one draw the way a mesh renderer would, a pipeline change every few draws, then the
+//! draw's bindless indices and the draw.
+static void RecordBenchDraw(GraphicsCommandList* PList, U32 Draw)
+{
+    if ((Draw % 16) == 0)
+    {
+        // Never dereferenced by a stream list, the pointer only has to be stable.
+        SIZE PipelineId = 0x1000 + ((Draw / 16) % 64) * 0x100;
+        PipelineState* PPipeline = reinterpret_cast<PipelineState*>(PipelineId);
+        PList->SetPipelineState(PipelineStateType_GRAPHICS, PPipeline, nullptr);
+    }
+    U32 Indices[2] = { Draw, Draw * 3 + 1 };
+    PList->SetBindlessIndices(2, Indices, 0);
+    PList->DrawIndexedInstanced(36 + (Draw % 7) * 3, 1, Draw * 64, 0, 0);
+}
+
+
+//! 10k draws split across 1 to 16 lists, each recorded on its own thread. Lists are command stream
+//! lists, so only the recording model is measured and the results do not depend on a driver. The
+//! device is not used.
+void RunParallelRecordingBench(GraphicsDevice*)
+{
+    const U32 NumDraws = 10000;
+    const U32 NumWarmupFrames = 10;
+    const U32 NumFrames = 200;
+    const U32 ThreadCounts[] = { 1, 2, 4, 8, 16 };
+
+    printf("  %u draws, %u hardware threads\n", NumDraws, std::thread::hardware_concurrency());
+
+    R64 SingleThreadSeconds = 0.0;
+    for (U32 NumThreads : ThreadCounts)
+    {
+        std::vector<CommandStreamList> Lists(NumThreads);
+        std::vector<GraphicsCommandList*> PLists(NumThreads);
+        for (U32 I = 0; I < NumThreads; ++I)
+        {
+            PLists[I] = &Lists[I];
+        }
+
+        // The calling thread records the first list, the workers the others.
+        WorkerPool Pool;
+        if (NumThreads > 1)
+        {
+            Pool.Initialize(NumThreads - 1);
+        }
+
+        auto Record = [&] (U32 ListIndex, GraphicsCommandList* PList) -> void
+        {
+            U32 First = 0;
+            U32 Count = 0;
+            GetParallelRange(NumDraws, NumThreads, ListIndex, &First, &Count);
+            for (U32 Draw = First; Draw < First + Count; ++Draw)
+            {
+                RecordBenchDraw(PList, Draw);
+            }
+        };
+
+        R64 Seconds = 0.0;
+        for (U32 Frame = 0; Frame < NumWarmupFrames + NumFrames; ++Frame)
+        {
+            R64 Start = GetBenchSeconds();
+            RecordCommandListsParallel(NumThreads > 1 ? &Pool : nullptr, NumThreads, PLists.data(), Record);
+            if (Frame >= NumWarmupFrames)
+            {
+                Seconds += GetBenchSeconds() - Start;
+            }
+        }
+
+        U32 NumCommands = 0;
+        for (const CommandStreamList& List : Lists)
+        {
+            NumCommands += List.GetStream().GetNumCommands();
+        }
+        SingleThreadSeconds = (NumThreads == 1) ? Seconds : SingleThreadSeconds;
+        printf("  %2u threads   %.3f ms per frame   %.2fx   %u commands\n",
+               NumThreads, Seconds * 1e3 / NumFrames, SingleThreadSeconds / Seconds, NumCommands);
+    }
+}
+} // Synthe
\ No newline at end of file
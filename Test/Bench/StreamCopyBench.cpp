@@ -0,0 +1,116 @@
+// No License, this is entirely open source!
+// Software for learning purposes.
+// Author: Mario Garcia
+
+#include "Bench.hpp"
+#include "Common/Memory/StreamCopy.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+
+namespace Synthe {
+
+
+//! Bytes copied per timed run, small copies are repeated to reach it.
+static const U64 k_BytesPerRun = MEM_1MB * MEM_BYTES(512);
+static const U32 k_NumRuns = 3;
+
+
+typedef void (*CopyFunction)(void* PDst, const void* PSrc, U64 SizeInBytes);
+
+
+static void MemcpyCopy(void* PDst, const void* PSrc, U64 SizeInBytes)
+{
+    memcpy(PDst, PSrc, static_cast<size_t>(SizeInBytes));
+}
+
+
+//! Best throughput in GB/s over k_NumRuns runs of copying SizeInBytes at a time.
+static R64 MeasureCopy(CopyFunction Copy, void* PDst, const void* PSrc, U64 SizeInBytes)
+{
+    U64 Reps = k_BytesPerRun / SizeInBytes;
+    Reps = Reps ? Reps : 1;
+    R64 Best = 0.0;
+    for (U32 Run = 0; Run < k_NumRuns; ++Run)
+    {
+        R64 Start = GetBenchSeconds();
+        for (U64 R = 0; R < Reps; ++R)
+        {
+            Copy(PDst, PSrc, SizeInBytes);
+        }
+        R64 Seconds = GetBenchSeconds() - Start;
+        R64 GBPerSecond = static_cast<R64>(Reps * SizeInBytes) / Seconds / static_cast<R64>(MEM_1GB);
+        Best = GBPerSecond > Best ? GBPerSecond : Best;
+    }
+    return Best;
+}
+
+
+static void MeasureSizes(const char* Label, void* PDst, const U8* PSrc, U64 MaxSizeInBytes)
+{
+    const U64 Sizes[] = { 256ULL, 4ULL * MEM_1KB, 64ULL * MEM_1KB, MEM_1MB, 16ULL * MEM_1MB, 256ULL * MEM_1MB };
+    for (U64 Size : Sizes)
+    {
+        if (Size > MaxSizeInBytes)
+        {
+            break;
+        }
+        R64 Memcpy = MeasureCopy(MemcpyCopy, PDst, PSrc, Size);
+        R64 Stream = MeasureCopy(StreamCopy, PDst, PSrc, Size);
+        printf("  %-8s %9llu B   memcpy %6.2f GB/s   stream %6.2f GB/s\n",
+               Label, Size, Memcpy, Stream);
+    }
+}
+
+
+void RunStreamCopyBench(GraphicsDevice* PDevice)
+{
+    const char* Levels[] = { "scalar", "SSE2", "AVX2" };
+    printf("  kernel: %s\n", Levels[GetStreamKernelLevel()]);
+
+    const U64 HostSize = 256ULL * MEM_1MB;
+    std::vector<U8> Src(HostSize);
+    std::vector<U8> Dst(HostSize);
+    for (U64 I = 0; I < HostSize; ++I)
+    {
+        Src[I] = static_cast<U8>(I * 31);
+    }
+    // Touch the destination so page faults are not timed.
+    memset(Dst.data(), 0, HostSize);
+    MeasureSizes("host", Dst.data(), Src.data(), HostSize);
+
+    if (!PDevice)
+    {
+        return;
+    }
+
+    // Upload heaps are write-combined, the case the non-temporal kernels are meant for.
+    const U64 UploadSize = 64ULL * MEM_1MB;
+    ResourceCreateInfo CreateInfo = { };
+    CreateInfo.Dimension = ResourceDimension_BUFFER;
+    CreateInfo.Width = UploadSize;
+    CreateInfo.Height = 1;
+    CreateInfo.DepthOrArraySize = 1;
+    CreateInfo.Mips = 1;
+    CreateInfo.ResourceFormat = GFormat_UNKNOWN;
+    CreateInfo.Usage = ResourceUsage_CPU_UPLOAD;
+    CreateInfo.SampleCount = 1;
+    CreateInfo.SampleQuality = 0;
+
+    GPUHandle Upload = 0;
+    void* PMapped = nullptr;
+    if (PDevice->CreateResource(&Upload, &CreateInfo, nullptr) != SResult_OK)
+    {
+        printf("  upload buffer could not be created, skipped.\n");
+        return;
+    }
+    if (PDevice->MapResource(Upload, &PMapped) == SResult_OK)
+    {
+        MeasureSizes("upload", PMapped, Src.data(), UploadSize);
+        PDevice->UnmapResource(Upload);
+    }
+    PDevice->DestroyResource(Upload);
+}
+} // Synthe